@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * HW model which raises FD_EVENT_IRQ when a host file descriptor
+ * becomes readable, so that drivers talking to the host (like the
+ * TAP based ethernet driver) do not need to poll from Zephyr threads.
+ *
+ * Each registered descriptor is either armed or not.  Armed
+ * descriptors are checked with a non-blocking poll() every
+ * CONFIG_NATIVE_POSIX_FD_IRQ_PERIOD microseconds of simulated time
+ * (with select(), so FD_SETSIZE bounds the descriptor numbers).
+ * A readable one is disarmed and flagged as pending, and the
+ * interrupt raised.  The driver collects the flag from its ISR with
+ * hw_fd_irq_clear(), drains the descriptor and re-arms it with
+ * hw_fd_irq_arm().  While nothing is armed this model has no timer
+ * pending, so it costs nothing.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/select.h>
+#include <sys/util.h>
+#include "hw_models_top.h"
+#include "timer_model.h"
+#include "board_soc.h"
+#include "irq_ctrl.h"
+#include "hw_fd_irq.h"
+#include <arch/posix/posix_trace.h>
+
+#define HW_FD_IRQ_MAX 32
+
+uint64_t hw_fd_irq_timer;
+
+static struct {
+	int fd;
+	bool armed;
+	bool pending;
+} watches[HW_FD_IRQ_MAX];
+
+static int watch_count;
+
+void hw_fd_irq_init(void)
+{
+	hw_fd_irq_timer = NEVER;
+	watch_count = 0;
+}
+
+static bool any_armed(void)
+{
+	for (int i = 0; i < watch_count; i++) {
+		if (watches[i].armed) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void hw_fd_irq_triggered(void)
+{
+	struct timeval timeout;
+	uint64_t wait;
+	fd_set rset;
+	bool raise = false;
+	int max_fd = -1;
+
+	FD_ZERO(&rset);
+
+	for (int i = 0; i < watch_count; i++) {
+		if (watches[i].armed) {
+			FD_SET(watches[i].fd, &rset);
+			max_fd = MAX(max_fd, watches[i].fd);
+		}
+	}
+
+	/* When slowing down to real time, block on the descriptors until
+	 * this instant is due instead of racing ahead to the next tick.
+	 * That way data from the host is noticed as soon as it arrives.
+	 */
+	wait = hwtimer_get_real_time_wait(hw_fd_irq_timer);
+	timeout.tv_sec = wait / 1000000U;
+	timeout.tv_usec = wait % 1000000U;
+
+	if ((max_fd >= 0) &&
+	    (select(max_fd + 1, &rset, NULL, NULL, &timeout) > 0)) {
+		for (int i = 0; i < watch_count; i++) {
+			if (watches[i].armed &&
+			    FD_ISSET(watches[i].fd, &rset)) {
+				watches[i].armed = false;
+				watches[i].pending = true;
+				raise = true;
+			}
+		}
+	}
+
+	if (raise) {
+		hw_irq_ctrl_set_irq(FD_EVENT_IRQ);
+	}
+
+	if (any_armed()) {
+		hw_fd_irq_timer = hwm_get_time() +
+				  CONFIG_NATIVE_POSIX_FD_IRQ_PERIOD;
+	} else {
+		hw_fd_irq_timer = NEVER;
+	}
+}
+
+/**
+ * Register a host file descriptor, initially disarmed.
+ * Returns a handle for the other calls, or -1 if there is no room.
+ */
+int hw_fd_irq_register(int fd)
+{
+	if (watch_count >= HW_FD_IRQ_MAX) {
+		posix_print_warning("Too many fds watched for FD_EVENT_IRQ\n");
+		return -1;
+	}
+
+	watches[watch_count].fd = fd;
+	watches[watch_count].armed = false;
+	watches[watch_count].pending = false;
+
+	return watch_count++;
+}
+
+/**
+ * Start watching the descriptor. FD_EVENT_IRQ is raised once it is
+ * readable, after which it must be armed again.
+ */
+void hw_fd_irq_arm(int handle)
+{
+	watches[handle].armed = true;
+
+	if (hw_fd_irq_timer == NEVER) {
+		hw_fd_irq_timer = hwm_get_time() +
+				  CONFIG_NATIVE_POSIX_FD_IRQ_PERIOD;
+		hwm_find_next_timer();
+	}
+}
+
+/**
+ * Returns true (and clears the flag) if the descriptor became readable
+ * since the last call. To be called from the FD_EVENT_IRQ handler.
+ */
+bool hw_fd_irq_clear(int handle)
+{
+	bool pending = watches[handle].pending;
+
+	watches[handle].pending = false;
+
+	return pending;
+}
@@ -0,0 +1,28 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _NATIVE_POSIX_HW_FD_IRQ_H
+#define _NATIVE_POSIX_HW_FD_IRQ_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void hw_fd_irq_init(void);
+void hw_fd_irq_triggered(void);
+
+int hw_fd_irq_register(int fd);
+void hw_fd_irq_arm(int handle);
+bool hw_fd_irq_clear(int handle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _NATIVE_POSIX_HW_FD_IRQ_H */
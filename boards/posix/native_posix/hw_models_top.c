@@ -22,6 +22,7 @@
 #include <arch/posix/posix_soc_if.h>
 #include "posix_arch_internal.h"
 #include "sdl_events.h"
+#include "hw_fd_irq.h"
 #include <sys/util.h>
 
 
@@ -35,6 +36,9 @@ extern uint64_t hw_counter_timer;
 #ifdef CONFIG_HAS_SDL
 extern uint64_t sdl_event_timer;
 #endif
+#ifdef CONFIG_NATIVE_POSIX_FD_IRQ
+extern uint64_t hw_fd_irq_timer;
+#endif
 
 static enum {
 	HWTIMER = 0,
@@ -42,6 +46,9 @@ static enum {
 	HW_COUNTER,
 #ifdef CONFIG_HAS_SDL
 	SDLEVENTTIMER,
+#endif
+#ifdef CONFIG_NATIVE_POSIX_FD_IRQ
+	FD_IRQ,
 #endif
 	NUMBER_OF_TIMERS,
 	NONE
@@ -54,6 +61,9 @@ static uint64_t *Timer_list[NUMBER_OF_TIMERS] = {
 #ifdef CONFIG_HAS_SDL
 	&sdl_event_timer,
 #endif
+#ifdef CONFIG_NATIVE_POSIX_FD_IRQ
+	&hw_fd_irq_timer,
+#endif
 };
 
 static uint64_t next_timer_time;
@@ -160,6 +170,11 @@ void hwm_main_loop(void)
 		case SDLEVENTTIMER:
 			sdl_handle_events();
 			break;
+#endif
+#ifdef CONFIG_NATIVE_POSIX_FD_IRQ
+		case FD_IRQ:
+			hw_fd_irq_triggered();
+			break;
 #endif
 		default:
 			/* LCOV_EXCL_START */
@@ -203,6 +218,9 @@ void hwm_init(void)
 	hwtimer_init();
 	hw_counter_init();
 	hw_irq_ctrl_init();
+#ifdef CONFIG_NATIVE_POSIX_FD_IRQ
+	hw_fd_irq_init();
+#endif
 
 	hwm_find_next_timer();
 }
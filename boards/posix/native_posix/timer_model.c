@@ -184,6 +184,26 @@ void hwtimer_enable(uint64_t period)
 	hwm_find_next_timer();
 }
 
+/**
+ * Return how many host microseconds are left until simulated time
+ * <sim_time> is due in real time, or 0 if it already is or we are not
+ * slowing down to real time
+ */
+uint64_t hwtimer_get_real_time_wait(uint64_t sim_time)
+{
+	uint64_t expected_rt, real_time;
+
+	if (!real_time_mode) {
+		return 0;
+	}
+
+	expected_rt = (sim_time - last_radj_stime) / clock_ratio
+		      + last_radj_rtime;
+	real_time = get_host_us_time();
+
+	return expected_rt > real_time ? expected_rt - real_time : 0;
+}
+
 static void hwtimer_tick_timer_reached(void)
 {
 	if (real_time_mode) {
@@ -37,6 +37,11 @@ LOG_MODULE_REGISTER(LOG_MODULE_NAME);
 #include "eth_native_posix_priv.h"
 #include "eth.h"
 
+#if defined(CONFIG_ETH_NATIVE_POSIX_RX_IRQ)
+#include "board_soc.h"
+#include "hw_fd_irq.h"
+#endif
+
 #define NET_BUF_TIMEOUT K_MSEC(100)
 
 #if defined(CONFIG_NET_VLAN)
@@ -56,6 +61,10 @@ struct eth_context {
 	struct z_thread_stack_element *rx_stack;
 	size_t rx_stack_size;
 	int dev_fd;
+#if defined(CONFIG_ETH_NATIVE_POSIX_RX_IRQ)
+	int fd_irq;
+	struct k_sem rx_sem;
+#endif
 	bool init_done;
 	bool status;
 	bool promisc_mode;
@@ -294,6 +303,76 @@ error:
 }
 #endif
 
+#if !defined(CONFIG_NET_VLAN)
+/* Read the frame from the host directly into the fragments of a freshly
+ * allocated packet, avoiding the copy through ctx->recv. Returns 0 if
+ * there was nothing to read, 1 if a packet was received and a negative
+ * value on error.
+ */
+static int read_pkt(struct eth_context *ctx, int fd, struct net_pkt **out)
+{
+	void *bufs[ETH_NATIVE_POSIX_MAX_FRAGS];
+	size_t lens[ETH_NATIVE_POSIX_MAX_FRAGS];
+	struct net_buf *buf, *prev;
+	struct net_pkt *pkt;
+	int frags = 0;
+	int count;
+
+	pkt = net_pkt_rx_alloc_with_buffer(ctx->iface, sizeof(ctx->recv),
+					   AF_UNSPEC, 0, NET_BUF_TIMEOUT);
+	if (!pkt) {
+		return -ENOMEM;
+	}
+
+	for (buf = pkt->buffer; buf; buf = buf->frags) {
+		if (frags == ETH_NATIVE_POSIX_MAX_FRAGS) {
+			/* Too small buffers to cover a frame, so fall back
+			 * to reading via the bounce buffer.
+			 */
+			net_pkt_unref(pkt);
+			return -E2BIG;
+		}
+
+		bufs[frags] = net_buf_tail(buf);
+		lens[frags] = net_buf_tailroom(buf);
+		frags++;
+	}
+
+	count = eth_read_data_frags(fd, bufs, lens, frags);
+	if (count <= 0) {
+		net_pkt_unref(pkt);
+		return 0;
+	}
+
+	/* Account the received bytes and give back the unused tail */
+	prev = NULL;
+	buf = pkt->buffer;
+
+	while (buf) {
+		size_t len = MIN((size_t)count, net_buf_tailroom(buf));
+
+		if (len == 0U && prev) {
+			net_buf_frag_del(prev, buf);
+			buf = prev->frags;
+			continue;
+		}
+
+		net_buf_add(buf, len);
+		count -= len;
+		prev = buf;
+		buf = buf->frags;
+	}
+
+	net_pkt_cursor_init(pkt);
+
+	LOG_DBG("Recv pkt %p len %zd", pkt, net_pkt_get_len(pkt));
+
+	*out = pkt;
+
+	return 1;
+}
+#endif
+
 static struct net_pkt *prepare_non_vlan_pkt(struct eth_context *ctx,
 					    int count, int *status)
 {
@@ -327,6 +406,17 @@ static int read_data(struct eth_context *ctx, int fd)
 	int status;
 	int count;
 
+#if !defined(CONFIG_NET_VLAN)
+	status = read_pkt(ctx, fd, &pkt);
+	if (status == 0) {
+		return 0;
+	} else if (status > 0) {
+		goto received;
+	} else if (status != -E2BIG) {
+		return status;
+	}
+#endif
+
 	count = eth_read_data(fd, ctx->recv, sizeof(ctx->recv));
 	if (count <= 0) {
 		return 0;
@@ -357,6 +447,8 @@ static int read_data(struct eth_context *ctx, int fd)
 			return status;
 		}
 	}
+
+received:
 #endif
 
 	iface = get_iface(ctx, vlan_tag);
@@ -370,15 +462,93 @@ static int read_data(struct eth_context *ctx, int fd)
 	return 0;
 }
 
+/* Read at most CONFIG_ETH_NATIVE_POSIX_RX_BATCH frames. Returns true if
+ * the host still has data pending for us.
+ */
+static bool read_batch(struct eth_context *ctx)
+{
+	for (int i = 0; i < CONFIG_ETH_NATIVE_POSIX_RX_BATCH; i++) {
+		if (eth_wait_data(ctx->dev_fd)) {
+			return false;
+		}
+
+		read_data(ctx, ctx->dev_fd);
+	}
+
+	return !eth_wait_data(ctx->dev_fd);
+}
+
+#if defined(CONFIG_ETH_NATIVE_POSIX_RX_IRQ)
+static struct eth_context *rx_irq_ctx[CONFIG_ETH_NATIVE_POSIX_INTERFACE_COUNT];
+
+static void eth_rx_isr(const void *arg)
+{
+	ARG_UNUSED(arg);
+
+	for (int i = 0; i < ARRAY_SIZE(rx_irq_ctx); i++) {
+		struct eth_context *ctx = rx_irq_ctx[i];
+
+		if (ctx && hw_fd_irq_clear(ctx->fd_irq)) {
+			k_sem_give(&ctx->rx_sem);
+		}
+	}
+}
+
+static void rx_irq_setup(struct eth_context *ctx)
+{
+	static bool connected;
+
+	k_sem_init(&ctx->rx_sem, 0, 1);
+
+	ctx->fd_irq = hw_fd_irq_register(ctx->dev_fd);
+	if (ctx->fd_irq < 0) {
+		return;
+	}
+
+	for (int i = 0; i < ARRAY_SIZE(rx_irq_ctx); i++) {
+		if (rx_irq_ctx[i] == NULL) {
+			rx_irq_ctx[i] = ctx;
+			break;
+		}
+	}
+
+	if (!connected) {
+		IRQ_CONNECT(FD_EVENT_IRQ, 1, eth_rx_isr, NULL, 0);
+		irq_enable(FD_EVENT_IRQ);
+		connected = true;
+	}
+}
+
+static bool rx_irq_wait(struct eth_context *ctx)
+{
+	if (ctx->fd_irq < 0 || !net_if_is_up(ctx->iface)) {
+		return false;
+	}
+
+	hw_fd_irq_arm(ctx->fd_irq);
+	k_sem_take(&ctx->rx_sem, K_FOREVER);
+
+	return true;
+}
+#else
+#define rx_irq_setup(ctx)
+#define rx_irq_wait(ctx) false
+#endif /* CONFIG_ETH_NATIVE_POSIX_RX_IRQ */
+
 static void eth_rx(struct eth_context *ctx)
 {
 	LOG_DBG("Starting ZETH RX thread");
 
 	while (1) {
 		if (net_if_is_up(ctx->iface)) {
-			while (!eth_wait_data(ctx->dev_fd)) {
-				read_data(ctx, ctx->dev_fd);
+			if (read_batch(ctx)) {
+				/* More frames pending, let others run first */
 				k_yield();
+				continue;
+			}
+
+			if (rx_irq_wait(ctx)) {
+				continue;
 			}
 		}
 
@@ -482,6 +652,8 @@ static void eth_iface_init(struct net_if *iface)
 	if (ctx->dev_fd < 0) {
 		LOG_ERR("Cannot create %s (%d)", ctx->if_name, -errno);
 	} else {
+		rx_irq_setup(ctx);
+
 		/* Create a thread that will handle incoming data from host */
 		create_rx_handler(ctx);
 
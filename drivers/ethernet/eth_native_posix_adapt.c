@@ -23,6 +23,7 @@
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <sys/select.h>
+#include <sys/uio.h>
 #include <net/if.h>
 #include <time.h>
 #include <arch/posix/posix_trace.h>
@@ -170,6 +171,23 @@ ssize_t eth_read_data(int fd, void *buf, size_t buf_len)
 	return read(fd, buf, buf_len);
 }
 
+ssize_t eth_read_data_frags(int fd, void **bufs, size_t *lens, int count)
+{
+	struct iovec iov[ETH_NATIVE_POSIX_MAX_FRAGS];
+	int i;
+
+	if (count > ETH_NATIVE_POSIX_MAX_FRAGS) {
+		count = ETH_NATIVE_POSIX_MAX_FRAGS;
+	}
+
+	for (i = 0; i < count; i++) {
+		iov[i].iov_base = bufs[i];
+		iov[i].iov_len = lens[i];
+	}
+
+	return readv(fd, iov, count);
+}
+
 ssize_t eth_write_data(int fd, void *buf, size_t buf_len)
 {
 	return write(fd, buf, buf_len);
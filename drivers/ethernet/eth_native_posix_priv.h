@@ -14,6 +14,9 @@
 #define ETH_NATIVE_POSIX_DRV_NAME CONFIG_ETH_NATIVE_POSIX_DRV_NAME
 #define ETH_NATIVE_POSIX_DEV_NAME CONFIG_ETH_NATIVE_POSIX_DEV_NAME
 
+/* Upper bound of net_buf fragments a frame is read into at once */
+#define ETH_NATIVE_POSIX_MAX_FRAGS 32
+
 #if defined(CONFIG_ETH_NATIVE_POSIX_STARTUP_AUTOMATIC)
 #define ETH_NATIVE_POSIX_SETUP_SCRIPT CONFIG_ETH_NATIVE_POSIX_SETUP_SCRIPT
 #define ETH_NATIVE_POSIX_STARTUP_SCRIPT CONFIG_ETH_NATIVE_POSIX_STARTUP_SCRIPT
@@ -31,6 +34,7 @@ int eth_setup_host(const char *if_name);
 int eth_start_script(const char *if_name);
 int eth_wait_data(int fd);
 ssize_t eth_read_data(int fd, void *buf, size_t buf_len);
+ssize_t eth_read_data_frags(int fd, void **bufs, size_t *lens, int count);
 ssize_t eth_write_data(int fd, void *buf, size_t buf_len);
 int eth_if_up(const char *if_name);
 int eth_if_down(const char *if_name);
@@ -23,6 +23,47 @@ LOG_MODULE_REGISTER(LOG_MODULE_NAME);
 #include <net/net_if.h>
 
 #include <net/dummy.h>
+#include <net/loopback.h>
+
+#if defined(CONFIG_NET_LOOPBACK_SIMULATE_PACKET_DROP)
+static float loopback_packet_drop_ratio;
+static float loopback_packet_drop_state;
+static int loopback_packet_dropped_count;
+
+int loopback_set_packet_drop_ratio(float ratio)
+{
+	if (ratio < 0.0f || ratio > 1.0f) {
+		return -EINVAL;
+	}
+
+	loopback_packet_drop_ratio = ratio;
+
+	return 0;
+}
+
+int loopback_get_num_dropped_packets(void)
+{
+	return loopback_packet_dropped_count;
+}
+
+/* Drops are spread evenly rather than randomly so that tests are
+ * repeatable.
+ */
+static bool loopback_packet_drop(void)
+{
+	loopback_packet_drop_state += loopback_packet_drop_ratio;
+
+	if (loopback_packet_drop_state >= 1.0f) {
+		loopback_packet_drop_state -= 1.0f;
+		loopback_packet_dropped_count++;
+		return true;
+	}
+
+	return false;
+}
+#else
+#define loopback_packet_drop() false
+#endif /* CONFIG_NET_LOOPBACK_SIMULATE_PACKET_DROP */
 
 int loopback_dev_init(const struct device *dev)
 {
@@ -50,6 +91,12 @@ static int loopback_send(const struct device *dev, struct net_pkt *pkt)
 		return -ENODATA;
 	}
 
+	if (loopback_packet_drop()) {
+		/* Lost on the way, which is a successful send for us */
+		res = 0;
+		goto out;
+	}
+
 	/* We need to swap the IP addresses because otherwise
 	 * the packet will be dropped.
 	 */
@@ -81,6 +128,13 @@ static int loopback_send(const struct device *dev, struct net_pkt *pkt)
 		goto out;
 	}
 
+	/* The packet never left the host so there is no need to verify
+	 * the checksums calculated when it was sent.
+	 */
+	if (IS_ENABLED(CONFIG_NET_LOOPBACK_SKIP_CHECKSUM)) {
+		net_pkt_set_chksum_done(cloned, true);
+	}
+
 	res = net_recv_data(net_pkt_iface(cloned), cloned);
 	if (res < 0) {
 		LOG_ERR("Data receive failed.");
@@ -2519,6 +2519,9 @@ struct k_mutex {
 	/** Original thread priority */
 	int owner_orig_prio;
 
+	/** Owner and whether threads wait for it, the lock itself */
+	atomic_ptr_t state;
+
 	_OBJECT_TRACING_NEXT_PTR(k_mutex)
 	_OBJECT_TRACING_LINKED_FLAG
 };
@@ -2532,6 +2535,7 @@ struct k_mutex {
 	.owner = NULL, \
 	.lock_count = 0, \
 	.owner_orig_prio = K_LOWEST_THREAD_PRIO, \
+	.state = NULL, \
 	_OBJECT_TRACING_INIT \
 	}
 
@@ -4130,6 +4134,8 @@ struct k_msgq {
 
 	/** Message queue */
 	uint8_t flags;
+
+	_POLL_EVENT;
 };
 /**
  * @cond INTERNAL_HIDDEN
@@ -4147,6 +4153,7 @@ struct k_msgq {
 	.write_ptr = q_buffer, \
 	.used_msgs = 0, \
 	_OBJECT_TRACING_INIT \
+	_POLL_EVENT_OBJ_INIT(obj) \
 	}
 
 /**
@@ -4155,6 +4162,10 @@ struct k_msgq {
 
 
 #define K_MSGQ_FLAG_ALLOC	BIT(0)
+/* The slot at write_ptr is claimed by a producer */
+#define K_MSGQ_FLAG_PUT_CLAIMED	BIT(1)
+/* The message at read_ptr is claimed by a consumer */
+#define K_MSGQ_FLAG_GET_CLAIMED	BIT(2)
 
 /**
  * @brief Message Queue Attributes
@@ -4268,6 +4279,7 @@ int k_msgq_cleanup(struct k_msgq *msgq);
  *                K_FOREVER.
  *
  * @retval 0 Message sent.
+ * @retval -EBUSY A k_msgq_put_claim() holds the sending side of the queue.
  * @retval -ENOMSG Returned without waiting or queue purged.
  * @retval -EAGAIN Waiting period timed out.
  */
@@ -4288,6 +4300,7 @@ __syscall int k_msgq_put(struct k_msgq *msgq, const void *data, k_timeout_t time
  *                K_FOREVER.
  *
  * @retval 0 Message received.
+ * @retval -EBUSY A k_msgq_get_claim() holds the receiving side of the queue.
  * @retval -ENOMSG Returned without waiting.
  * @retval -EAGAIN Waiting period timed out.
  */
@@ -4309,12 +4322,113 @@ __syscall int k_msgq_get(struct k_msgq *msgq, void *data, k_timeout_t timeout);
  */
 __syscall int k_msgq_peek(struct k_msgq *msgq, void *data);
 
+/**
+ * @brief Claim space for a message in a message queue.
+ *
+ * This routine reserves the next free slot of message queue @a msgq and
+ * returns a pointer to it, so that the message can be built in place
+ * instead of being copied in by k_msgq_put(). The message is sent by
+ * k_msgq_put_commit().
+ *
+ * A claim holds the sending side of the queue: until it is committed,
+ * k_msgq_put() and k_msgq_put_claim() fail with -EBUSY. Threads already
+ * waiting to send when the claim is granted keep waiting, and are served
+ * once it is committed. Claims are meant for queues with a single producer.
+ *
+ * User mode threads can't access the ring buffer, @a buf is then given
+ * in its place and k_msgq_put_commit() copies it into the queue.
+ *
+ * @note Can be called by ISRs, but @a timeout must be set to K_NO_WAIT.
+ *
+ * @param msgq Address of the message queue.
+ * @param data Address of the pointer to set to the claimed slot.
+ * @param buf Message sized buffer used in user mode, may be NULL otherwise.
+ * @param timeout Waiting period for a free slot,
+ *                or one of the special values K_NO_WAIT and
+ *                K_FOREVER.
+ *
+ * @retval 0 Slot claimed.
+ * @retval -EBUSY Another claim holds the sending side of the queue.
+ * @retval -ENOMSG Returned without waiting or queue purged.
+ * @retval -EAGAIN Waiting period timed out.
+ */
+__syscall int k_msgq_put_claim(struct k_msgq *msgq, void **data, void *buf,
+			       k_timeout_t timeout);
+
+/**
+ * @brief Send a message claimed with k_msgq_put_claim().
+ *
+ * The message is handed to the first thread waiting to receive, or
+ * becomes the last message of the queue.
+ *
+ * @note Can be called by ISRs.
+ *
+ * @param msgq Address of the message queue.
+ * @param data Pointer given by k_msgq_put_claim(), or NULL to give the
+ *             claimed slot back without sending a message.
+ *
+ * @retval 0 Message sent, or claim given back.
+ * @retval -EINVAL No claim is outstanding.
+ */
+__syscall int k_msgq_put_commit(struct k_msgq *msgq, const void *data);
+
+/**
+ * @brief Claim the first message of a message queue.
+ *
+ * This routine returns a pointer to the first message of message queue
+ * @a msgq, which stays in the ring buffer until k_msgq_get_commit() is
+ * called, so that it can be used in place instead of being copied out
+ * by k_msgq_get().
+ *
+ * A claim holds the receiving side of the queue: until it is committed,
+ * k_msgq_get() and k_msgq_get_claim() fail with -EBUSY, and k_poll() does
+ * not report the queue as readable. Threads already waiting to receive
+ * when the claim is granted keep waiting: those in k_msgq_get() are still
+ * given new messages, those in k_msgq_get_claim() are served once the
+ * claim is committed. Claims are meant for queues with a single consumer.
+ *
+ * User mode threads can't access the ring buffer, the message is then
+ * copied into @a buf which is given in its place.
+ *
+ * @note Can be called by ISRs, but @a timeout must be set to K_NO_WAIT.
+ *
+ * @param msgq Address of the message queue.
+ * @param data Address of the pointer to set to the claimed message.
+ * @param buf Message sized buffer used in user mode, may be NULL otherwise.
+ * @param timeout Waiting period for a message,
+ *                or one of the special values K_NO_WAIT and
+ *                K_FOREVER.
+ *
+ * @retval 0 Message claimed.
+ * @retval -EBUSY Another claim holds the receiving side of the queue.
+ * @retval -ENOMSG Returned without waiting.
+ * @retval -EAGAIN Waiting period timed out.
+ */
+__syscall int k_msgq_get_claim(struct k_msgq *msgq, void **data, void *buf,
+			       k_timeout_t timeout);
+
+/**
+ * @brief Remove a message claimed with k_msgq_get_claim().
+ *
+ * The claimed message is removed from the queue and its slot is given
+ * to the first thread waiting to send, if any.
+ *
+ * @note Can be called by ISRs.
+ *
+ * @param msgq Address of the message queue.
+ *
+ * @retval 0 Message removed.
+ * @retval -EINVAL No claim is outstanding, or the queue was purged.
+ */
+__syscall int k_msgq_get_commit(struct k_msgq *msgq);
+
 /**
  * @brief Purge a message queue.
  *
  * This routine discards all unreceived messages in a message queue's ring
  * buffer. Any threads that are blocked waiting to send a message to the
- * message queue are unblocked and see an -ENOMSG error code.
+ * message queue are unblocked and see an -ENOMSG error code. An outstanding
+ * k_msgq_get_claim() is dropped along with its message.
  *
  * @param msgq Address of the message queue.
  *
@@ -4904,10 +5018,15 @@ static inline uint32_t k_mem_slab_num_free_get(struct k_mem_slab *slab)
 
 /* kernel synchronized heap struct */
 
+struct sys_heap_cache;
+
 struct k_heap {
 	struct sys_heap heap;
 	_wait_q_t wait_q;
 	struct k_spinlock lock;
+#ifdef CONFIG_SYS_HEAP_CPU_CACHE
+	struct sys_heap_cache *cache;
+#endif
 };
 
 /**
@@ -4979,6 +5098,96 @@ static inline void *k_heap_alloc(struct k_heap *h, size_t bytes,
  */
 void k_heap_free(struct k_heap *h, void *mem);
 
+#if defined(CONFIG_SYS_HEAP_CPU_CACHE) || defined(__DOXYGEN__)
+/**
+ * @brief Attach per-CPU caches of small blocks to a k_heap
+ *
+ * Once attached, small allocations and frees of the heap are served
+ * from per-CPU magazines and only take the lock of the heap to move
+ * blocks in batches, see sys_heap_cache.  The cached blocks are given
+ * back to the heap before an allocation fails or waits.
+ *
+ * @param h Heap to attach the cache to
+ * @param cache Cache, owned by the heap from now on
+ */
+void k_heap_cache_init(struct k_heap *h, struct sys_heap_cache *cache);
+#endif
+
+/**
+ * @brief Get the layout of the free memory of a k_heap
+ *
+ * Builds a histogram of the free chunks and computes a fragmentation
+ * index, see sys_heap_frag_stats_get().  The heap is locked for the
+ * time it takes to walk all of its free chunks.
+ *
+ * @param h Heap to inspect
+ * @param stats Filled with the layout of the free memory
+ */
+void k_heap_frag_stats_get(struct k_heap *h, struct sys_heap_frag_stats *stats);
+
+#if defined(CONFIG_SYS_HEAP_RUNTIME_STATS) || defined(__DOXYGEN__)
+/**
+ * @brief Get the memory usage of a k_heap
+ *
+ * @param h Heap to inspect
+ * @param stats Filled with the free and allocated bytes and the
+ *        high-water mark of the allocated bytes
+ */
+void k_heap_runtime_stats_get(struct k_heap *h, struct sys_memory_stats *stats);
+
+/**
+ * @brief Reset the high-water mark of a k_heap to its current usage
+ *
+ * @param h Heap to reset
+ */
+void k_heap_runtime_stats_reset_max(struct k_heap *h);
+#endif
+
+#if defined(CONFIG_K_HEAP_SITE_STATS) || defined(__DOXYGEN__)
+/**
+ * @brief Allocations of a k_heap made from one call site
+ */
+struct k_heap_site {
+	/** Return address of the allocation call, NULL for the entry that
+	 *  collects the sites which did not fit in the table.
+	 */
+	const void *site;
+	/** Heap allocated from */
+	struct k_heap *heap;
+	/** Number of successful allocations */
+	uint32_t allocs;
+	/** Number of frees */
+	uint32_t frees;
+	/** Number of failed allocations */
+	uint32_t failures;
+	/** Bytes currently allocated */
+	size_t bytes;
+	/** High-water mark of bytes */
+	size_t max_bytes;
+};
+
+/**
+ * @typedef k_heap_site_cb_t
+ * @brief Callback used while iterating over the call sites
+ *
+ * @param site Snapshot of the statistics of one call site
+ * @param user_data A valid pointer on some user data or NULL
+ */
+typedef void (*k_heap_site_cb_t)(const struct k_heap_site *site,
+				 void *user_data);
+
+/**
+ * @brief Go through the call sites that allocated from any k_heap
+ *
+ * The allocations made through k_malloc() and the thread resource
+ * pools are accounted to the caller of these functions.
+ *
+ * @param cb Callback called for each call site, without any lock held
+ * @param user_data User specified data or NULL
+ */
+void k_heap_site_foreach(k_heap_site_cb_t cb, void *user_data);
+#endif
+
 /**
  * @brief Define a static k_heap
  *
@@ -5095,6 +5304,9 @@ enum _poll_types_bits {
 	/* queue/FIFO/LIFO data availability */
 	_POLL_TYPE_DATA_AVAILABLE,
 
+	/* msgq data availability */
+	_POLL_TYPE_MSGQ_DATA_AVAILABLE,
+
 	_POLL_NUM_TYPES
 };
 
@@ -5117,6 +5329,9 @@ enum _poll_states_bits {
 	/* queue/FIFO/LIFO wait was cancelled */
 	_POLL_STATE_CANCELLED,
 
+	/* data is available to read on a message queue */
+	_POLL_STATE_MSGQ_DATA_AVAILABLE,
+
 	_POLL_NUM_STATES
 };
 
@@ -5147,6 +5362,7 @@ enum _poll_states_bits {
 #define K_POLL_TYPE_SEM_AVAILABLE Z_POLL_TYPE_BIT(_POLL_TYPE_SEM_AVAILABLE)
 #define K_POLL_TYPE_DATA_AVAILABLE Z_POLL_TYPE_BIT(_POLL_TYPE_DATA_AVAILABLE)
 #define K_POLL_TYPE_FIFO_DATA_AVAILABLE K_POLL_TYPE_DATA_AVAILABLE
+#define K_POLL_TYPE_MSGQ_DATA_AVAILABLE Z_POLL_TYPE_BIT(_POLL_TYPE_MSGQ_DATA_AVAILABLE)
 
 /* public - polling modes */
 enum k_poll_modes {
@@ -5163,6 +5379,7 @@ enum k_poll_modes {
 #define K_POLL_STATE_DATA_AVAILABLE Z_POLL_STATE_BIT(_POLL_STATE_DATA_AVAILABLE)
 #define K_POLL_STATE_FIFO_DATA_AVAILABLE K_POLL_STATE_DATA_AVAILABLE
 #define K_POLL_STATE_CANCELLED Z_POLL_STATE_BIT(_POLL_STATE_CANCELLED)
+#define K_POLL_STATE_MSGQ_DATA_AVAILABLE Z_POLL_STATE_BIT(_POLL_STATE_MSGQ_DATA_AVAILABLE)
 
 /* public - poll signal object */
 struct k_poll_signal {
@@ -5218,6 +5435,7 @@ struct k_poll_event {
 		struct k_sem *sem;
 		struct k_fifo *fifo;
 		struct k_queue *queue;
+		struct k_msgq *msgq;
 	};
 };
 
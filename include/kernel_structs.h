@@ -218,6 +218,10 @@ typedef void (*_timeout_func_t)(struct _timeout *t);
 struct _timeout {
 	sys_dnode_t node;
 	_timeout_func_t fn;
+#ifdef CONFIG_TIMEOUT_QUEUE_PER_CPU
+	/* Index of the per-CPU queue this timeout was armed on */
+	uint8_t queue;
+#endif
 #ifdef CONFIG_TIMEOUT_64BIT
 	/* Can't use k_ticks_t for header dependency reasons */
 	int64_t dticks;
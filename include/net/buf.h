@@ -975,6 +975,8 @@ struct net_buf_data_alloc {
 	void *alloc_data;
 };
 
+struct net_buf_cache;
+
 /**
  * @brief Network buffer pool representation.
  *
@@ -1007,6 +1009,11 @@ struct net_buf_pool {
 	/** Data allocation handlers. */
 	const struct net_buf_data_alloc *alloc;
 
+#if defined(CONFIG_NET_BUF_CPU_CACHE)
+	/** Optional per-CPU cache of free buffers, see net_buf_cache */
+	struct net_buf_cache *cache;
+#endif /* CONFIG_NET_BUF_CPU_CACHE */
+
 	/** Start of buffer storage array */
 	struct net_buf * const __bufs;
 };
@@ -1188,6 +1195,129 @@ extern const struct net_buf_data_cb net_buf_var_cb;
 	BUILD_ASSERT(_ud_size <= CONFIG_NET_BUF_USER_DATA_SIZE);             \
 	NET_BUF_POOL_FIXED_DEFINE(_name, _count, _size, _destroy)
 
+#if defined(CONFIG_NET_BUF_CPU_CACHE)
+/**
+ * @brief Backing allocator of a per-CPU buffer cache.
+ */
+struct net_buf_cache_ops {
+	/** Take up to @a count free objects without waiting, return how
+	 *  many were taken.
+	 */
+	size_t (*get_bulk)(void *backend, void **objs, size_t count);
+
+	/** Take one free object, waiting up to @a timeout. */
+	void *(*get)(void *backend, k_timeout_t timeout);
+
+	/** Give back @a count objects. */
+	void (*put_bulk)(void *backend, void **objs, size_t count);
+};
+
+/** @cond INTERNAL_HIDDEN */
+struct net_buf_cache_mag {
+	struct k_spinlock lock;
+	uint16_t count;
+#if defined(CONFIG_NET_BUF_POOL_USAGE)
+	uint32_t hits;
+	uint32_t misses;
+#endif
+	void *objs[CONFIG_NET_BUF_CPU_CACHE_SIZE];
+};
+/** @endcond */
+
+/**
+ * @brief Per-CPU cache of free objects in front of a shared allocator.
+ *
+ * Each CPU keeps a small stack (magazine) of free objects. Allocations
+ * and frees are served from the magazine of the current CPU without
+ * touching the shared allocator, which is only called to refill an
+ * empty magazine or to drain a full one, half a magazine at a time.
+ *
+ * When the shared allocator runs dry, the magazines of all the CPUs are
+ * drained back to it before giving up or waiting, and while anyone
+ * waits, frees go straight to the shared allocator, so cached objects
+ * never starve a waiter.
+ */
+struct net_buf_cache {
+	/** @cond INTERNAL_HIDDEN */
+	struct net_buf_cache_mag mags[CONFIG_MP_NUM_CPUS];
+	atomic_t waiters;
+	const struct net_buf_cache_ops *ops;
+	void *backend;
+	/** @endcond */
+};
+
+/**
+ * @brief Static initializer of a per-CPU buffer cache.
+ *
+ * @param _ops Backing allocator operations, struct net_buf_cache_ops.
+ * @param _backend Backing allocator, passed to the operations.
+ */
+#define NET_BUF_CACHE_INITIALIZER(_ops, _backend) \
+	{                                         \
+		.ops = _ops,                      \
+		.backend = _backend,              \
+	}
+
+/** Operations for a cache in front of a buffer pool, see net_buf_pool. */
+extern const struct net_buf_cache_ops net_buf_pool_cache_ops;
+
+/**
+ * @brief Static initializer of a per-CPU cache of a buffer pool.
+ *
+ * The cache is used once it is set as the @c cache of the pool.
+ *
+ * @param _pool Name of the pool.
+ */
+#define NET_BUF_POOL_CACHE_INITIALIZER(_pool) \
+	NET_BUF_CACHE_INITIALIZER(&net_buf_pool_cache_ops, &_pool)
+
+/**
+ * @brief Allocate an object through a per-CPU cache.
+ *
+ * @param cache Cache.
+ * @param timeout How long to wait when no object is free.
+ *
+ * @return Object or NULL if none was free in time.
+ */
+void *net_buf_cache_get(struct net_buf_cache *cache, k_timeout_t timeout);
+
+/**
+ * @brief Free an object through a per-CPU cache.
+ *
+ * @param cache Cache.
+ * @param obj Object taken with net_buf_cache_get().
+ */
+void net_buf_cache_put(struct net_buf_cache *cache, void *obj);
+
+/**
+ * @brief Give all the cached objects back to the shared allocator.
+ *
+ * @param cache Cache.
+ */
+void net_buf_cache_flush(struct net_buf_cache *cache);
+
+/**
+ * @brief Number of free objects held in the per-CPU caches.
+ *
+ * @param cache Cache.
+ *
+ * @return Number of cached objects.
+ */
+size_t net_buf_cache_count(struct net_buf_cache *cache);
+
+#if defined(CONFIG_NET_BUF_POOL_USAGE)
+/**
+ * @brief Get the allocation statistics of a per-CPU cache.
+ *
+ * @param cache Cache.
+ * @param hits Number of allocations served from a magazine.
+ * @param misses Number of allocations that had to refill one.
+ */
+void net_buf_cache_stats(struct net_buf_cache *cache, uint32_t *hits,
+			 uint32_t *misses);
+#endif /* CONFIG_NET_BUF_POOL_USAGE */
+#endif /* CONFIG_NET_BUF_CPU_CACHE */
+
 /**
  * @brief Looks up a pool based on its ID.
  *
@@ -1339,6 +1469,13 @@ static inline void net_buf_destroy(struct net_buf *buf)
 {
 	struct net_buf_pool *pool = net_buf_pool_get(buf->pool_id);
 
+#if defined(CONFIG_NET_BUF_CPU_CACHE)
+	if (pool->cache) {
+		net_buf_cache_put(pool->cache, buf);
+		return;
+	}
+#endif
+
 	k_lifo_put(&pool->free, buf);
 }
 
@@ -417,6 +417,44 @@ static inline int dns_cancel_addr_info(uint16_t dns_id)
 	return dns_resolve_cancel(dns_resolve_get_default(), dns_id);
 }
 
+/**
+ * @typedef dns_resolve_cache_cb_t
+ * @brief Callback used while iterating over the cached DNS answers
+ *
+ * @param query Name the answer is for
+ * @param type Query type of the answer
+ * @param info Cached address, NULL if the name was not found
+ * @param status 0 for an address, otherwise the status the resolving of
+ *        the name ended with, e.g. DNS_EAI_FAIL or DNS_EAI_NODATA.
+ * @param ttl Seconds until the answer expires
+ * @param user_data The user data given in dns_resolve_cache_foreach() call.
+ */
+typedef void (*dns_resolve_cache_cb_t)(const char *query,
+				       enum dns_query_type type,
+				       const struct dns_addrinfo *info,
+				       int status,
+				       uint32_t ttl,
+				       void *user_data);
+
+/**
+ * @brief Go through the cached DNS answers.
+ *
+ * @details The cache is used if CONFIG_DNS_RESOLVER_CACHE is enabled.
+ * The callback is called once for each cached address, and once for each
+ * name that was not found.
+ *
+ * @param cb Callback to call for each cached answer.
+ * @param user_data The user data.
+ */
+void dns_resolve_cache_foreach(dns_resolve_cache_cb_t cb, void *user_data);
+
+/**
+ * @brief Drop all the cached DNS answers.
+ *
+ * @details The following queries are sent to the DNS servers again.
+ */
+void dns_resolve_cache_flush(void);
+
 /**
  * @}
  */
@@ -150,6 +150,11 @@ enum ethernet_hw_caps {
 	/** DSA switch */
 	ETHERNET_DSA_SLAVE_PORT	= BIT(15),
 	ETHERNET_DSA_MASTER_PORT	= BIT(16),
+
+	/** TCP segmentation offload, packets larger than the MTU are cut
+	 * to segments of net_pkt_gso_size() bytes, checksums included.
+	 */
+	ETHERNET_HW_TX_SEG		= BIT(17),
 };
 
 /** @cond INTERNAL_HIDDEN */
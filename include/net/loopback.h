@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2021 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Network loopback interface
+ */
+
+#ifndef ZEPHYR_INCLUDE_NET_LOOPBACK_H_
+#define ZEPHYR_INCLUDE_NET_LOOPBACK_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Loopback interface
+ * @defgroup loopback Loopback Interface
+ * @ingroup networking
+ * @{
+ */
+
+#if defined(CONFIG_NET_LOOPBACK_SIMULATE_PACKET_DROP)
+/**
+ * @brief Set the share of the packets the loopback interface drops
+ *
+ * @param ratio Between 0 (no drops, the default) and 1 (drop all).
+ *
+ * @return 0 on success, -EINVAL if the ratio is out of range.
+ */
+int loopback_set_packet_drop_ratio(float ratio);
+
+/**
+ * @brief Get the number of packets dropped so far
+ *
+ * @return Number of dropped packets.
+ */
+int loopback_get_num_dropped_packets(void);
+#endif
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_INCLUDE_NET_LOOPBACK_H_ */
@@ -274,6 +274,10 @@ __net_socket struct net_context {
 		struct k_fifo accept_q;
 	};
 
+#if defined(CONFIG_NET_SOCKETS_EPOLL)
+	/** epoll instances watching the socket */
+	sys_slist_t epoll_items;
+#endif
 #endif /* CONFIG_NET_SOCKETS */
 
 #if defined(CONFIG_NET_OFFLOAD)
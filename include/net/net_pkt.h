@@ -125,6 +125,13 @@ struct net_pkt {
 	uint64_t txtime;
 #endif /* CONFIG_NET_PKT_TXTIME */
 
+#if defined(CONFIG_NET_TCP_GSO)
+	/* Segment size when the packet is larger than the MTU and is to be
+	 * cut to TCP segments by the device or when it reaches the L2.
+	 */
+	uint16_t gso_size;
+#endif /* CONFIG_NET_TCP_GSO */
+
 	/** Reference counter */
 	atomic_t atomic_ref;
 
@@ -188,6 +195,14 @@ struct net_pkt {
 	uint8_t captured : 1; /* Set to 1 if this packet is already being
 			       * captured
 			       */
+	uint8_t chksum_done : 1; /* Set to 1 if the checksums of this
+				  * incoming packet are already verified,
+				  * for example by the network hardware
+				  */
+	uint8_t ip_reassembled : 1; /* Set to 1 if this packet was
+				     * reassembled from IP fragments, it
+				     * has no link layer header then
+				     */
 
 	union {
 		/* IPv6 hop limit or IPv4 ttl for this network packet.
@@ -342,6 +357,28 @@ static inline void net_pkt_set_captured(struct net_pkt *pkt, bool is_captured)
 	pkt->captured = is_captured;
 }
 
+static inline bool net_pkt_is_chksum_done(struct net_pkt *pkt)
+{
+	return !!(pkt->chksum_done);
+}
+
+static inline void net_pkt_set_chksum_done(struct net_pkt *pkt,
+					   bool is_chksum_done)
+{
+	pkt->chksum_done = is_chksum_done;
+}
+
+static inline bool net_pkt_is_ip_reassembled(struct net_pkt *pkt)
+{
+	return !!(pkt->ip_reassembled);
+}
+
+static inline void net_pkt_set_ip_reassembled(struct net_pkt *pkt,
+					      bool is_ip_reassembled)
+{
+	pkt->ip_reassembled = is_ip_reassembled;
+}
+
 static inline uint8_t net_pkt_ip_hdr_len(struct net_pkt *pkt)
 {
 	return pkt->ip_hdr_len;
@@ -832,6 +869,33 @@ static inline void net_pkt_set_txtime(struct net_pkt *pkt, uint64_t txtime)
 }
 #endif /* CONFIG_NET_PKT_TXTIME */
 
+#if defined(CONFIG_NET_TCP_GSO)
+static inline uint16_t net_pkt_gso_size(struct net_pkt *pkt)
+{
+	return pkt->gso_size;
+}
+
+static inline void net_pkt_set_gso_size(struct net_pkt *pkt,
+					uint16_t gso_size)
+{
+	pkt->gso_size = gso_size;
+}
+#else
+static inline uint16_t net_pkt_gso_size(struct net_pkt *pkt)
+{
+	ARG_UNUSED(pkt);
+
+	return 0;
+}
+
+static inline void net_pkt_set_gso_size(struct net_pkt *pkt,
+					uint16_t gso_size)
+{
+	ARG_UNUSED(pkt);
+	ARG_UNUSED(gso_size);
+}
+#endif /* CONFIG_NET_TCP_GSO */
+
 #if defined(CONFIG_NET_PKT_TXTIME_STATS_DETAIL) || \
 	defined(CONFIG_NET_PKT_RXTIME_STATS_DETAIL)
 static inline uint32_t *net_pkt_stats_tick(struct net_pkt *pkt)
@@ -1355,6 +1419,19 @@ void net_pkt_get_info(struct k_mem_slab **rx,
 		      struct net_buf_pool **rx_data,
 		      struct net_buf_pool **tx_data);
 
+#if defined(CONFIG_NET_BUF_CPU_CACHE)
+/**
+ * @brief Get the per-CPU caches of the predefined RX and TX pools.
+ *
+ * The caches of the DATA pools are the @c cache of the pools.
+ *
+ * @param rx Pointer to the cache of the RX pool is returned.
+ * @param tx Pointer to the cache of the TX pool is returned.
+ */
+void net_pkt_get_cache_info(struct net_buf_cache **rx,
+			    struct net_buf_cache **tx);
+#endif /* CONFIG_NET_BUF_CPU_CACHE */
+
 /** @cond INTERNAL_HIDDEN */
 
 #if defined(CONFIG_NET_DEBUG_NET_PKT_ALLOC)
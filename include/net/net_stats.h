@@ -156,6 +156,9 @@ struct net_stats_tcp {
 	/** Number of retransmitted TCP segments. */
 	net_stats_t rexmit;
 
+	/** Number of fast retransmits, each starting a loss recovery. */
+	net_stats_t fast_rexmit;
+
 	/** Number of dropped connection attempts because too few connections
 	 * were available.
 	 */
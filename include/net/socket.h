@@ -27,18 +27,27 @@
 #include <net/net_ip.h>
 #include <net/dns_resolve.h>
 #include <net/socket_select.h>
+#include <net/socket_epoll.h>
 #include <stdlib.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+struct timespec;
+
 struct zsock_pollfd {
 	int fd;
 	short events;
 	short revents;
 };
 
+/** Message vector entry of zsock_sendmmsg() and zsock_recvmmsg() */
+struct zsock_mmsghdr {
+	struct msghdr msg_hdr;	/* Message */
+	unsigned int msg_len;	/* Number of bytes sent or received */
+};
+
 /* ZSOCK_POLL* values are compatible with Linux */
 /** zsock_poll: Poll for readability */
 #define ZSOCK_POLLIN 1
@@ -63,6 +72,8 @@ struct zsock_pollfd {
 #define ZSOCK_MSG_DONTWAIT 0x40
 /** zsock_recv: block until the full amount of data can be returned */
 #define ZSOCK_MSG_WAITALL 0x100
+/** zsock_recvmmsg: block only until the first message has been received */
+#define ZSOCK_MSG_WAITFORONE 0x10000
 
 /* Well-known values, e.g. from Linux man 2 shutdown:
  * "The constants SHUT_RD, SHUT_WR, SHUT_RDWR have the value 0, 1, 2,
@@ -370,6 +381,35 @@ static inline ssize_t zsock_send(int sock, const void *buf, size_t len,
 __syscall ssize_t zsock_sendmsg(int sock, const struct msghdr *msg,
 				int flags);
 
+/**
+ * @brief Send multiple messages with one call
+ *
+ * @details
+ * @rst
+ * Like ``sendmmsg()`` of Linux: the messages of @a msgvec are sent in
+ * order as with :c:func:`zsock_sendmsg()`, and the number of bytes sent
+ * of each message is stored in its ``msg_len``. For native datagram
+ * sockets the whole batch is handed to the network stack in one go,
+ * with the scheduler locked. On a single CPU the TX thread is then woken
+ * once for the batch instead of once per datagram; with SMP it may run
+ * on another CPU and drain the queue while the batch is being added. At
+ * most 1024 messages are sent per call.
+ * This function is also exposed as ``sendmmsg()``
+ * if :option:`CONFIG_NET_SOCKETS_POSIX_NAMES` is defined.
+ * @endrst
+ *
+ * @param sock Socket
+ * @param msgvec Messages to send
+ * @param vlen Number of messages in @a msgvec
+ * @param flags Send flags, applied to every message
+ *
+ * @return Number of messages sent, which is less than @a vlen if an error
+ *         occurred after the first message, or -1 with errno set if the
+ *         first message could not be sent
+ */
+__syscall int zsock_sendmmsg(int sock, struct zsock_mmsghdr *msgvec,
+			     unsigned int vlen, int flags);
+
 /**
  * @brief Receive data from an arbitrary network address
  *
@@ -386,6 +426,75 @@ __syscall ssize_t zsock_recvfrom(int sock, void *buf, size_t max_len,
 				 int flags, struct sockaddr *src_addr,
 				 socklen_t *addrlen);
 
+/**
+ * @brief Receive multiple messages with one call
+ *
+ * @details
+ * @rst
+ * Like ``recvmmsg()`` of Linux: up to @a vlen messages are received
+ * into the buffers described by @a msgvec, and the length of each
+ * message is stored in its ``msg_len``. The source address is stored in
+ * ``msg_name`` if it is set, and ZSOCK_MSG_TRUNC is set in ``msg_flags``
+ * of a datagram that did not fit. No ancillary data is returned. The
+ * call blocks until @a vlen messages have been received, unless
+ * ZSOCK_MSG_DONTWAIT or ZSOCK_MSG_WAITFORONE is given in @a flags or
+ * @a timeout expires. For native datagram sockets the timeout also
+ * bounds the wait for the first message; for other sockets, as on
+ * Linux, it is only checked after each message. At most 1024 messages
+ * are received per call.
+ * This function is also exposed as ``recvmmsg()``
+ * if :option:`CONFIG_NET_SOCKETS_POSIX_NAMES` is defined.
+ * @endrst
+ *
+ * @param sock Socket
+ * @param msgvec Buffers for the messages
+ * @param vlen Number of entries in @a msgvec
+ * @param flags Receive flags, applied to every message
+ * @param timeout Time limit for the whole call, or NULL
+ *
+ * @return Number of messages received, or -1 with errno set if no message
+ *         could be received
+ */
+__syscall int zsock_recvmmsg(int sock, struct zsock_mmsghdr *msgvec,
+			     unsigned int vlen, int flags,
+			     struct timespec *timeout);
+
+struct net_buf;
+
+/**
+ * @brief Receive data without copying it
+ *
+ * @details
+ * Like :c:func:`zsock_recvfrom()`, but instead of copying the data to a
+ * buffer of the caller, the network buffers holding the data are lent to
+ * the caller as a fragment chain. The chain is the data of one received
+ * datagram, or of one received segment for a stream socket. The caller
+ * must return it with :c:func:`zsock_recv_zc_release()`.
+ * Only ZSOCK_MSG_DONTWAIT is supported in @a flags. Available with
+ * :option:`CONFIG_NET_SOCKETS_RECV_ZEROCOPY` for native sockets in
+ * supervisor mode.
+ *
+ * @param sock Socket
+ * @param frags Set to the fragment chain holding the data, or to NULL
+ *        if there is no data
+ * @param flags Receive flags
+ * @param src_addr Source address of a datagram, can be NULL
+ * @param addrlen Length of @a src_addr, updated to the actual length
+ *
+ * @return Number of bytes in the chain, 0 at the end of a stream, -1 with
+ *         errno set on error
+ */
+ssize_t zsock_recvfrom_zc(int sock, struct net_buf **frags, int flags,
+			  struct sockaddr *src_addr, socklen_t *addrlen);
+
+/**
+ * @brief Return the buffers lent by zsock_recvfrom_zc()
+ *
+ * @param frags Fragment chain returned by :c:func:`zsock_recvfrom_zc()`,
+ *        can be NULL
+ */
+void zsock_recv_zc_release(struct net_buf *frags);
+
 /**
  * @brief Receive data from a connected peer
  *
@@ -636,6 +745,7 @@ int zsock_getnameinfo(const struct sockaddr *addr, socklen_t addrlen,
 #if defined(CONFIG_NET_SOCKETS_POSIX_NAMES)
 
 #define pollfd zsock_pollfd
+#define mmsghdr zsock_mmsghdr
 
 static inline int socket(int family, int type, int proto)
 {
@@ -704,12 +814,25 @@ static inline ssize_t sendmsg(int sock, const struct msghdr *message,
 	return zsock_sendmsg(sock, message, flags);
 }
 
+static inline int sendmmsg(int sock, struct zsock_mmsghdr *msgvec,
+			   unsigned int vlen, int flags)
+{
+	return zsock_sendmmsg(sock, msgvec, vlen, flags);
+}
+
 static inline ssize_t recvfrom(int sock, void *buf, size_t max_len, int flags,
 			       struct sockaddr *src_addr, socklen_t *addrlen)
 {
 	return zsock_recvfrom(sock, buf, max_len, flags, src_addr, addrlen);
 }
 
+static inline int recvmmsg(int sock, struct zsock_mmsghdr *msgvec,
+			   unsigned int vlen, int flags,
+			   struct timespec *timeout)
+{
+	return zsock_recvmmsg(sock, msgvec, vlen, flags, timeout);
+}
+
 static inline int poll(struct zsock_pollfd *fds, int nfds, int timeout)
 {
 	return zsock_poll(fds, nfds, timeout);
@@ -786,6 +909,7 @@ static inline char *inet_ntop(sa_family_t family, const void *src, char *dst,
 #define MSG_TRUNC ZSOCK_MSG_TRUNC
 #define MSG_DONTWAIT ZSOCK_MSG_DONTWAIT
 #define MSG_WAITALL ZSOCK_MSG_WAITALL
+#define MSG_WAITFORONE ZSOCK_MSG_WAITFORONE
 
 #define SHUT_RD ZSOCK_SHUT_RD
 #define SHUT_WR ZSOCK_SHUT_WR
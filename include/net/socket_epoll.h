@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_INCLUDE_NET_SOCKET_EPOLL_H_
+#define ZEPHYR_INCLUDE_NET_SOCKET_EPOLL_H_
+
+/**
+ * @brief BSD Sockets compatible API
+ * @defgroup bsd_sockets BSD Sockets compatible API
+ * @ingroup networking
+ * @{
+ */
+
+#include <zephyr/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ZSOCK_EPOLL* values are compatible with Linux */
+/** zsock_epoll: The socket is readable */
+#define ZSOCK_EPOLLIN 0x001
+/** zsock_epoll: The socket is writable */
+#define ZSOCK_EPOLLOUT 0x004
+/** zsock_epoll: Error condition (output value only) */
+#define ZSOCK_EPOLLERR 0x008
+/** zsock_epoll: Closed connection (output value only) */
+#define ZSOCK_EPOLLHUP 0x010
+/** zsock_epoll: Report the socket only once until it is modified again */
+#define ZSOCK_EPOLLONESHOT 0x40000000U
+/** zsock_epoll: Edge triggered, report only the changes of the state */
+#define ZSOCK_EPOLLET 0x80000000U
+
+/** zsock_epoll_ctl: Add a socket to the interest set */
+#define ZSOCK_EPOLL_CTL_ADD 1
+/** zsock_epoll_ctl: Remove a socket from the interest set */
+#define ZSOCK_EPOLL_CTL_DEL 2
+/** zsock_epoll_ctl: Change the events of a socket in the interest set */
+#define ZSOCK_EPOLL_CTL_MOD 3
+
+/** User data returned with the events of a socket */
+typedef union zsock_epoll_data {
+	void *ptr;
+	int fd;
+	uint32_t u32;
+	uint64_t u64;
+} zsock_epoll_data_t;
+
+/** Events of a socket */
+struct zsock_epoll_event {
+	/** Requested events, or the ones that occurred on output */
+	uint32_t events;
+	/** User data */
+	zsock_epoll_data_t data;
+};
+
+/**
+ * @brief Create an epoll instance
+ *
+ * @details
+ * @rst
+ * See `Linux manual page
+ * <https://man7.org/linux/man-pages/man2/epoll_create.2.html>`__
+ * for normative description. Unlike with :c:func:`zsock_poll()`, the
+ * sockets to watch are registered once and the sockets that become ready
+ * are queued to the instance as the data arrives, so a wait costs the
+ * same regardless of how many sockets are watched. Only native network
+ * sockets can be added to the instance. The instance is released with
+ * :c:func:`zsock_close()`.
+ * This function is also exposed as ``epoll_create1()``
+ * if :option:`CONFIG_NET_SOCKETS_POSIX_NAMES` is defined.
+ * @endrst
+ *
+ * @param flags Must be 0
+ *
+ * @return File descriptor of the instance, -1 with errno set on error
+ */
+int zsock_epoll_create1(int flags);
+
+/**
+ * @brief Create an epoll instance
+ *
+ * @details
+ * @rst
+ * Same as :c:func:`zsock_epoll_create1()`, the size is only checked.
+ * This function is also exposed as ``epoll_create()``
+ * if :option:`CONFIG_NET_SOCKETS_POSIX_NAMES` is defined.
+ * @endrst
+ *
+ * @param size Must be greater than 0
+ */
+int zsock_epoll_create(int size);
+
+/**
+ * @brief Add, modify or remove a socket of an epoll instance
+ *
+ * @details
+ * @rst
+ * See `Linux manual page
+ * <https://man7.org/linux/man-pages/man2/epoll_ctl.2.html>`__
+ * for normative description.
+ * This function is also exposed as ``epoll_ctl()``
+ * if :option:`CONFIG_NET_SOCKETS_POSIX_NAMES` is defined.
+ * @endrst
+ *
+ * @param epfd Epoll instance
+ * @param op ZSOCK_EPOLL_CTL_ADD, ZSOCK_EPOLL_CTL_MOD or ZSOCK_EPOLL_CTL_DEL
+ * @param fd Socket
+ * @param event Events to watch and the user data, ignored for
+ *        ZSOCK_EPOLL_CTL_DEL
+ *
+ * @return 0 if ok, -1 with errno set on error
+ */
+int zsock_epoll_ctl(int epfd, int op, int fd, struct zsock_epoll_event *event);
+
+/**
+ * @brief Wait for the sockets of an epoll instance to become ready
+ *
+ * @details
+ * @rst
+ * See `Linux manual page
+ * <https://man7.org/linux/man-pages/man2/epoll_wait.2.html>`__
+ * for normative description.
+ * This function is also exposed as ``epoll_wait()``
+ * if :option:`CONFIG_NET_SOCKETS_POSIX_NAMES` is defined.
+ * @endrst
+ *
+ * @param epfd Epoll instance
+ * @param events Array the ready sockets are returned in
+ * @param maxevents Size of the array
+ * @param timeout Time to wait in milliseconds, -1 to wait forever
+ *
+ * @return Number of ready sockets, 0 on timeout, -1 with errno set on error
+ */
+int zsock_epoll_wait(int epfd, struct zsock_epoll_event *events,
+		     int maxevents, int timeout);
+
+#ifdef CONFIG_NET_SOCKETS_POSIX_NAMES
+
+#define epoll_data_t zsock_epoll_data_t
+#define epoll_event zsock_epoll_event
+
+#define EPOLLIN ZSOCK_EPOLLIN
+#define EPOLLOUT ZSOCK_EPOLLOUT
+#define EPOLLERR ZSOCK_EPOLLERR
+#define EPOLLHUP ZSOCK_EPOLLHUP
+#define EPOLLONESHOT ZSOCK_EPOLLONESHOT
+#define EPOLLET ZSOCK_EPOLLET
+
+#define EPOLL_CTL_ADD ZSOCK_EPOLL_CTL_ADD
+#define EPOLL_CTL_DEL ZSOCK_EPOLL_CTL_DEL
+#define EPOLL_CTL_MOD ZSOCK_EPOLL_CTL_MOD
+
+static inline int epoll_create1(int flags)
+{
+	return zsock_epoll_create1(flags);
+}
+
+static inline int epoll_create(int size)
+{
+	return zsock_epoll_create(size);
+}
+
+static inline int epoll_ctl(int epfd, int op, int fd,
+			    struct zsock_epoll_event *event)
+{
+	return zsock_epoll_ctl(epfd, op, fd, event);
+}
+
+static inline int epoll_wait(int epfd, struct zsock_epoll_event *events,
+			     int maxevents, int timeout)
+{
+	return zsock_epoll_wait(epfd, events, maxevents, timeout);
+}
+
+#endif /* CONFIG_NET_SOCKETS_POSIX_NAMES */
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @}
+ */
+
+#endif /* ZEPHYR_INCLUDE_NET_SOCKET_EPOLL_H_ */
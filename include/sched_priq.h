@@ -44,16 +44,22 @@ void z_priq_rb_add(struct _priq_rb *pq, struct k_thread *thread);
 void z_priq_rb_remove(struct _priq_rb *pq, struct k_thread *thread);
 struct k_thread *z_priq_rb_best(struct _priq_rb *pq);
 
-/* Traditional/textbook "multi-queue" structure.  Separate lists for a
- * small number (max 32 here) of fixed priorities.  This corresponds
- * to the original Zephyr scheduler.  RAM requirements are
- * comparatively high, but performance is very fast.  Won't work with
- * features like deadline scheduling which need large priority spaces
- * to represent their requirements.
+/* Traditional/textbook "multi-queue" structure.  Separate lists for
+ * each of the fixed priorities, indexed by a bitmap of non-empty
+ * lists so the best thread is found with a find-first-set over a few
+ * words.  This corresponds to the original Zephyr scheduler.  RAM
+ * requirements are comparatively high, but performance is very fast.
+ * Won't work with features like deadline scheduling which need large
+ * priority spaces to represent their requirements.
  */
+#define K_NUM_THREAD_PRIO (CONFIG_NUM_PREEMPT_PRIORITIES + \
+			   CONFIG_NUM_COOP_PRIORITIES + 1)
+#define PRIQ_BITMAP_SIZE (ceiling_fraction(K_NUM_THREAD_PRIO, BITS_PER_LONG))
+
 struct _priq_mq {
-	sys_dlist_t queues[32];
-	unsigned int bitmask; /* bit 1<<i set if queues[i] is non-empty */
+	sys_dlist_t queues[K_NUM_THREAD_PRIO];
+	/* bit i set if queues[i] is non-empty */
+	unsigned long bitmask[PRIQ_BITMAP_SIZE];
 };
 
 void z_priq_mq_add(struct _priq_mq *pq, struct k_thread *thread);
@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Lock-free queues
+ */
+
+#ifndef ZEPHYR_INCLUDE_SYS_LOCKFREE_QUEUE_H_
+#define ZEPHYR_INCLUDE_SYS_LOCKFREE_QUEUE_H_
+
+#include <kernel.h>
+#include <sys/atomic.h>
+#include <sys/sem.h>
+#include <sys/util.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * The queues hold fixed size items copied in and out, like k_msgq, but
+ * use atomic operations instead of a lock. They can live in user memory
+ * and be used from ISRs.
+ *
+ * Waiting is left to the consumer. A producer gives the sys_sem and
+ * raises the k_poll_signal attached with *_notify_set(), if any, only
+ * when it adds the first item to an empty queue.
+ */
+
+/**
+ * @brief Lock-free single producer, single consumer queue
+ */
+struct spsc_queue {
+	/** Number of items taken, only written by the consumer */
+	atomic_t head;
+	/** Number of items added, only written by the producer */
+	atomic_t tail;
+	/** Number of items the queue holds, minus one */
+	uint32_t mask;
+	/** Item size */
+	size_t item_size;
+	/** Item storage */
+	uint8_t *buf;
+	/** Given when an item is added to the empty queue, may be NULL */
+	struct sys_sem *sem;
+	/** Raised when an item is added to the empty queue, may be NULL */
+	struct k_poll_signal *signal;
+};
+
+/**
+ * @brief Lock-free bounded multiple producer, multiple consumer queue
+ */
+struct mpmc_queue {
+	/** Number of items taken */
+	atomic_t head;
+	/** Number of items added */
+	atomic_t tail;
+	/** Number of items the queue holds, minus one */
+	uint32_t mask;
+	/** Item size */
+	size_t item_size;
+	/** Cells, each a sequence number followed by an item */
+	uint8_t *buf;
+	/** Given when an item is added to the empty queue, may be NULL */
+	struct sys_sem *sem;
+	/** Raised when an item is added to the empty queue, may be NULL */
+	struct k_poll_signal *signal;
+};
+
+/**
+ * @defgroup lockfree_queue_apis Lock-free Queue APIs
+ * @ingroup kernel_apis
+ * @{
+ */
+
+/**
+ * @brief Size of the buffer of a single producer, single consumer queue
+ *
+ * @param item_size Item size (in bytes).
+ * @param capacity Number of items, a power of 2.
+ */
+#define SPSC_QUEUE_BUF_SIZE(item_size, capacity) ((item_size) * (capacity))
+
+/**
+ * @brief Size of the buffer of a multiple producer, multiple consumer queue
+ *
+ * @param item_size Item size (in bytes).
+ * @param capacity Number of items, a power of 2.
+ */
+#define MPMC_QUEUE_BUF_SIZE(item_size, capacity) \
+	(ROUND_UP(sizeof(atomic_t) + (item_size), sizeof(atomic_t)) * \
+	 (capacity))
+
+/**
+ * @brief Initialize a single producer, single consumer queue
+ *
+ * @param q Address of the queue.
+ * @param buf Buffer of SPSC_QUEUE_BUF_SIZE() bytes.
+ * @param item_size Item size (in bytes).
+ * @param capacity Number of items, a power of 2.
+ */
+void spsc_queue_init(struct spsc_queue *q, void *buf, size_t item_size,
+		     uint32_t capacity);
+
+/**
+ * @brief Set how the consumer of a queue is woken up
+ *
+ * @param q Address of the queue.
+ * @param sem Semaphore given when the queue gets an item while it was
+ *            empty, or NULL. Its limit should be 1.
+ * @param signal Poll signal raised when the queue gets an item while it
+ *               was empty, or NULL. Requires CONFIG_POLL.
+ */
+void spsc_queue_notify_set(struct spsc_queue *q, struct sys_sem *sem,
+			   struct k_poll_signal *signal);
+
+/**
+ * @brief Add an item to a single producer, single consumer queue
+ *
+ * @note Can be called by ISRs, but by one producer at a time.
+ *
+ * @param q Address of the queue.
+ * @param item Item to copy into the queue.
+ *
+ * @retval 0 Item added.
+ * @retval -ENOMSG Queue full.
+ */
+int spsc_queue_put(struct spsc_queue *q, const void *item);
+
+/**
+ * @brief Take an item from a single producer, single consumer queue
+ *
+ * @note Can be called by ISRs, but by one consumer at a time.
+ *
+ * @param q Address of the queue.
+ * @param item Address of area to hold the item.
+ *
+ * @retval 0 Item taken.
+ * @retval -ENOMSG Queue empty.
+ */
+int spsc_queue_get(struct spsc_queue *q, void *item);
+
+/**
+ * @brief Take an item from a single producer, single consumer queue,
+ * waiting for one if it is empty
+ *
+ * The queue must have a semaphore set with spsc_queue_notify_set().
+ *
+ * @param q Address of the queue.
+ * @param item Address of area to hold the item.
+ * @param timeout Waiting period for an item,
+ *                or one of the special values K_NO_WAIT and K_FOREVER.
+ *
+ * @retval 0 Item taken.
+ * @retval -ENOMSG Returned without waiting.
+ * @retval -EAGAIN Waiting period timed out.
+ */
+int spsc_queue_get_wait(struct spsc_queue *q, void *item,
+			k_timeout_t timeout);
+
+/**
+ * @brief Initialize a multiple producer, multiple consumer queue
+ *
+ * @param q Address of the queue.
+ * @param buf Buffer of MPMC_QUEUE_BUF_SIZE() bytes, aligned like atomic_t.
+ * @param item_size Item size (in bytes).
+ * @param capacity Number of items, a power of 2.
+ */
+void mpmc_queue_init(struct mpmc_queue *q, void *buf, size_t item_size,
+		     uint32_t capacity);
+
+/**
+ * @brief Set how the consumers of a queue are woken up
+ *
+ * @param q Address of the queue.
+ * @param sem Semaphore given when the queue gets an item while it was
+ *            empty, or NULL. Its limit should be 1.
+ * @param signal Poll signal raised when the queue gets an item while it
+ *               was empty, or NULL. Requires CONFIG_POLL.
+ */
+void mpmc_queue_notify_set(struct mpmc_queue *q, struct sys_sem *sem,
+			   struct k_poll_signal *signal);
+
+/**
+ * @brief Add an item to a multiple producer, multiple consumer queue
+ *
+ * @note Can be called by ISRs.
+ *
+ * @param q Address of the queue.
+ * @param item Item to copy into the queue.
+ *
+ * @retval 0 Item added.
+ * @retval -ENOMSG Queue full.
+ */
+int mpmc_queue_put(struct mpmc_queue *q, const void *item);
+
+/**
+ * @brief Take an item from a multiple producer, multiple consumer queue
+ *
+ * @note Can be called by ISRs.
+ *
+ * @param q Address of the queue.
+ * @param item Address of area to hold the item.
+ *
+ * @retval 0 Item taken.
+ * @retval -ENOMSG Queue empty.
+ */
+int mpmc_queue_get(struct mpmc_queue *q, void *item);
+
+/**
+ * @brief Take an item from a multiple producer, multiple consumer queue,
+ * waiting for one if it is empty
+ *
+ * The queue must have a semaphore set with mpmc_queue_notify_set(). A
+ * consumer woken up passes the wakeup on to the next one if items are
+ * left.
+ *
+ * @param q Address of the queue.
+ * @param item Address of area to hold the item.
+ * @param timeout Waiting period for an item,
+ *                or one of the special values K_NO_WAIT and K_FOREVER.
+ *
+ * @retval 0 Item taken.
+ * @retval -ENOMSG Returned without waiting.
+ * @retval -EAGAIN Waiting period timed out.
+ */
+int mpmc_queue_get_wait(struct mpmc_queue *q, void *item,
+			k_timeout_t timeout);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_INCLUDE_SYS_LOCKFREE_QUEUE_H_ */
@@ -170,13 +170,12 @@ static inline bool size_mul_overflow(size_t a, size_t b, size_t *result)
  *
  *	struct k_thread *z_priq_mq_best(struct _priq_mq *pq)
  *	{
- *		if (!pq->bitmask) {
- *			return NULL;
+ *		...
+ *		if (pq->bitmask[i] == 0U) {
+ *			continue;
  *		}
  *
- *		struct k_thread *thread = NULL;
- *		sys_dlist_t *l =
- *			&pq->queues[u32_count_trailing_zeros(pq->bitmask)];
+ *		int bit = u32_count_trailing_zeros(pq->bitmask[i]);
  *
  *		...
  *
@@ -120,6 +120,22 @@ void *sys_heap_aligned_alloc(struct sys_heap *heap, size_t align, size_t bytes);
  */
 void sys_heap_free(struct sys_heap *heap, void *mem);
 
+/** @brief Return the usable size of an allocated block
+ *
+ * Returns the number of bytes that can be used from @a mem, which may
+ * be more than what was requested when the block was allocated.
+ *
+ * The size of an allocated block only changes when the block itself
+ * is freed or reallocated, so unlike the other sys_heap functions this
+ * one may be called without the lock of the heap by the owner of the
+ * block.
+ *
+ * @param heap Heap the block was allocated from
+ * @param mem A pointer previously returned from sys_heap_alloc()
+ * @return Usable size of the block in bytes
+ */
+size_t sys_heap_usable_size(struct sys_heap *heap, void *mem);
+
 /** @brief Expand the size of an existing allocation
  *
  * Returns a pointer to a new memory region with the same contents,
@@ -201,6 +217,80 @@ void sys_heap_stress(void *(*alloc_fn)(void *arg, size_t bytes),
 		     int target_percent,
 		     struct z_heap_stress_result *result);
 
+/** Maximum number of free list buckets of a heap */
+#define SYS_HEAP_MAX_BUCKETS 32
+
+/**
+ * @brief Layout of the free memory of a heap
+ */
+struct sys_heap_frag_stats {
+	/** Free chunks of each bucket, by increasing size */
+	struct {
+		/** Usable size of the smallest chunk of the bucket */
+		uint32_t min_bytes;
+		/** Number of free chunks in the bucket */
+		uint32_t chunks;
+	} buckets[SYS_HEAP_MAX_BUCKETS];
+	/** Number of buckets of the heap */
+	int nb_buckets;
+	/** Number of free chunks */
+	uint32_t free_chunks;
+	/** Usable bytes in free chunks */
+	size_t free_bytes;
+	/** Size of the largest block that can be allocated */
+	size_t largest_free_bytes;
+	/** Fragmentation index, from 0 when all the free memory is in one
+	 *  chunk to 1000 when it is scattered in tiny chunks.
+	 */
+	uint16_t frag_index;
+};
+
+/** @brief Get the layout of the free memory of a heap
+ *
+ * Walks the free lists of the heap to build a histogram of the free
+ * chunks per bucket and compute how fragmented the free memory is:
+ * the fragmentation index is 1000 * (1 - largest / free bytes).
+ *
+ * @note This takes time linear in the number of free chunks, and like
+ * the other sys_heap functions it needs the heap to be locked.
+ *
+ * @param heap Heap to inspect
+ * @param stats Filled with the layout of the free memory
+ */
+void sys_heap_frag_stats_get(struct sys_heap *heap,
+			     struct sys_heap_frag_stats *stats);
+
+#ifdef CONFIG_SYS_HEAP_RUNTIME_STATS
+/**
+ * @brief Memory usage of a heap
+ */
+struct sys_memory_stats {
+	/** Bytes in free chunks */
+	size_t free_bytes;
+	/** Bytes in allocated chunks, chunk headers included */
+	size_t allocated_bytes;
+	/** High-water mark of allocated_bytes */
+	size_t max_allocated_bytes;
+};
+
+/** @brief Get the memory usage of a heap
+ *
+ * The counters are kept up to date by every allocation and free, so
+ * this takes constant time.
+ *
+ * @param heap Heap to inspect
+ * @param stats Filled with the memory usage of the heap
+ */
+void sys_heap_runtime_stats_get(struct sys_heap *heap,
+				struct sys_memory_stats *stats);
+
+/** @brief Reset the high-water mark of a heap to its current usage
+ *
+ * @param heap Heap to reset
+ */
+void sys_heap_runtime_stats_reset_max(struct sys_heap *heap);
+#endif /* CONFIG_SYS_HEAP_RUNTIME_STATS */
+
 /** @brief Print heap internal structure information to the console
  *
  * Print information on the heap structure such as its size, chunk buckets,
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef ZEPHYR_INCLUDE_SYS_SYS_HEAP_CACHE_H_
+#define ZEPHYR_INCLUDE_SYS_SYS_HEAP_CACHE_H_
+
+#include <kernel.h>
+#include <sys/atomic.h>
+#include <sys/sys_heap.h>
+
+/* Per-CPU caches of small blocks in front of a sys_heap.
+ *
+ * Small requests are rounded up to a power-of-two size class, from
+ * SYS_HEAP_CACHE_MIN_BYTES up to CONFIG_SYS_HEAP_CPU_CACHE_CLASSES
+ * classes.  Each CPU keeps a magazine of free blocks per class, so
+ * allocating and freeing a small block only takes a per-CPU lock that
+ * is never contended in the fast path.  The heap itself, and the lock
+ * that its owner uses to protect it, are only taken to refill an empty
+ * magazine or to drain a full one, half a magazine at a time.
+ *
+ * Cached blocks stay allocated as far as the heap is concerned.  The
+ * owner of the heap must flush the caches before failing or waiting
+ * for an allocation, and should raise the waiters count while anyone
+ * waits so that frees go straight to the heap.
+ */
+
+/** Size of the smallest class of cached blocks */
+#define SYS_HEAP_CACHE_MIN_BYTES 16U
+
+/** Size of the largest class of cached blocks */
+#define SYS_HEAP_CACHE_MAX_BYTES \
+	(SYS_HEAP_CACHE_MIN_BYTES << (CONFIG_SYS_HEAP_CPU_CACHE_CLASSES - 1))
+
+/**
+ * @brief Locked access to the heap behind a cache.
+ *
+ * Both operations are called without any lock held and must take the
+ * lock protecting the heap, once per call.
+ */
+struct sys_heap_cache_ops {
+	/** Allocate up to @a count blocks of @a bytes, aligned on
+	 *  @a align, return how many were allocated.
+	 */
+	size_t (*alloc_bulk)(void *backend, size_t align, size_t bytes,
+			     void **blocks, size_t count);
+
+	/** Free @a count blocks. */
+	void (*free_bulk)(void *backend, void **blocks, size_t count);
+};
+
+/** @cond INTERNAL_HIDDEN */
+struct sys_heap_cache_mag {
+	struct k_spinlock lock;
+	uint16_t count;
+	void *blocks[CONFIG_SYS_HEAP_CPU_CACHE_SIZE];
+};
+/** @endcond */
+
+struct sys_heap_cache {
+	/** @cond INTERNAL_HIDDEN */
+	struct sys_heap_cache_mag mags[CONFIG_MP_NUM_CPUS]
+				      [CONFIG_SYS_HEAP_CPU_CACHE_CLASSES];
+	struct sys_heap *heap;
+	const struct sys_heap_cache_ops *ops;
+	void *backend;
+	size_t align;
+	/** @endcond */
+
+	/** Bytes the owner of the heap keeps at the end of every block,
+	 *  included in the requests but left out of the size classes.
+	 *  Zero after sys_heap_cache_init().
+	 */
+	size_t reserve;
+
+	/** Number of threads waiting for memory, frees bypass the cache
+	 *  while it is not zero.
+	 */
+	atomic_t waiters;
+};
+
+/** @brief Initialize a per-CPU cache of small blocks
+ *
+ * @param cache Cache to initialize
+ * @param heap Heap the blocks are allocated from
+ * @param ops Locked access to @a heap
+ * @param backend Passed back to the operations
+ * @param align Alignment of the cached blocks, a power of two.
+ *              Requests for a bigger alignment are not cached.
+ */
+void sys_heap_cache_init(struct sys_heap_cache *cache, struct sys_heap *heap,
+			 const struct sys_heap_cache_ops *ops, void *backend,
+			 size_t align);
+
+/** @brief Allocate a small block through the cache
+ *
+ * Returns a block from the magazine of the current CPU, refilling it
+ * from the heap when empty.  NULL is returned when the request is too
+ * big or too aligned to be cached, or when the heap has no memory
+ * left; the caller then falls back to allocating from the heap.
+ *
+ * @param cache Cache
+ * @param align Alignment in bytes, a power of two or zero
+ * @param bytes Number of bytes requested
+ * @return Pointer to memory the caller can now use, or NULL
+ */
+void *sys_heap_cache_alloc(struct sys_heap_cache *cache, size_t align,
+			   size_t bytes);
+
+/** @brief Free a block through the cache
+ *
+ * Keeps the block in the magazine of the current CPU if it has the
+ * size of a class.  Otherwise the caller must free it to the heap.
+ *
+ * @param cache Cache
+ * @param mem A pointer allocated from the heap of the cache, or NULL
+ * @return true if the block was taken by the cache
+ */
+bool sys_heap_cache_free(struct sys_heap_cache *cache, void *mem);
+
+/** @brief Give all the cached blocks back to the heap
+ *
+ * @param cache Cache
+ */
+void sys_heap_cache_flush(struct sys_heap_cache *cache);
+
+/** @brief Number of free blocks held by the cache
+ *
+ * @param cache Cache
+ * @return Number of cached blocks, of all CPUs and classes
+ */
+size_t sys_heap_cache_count(struct sys_heap_cache *cache);
+
+#endif /* ZEPHYR_INCLUDE_SYS_SYS_HEAP_CACHE_H_ */
@@ -170,6 +170,21 @@
  * @param mutex Mutex object
  */
 #define sys_trace_mutex_unlock(mutex)
+
+/**
+ * @brief Trace an allocation from a k_heap
+ * @param heap Heap object
+ * @param bytes Number of bytes requested
+ * @param mem Allocated memory, NULL if the allocation failed
+ */
+#define sys_trace_k_heap_alloc(heap, bytes, mem)
+
+/**
+ * @brief Trace freeing memory to a k_heap
+ * @param heap Heap object
+ * @param mem Memory being freed, or NULL
+ */
+#define sys_trace_k_heap_free(heap, mem)
 /**
  * @}
  */
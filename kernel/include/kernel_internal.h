@@ -82,6 +82,29 @@ static inline void *z_thread_malloc(size_t size)
 	return z_thread_aligned_alloc(0, size);
 }
 
+/**
+ * @brief Allocate aligned memory from a k_heap on behalf of a caller
+ *
+ * Behaves like k_heap_aligned_alloc(), but with CONFIG_K_HEAP_SITE_STATS
+ * the allocation is accounted to @a site instead of the direct caller.
+ *
+ * @param h Heap from which to allocate
+ * @param align Alignment in bytes, must be a power of two
+ * @param bytes Number of bytes requested
+ * @param timeout How long to wait, or K_NO_WAIT
+ * @param site Call site of the allocation, usually Z_HEAP_ALLOC_SITE
+ * @return Pointer to memory the caller can now use
+ */
+void *z_heap_aligned_alloc_site(struct k_heap *h, size_t align, size_t bytes,
+				k_timeout_t timeout, const void *site);
+
+/* Call site an allocation is accounted to, see k_heap_site */
+#ifdef CONFIG_K_HEAP_SITE_STATS
+#define Z_HEAP_ALLOC_SITE __builtin_return_address(0)
+#else
+#define Z_HEAP_ALLOC_SITE NULL
+#endif
+
 /* set and clear essential thread flag */
 
 extern void z_thread_essential_set(void);
@@ -8,11 +8,24 @@
 #include <ksched.h>
 #include <wait_q.h>
 #include <init.h>
+#include <kernel_internal.h>
+#include <sys/math_extras.h>
+#ifdef CONFIG_SYS_HEAP_CPU_CACHE
+#include <sys/sys_heap_cache.h>
+#endif
+
+#ifdef CONFIG_K_HEAP_SITE_STATS
+/* Every block ends with the index of its call site in sites[] */
+typedef uint16_t site_tag_t;
+#endif
 
 void k_heap_init(struct k_heap *h, void *mem, size_t bytes)
 {
 	z_waitq_init(&h->wait_q);
 	sys_heap_init(&h->heap, mem, bytes);
+#ifdef CONFIG_SYS_HEAP_CPU_CACHE
+	h->cache = NULL;
+#endif
 }
 
 static int statics_init(const struct device *unused)
@@ -26,18 +39,199 @@ static int statics_init(const struct device *unused)
 
 SYS_INIT(statics_init, PRE_KERNEL_1, CONFIG_KERNEL_INIT_PRIORITY_OBJECTS);
 
-void *k_heap_aligned_alloc(struct k_heap *h, size_t align, size_t bytes,
+#ifdef CONFIG_SYS_HEAP_CPU_CACHE
+static size_t cache_alloc_bulk(void *backend, size_t align, size_t bytes,
+			       void **blocks, size_t count)
+{
+	struct k_heap *h = backend;
+	k_spinlock_key_t key = k_spin_lock(&h->lock);
+	size_t n;
+
+	for (n = 0; n < count; n++) {
+		blocks[n] = sys_heap_aligned_alloc(&h->heap, align, bytes);
+		if (blocks[n] == NULL) {
+			break;
+		}
+	}
+
+	k_spin_unlock(&h->lock, key);
+	return n;
+}
+
+static void cache_free_bulk(void *backend, void **blocks, size_t count)
+{
+	struct k_heap *h = backend;
+	k_spinlock_key_t key = k_spin_lock(&h->lock);
+
+	for (size_t i = 0; i < count; i++) {
+		sys_heap_free(&h->heap, blocks[i]);
+	}
+
+	if (z_unpend_all(&h->wait_q) != 0) {
+		z_reschedule(&h->lock, key);
+	} else {
+		k_spin_unlock(&h->lock, key);
+	}
+}
+
+static const struct sys_heap_cache_ops cache_ops = {
+	.alloc_bulk = cache_alloc_bulk,
+	.free_bulk = cache_free_bulk,
+};
+
+void k_heap_cache_init(struct k_heap *h, struct sys_heap_cache *cache)
+{
+	sys_heap_cache_init(cache, &h->heap, &cache_ops, h, sizeof(void *));
+#ifdef CONFIG_K_HEAP_SITE_STATS
+	/* keep the call site tag out of the size classes */
+	cache->reserve = sizeof(site_tag_t);
+#endif
+	h->cache = cache;
+}
+#endif /* CONFIG_SYS_HEAP_CPU_CACHE */
+
+#ifdef CONFIG_K_HEAP_SITE_STATS
+#define NUM_SITES CONFIG_K_HEAP_SITE_STATS_COUNT
+
+/* Entry 0 collects the call sites that do not fit in the table */
+static struct k_heap_site sites[NUM_SITES];
+static struct k_spinlock sites_lock;
+
+/* Must be called with sites_lock held */
+static site_tag_t site_get(struct k_heap *h, const void *site)
+{
+	uintptr_t idx = (((uintptr_t)site ^ (uintptr_t)h) >> 2) %
+			(NUM_SITES - 1);
+
+	for (int i = 0; i < NUM_SITES - 1; i++) {
+		struct k_heap_site *entry = &sites[1 + idx];
+
+		if (entry->site == NULL) {
+			entry->site = site;
+			entry->heap = h;
+		}
+
+		if (entry->site == site && entry->heap == h) {
+			return 1 + idx;
+		}
+
+		idx = (idx + 1) % (NUM_SITES - 1);
+	}
+
+	return 0;
+}
+
+/* The size of a block does not change while it is allocated, so its
+ * tag is found again at the end of it when freed.
+ */
+static inline site_tag_t *site_tag(struct k_heap *h, void *mem,
+				   size_t *usable)
+{
+	*usable = sys_heap_usable_size(&h->heap, mem);
+
+	return (site_tag_t *)((uint8_t *)mem + *usable - sizeof(site_tag_t));
+}
+
+static void site_alloc(struct k_heap *h, const void *site, void *mem)
+{
+	k_spinlock_key_t key = k_spin_lock(&sites_lock);
+	site_tag_t tag = site_get(h, site);
+	struct k_heap_site *entry = &sites[tag];
+	size_t usable;
+
+	if (mem == NULL) {
+		entry->failures++;
+	} else {
+		UNALIGNED_PUT(tag, site_tag(h, mem, &usable));
+
+		entry->allocs++;
+		entry->bytes += usable;
+		entry->max_bytes = MAX(entry->max_bytes, entry->bytes);
+	}
+
+	k_spin_unlock(&sites_lock, key);
+}
+
+static void site_free(struct k_heap *h, void *mem)
+{
+	struct k_heap_site *entry;
+	k_spinlock_key_t key;
+	site_tag_t tag;
+	size_t usable;
+
+	tag = UNALIGNED_GET(site_tag(h, mem, &usable));
+	__ASSERT(tag < NUM_SITES, "corrupted call site tag for memory at %p",
+		 mem);
+
+	key = k_spin_lock(&sites_lock);
+
+	entry = &sites[tag];
+	entry->frees++;
+	entry->bytes -= usable;
+
+	k_spin_unlock(&sites_lock, key);
+}
+
+void k_heap_site_foreach(k_heap_site_cb_t cb, void *user_data)
+{
+	struct k_heap_site entry;
+	k_spinlock_key_t key;
+
+	for (int i = 0; i < NUM_SITES; i++) {
+		key = k_spin_lock(&sites_lock);
+		entry = sites[i];
+		k_spin_unlock(&sites_lock, key);
+
+		if (entry.allocs == 0U && entry.failures == 0U) {
+			continue;
+		}
+
+		cb(&entry, user_data);
+	}
+}
+#endif /* CONFIG_K_HEAP_SITE_STATS */
+
+static void *heap_alloc(struct k_heap *h, size_t align, size_t bytes,
 			k_timeout_t timeout)
 {
 	int64_t now, end = sys_clock_timeout_end_calc(timeout);
 	void *ret = NULL;
-	k_spinlock_key_t key = k_spin_lock(&h->lock);
+	k_spinlock_key_t key;
+#ifdef CONFIG_SYS_HEAP_CPU_CACHE
+	bool flushed = false;
+#endif
 
 	__ASSERT(!arch_is_in_isr() || K_TIMEOUT_EQ(timeout, K_NO_WAIT), "");
 
+#ifdef CONFIG_SYS_HEAP_CPU_CACHE
+	if (h->cache != NULL) {
+		ret = sys_heap_cache_alloc(h->cache, align, bytes);
+		if (ret != NULL) {
+			return ret;
+		}
+	}
+#endif
+
+	key = k_spin_lock(&h->lock);
+
 	while (ret == NULL) {
 		ret = sys_heap_aligned_alloc(&h->heap, align, bytes);
 
+#ifdef CONFIG_SYS_HEAP_CPU_CACHE
+		/* The missing memory may sit in the caches.  Announce
+		 * ourselves so that no block is cached again while we
+		 * wait, then give all of them back and retry once.
+		 */
+		if (ret == NULL && h->cache != NULL && !flushed) {
+			flushed = true;
+			atomic_inc(&h->cache->waiters);
+			k_spin_unlock(&h->lock, key);
+			sys_heap_cache_flush(h->cache);
+			key = k_spin_lock(&h->lock);
+			continue;
+		}
+#endif
+
 		now = sys_clock_tick_get();
 		if ((ret != NULL) || ((end - now) <= 0)) {
 			break;
@@ -49,13 +243,97 @@ void *k_heap_aligned_alloc(struct k_heap *h, size_t align, size_t bytes,
 	}
 
 	k_spin_unlock(&h->lock, key);
+
+#ifdef CONFIG_SYS_HEAP_CPU_CACHE
+	if (flushed) {
+		atomic_dec(&h->cache->waiters);
+	}
+#endif
+
 	return ret;
 }
 
-void k_heap_free(struct k_heap *h, void *mem)
+void *z_heap_aligned_alloc_site(struct k_heap *h, size_t align, size_t bytes,
+				k_timeout_t timeout, const void *site)
+{
+	size_t alloc_bytes = bytes;
+	void *ret;
+
+	ARG_UNUSED(site);
+
+#ifdef CONFIG_K_HEAP_SITE_STATS
+	if (size_add_overflow(bytes, sizeof(site_tag_t), &alloc_bytes)) {
+		return NULL;
+	}
+#endif
+
+	ret = heap_alloc(h, align, alloc_bytes, timeout);
+
+#ifdef CONFIG_K_HEAP_SITE_STATS
+	site_alloc(h, site, ret);
+#endif
+
+	sys_trace_k_heap_alloc(h, bytes, ret);
+
+	return ret;
+}
+
+void *k_heap_aligned_alloc(struct k_heap *h, size_t align, size_t bytes,
+			k_timeout_t timeout)
+{
+	return z_heap_aligned_alloc_site(h, align, bytes, timeout,
+					 Z_HEAP_ALLOC_SITE);
+}
+
+void k_heap_frag_stats_get(struct k_heap *h, struct sys_heap_frag_stats *stats)
+{
+	k_spinlock_key_t key = k_spin_lock(&h->lock);
+
+	sys_heap_frag_stats_get(&h->heap, stats);
+
+	k_spin_unlock(&h->lock, key);
+}
+
+#ifdef CONFIG_SYS_HEAP_RUNTIME_STATS
+void k_heap_runtime_stats_get(struct k_heap *h, struct sys_memory_stats *stats)
 {
 	k_spinlock_key_t key = k_spin_lock(&h->lock);
 
+	sys_heap_runtime_stats_get(&h->heap, stats);
+
+	k_spin_unlock(&h->lock, key);
+}
+
+void k_heap_runtime_stats_reset_max(struct k_heap *h)
+{
+	k_spinlock_key_t key = k_spin_lock(&h->lock);
+
+	sys_heap_runtime_stats_reset_max(&h->heap);
+
+	k_spin_unlock(&h->lock, key);
+}
+#endif /* CONFIG_SYS_HEAP_RUNTIME_STATS */
+
+void k_heap_free(struct k_heap *h, void *mem)
+{
+	k_spinlock_key_t key;
+
+	sys_trace_k_heap_free(h, mem);
+
+#ifdef CONFIG_K_HEAP_SITE_STATS
+	if (mem != NULL) {
+		site_free(h, mem);
+	}
+#endif
+
+#ifdef CONFIG_SYS_HEAP_CPU_CACHE
+	if (h->cache != NULL && sys_heap_cache_free(h->cache, mem)) {
+		return;
+	}
+#endif
+
+	key = k_spin_lock(&h->lock);
+
 	sys_heap_free(&h->heap, mem);
 
 	if (z_unpend_all(&h->wait_q) != 0) {
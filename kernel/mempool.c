@@ -5,11 +5,13 @@
  */
 
 #include <kernel.h>
+#include <kernel_internal.h>
 #include <string.h>
 #include <sys/math_extras.h>
 #include <sys/util.h>
 
-static void *z_heap_aligned_alloc(struct k_heap *heap, size_t align, size_t size)
+static void *z_heap_aligned_alloc(struct k_heap *heap, size_t align, size_t size,
+				  const void *site)
 {
 	void *mem;
 	struct k_heap **heap_ref;
@@ -26,7 +28,7 @@ static void *z_heap_aligned_alloc(struct k_heap *heap, size_t align, size_t size
 	}
 	__align = align | sizeof(heap_ref);
 
-	mem = k_heap_aligned_alloc(heap, __align, size, K_NO_WAIT);
+	mem = z_heap_aligned_alloc_site(heap, __align, size, K_NO_WAIT, site);
 	if (mem == NULL) {
 		return NULL;
 	}
@@ -65,7 +67,8 @@ void *k_aligned_alloc(size_t align, size_t size)
 	__ASSERT((align & (align - 1)) == 0,
 		"align must be a power of 2");
 
-	return z_heap_aligned_alloc(_SYSTEM_HEAP, align, size);
+	return z_heap_aligned_alloc(_SYSTEM_HEAP, align, size,
+				    Z_HEAP_ALLOC_SITE);
 }
 
 void *k_calloc(size_t nmemb, size_t size)
@@ -104,7 +107,8 @@ void *z_thread_aligned_alloc(size_t align, size_t size)
 	}
 
 	if (heap != NULL) {
-		ret = z_heap_aligned_alloc(heap, align, size);
+		ret = z_heap_aligned_alloc(heap, align, size,
+					   Z_HEAP_ALLOC_SITE);
 	} else {
 		ret = NULL;
 	}
@@ -59,6 +59,9 @@ void k_msgq_init(struct k_msgq *msgq, char *buffer, size_t msg_size,
 	msgq->flags = 0;
 	z_waitq_init(&msgq->wait_q);
 	msgq->lock = (struct k_spinlock) {};
+#ifdef CONFIG_POLL
+	sys_dlist_init(&msgq->poll_events);
+#endif
 
 	SYS_TRACING_OBJ_INIT(k_msgq, msgq);
 
@@ -113,36 +116,176 @@ int k_msgq_cleanup(struct k_msgq *msgq)
 }
 
 
+static inline void handle_poll_events(struct k_msgq *msgq)
+{
+#ifdef CONFIG_POLL
+	z_handle_obj_poll_events(&msgq->poll_events,
+				 K_POLL_STATE_MSGQ_DATA_AVAILABLE);
+#endif
+}
+
+static void write_advance(struct k_msgq *msgq)
+{
+	msgq->write_ptr += msgq->msg_size;
+	if (msgq->write_ptr == msgq->buffer_end) {
+		msgq->write_ptr = msgq->buffer_start;
+	}
+	msgq->used_msgs++;
+}
+
+static void read_advance(struct k_msgq *msgq)
+{
+	msgq->read_ptr += msgq->msg_size;
+	if (msgq->read_ptr == msgq->buffer_end) {
+		msgq->read_ptr = msgq->buffer_start;
+	}
+	msgq->used_msgs--;
+}
+
+/*
+ * Pended threads point their swap_data to one of these. With claims,
+ * threads waiting to send and to receive can pend on the queue at the
+ * same time.
+ */
+struct msgq_waiter {
+	void *data;	/* message buffer, or NULL when waiting for a claim */
+	bool get;	/* waiting to receive */
+};
+
+/*
+ * Returns the first thread waiting to receive (get) or to send that can
+ * be served now. A claim on that side holds back the threads waiting for
+ * a claim, and on the sending side also those waiting to send, as the
+ * claim owns the slot at write_ptr.
+ */
+static struct k_thread *find_waiter(struct k_msgq *msgq, bool get)
+{
+	uint8_t flag = get ? K_MSGQ_FLAG_GET_CLAIMED : K_MSGQ_FLAG_PUT_CLAIMED;
+	struct k_thread *thread;
+	struct msgq_waiter *waiter;
+
+	if (!get && (msgq->flags & flag) != 0U) {
+		return NULL;
+	}
+
+	_WAIT_Q_FOR_EACH(&msgq->wait_q, thread) {
+		waiter = thread->base.swap_data;
+
+		if (waiter->get == get &&
+		    (waiter->data != NULL || (msgq->flags & flag) == 0U)) {
+			return thread;
+		}
+	}
+
+	return NULL;
+}
+
+static void wake_waiter(struct k_thread *thread)
+{
+	z_unpend_thread(thread);
+	arch_thread_return_value_set(thread, 0);
+	z_ready_thread(thread);
+}
+
+/*
+ * Threads waiting for a claim pend without a message buffer. The claim
+ * holds one side of the queue, the other threads waiting on that side
+ * stay pended until they can be served.
+ */
+static void grant_claim(struct k_msgq *msgq, struct k_thread *thread,
+			uint8_t flag)
+{
+	msgq->flags |= flag;
+	wake_waiter(thread);
+}
+
+/*
+ * Gives a message to the first thread waiting to receive, or adds it to
+ * the queue, which must not be full. Returns true if a thread was woken up.
+ */
+static bool send_msg(struct k_msgq *msgq, const void *data)
+{
+	struct k_thread *pending_thread;
+	struct msgq_waiter *waiter = NULL;
+
+	pending_thread = find_waiter(msgq, true);
+	if (pending_thread != NULL) {
+		waiter = pending_thread->base.swap_data;
+	}
+
+	if (waiter != NULL && waiter->data != NULL) {
+		/* give message to waiting thread */
+		(void)memcpy(waiter->data, data, msgq->msg_size);
+		/* wake up waiting thread */
+		wake_waiter(pending_thread);
+		return true;
+	}
+
+	/* put message in queue, unless it was built there */
+	if (data != msgq->write_ptr) {
+		(void)memcpy(msgq->write_ptr, data, msgq->msg_size);
+	}
+	write_advance(msgq);
+
+	if (pending_thread != NULL) {
+		grant_claim(msgq, pending_thread, K_MSGQ_FLAG_GET_CLAIMED);
+		return true;
+	}
+
+	/* pollers are told once the claim is committed */
+	if ((msgq->flags & K_MSGQ_FLAG_GET_CLAIMED) == 0U) {
+		handle_poll_events(msgq);
+	}
+	return false;
+}
+
+/*
+ * Gives the slot freed by a receiver to the first thread waiting to send,
+ * if any. Its message is sent like a new one, threads waiting to receive
+ * can be pended while a put claim is held. Returns true if a thread was
+ * woken up.
+ */
+static bool refill_msg(struct k_msgq *msgq)
+{
+	struct k_thread *pending_thread;
+	struct msgq_waiter *waiter;
+
+	pending_thread = find_waiter(msgq, false);
+	if (pending_thread == NULL) {
+		return false;
+	}
+
+	waiter = pending_thread->base.swap_data;
+	if (waiter->data == NULL) {
+		grant_claim(msgq, pending_thread, K_MSGQ_FLAG_PUT_CLAIMED);
+		return true;
+	}
+
+	/* send thread's message */
+	(void)send_msg(msgq, waiter->data);
+
+	/* wake up waiting thread */
+	wake_waiter(pending_thread);
+	return true;
+}
+
 int z_impl_k_msgq_put(struct k_msgq *msgq, const void *data, k_timeout_t timeout)
 {
 	__ASSERT(!arch_is_in_isr() || K_TIMEOUT_EQ(timeout, K_NO_WAIT), "");
 
-	struct k_thread *pending_thread;
 	k_spinlock_key_t key;
 	int result;
 
 	key = k_spin_lock(&msgq->lock);
 
-	if (msgq->used_msgs < msgq->max_msgs) {
+	if ((msgq->flags & K_MSGQ_FLAG_PUT_CLAIMED) != 0U) {
+		/* the slot at write_ptr is taken by a claim */
+		result = -EBUSY;
+	} else if (msgq->used_msgs < msgq->max_msgs) {
 		/* message queue isn't full */
-		pending_thread = z_unpend_first_thread(&msgq->wait_q);
-		if (pending_thread != NULL) {
-			/* give message to waiting thread */
-			(void)memcpy(pending_thread->base.swap_data, data,
-			       msgq->msg_size);
-			/* wake up waiting thread */
-			arch_thread_return_value_set(pending_thread, 0);
-			z_ready_thread(pending_thread);
+		if (send_msg(msgq, data)) {
 			z_reschedule(&msgq->lock, key);
 			return 0;
-		} else {
-			/* put message in queue */
-			(void)memcpy(msgq->write_ptr, data, msgq->msg_size);
-			msgq->write_ptr += msgq->msg_size;
-			if (msgq->write_ptr == msgq->buffer_end) {
-				msgq->write_ptr = msgq->buffer_start;
-			}
-			msgq->used_msgs++;
 		}
 		result = 0;
 	} else if (K_TIMEOUT_EQ(timeout, K_NO_WAIT)) {
@@ -150,7 +293,9 @@ int z_impl_k_msgq_put(struct k_msgq *msgq, const void *data, k_timeout_t timeout
 		result = -ENOMSG;
 	} else {
 		/* wait for put message success, failure, or timeout */
-		_current->base.swap_data = (void *) data;
+		struct msgq_waiter waiter = { .data = (void *)data };
+
+		_current->base.swap_data = &waiter;
 		return z_pend_curr(&msgq->lock, key, &msgq->wait_q, timeout);
 	}
 
@@ -194,35 +339,20 @@ int z_impl_k_msgq_get(struct k_msgq *msgq, void *data, k_timeout_t timeout)
 	__ASSERT(!arch_is_in_isr() || K_TIMEOUT_EQ(timeout, K_NO_WAIT), "");
 
 	k_spinlock_key_t key;
-	struct k_thread *pending_thread;
 	int result;
 
 	key = k_spin_lock(&msgq->lock);
 
-	if (msgq->used_msgs > 0U) {
+	if ((msgq->flags & K_MSGQ_FLAG_GET_CLAIMED) != 0U) {
+		/* the message at read_ptr is taken by a claim */
+		result = -EBUSY;
+	} else if (msgq->used_msgs > 0U) {
 		/* take first available message from queue */
 		(void)memcpy(data, msgq->read_ptr, msgq->msg_size);
-		msgq->read_ptr += msgq->msg_size;
-		if (msgq->read_ptr == msgq->buffer_end) {
-			msgq->read_ptr = msgq->buffer_start;
-		}
-		msgq->used_msgs--;
+		read_advance(msgq);
 
 		/* handle first thread waiting to write (if any) */
-		pending_thread = z_unpend_first_thread(&msgq->wait_q);
-		if (pending_thread != NULL) {
-			/* add thread's message to queue */
-			(void)memcpy(msgq->write_ptr, pending_thread->base.swap_data,
-			       msgq->msg_size);
-			msgq->write_ptr += msgq->msg_size;
-			if (msgq->write_ptr == msgq->buffer_end) {
-				msgq->write_ptr = msgq->buffer_start;
-			}
-			msgq->used_msgs++;
-
-			/* wake up waiting thread */
-			arch_thread_return_value_set(pending_thread, 0);
-			z_ready_thread(pending_thread);
+		if (refill_msg(msgq)) {
 			z_reschedule(&msgq->lock, key);
 			return 0;
 		}
@@ -232,7 +362,9 @@ int z_impl_k_msgq_get(struct k_msgq *msgq, void *data, k_timeout_t timeout)
 		result = -ENOMSG;
 	} else {
 		/* wait for get message success or timeout */
-		_current->base.swap_data = data;
+		struct msgq_waiter waiter = { .data = data, .get = true };
+
+		_current->base.swap_data = &waiter;
 		return z_pend_curr(&msgq->lock, key, &msgq->wait_q, timeout);
 	}
 
@@ -285,6 +417,226 @@ static inline int z_vrfy_k_msgq_peek(struct k_msgq *msgq, void *data)
 #include <syscalls/k_msgq_peek_mrsh.c>
 #endif
 
+int z_impl_k_msgq_put_claim(struct k_msgq *msgq, void **data, void *buf,
+			    k_timeout_t timeout)
+{
+	__ASSERT(!arch_is_in_isr() || K_TIMEOUT_EQ(timeout, K_NO_WAIT), "");
+
+	k_spinlock_key_t key;
+	int result;
+
+	ARG_UNUSED(buf);
+
+	key = k_spin_lock(&msgq->lock);
+
+	if ((msgq->flags & K_MSGQ_FLAG_PUT_CLAIMED) != 0U) {
+		result = -EBUSY;
+	} else if (msgq->used_msgs < msgq->max_msgs) {
+		msgq->flags |= K_MSGQ_FLAG_PUT_CLAIMED;
+		*data = msgq->write_ptr;
+		result = 0;
+	} else if (K_TIMEOUT_EQ(timeout, K_NO_WAIT)) {
+		/* don't wait for message space to become available */
+		result = -ENOMSG;
+	} else {
+		/* wait to be granted the claim, see refill_msg() */
+		struct msgq_waiter waiter = { 0 };
+
+		_current->base.swap_data = &waiter;
+		result = z_pend_curr(&msgq->lock, key, &msgq->wait_q, timeout);
+		if (result == 0) {
+			/* write_ptr can't move while we hold the claim */
+			*data = msgq->write_ptr;
+		}
+		return result;
+	}
+
+	k_spin_unlock(&msgq->lock, key);
+
+	return result;
+}
+
+#ifdef CONFIG_USERSPACE
+static inline int z_vrfy_k_msgq_put_claim(struct k_msgq *msgq, void **data,
+					  void *buf, k_timeout_t timeout)
+{
+	void *slot;
+	int result;
+
+	Z_OOPS(Z_SYSCALL_OBJ(msgq, K_OBJ_MSGQ));
+	Z_OOPS(Z_SYSCALL_MEMORY_WRITE(data, sizeof(*data)));
+	Z_OOPS(Z_SYSCALL_MEMORY_WRITE(buf, msgq->msg_size));
+
+	/* the message is built in buf and copied in by the commit */
+	result = z_impl_k_msgq_put_claim(msgq, &slot, NULL, timeout);
+	if (result == 0) {
+		*data = buf;
+	}
+
+	return result;
+}
+#include <syscalls/k_msgq_put_claim_mrsh.c>
+#endif
+
+int z_impl_k_msgq_put_commit(struct k_msgq *msgq, const void *data)
+{
+	k_spinlock_key_t key;
+	bool woken = false;
+
+	key = k_spin_lock(&msgq->lock);
+
+	if ((msgq->flags & K_MSGQ_FLAG_PUT_CLAIMED) == 0U) {
+		k_spin_unlock(&msgq->lock, key);
+		return -EINVAL;
+	}
+
+	msgq->flags &= ~K_MSGQ_FLAG_PUT_CLAIMED;
+
+	if (data != NULL) {
+		woken = send_msg(msgq, data);
+	}
+
+	/* slots freed while the claim was held are handed out now */
+	while (msgq->used_msgs < msgq->max_msgs && refill_msg(msgq)) {
+		woken = true;
+	}
+
+	if (woken) {
+		z_reschedule(&msgq->lock, key);
+		return 0;
+	}
+
+	k_spin_unlock(&msgq->lock, key);
+
+	return 0;
+}
+
+#ifdef CONFIG_USERSPACE
+static inline int z_vrfy_k_msgq_put_commit(struct k_msgq *msgq,
+					   const void *data)
+{
+	Z_OOPS(Z_SYSCALL_OBJ(msgq, K_OBJ_MSGQ));
+	if (data != NULL) {
+		Z_OOPS(Z_SYSCALL_MEMORY_READ(data, msgq->msg_size));
+	}
+
+	return z_impl_k_msgq_put_commit(msgq, data);
+}
+#include <syscalls/k_msgq_put_commit_mrsh.c>
+#endif
+
+int z_impl_k_msgq_get_claim(struct k_msgq *msgq, void **data, void *buf,
+			    k_timeout_t timeout)
+{
+	__ASSERT(!arch_is_in_isr() || K_TIMEOUT_EQ(timeout, K_NO_WAIT), "");
+
+	k_spinlock_key_t key;
+	int result;
+
+	ARG_UNUSED(buf);
+
+	key = k_spin_lock(&msgq->lock);
+
+	if ((msgq->flags & K_MSGQ_FLAG_GET_CLAIMED) != 0U) {
+		result = -EBUSY;
+	} else if (msgq->used_msgs > 0U) {
+		msgq->flags |= K_MSGQ_FLAG_GET_CLAIMED;
+		*data = msgq->read_ptr;
+		result = 0;
+	} else if (K_TIMEOUT_EQ(timeout, K_NO_WAIT)) {
+		/* don't wait for a message to become available */
+		result = -ENOMSG;
+	} else {
+		/* wait to be granted the claim, see send_msg() */
+		struct msgq_waiter waiter = { .get = true };
+
+		_current->base.swap_data = &waiter;
+		result = z_pend_curr(&msgq->lock, key, &msgq->wait_q, timeout);
+		if (result == 0) {
+			/* read_ptr can't move while we hold the claim */
+			*data = msgq->read_ptr;
+		}
+		return result;
+	}
+
+	k_spin_unlock(&msgq->lock, key);
+
+	return result;
+}
+
+#ifdef CONFIG_USERSPACE
+static inline int z_vrfy_k_msgq_get_claim(struct k_msgq *msgq, void **data,
+					  void *buf, k_timeout_t timeout)
+{
+	void *slot;
+	int result;
+
+	Z_OOPS(Z_SYSCALL_OBJ(msgq, K_OBJ_MSGQ));
+	Z_OOPS(Z_SYSCALL_MEMORY_WRITE(data, sizeof(*data)));
+	Z_OOPS(Z_SYSCALL_MEMORY_WRITE(buf, msgq->msg_size));
+
+	/* the claimed message stays put, so it can be copied unlocked */
+	result = z_impl_k_msgq_get_claim(msgq, &slot, NULL, timeout);
+	if (result == 0) {
+		(void)memcpy(buf, slot, msgq->msg_size);
+		*data = buf;
+	}
+
+	return result;
+}
+#include <syscalls/k_msgq_get_claim_mrsh.c>
+#endif
+
+int z_impl_k_msgq_get_commit(struct k_msgq *msgq)
+{
+	struct k_thread *pending_thread;
+	k_spinlock_key_t key;
+	bool woken;
+
+	key = k_spin_lock(&msgq->lock);
+
+	if ((msgq->flags & K_MSGQ_FLAG_GET_CLAIMED) == 0U) {
+		k_spin_unlock(&msgq->lock, key);
+		return -EINVAL;
+	}
+
+	msgq->flags &= ~K_MSGQ_FLAG_GET_CLAIMED;
+	read_advance(msgq);
+
+	woken = refill_msg(msgq);
+
+	/* the next message goes to a thread waiting for a claim */
+	if (msgq->used_msgs > 0U) {
+		pending_thread = find_waiter(msgq, true);
+		if (pending_thread != NULL) {
+			grant_claim(msgq, pending_thread,
+				    K_MSGQ_FLAG_GET_CLAIMED);
+			woken = true;
+		} else {
+			handle_poll_events(msgq);
+		}
+	}
+
+	if (woken) {
+		z_reschedule(&msgq->lock, key);
+		return 0;
+	}
+
+	k_spin_unlock(&msgq->lock, key);
+
+	return 0;
+}
+
+#ifdef CONFIG_USERSPACE
+static inline int z_vrfy_k_msgq_get_commit(struct k_msgq *msgq)
+{
+	Z_OOPS(Z_SYSCALL_OBJ(msgq, K_OBJ_MSGQ));
+
+	return z_impl_k_msgq_get_commit(msgq);
+}
+#include <syscalls/k_msgq_get_commit_mrsh.c>
+#endif
+
 void z_impl_k_msgq_purge(struct k_msgq *msgq)
 {
 	k_spinlock_key_t key;
@@ -300,6 +652,7 @@ void z_impl_k_msgq_purge(struct k_msgq *msgq)
 
 	msgq->used_msgs = 0;
 	msgq->read_ptr = msgq->write_ptr;
+	msgq->flags &= ~K_MSGQ_FLAG_GET_CLAIMED;
 
 	z_reschedule(&msgq->lock, key);
 }
@@ -68,10 +68,69 @@ SYS_INIT(init_mutex_module, PRE_KERNEL_1, CONFIG_KERNEL_INIT_PRIORITY_OBJECTS);
 
 #endif /* CONFIG_OBJECT_TRACING */
 
+/* The state of a mutex is the pointer to its owner, with MUTEX_WAITERS
+ * set once a thread is about to wait for it.  Taking a free mutex and
+ * giving back one that nobody waits for is a single compare-and-swap.
+ * Waiters set the flag with the global lock held before they pend, so
+ * an owner that finds it set takes the lock to hand the mutex over,
+ * like before.  The owner and lock_count fields are only written by
+ * the owner, or with the global lock held when the mutex is handed
+ * over.
+ *
+ * owner_orig_prio holds the priority the owner had when it took the
+ * mutex, before any waiter raised it.  It is recorded at that time, as
+ * the priority may already be raised by waiters of other mutexes when
+ * the first waiter of this one comes.
+ */
+#define MUTEX_WAITERS ((uintptr_t)1)
+
+static inline uintptr_t mutex_state(struct k_mutex *mutex)
+{
+	return (uintptr_t)atomic_ptr_get(&mutex->state);
+}
+
+static inline bool mutex_state_cas(struct k_mutex *mutex, uintptr_t old_state,
+				   uintptr_t new_state)
+{
+	return atomic_ptr_cas(&mutex->state, (void *)old_state,
+			      (void *)new_state);
+}
+
+static inline struct k_thread *mutex_owner(uintptr_t state)
+{
+	return (struct k_thread *)(state & ~MUTEX_WAITERS);
+}
+
+static inline bool mutex_try_take(struct k_mutex *mutex)
+{
+	/* Waiters may raise our priority as soon as we own the mutex, and
+	 * read owner_orig_prio if they time out: read the priority before
+	 * and don't get preempted until it is recorded.
+	 */
+	unsigned int key = arch_irq_lock();
+	int prio = _current->base.prio;
+
+	if (!mutex_state_cas(mutex, 0U, (uintptr_t)_current)) {
+		arch_irq_unlock(key);
+		return false;
+	}
+
+	mutex->owner_orig_prio = prio;
+	mutex->owner = _current;
+	mutex->lock_count = 1U;
+
+	arch_irq_unlock(key);
+
+	LOG_DBG("%p took mutex %p", _current, mutex);
+
+	return true;
+}
+
 int z_impl_k_mutex_init(struct k_mutex *mutex)
 {
 	mutex->owner = NULL;
 	mutex->lock_count = 0U;
+	mutex->state = NULL;
 
 	sys_trace_mutex_init(mutex);
 
@@ -102,63 +161,129 @@ static int32_t new_prio_for_inheritance(int32_t target, int32_t limit)
 	return new_prio;
 }
 
-static bool adjust_owner_prio(struct k_mutex *mutex, int32_t new_prio)
+static bool adjust_owner_prio(struct k_thread *owner, int32_t new_prio)
 {
-	if (mutex->owner->base.prio != new_prio) {
+	if (owner->base.prio != new_prio) {
 
 		LOG_DBG("%p (ready (y/n): %c) prio changed to %d (was %d)",
-			mutex->owner, z_is_thread_ready(mutex->owner) ?
-			'y' : 'n',
-			new_prio, mutex->owner->base.prio);
+			owner, z_is_thread_ready(owner) ? 'y' : 'n',
+			new_prio, owner->base.prio);
+
+		return z_set_prio(owner, new_prio);
+	}
+	return false;
+}
 
-		return z_set_prio(mutex->owner, new_prio);
+#ifdef CONFIG_MUTEX_SPIN_COUNT
+static bool thread_running(struct k_thread *thread)
+{
+	for (int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		if (_kernel.cpus[i].current == thread) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/* A mutex is usually held for a short while.  As long as its owner
+ * runs on another CPU and no thread waits before us, wait for it to
+ * give the mutex back rather than pend and be switched back in.
+ */
+static bool mutex_spin(struct k_mutex *mutex)
+{
+	for (int i = 0; i < CONFIG_MUTEX_SPIN_COUNT; i++) {
+		uintptr_t state = mutex_state(mutex);
+
+		if (state == 0U) {
+			if (mutex_try_take(mutex)) {
+				return true;
+			}
+		} else if ((state & MUTEX_WAITERS) != 0U ||
+			   !thread_running(mutex_owner(state))) {
+			return false;
+		}
+
+		/* Don't hammer the owner's cache line */
+		arch_nop();
 	}
+
 	return false;
 }
+#endif /* CONFIG_MUTEX_SPIN_COUNT */
 
 int z_impl_k_mutex_lock(struct k_mutex *mutex, k_timeout_t timeout)
 {
+	struct k_thread *owner;
 	int new_prio;
 	k_spinlock_key_t key;
 	bool resched = false;
+	uintptr_t state;
 
 	__ASSERT(!arch_is_in_isr(), "mutexes cannot be used inside ISRs");
 
 	sys_trace_mutex_lock(mutex);
-	key = k_spin_lock(&lock);
 
-	if (likely((mutex->lock_count == 0U) || (mutex->owner == _current))) {
+	state = mutex_state(mutex);
 
-		mutex->owner_orig_prio = (mutex->lock_count == 0U) ?
-					_current->base.prio :
-					mutex->owner_orig_prio;
+	if (likely(state == 0U) && mutex_try_take(mutex)) {
+		sys_trace_end_call(SYS_TRACE_ID_MUTEX_LOCK);
+		return 0;
+	}
 
+	/* Only the owner can see itself as the owner */
+	if (mutex_owner(state) == _current) {
 		mutex->lock_count++;
-		mutex->owner = _current;
 
-		LOG_DBG("%p took mutex %p, count: %d, orig prio: %d",
-			_current, mutex, mutex->lock_count,
-			mutex->owner_orig_prio);
+		LOG_DBG("%p took mutex %p, count: %d", _current, mutex,
+			mutex->lock_count);
 
-		k_spin_unlock(&lock, key);
 		sys_trace_end_call(SYS_TRACE_ID_MUTEX_LOCK);
-
 		return 0;
 	}
 
 	if (unlikely(K_TIMEOUT_EQ(timeout, K_NO_WAIT))) {
-		k_spin_unlock(&lock, key);
 		sys_trace_end_call(SYS_TRACE_ID_MUTEX_LOCK);
 		return -EBUSY;
 	}
 
+#ifdef CONFIG_MUTEX_SPIN_COUNT
+	if (mutex_spin(mutex)) {
+		sys_trace_end_call(SYS_TRACE_ID_MUTEX_LOCK);
+		return 0;
+	}
+#endif
+
+	key = k_spin_lock(&lock);
+
+	/* Flag the mutex as waited for, unless it was given back */
+	for (;;) {
+		state = mutex_state(mutex);
+
+		if (state == 0U) {
+			if (mutex_try_take(mutex)) {
+				k_spin_unlock(&lock, key);
+				sys_trace_end_call(SYS_TRACE_ID_MUTEX_LOCK);
+				return 0;
+			}
+		} else if ((state & MUTEX_WAITERS) != 0U) {
+			break;
+		} else if (mutex_state_cas(mutex, state,
+					   state | MUTEX_WAITERS)) {
+			break;
+		}
+	}
+
+	/* The owner cannot change without the lock from now on */
+	owner = mutex_owner(state);
+
 	new_prio = new_prio_for_inheritance(_current->base.prio,
-					    mutex->owner->base.prio);
+					    owner->base.prio);
 
 	LOG_DBG("adjusting prio up on mutex %p", mutex);
 
-	if (z_is_prio_higher(new_prio, mutex->owner->base.prio)) {
-		resched = adjust_owner_prio(mutex, new_prio);
+	if (z_is_prio_higher(new_prio, owner->base.prio)) {
+		resched = adjust_owner_prio(owner, new_prio);
 	}
 
 	int got_mutex = z_pend_curr(&lock, key, &mutex->wait_q, timeout);
@@ -179,15 +304,24 @@ int z_impl_k_mutex_lock(struct k_mutex *mutex, k_timeout_t timeout)
 
 	key = k_spin_lock(&lock);
 
-	struct k_thread *waiter = z_waitq_head(&mutex->wait_q);
+	/* Without waiters flagged, the mutex was given back meanwhile and
+	 * its owner, if any, does not inherit a priority.
+	 */
+	state = mutex_state(mutex);
 
-	new_prio = (waiter != NULL) ?
-		new_prio_for_inheritance(waiter->base.prio, mutex->owner_orig_prio) :
-		mutex->owner_orig_prio;
+	if ((state & MUTEX_WAITERS) != 0U) {
+		struct k_thread *waiter = z_waitq_head(&mutex->wait_q);
 
-	LOG_DBG("adjusting prio down on mutex %p", mutex);
+		new_prio = (waiter != NULL) ?
+			new_prio_for_inheritance(waiter->base.prio,
+						 mutex->owner_orig_prio) :
+			mutex->owner_orig_prio;
 
-	resched = adjust_owner_prio(mutex, new_prio) || resched;
+		LOG_DBG("adjusting prio down on mutex %p", mutex);
+
+		resched = adjust_owner_prio(mutex_owner(state), new_prio) ||
+			  resched;
+	}
 
 	if (resched) {
 		z_reschedule(&lock, key);
@@ -212,16 +346,17 @@ static inline int z_vrfy_k_mutex_lock(struct k_mutex *mutex,
 int z_impl_k_mutex_unlock(struct k_mutex *mutex)
 {
 	struct k_thread *new_owner;
+	uintptr_t state = mutex_state(mutex);
 
 	__ASSERT(!arch_is_in_isr(), "mutexes cannot be used inside ISRs");
 
-	CHECKIF(mutex->owner == NULL) {
+	CHECKIF(mutex_owner(state) == NULL) {
 		return -EINVAL;
 	}
 	/*
 	 * The current thread does not own the mutex.
 	 */
-	CHECKIF(mutex->owner != _current) {
+	CHECKIF(mutex_owner(state) != _current) {
 		return -EPERM;
 	}
 
@@ -234,7 +369,6 @@ int z_impl_k_mutex_unlock(struct k_mutex *mutex)
 	__ASSERT_NO_MSG(mutex->lock_count > 0U);
 
 	sys_trace_mutex_unlock(mutex);
-	z_sched_lock();
 
 	LOG_DBG("mutex %p lock_count: %d", mutex, mutex->lock_count);
 
@@ -247,9 +381,25 @@ int z_impl_k_mutex_unlock(struct k_mutex *mutex)
 		goto k_mutex_unlock_return;
 	}
 
+	/* Nobody waits, nobody raised our priority: just give it back */
+	if ((state & MUTEX_WAITERS) == 0U) {
+		mutex->owner = NULL;
+		mutex->lock_count = 0U;
+
+		if (mutex_state_cas(mutex, state, 0U)) {
+			goto k_mutex_unlock_return;
+		}
+
+		/* A waiter came in meanwhile */
+		mutex->owner = _current;
+		mutex->lock_count = 1U;
+	}
+
+	z_sched_lock();
+
 	k_spinlock_key_t key = k_spin_lock(&lock);
 
-	adjust_owner_prio(mutex, mutex->owner_orig_prio);
+	adjust_owner_prio(_current, mutex->owner_orig_prio);
 
 	/* Get the new owner, if any */
 	new_owner = z_unpend_first_thread(&mutex->wait_q);
@@ -266,17 +416,24 @@ int z_impl_k_mutex_unlock(struct k_mutex *mutex)
 		 * ajust its priority
 		 */
 		mutex->owner_orig_prio = new_owner->base.prio;
+		state = (uintptr_t)new_owner;
+		if (z_waitq_head(&mutex->wait_q) != NULL) {
+			state |= MUTEX_WAITERS;
+		}
+		atomic_ptr_set(&mutex->state, (void *)state);
+
 		arch_thread_return_value_set(new_owner, 0);
 		z_ready_thread(new_owner);
 		z_reschedule(&lock, key);
 	} else {
 		mutex->lock_count = 0U;
+		atomic_ptr_set(&mutex->state, NULL);
 		k_spin_unlock(&lock, key);
 	}
 
+	k_sched_unlock();
 
 k_mutex_unlock_return:
-	k_sched_unlock();
 	sys_trace_end_call(SYS_TRACE_ID_MUTEX_UNLOCK);
 
 	return 0;
@@ -72,6 +72,13 @@ static inline bool is_condition_met(struct k_poll_event *event, uint32_t *state)
 			return true;
 		}
 		break;
+	case K_POLL_TYPE_MSGQ_DATA_AVAILABLE:
+		if (event->msgq->used_msgs > 0U &&
+		    (event->msgq->flags & K_MSGQ_FLAG_GET_CLAIMED) == 0U) {
+			*state = K_POLL_STATE_MSGQ_DATA_AVAILABLE;
+			return true;
+		}
+		break;
 	case K_POLL_TYPE_SIGNAL:
 		if (event->signal->signaled != 0U) {
 			*state = K_POLL_STATE_SIGNALED;
@@ -130,6 +137,10 @@ static inline void register_event(struct k_poll_event *event,
 		__ASSERT(event->queue != NULL, "invalid queue\n");
 		add_event(&event->queue->poll_events, event, poller);
 		break;
+	case K_POLL_TYPE_MSGQ_DATA_AVAILABLE:
+		__ASSERT(event->msgq != NULL, "invalid message queue\n");
+		add_event(&event->msgq->poll_events, event, poller);
+		break;
 	case K_POLL_TYPE_SIGNAL:
 		__ASSERT(event->signal != NULL, "invalid poll signal\n");
 		add_event(&event->signal->poll_events, event, poller);
@@ -161,6 +172,10 @@ static inline void clear_event_registration(struct k_poll_event *event)
 		__ASSERT(event->queue != NULL, "invalid queue\n");
 		remove_event = true;
 		break;
+	case K_POLL_TYPE_MSGQ_DATA_AVAILABLE:
+		__ASSERT(event->msgq != NULL, "invalid message queue\n");
+		remove_event = true;
+		break;
 	case K_POLL_TYPE_SIGNAL:
 		__ASSERT(event->signal != NULL, "invalid poll signal\n");
 		remove_event = true;
@@ -362,6 +377,9 @@ static inline int z_vrfy_k_poll(struct k_poll_event *events,
 		case K_POLL_TYPE_DATA_AVAILABLE:
 			Z_OOPS(Z_SYSCALL_OBJ(e->queue, K_OBJ_QUEUE));
 			break;
+		case K_POLL_TYPE_MSGQ_DATA_AVAILABLE:
+			Z_OOPS(Z_SYSCALL_OBJ(e->msgq, K_OBJ_MSGQ));
+			break;
 		default:
 			ret = -EINVAL;
 			goto out_free;
@@ -16,6 +16,7 @@
 #include <kernel_internal.h>
 #include <logging/log.h>
 #include <sys/atomic.h>
+#include <sys/math_extras.h>
 LOG_MODULE_DECLARE(os, CONFIG_KERNEL_LOG_LEVEL);
 
 #if defined(CONFIG_SCHED_DUMB)
@@ -1030,18 +1031,13 @@ struct k_thread *z_priq_rb_best(struct _priq_rb *pq)
 	return thread;
 }
 
-#ifdef CONFIG_SCHED_MULTIQ
-# if (K_LOWEST_THREAD_PRIO - K_HIGHEST_THREAD_PRIO) > 31
-# error Too many priorities for multiqueue scheduler (max 32)
-# endif
-#endif
-
 ALWAYS_INLINE void z_priq_mq_add(struct _priq_mq *pq, struct k_thread *thread)
 {
 	int priority_bit = thread->base.prio - K_HIGHEST_THREAD_PRIO;
 
 	sys_dlist_append(&pq->queues[priority_bit], &thread->base.qnode_dlist);
-	pq->bitmask |= BIT(priority_bit);
+	pq->bitmask[priority_bit / BITS_PER_LONG] |=
+		BIT(priority_bit % BITS_PER_LONG);
 }
 
 ALWAYS_INLINE void z_priq_mq_remove(struct _priq_mq *pq, struct k_thread *thread)
@@ -1050,23 +1046,35 @@ ALWAYS_INLINE void z_priq_mq_remove(struct _priq_mq *pq, struct k_thread *thread
 
 	sys_dlist_remove(&thread->base.qnode_dlist);
 	if (sys_dlist_is_empty(&pq->queues[priority_bit])) {
-		pq->bitmask &= ~BIT(priority_bit);
+		pq->bitmask[priority_bit / BITS_PER_LONG] &=
+			~BIT(priority_bit % BITS_PER_LONG);
 	}
 }
 
 struct k_thread *z_priq_mq_best(struct _priq_mq *pq)
 {
-	if (!pq->bitmask) {
-		return NULL;
-	}
-
 	struct k_thread *thread = NULL;
-	sys_dlist_t *l = &pq->queues[__builtin_ctz(pq->bitmask)];
-	sys_dnode_t *n = sys_dlist_peek_head(l);
 
-	if (n != NULL) {
-		thread = CONTAINER_OF(n, struct k_thread, base.qnode_dlist);
+	for (int i = 0; i < PRIQ_BITMAP_SIZE; i++) {
+		if (pq->bitmask[i] == 0U) {
+			continue;
+		}
+
+#ifdef CONFIG_64BIT
+		int bit = u64_count_trailing_zeros(pq->bitmask[i]);
+#else
+		int bit = u32_count_trailing_zeros(pq->bitmask[i]);
+#endif
+		sys_dlist_t *l = &pq->queues[i * BITS_PER_LONG + bit];
+		sys_dnode_t *n = sys_dlist_peek_head(l);
+
+		if (n != NULL) {
+			thread = CONTAINER_OF(n, struct k_thread,
+					      base.qnode_dlist);
+		}
+		break;
 	}
+
 	return thread;
 }
 
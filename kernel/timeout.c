@@ -11,10 +11,13 @@
 #include <syscall_handler.h>
 #include <drivers/timer/system_timer.h>
 #include <sys_clock.h>
+#include <sys/math_extras.h>
 
 static uint64_t curr_tick;
 
+#ifdef CONFIG_TIMEOUT_QUEUE_DLIST
 static sys_dlist_t timeout_list = SYS_DLIST_STATIC_INIT(&timeout_list);
+#endif
 
 static struct k_spinlock timeout_lock;
 
@@ -36,6 +39,356 @@ static inline int z_vrfy_sys_clock_hw_cycles_per_sec_runtime_get(void)
 #endif /* CONFIG_USERSPACE */
 #endif /* CONFIG_TIMER_READS_ITS_FREQUENCY_AT_RUNTIME */
 
+#ifdef CONFIG_TIMEOUT_QUEUE_WHEEL
+/* Hierarchical timing wheel.  Here the dticks field of a queued
+ * timeout holds its absolute expiry tick rather than a delta.  A
+ * timeout is filed at the level of the most significant
+ * WHEEL_BITS-wide digit in which its expiry differs from wheel_now,
+ * in the slot indexed by that digit of the expiry.  All timeouts in a
+ * level-0 slot expire on the same tick, and every timeout at level N
+ * expires before any at level N+1, so the earliest one is always in
+ * the lowest occupied slot of the lowest occupied level.  Expiries
+ * too far out for the wheel go to an unsorted overflow list.
+ *
+ * As wheel_now advances (only ever up to the earliest expiry, see
+ * wheel_advance()) the single slot it enters at the highest changed
+ * level is cascaded down, which is all that's needed to keep the
+ * invariant above.  A slot's list head is only valid while its bit
+ * is set in wheel_occupied[].
+ */
+#define WHEEL_BITS 6
+#define WHEEL_SLOTS BIT(WHEEL_BITS)
+#define WHEEL_LEVELS CONFIG_TIMEOUT_QUEUE_WHEEL_LEVELS
+
+BUILD_ASSERT(WHEEL_SLOTS <= 64, "slot occupancy must fit in a uint64_t");
+
+static uint64_t wheel_now;
+
+static uint64_t wheel_occupied[WHEEL_LEVELS];
+
+static sys_dlist_t wheel[WHEEL_LEVELS][WHEEL_SLOTS];
+
+static sys_dlist_t wheel_overflow = SYS_DLIST_STATIC_INIT(&wheel_overflow);
+
+/* Cached earliest timeout, NULL when it must be searched for */
+static struct _timeout *wheel_first;
+
+static int wheel_level(uint64_t expiry)
+{
+	uint64_t diff = expiry ^ wheel_now;
+
+	if (diff == 0U) {
+		return 0;
+	}
+
+	return (63 - u64_count_leading_zeros(diff)) / WHEEL_BITS;
+}
+
+static int wheel_slot(uint64_t expiry, int level)
+{
+	return (expiry >> (level * WHEEL_BITS)) & (WHEEL_SLOTS - 1);
+}
+
+static void wheel_insert(struct _timeout *to, bool cascade)
+{
+	int level = wheel_level(to->dticks);
+	sys_dlist_t *list = &wheel_overflow;
+
+	if (level < WHEEL_LEVELS) {
+		int slot = wheel_slot(to->dticks, level);
+
+		list = &wheel[level][slot];
+		if ((wheel_occupied[level] & BIT64(slot)) == 0U) {
+			sys_dlist_init(list);
+			wheel_occupied[level] |= BIT64(slot);
+		}
+	}
+
+	/* Cascaded timeouts were armed before anything already
+	 * filed at their new position with the same expiry, so they
+	 * go in front to keep same-tick timeouts in arming order.
+	 */
+	if (cascade) {
+		sys_dlist_prepend(list, &to->node);
+	} else {
+		sys_dlist_append(list, &to->node);
+	}
+}
+
+/* Moves the wheel reference to @now, which must not be later than
+ * any queued expiry.
+ */
+static void wheel_advance(uint64_t now)
+{
+	uint64_t diff = now ^ wheel_now;
+	int level = diff == 0U ? 0
+		: (63 - u64_count_leading_zeros(diff)) / WHEEL_BITS;
+	sys_dlist_t pending;
+	sys_dnode_t *node;
+
+	wheel_now = now;
+
+	/* Level 0 slots are exact ticks, nothing to cascade */
+	if (level == 0) {
+		return;
+	}
+
+	sys_dlist_init(&pending);
+
+	if (level >= WHEEL_LEVELS) {
+		/* The whole wheel span is behind us, so only the
+		 * overflow list can be non-empty.
+		 */
+		while ((node = sys_dlist_get(&wheel_overflow)) != NULL) {
+			sys_dlist_append(&pending, node);
+		}
+	} else {
+		int slot = wheel_slot(now, level);
+
+		if ((wheel_occupied[level] & BIT64(slot)) == 0U) {
+			return;
+		}
+
+		wheel_occupied[level] &= ~BIT64(slot);
+		while ((node = sys_dlist_get(&wheel[level][slot])) != NULL) {
+			sys_dlist_append(&pending, node);
+		}
+	}
+
+	while ((node = sys_dlist_peek_tail(&pending)) != NULL) {
+		sys_dlist_remove(node);
+		wheel_insert(CONTAINER_OF(node, struct _timeout, node), true);
+	}
+}
+
+static struct _timeout *first(void)
+{
+	sys_dlist_t *list = &wheel_overflow;
+	struct _timeout *t;
+
+	if (wheel_first != NULL) {
+		return wheel_first;
+	}
+
+	for (int level = 0; level < WHEEL_LEVELS; level++) {
+		if (wheel_occupied[level] != 0U) {
+			int slot = u64_count_trailing_zeros(wheel_occupied[level]);
+
+			list = &wheel[level][slot];
+			if (level == 0) {
+				wheel_first = SYS_DLIST_PEEK_HEAD_CONTAINER(list,
+									    t, node);
+				return wheel_first;
+			}
+			break;
+		}
+	}
+
+	/* Higher level slots and the overflow list are unordered;
+	 * the first queued wins a tie.
+	 */
+	SYS_DLIST_FOR_EACH_CONTAINER(list, t, node) {
+		if (wheel_first == NULL || t->dticks < wheel_first->dticks) {
+			wheel_first = t;
+		}
+	}
+
+	return wheel_first;
+}
+
+static void remove_timeout(struct _timeout *t)
+{
+	int level = wheel_level(t->dticks);
+
+	sys_dlist_remove(&t->node);
+
+	if (level < WHEEL_LEVELS) {
+		int slot = wheel_slot(t->dticks, level);
+
+		if (sys_dlist_is_empty(&wheel[level][slot])) {
+			wheel_occupied[level] &= ~BIT64(slot);
+		}
+	}
+
+	if (t == wheel_first) {
+		wheel_first = NULL;
+	}
+}
+
+static void insert_timeout(struct _timeout *to, k_ticks_t ticks)
+{
+	to->dticks = curr_tick + ticks;
+	wheel_insert(to, false);
+
+	if (wheel_first != NULL && to->dticks < wheel_first->dticks) {
+		wheel_first = to;
+	}
+}
+
+/* Ticks from curr_tick until @t expires */
+static k_ticks_t timeout_delta(const struct _timeout *t)
+{
+	return t->dticks - curr_tick;
+}
+
+#elif defined(CONFIG_TIMEOUT_QUEUE_PER_CPU)
+/* One queue per CPU, each a list sorted by absolute expiry tick (held
+ * in dticks) under its own lock.  Timeouts are armed on the queue of
+ * the arming CPU, or of the CPU their thread is pinned to, and are
+ * aborted from whichever queue they are on, so arming and aborting on
+ * different CPUs no longer contend.  timeout_lock still guards
+ * curr_tick and serializes sys_clock_announce().  Lock order is
+ * timeout_lock first, then a queue lock.
+ */
+struct timeout_queue {
+	struct k_spinlock lock;
+	sys_dlist_t list;
+};
+
+#define TIMEOUT_QUEUE_INIT(i, _) \
+	{ .list = SYS_DLIST_STATIC_INIT(&timeout_queues[i].list) },
+
+static struct timeout_queue timeout_queues[CONFIG_MP_NUM_CPUS] = {
+	UTIL_LISTIFY(CONFIG_MP_NUM_CPUS, TIMEOUT_QUEUE_INIT)
+};
+
+static struct _timeout *queue_first(struct timeout_queue *q)
+{
+	sys_dnode_t *t = sys_dlist_peek_head(&q->list);
+
+	return t == NULL ? NULL : CONTAINER_OF(t, struct _timeout, node);
+}
+
+static int pick_queue(struct _timeout *to)
+{
+	/* Only used as a placement hint, so a stale CPU id after a
+	 * migration is harmless.
+	 */
+	int cpu = arch_curr_cpu()->id;
+
+#ifdef CONFIG_SCHED_CPU_MASK
+	if (to->fn == z_thread_timeout) {
+		struct _thread_base *base =
+			CONTAINER_OF(to, struct _thread_base, timeout);
+		uint8_t mask = base->cpu_mask;
+
+		if ((mask & BIT(cpu)) == 0U && mask != 0U) {
+			cpu = u32_count_trailing_zeros(mask);
+		}
+	}
+#endif
+
+	return cpu;
+}
+
+/* Returns true if @to became the head of its queue */
+static bool queue_insert(struct _timeout *to, uint64_t expiry)
+{
+	struct timeout_queue *q;
+	struct _timeout *t;
+	bool head = false;
+
+	to->queue = pick_queue(to);
+	to->dticks = expiry;
+	q = &timeout_queues[to->queue];
+
+	LOCKED(&q->lock) {
+		SYS_DLIST_FOR_EACH_CONTAINER(&q->list, t, node) {
+			if (t->dticks > to->dticks) {
+				sys_dlist_insert(&t->node, &to->node);
+				break;
+			}
+		}
+
+		if (t == NULL) {
+			sys_dlist_append(&q->list, &to->node);
+		}
+
+		head = to == queue_first(q);
+	}
+
+	return head;
+}
+
+/* Removes and returns the earliest timeout due at or before @limit,
+ * must be called with timeout_lock held.
+ */
+static struct _timeout *pop_expired(uint64_t limit)
+{
+	struct _timeout *t = NULL;
+
+	while (t == NULL) {
+		struct timeout_queue *best = NULL;
+		int64_t best_expiry = 0;
+
+		for (int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+			struct timeout_queue *q = &timeout_queues[i];
+
+			LOCKED(&q->lock) {
+				struct _timeout *h = queue_first(q);
+
+				if (h != NULL && (best == NULL ||
+						  h->dticks < best_expiry)) {
+					best = q;
+					best_expiry = h->dticks;
+				}
+			}
+		}
+
+		if (best == NULL || best_expiry > limit) {
+			return NULL;
+		}
+
+		/* The head may have been aborted since we looked, in
+		 * which case go round again.
+		 */
+		LOCKED(&best->lock) {
+			t = queue_first(best);
+			if (t != NULL && t->dticks <= limit) {
+				sys_dlist_remove(&t->node);
+			} else {
+				t = NULL;
+			}
+		}
+	}
+
+	return t;
+}
+
+/* Ticks from curr_tick to the earliest expiry, K_TICKS_FOREVER if
+ * nothing is queued.  Must be called with timeout_lock held.
+ */
+static k_ticks_t first_delta(void)
+{
+	k_ticks_t ret = K_TICKS_FOREVER;
+
+	for (int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		struct timeout_queue *q = &timeout_queues[i];
+
+		LOCKED(&q->lock) {
+			struct _timeout *h = queue_first(q);
+
+			if (h != NULL) {
+				/* Late arrivals may already be overdue */
+				k_ticks_t dt = MAX(0, h->dticks - (int64_t)curr_tick);
+
+				if (ret == K_TICKS_FOREVER || dt < ret) {
+					ret = dt;
+				}
+			}
+		}
+	}
+
+	return ret;
+}
+
+static k_ticks_t timeout_delta(const struct _timeout *t)
+{
+	return t->dticks - curr_tick;
+}
+
+#else
+
 static struct _timeout *first(void)
 {
 	sys_dnode_t *t = sys_dlist_peek_head(&timeout_list);
@@ -59,6 +412,41 @@ static void remove_timeout(struct _timeout *t)
 	sys_dlist_remove(&t->node);
 }
 
+static void insert_timeout(struct _timeout *to, k_ticks_t ticks)
+{
+	struct _timeout *t;
+
+	to->dticks = ticks;
+	for (t = first(); t != NULL; t = next(t)) {
+		if (t->dticks > to->dticks) {
+			t->dticks -= to->dticks;
+			sys_dlist_insert(&t->node, &to->node);
+			break;
+		}
+		to->dticks -= t->dticks;
+	}
+
+	if (t == NULL) {
+		sys_dlist_append(&timeout_list, &to->node);
+	}
+}
+
+static k_ticks_t timeout_delta(const struct _timeout *t)
+{
+	return t->dticks;
+}
+
+#endif /* CONFIG_TIMEOUT_QUEUE_WHEEL */
+
+#ifndef CONFIG_TIMEOUT_QUEUE_PER_CPU
+static k_ticks_t first_delta(void)
+{
+	struct _timeout *to = first();
+
+	return to == NULL ? K_TICKS_FOREVER : timeout_delta(to);
+}
+#endif
+
 static int32_t elapsed(void)
 {
 	return announce_remaining == 0 ? sys_clock_elapsed() : 0U;
@@ -66,10 +454,10 @@ static int32_t elapsed(void)
 
 static int32_t next_timeout(void)
 {
-	struct _timeout *to = first();
+	k_ticks_t delta = first_delta();
 	int32_t ticks_elapsed = elapsed();
-	int32_t ret = to == NULL ? MAX_WAIT
-		: CLAMP(to->dticks - ticks_elapsed, 0, MAX_WAIT);
+	int32_t ret = delta == K_TICKS_FOREVER ? MAX_WAIT
+			: CLAMP(delta - ticks_elapsed, 0, MAX_WAIT);
 
 #ifdef CONFIG_TIMESLICING
 	if (_current_cpu->slice_ticks && _current_cpu->slice_ticks < ret) {
@@ -79,6 +467,29 @@ static int32_t next_timeout(void)
 	return ret;
 }
 
+/* Called with timeout_lock held when the first timeout changed */
+static void reprogram_timeout(void)
+{
+#if CONFIG_TIMESLICING
+	/*
+	 * This is not ideal, since it does not
+	 * account the time elapsed since the the
+	 * last announcement, and slice_ticks is based
+	 * on that. It means the that time remaining for
+	 * the next announcement can be lesser than
+	 * slice_ticks.
+	 */
+	int32_t next_time = next_timeout();
+
+	if (next_time == 0 ||
+	    _current_cpu->slice_ticks != next_time) {
+		sys_clock_set_timeout(next_time, false);
+	}
+#else
+	sys_clock_set_timeout(next_timeout(), false);
+#endif	/* CONFIG_TIMESLICING */
+}
+
 void z_add_timeout(struct _timeout *to, _timeout_func_t fn,
 		   k_timeout_t timeout)
 {
@@ -100,56 +511,62 @@ void z_add_timeout(struct _timeout *to, _timeout_func_t fn,
 	to->fn = fn;
 	ticks = MAX(1, ticks);
 
-	LOCKED(&timeout_lock) {
-		struct _timeout *t;
+#ifdef CONFIG_TIMEOUT_QUEUE_PER_CPU
+	uint64_t expiry;
 
-		to->dticks = ticks + elapsed();
-		for (t = first(); t != NULL; t = next(t)) {
-			if (t->dticks > to->dticks) {
-				t->dticks -= to->dticks;
-				sys_dlist_insert(&t->node, &to->node);
-				break;
-			}
-			to->dticks -= t->dticks;
-		}
+	LOCKED(&timeout_lock) {
+		expiry = curr_tick + elapsed() + ticks;
+	}
 
-		if (t == NULL) {
-			sys_dlist_append(&timeout_list, &to->node);
+	if (queue_insert(to, expiry)) {
+		LOCKED(&timeout_lock) {
+			reprogram_timeout();
 		}
+	}
+#else
+	LOCKED(&timeout_lock) {
+		insert_timeout(to, ticks + elapsed());
 
 		if (to == first()) {
-#if CONFIG_TIMESLICING
-			/*
-			 * This is not ideal, since it does not
-			 * account the time elapsed since the the
-			 * last announcement, and slice_ticks is based
-			 * on that. It means the that time remaining for
-			 * the next announcement can be lesser than
-			 * slice_ticks.
-			 */
-			int32_t next_time = next_timeout();
-
-			if (next_time == 0 ||
-			    _current_cpu->slice_ticks != next_time) {
-				sys_clock_set_timeout(next_time, false);
-			}
-#else
-			sys_clock_set_timeout(next_timeout(), false);
-#endif	/* CONFIG_TIMESLICING */
+			reprogram_timeout();
 		}
 	}
+#endif /* CONFIG_TIMEOUT_QUEUE_PER_CPU */
 }
 
 int z_abort_timeout(struct _timeout *to)
 {
 	int ret = -EINVAL;
 
+#ifdef CONFIG_TIMEOUT_QUEUE_PER_CPU
+	int idx;
+
+	/* The timeout may expire and be re-armed on another CPU's
+	 * queue between reading to->queue and taking its lock, in
+	 * which case chase it there.
+	 */
+	do {
+		idx = to->queue;
+
+		struct timeout_queue *q = &timeout_queues[idx];
+		k_spinlock_key_t key = k_spin_lock(&q->lock);
+
+		if (sys_dnode_is_linked(&to->node) && to->queue == idx) {
+			sys_dlist_remove(&to->node);
+			ret = 0;
+		}
+
+		k_spin_unlock(&q->lock, key);
+	} while (ret != 0 && sys_dnode_is_linked(&to->node) &&
+		 to->queue != idx);
+#else
 	LOCKED(&timeout_lock) {
 		if (sys_dnode_is_linked(&to->node)) {
 			remove_timeout(to);
 			ret = 0;
 		}
 	}
+#endif
 
 	return ret;
 }
@@ -163,12 +580,16 @@ static k_ticks_t timeout_rem(const struct _timeout *timeout)
 		return 0;
 	}
 
+#if defined(CONFIG_TIMEOUT_QUEUE_WHEEL) || defined(CONFIG_TIMEOUT_QUEUE_PER_CPU)
+	ticks = timeout_delta(timeout);
+#else
 	for (struct _timeout *t = first(); t != NULL; t = next(t)) {
 		ticks += t->dticks;
 		if (timeout == t) {
 			break;
 		}
 	}
+#endif
 
 	return ticks - elapsed();
 }
@@ -239,27 +660,49 @@ void sys_clock_announce(int32_t ticks)
 
 	announce_remaining = ticks;
 
-	while (first() != NULL && first()->dticks <= announce_remaining) {
+#ifdef CONFIG_TIMEOUT_QUEUE_PER_CPU
+	struct _timeout *t;
+
+	while ((t = pop_expired(curr_tick + announce_remaining)) != NULL) {
+		/* Timeouts armed while curr_tick moved may be overdue */
+		int dt = MAX(0, timeout_delta(t));
+#else
+	while (first() != NULL && timeout_delta(first()) <= announce_remaining) {
 		struct _timeout *t = first();
-		int dt = t->dticks;
+		int dt = timeout_delta(t);
+#endif
 
 		curr_tick += dt;
 		announce_remaining -= dt;
+#if defined(CONFIG_TIMEOUT_QUEUE_WHEEL)
+		wheel_advance(curr_tick);
+		remove_timeout(t);
+		t->dticks = 0;
+#elif defined(CONFIG_TIMEOUT_QUEUE_PER_CPU)
+		t->dticks = 0;
+#else
 		t->dticks = 0;
 		remove_timeout(t);
+#endif
 
 		k_spin_unlock(&timeout_lock, key);
 		t->fn(t);
 		key = k_spin_lock(&timeout_lock);
 	}
 
+#ifdef CONFIG_TIMEOUT_QUEUE_DLIST
 	if (first() != NULL) {
 		first()->dticks -= announce_remaining;
 	}
+#endif
 
 	curr_tick += announce_remaining;
 	announce_remaining = 0;
 
+#ifdef CONFIG_TIMEOUT_QUEUE_WHEEL
+	wheel_advance(curr_tick);
+#endif
+
 	sys_clock_set_timeout(next_timeout(), false);
 
 	k_spin_unlock(&timeout_lock, key);
@@ -13,6 +13,9 @@
 #include <app_memory/app_memdomain.h>
 #include <sys/mutex.h>
 #include <sys/sys_heap.h>
+#ifdef CONFIG_MINIMAL_LIBC_MALLOC_CPU_CACHE
+#include <sys/sys_heap_cache.h>
+#endif
 #include <zephyr/types.h>
 
 #define LOG_LEVEL CONFIG_KERNEL_LOG_LEVEL
@@ -35,16 +38,96 @@ Z_GENERIC_SECTION(POOL_SECTION) static struct sys_heap z_malloc_heap;
 Z_GENERIC_SECTION(POOL_SECTION) struct sys_mutex z_malloc_heap_mutex;
 Z_GENERIC_SECTION(POOL_SECTION) static char z_malloc_heap_mem[HEAP_BYTES];
 
+#ifdef CONFIG_MINIMAL_LIBC_MALLOC_CPU_CACHE
+static struct sys_heap_cache z_malloc_heap_cache;
+
+static size_t malloc_alloc_bulk(void *backend, size_t align, size_t bytes,
+				void **blocks, size_t count)
+{
+	int lock_ret;
+	size_t n;
+
+	ARG_UNUSED(backend);
+
+	lock_ret = sys_mutex_lock(&z_malloc_heap_mutex, K_FOREVER);
+	__ASSERT_NO_MSG(lock_ret == 0);
+
+	for (n = 0; n < count; n++) {
+		blocks[n] = sys_heap_aligned_alloc(&z_malloc_heap, align,
+						   bytes);
+		if (blocks[n] == NULL) {
+			break;
+		}
+	}
+
+	(void) sys_mutex_unlock(&z_malloc_heap_mutex);
+
+	return n;
+}
+
+static void malloc_free_bulk(void *backend, void **blocks, size_t count)
+{
+	int lock_ret;
+
+	ARG_UNUSED(backend);
+
+	lock_ret = sys_mutex_lock(&z_malloc_heap_mutex, K_FOREVER);
+	__ASSERT_NO_MSG(lock_ret == 0);
+
+	for (size_t i = 0; i < count; i++) {
+		sys_heap_free(&z_malloc_heap, blocks[i]);
+	}
+
+	(void) sys_mutex_unlock(&z_malloc_heap_mutex);
+}
+
+static const struct sys_heap_cache_ops malloc_cache_ops = {
+	.alloc_bulk = malloc_alloc_bulk,
+	.free_bulk = malloc_free_bulk,
+};
+#endif /* CONFIG_MINIMAL_LIBC_MALLOC_CPU_CACHE */
+
 void *malloc(size_t size)
 {
 	int lock_ret;
 
+#ifdef CONFIG_MINIMAL_LIBC_MALLOC_CPU_CACHE
+	void *cached = sys_heap_cache_alloc(&z_malloc_heap_cache,
+					    __alignof__(z_max_align_t),
+					    size);
+	if (cached != NULL) {
+		return cached;
+	}
+#endif
+
 	lock_ret = sys_mutex_lock(&z_malloc_heap_mutex, K_FOREVER);
 	__ASSERT_NO_MSG(lock_ret == 0);
 
 	void *ret = sys_heap_aligned_alloc(&z_malloc_heap,
 					   __alignof__(z_max_align_t),
 					   size);
+
+#ifdef CONFIG_MINIMAL_LIBC_MALLOC_CPU_CACHE
+	/* The missing memory may sit in the caches.  As in
+	 * k_heap_aligned_alloc(), announce ourselves so that no block is
+	 * cached again meanwhile, then give all of them back and retry.
+	 */
+	if (ret == NULL && size != 0 &&
+	    sys_heap_cache_count(&z_malloc_heap_cache) != 0) {
+		atomic_inc(&z_malloc_heap_cache.waiters);
+		(void) sys_mutex_unlock(&z_malloc_heap_mutex);
+		sys_heap_cache_flush(&z_malloc_heap_cache);
+
+		lock_ret = sys_mutex_lock(&z_malloc_heap_mutex, K_FOREVER);
+		__ASSERT_NO_MSG(lock_ret == 0);
+
+		ret = sys_heap_aligned_alloc(&z_malloc_heap,
+					     __alignof__(z_max_align_t),
+					     size);
+		atomic_dec(&z_malloc_heap_cache.waiters);
+	}
+#endif
+
 	if (ret == NULL && size != 0) {
 		errno = ENOMEM;
 	}
@@ -60,6 +143,11 @@ static int malloc_prepare(const struct device *unused)
 
 	sys_heap_init(&z_malloc_heap, z_malloc_heap_mem, HEAP_BYTES);
 	sys_mutex_init(&z_malloc_heap_mutex);
+#ifdef CONFIG_MINIMAL_LIBC_MALLOC_CPU_CACHE
+	sys_heap_cache_init(&z_malloc_heap_cache, &z_malloc_heap,
+			    &malloc_cache_ops, NULL,
+			    __alignof__(z_max_align_t));
+#endif
 
 	return 0;
 }
@@ -88,6 +176,12 @@ void free(void *ptr)
 {
 	int lock_ret;
 
+#ifdef CONFIG_MINIMAL_LIBC_MALLOC_CPU_CACHE
+	if (sys_heap_cache_free(&z_malloc_heap_cache, ptr)) {
+		return;
+	}
+#endif
+
 	lock_ret = sys_mutex_lock(&z_malloc_heap_mutex, K_FOREVER);
 	__ASSERT_NO_MSG(lock_ret == 0);
 	sys_heap_free(&z_malloc_heap, ptr);
@@ -5,6 +5,7 @@
  */
 #include <sys/sys_heap.h>
 #include <kernel.h>
+#include <string.h>
 #include "heap.h"
 
 /* White-box sys_heap validation code.  Uses internal data structures.
@@ -167,6 +168,25 @@ bool sys_heap_validate(struct sys_heap *heap)
 	for (c = right_chunk(h, 0); c <= max_chunkid(h); c = right_chunk(h, c)) {
 		set_chunk_used(h, c, !chunk_used(h, c));
 	}
+
+#ifdef CONFIG_SYS_HEAP_RUNTIME_STATS
+	/* The usage counters must add up to the used chunks */
+	size_t allocated_bytes = 0;
+	size_t heap_bytes = (h->end_chunk - right_chunk(h, 0)) * CHUNK_UNIT;
+
+	for (c = right_chunk(h, 0); c <= max_chunkid(h); c = right_chunk(h, c)) {
+		if (chunk_used(h, c)) {
+			allocated_bytes += chunk_size(h, c) * CHUNK_UNIT;
+		}
+	}
+
+	if (allocated_bytes != h->allocated_bytes ||
+	    h->free_bytes != heap_bytes - allocated_bytes ||
+	    h->max_allocated_bytes < allocated_bytes) {
+		return false;
+	}
+#endif
+
 	return true;
 }
 
@@ -387,3 +407,47 @@ void sys_heap_print_info(struct sys_heap *heap, bool dump_chunks)
 {
 	heap_print_info(heap->heap, dump_chunks);
 }
+
+void sys_heap_frag_stats_get(struct sys_heap *heap,
+			     struct sys_heap_frag_stats *stats)
+{
+	struct z_heap *h = heap->heap;
+	int i, nb_buckets = bucket_idx(h, h->end_chunk) + 1;
+
+	(void)memset(stats, 0, sizeof(*stats));
+	stats->nb_buckets = nb_buckets;
+
+	for (i = 0; i < nb_buckets; i++) {
+		chunkid_t first = h->buckets[i].next;
+		chunksz_t largest = 0;
+		uint32_t count = 0;
+		size_t bytes = 0;
+
+		if (first) {
+			chunkid_t curr = first;
+
+			do {
+				count++;
+				bytes += chunksz_to_bytes(h, chunk_size(h, curr));
+				largest = MAX(largest, chunk_size(h, curr));
+				curr = next_free_chunk(h, curr);
+			} while (curr != first);
+		}
+
+		stats->buckets[i].min_bytes =
+			chunksz_to_bytes(h, (1 << i) - 1 + min_chunk_size(h));
+		stats->buckets[i].chunks = count;
+
+		stats->free_chunks += count;
+		stats->free_bytes += bytes;
+		stats->largest_free_bytes = MAX(stats->largest_free_bytes,
+						count ? chunksz_to_bytes(h, largest)
+						      : 0);
+	}
+
+	/* One free chunk is not fragmented, many small ones are */
+	if (stats->free_bytes) {
+		stats->frag_index = 1000U - (uint32_t)(1000U *
+			(uint64_t)stats->largest_free_bytes / stats->free_bytes);
+	}
+}
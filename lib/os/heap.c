@@ -18,6 +18,22 @@ static void *chunk_mem(struct z_heap *h, chunkid_t c)
 	return ret;
 }
 
+/* Accounts for a used chunk going from old_sz to new_sz units, a chunk
+ * being allocated has an old_sz of 0 and one being freed a new_sz of 0.
+ */
+static inline void used_chunk_resized(struct z_heap *h, chunksz_t old_sz,
+				      chunksz_t new_sz)
+{
+#ifdef CONFIG_SYS_HEAP_RUNTIME_STATS
+	size_t delta = ((size_t)new_sz - old_sz) * CHUNK_UNIT;
+
+	h->allocated_bytes += delta;
+	h->free_bytes -= delta;
+	h->max_allocated_bytes = MAX(h->max_allocated_bytes,
+				     h->allocated_bytes);
+#endif
+}
+
 static void free_list_remove_bidx(struct z_heap *h, chunkid_t c, int bidx)
 {
 	struct z_heap_bucket *b = &h->buckets[bidx];
@@ -163,10 +179,22 @@ void sys_heap_free(struct sys_heap *heap, void *mem)
 		 "corrupted heap bounds (buffer overflow?) for memory at %p",
 		 mem);
 
+	used_chunk_resized(h, chunk_size(h, c), 0);
 	set_chunk_used(h, c, false);
 	free_chunk(h, c);
 }
 
+size_t sys_heap_usable_size(struct sys_heap *heap, void *mem)
+{
+	struct z_heap *h = heap->heap;
+	chunkid_t c = mem_to_chunkid(h, mem);
+	size_t addr = (size_t)mem;
+	size_t chunk_base = (size_t)&chunk_buf(h)[c];
+	size_t chunk_sz = chunk_size(h, c) * CHUNK_UNIT;
+
+	return chunk_sz - (addr - chunk_base);
+}
+
 static chunkid_t alloc_chunk(struct z_heap *h, chunksz_t sz)
 {
 	int bi = bucket_idx(h, sz);
@@ -239,6 +267,7 @@ void *sys_heap_alloc(struct sys_heap *heap, size_t bytes)
 		free_list_add(h, c + chunk_sz);
 	}
 
+	used_chunk_resized(h, 0, chunk_size(h, c));
 	set_chunk_used(h, c, true);
 	return chunk_mem(h, c);
 }
@@ -306,6 +335,7 @@ void *sys_heap_aligned_alloc(struct sys_heap *heap, size_t align, size_t bytes)
 		free_list_add(h, c_end);
 	}
 
+	used_chunk_resized(h, 0, chunk_size(h, c));
 	set_chunk_used(h, c, true);
 	return mem;
 }
@@ -342,6 +372,7 @@ void *sys_heap_aligned_realloc(struct sys_heap *heap, void *ptr,
 		return ptr;
 	} else if (chunk_size(h, c) > chunks_need) {
 		/* Shrink in place, split off and free unused suffix */
+		used_chunk_resized(h, chunk_size(h, c), chunks_need);
 		split_chunks(h, c, c + chunks_need);
 		set_chunk_used(h, c, true);
 		free_chunk(h, c + chunks_need);
@@ -358,6 +389,7 @@ void *sys_heap_aligned_realloc(struct sys_heap *heap, void *ptr,
 			free_list_add(h, rc + split_size);
 		}
 
+		used_chunk_resized(h, chunk_size(h, c), chunks_need);
 		merge_chunks(h, c, rc);
 		set_chunk_used(h, c, true);
 		return ptr;
@@ -422,4 +454,29 @@ void sys_heap_init(struct sys_heap *heap, void *mem, size_t bytes)
 	set_chunk_used(h, heap_sz, true);
 
 	free_list_add(h, chunk0_size);
+
+#ifdef CONFIG_SYS_HEAP_RUNTIME_STATS
+	h->free_bytes = (heap_sz - chunk0_size) * CHUNK_UNIT;
+	h->allocated_bytes = 0;
+	h->max_allocated_bytes = 0;
+#endif
+}
+
+#ifdef CONFIG_SYS_HEAP_RUNTIME_STATS
+void sys_heap_runtime_stats_get(struct sys_heap *heap,
+				struct sys_memory_stats *stats)
+{
+	struct z_heap *h = heap->heap;
+
+	stats->free_bytes = h->free_bytes;
+	stats->allocated_bytes = h->allocated_bytes;
+	stats->max_allocated_bytes = h->max_allocated_bytes;
+}
+
+void sys_heap_runtime_stats_reset_max(struct sys_heap *heap)
+{
+	struct z_heap *h = heap->heap;
+
+	h->max_allocated_bytes = h->allocated_bytes;
 }
+#endif /* CONFIG_SYS_HEAP_RUNTIME_STATS */
@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <sys/sys_heap_cache.h>
+#include <kernel.h>
+#include <string.h>
+#include "heap.h"
+
+#define MAG_SIZE CONFIG_SYS_HEAP_CPU_CACHE_SIZE
+#define NUM_CLASSES CONFIG_SYS_HEAP_CPU_CACHE_CLASSES
+
+/* Blocks moved between a magazine and the heap at once */
+#define BATCH (MAG_SIZE / 2)
+
+/* log2 of the size of the smallest class */
+#define MIN_SHIFT __builtin_ctz(SYS_HEAP_CACHE_MIN_BYTES)
+
+BUILD_ASSERT((SYS_HEAP_CACHE_MIN_BYTES & (SYS_HEAP_CACHE_MIN_BYTES - 1)) == 0,
+	     "SYS_HEAP_CACHE_MIN_BYTES must be a power of 2");
+
+static inline size_t class_bytes(int cls)
+{
+	return SYS_HEAP_CACHE_MIN_BYTES << cls;
+}
+
+/* Smallest class that fits a request, or -1 if none does */
+static int size_class(size_t bytes)
+{
+	if (bytes == 0U || bytes > SYS_HEAP_CACHE_MAX_BYTES) {
+		return -1;
+	}
+
+	if (bytes <= SYS_HEAP_CACHE_MIN_BYTES) {
+		return 0;
+	}
+
+	return 32 - __builtin_clz(bytes - 1) - MIN_SHIFT;
+}
+
+/* Class of an allocated block, or -1 if it has no class size.  The
+ * heap rounds the blocks up to its chunk unit, a block of a class has
+ * at most CHUNK_UNIT - 1 extra bytes besides the reserve.
+ */
+static int block_class(struct sys_heap_cache *cache, size_t usable)
+{
+	size_t bytes;
+	int cls;
+
+	if (usable < cache->reserve) {
+		return -1;
+	}
+
+	bytes = (usable - cache->reserve) & ~(size_t)(CHUNK_UNIT - 1U);
+	cls = size_class(bytes);
+
+	if (cls < 0 || class_bytes(cls) != bytes) {
+		return -1;
+	}
+
+	return cls;
+}
+
+/* Must be called with interrupts locked, so that we stay on this CPU */
+static inline struct sys_heap_cache_mag *cpu_mag(struct sys_heap_cache *cache,
+						 int cls)
+{
+#if CONFIG_MP_NUM_CPUS > 1
+	return &cache->mags[arch_curr_cpu()->id][cls];
+#else
+	return &cache->mags[0][cls];
+#endif
+}
+
+void sys_heap_cache_init(struct sys_heap_cache *cache, struct sys_heap *heap,
+			 const struct sys_heap_cache_ops *ops, void *backend,
+			 size_t align)
+{
+	__ASSERT(align != 0U && (align & (align - 1)) == 0U,
+		 "align must be a power of 2");
+
+	(void)memset(cache, 0, sizeof(*cache));
+
+	cache->heap = heap;
+	cache->ops = ops;
+	cache->backend = backend;
+	cache->align = align;
+}
+
+void *sys_heap_cache_alloc(struct sys_heap_cache *cache, size_t align,
+			   size_t bytes)
+{
+	struct sys_heap_cache_mag *mag;
+	void *blocks[BATCH];
+	k_spinlock_key_t key;
+	void *mem = NULL;
+	unsigned int irq;
+	size_t n, kept;
+	int cls;
+
+	if (bytes < cache->reserve || align > cache->align) {
+		return NULL;
+	}
+
+	cls = size_class(bytes - cache->reserve);
+	if (cls < 0) {
+		return NULL;
+	}
+
+	irq = arch_irq_lock();
+	mag = cpu_mag(cache, cls);
+	key = k_spin_lock(&mag->lock);
+
+	if (mag->count) {
+		mem = mag->blocks[--mag->count];
+	}
+
+	k_spin_unlock(&mag->lock, key);
+	arch_irq_unlock(irq);
+
+	if (mem != NULL) {
+		return mem;
+	}
+
+	/* Refill with a batch taken under a single lock of the heap.  We
+	 * may have moved to another CPU meanwhile, which does no harm.
+	 */
+	n = cache->ops->alloc_bulk(cache->backend, cache->align,
+				   class_bytes(cls) + cache->reserve, blocks,
+				   BATCH);
+	if (n == 0U) {
+		return NULL;
+	}
+
+	mem = blocks[--n];
+	kept = 0U;
+
+	if (n && !atomic_get(&cache->waiters)) {
+		irq = arch_irq_lock();
+		mag = cpu_mag(cache, cls);
+		key = k_spin_lock(&mag->lock);
+
+		kept = MIN(n, MAG_SIZE - mag->count);
+		memcpy(&mag->blocks[mag->count], blocks,
+		       kept * sizeof(blocks[0]));
+		mag->count += kept;
+
+		k_spin_unlock(&mag->lock, key);
+		arch_irq_unlock(irq);
+	}
+
+	if (n > kept) {
+		cache->ops->free_bulk(cache->backend, &blocks[kept], n - kept);
+	}
+
+	return mem;
+}
+
+bool sys_heap_cache_free(struct sys_heap_cache *cache, void *mem)
+{
+	struct sys_heap_cache_mag *mag;
+	void *blocks[BATCH];
+	k_spinlock_key_t key;
+	bool drain = false;
+	unsigned int irq;
+	int cls;
+
+	if (mem == NULL || ((uintptr_t)mem & (cache->align - 1U)) != 0U ||
+	    atomic_get(&cache->waiters)) {
+		return false;
+	}
+
+	cls = block_class(cache, sys_heap_usable_size(cache->heap, mem));
+	if (cls < 0) {
+		return false;
+	}
+
+	irq = arch_irq_lock();
+	mag = cpu_mag(cache, cls);
+	key = k_spin_lock(&mag->lock);
+
+	if (mag->count == MAG_SIZE) {
+		/* Keep the recently freed, cache-hot half */
+		memcpy(blocks, mag->blocks, BATCH * sizeof(blocks[0]));
+		memmove(mag->blocks, mag->blocks + BATCH,
+			(MAG_SIZE - BATCH) * sizeof(blocks[0]));
+		mag->count -= BATCH;
+		drain = true;
+	}
+
+	mag->blocks[mag->count++] = mem;
+
+	k_spin_unlock(&mag->lock, key);
+	arch_irq_unlock(irq);
+
+	if (drain) {
+		cache->ops->free_bulk(cache->backend, blocks, BATCH);
+	}
+
+	return true;
+}
+
+void sys_heap_cache_flush(struct sys_heap_cache *cache)
+{
+	struct sys_heap_cache_mag *mag;
+	void *blocks[MAG_SIZE];
+	k_spinlock_key_t key;
+	size_t n;
+
+	for (int cpu = 0; cpu < CONFIG_MP_NUM_CPUS; cpu++) {
+		for (int cls = 0; cls < NUM_CLASSES; cls++) {
+			mag = &cache->mags[cpu][cls];
+			key = k_spin_lock(&mag->lock);
+
+			n = mag->count;
+			memcpy(blocks, mag->blocks, n * sizeof(blocks[0]));
+			mag->count = 0U;
+
+			k_spin_unlock(&mag->lock, key);
+
+			if (n) {
+				cache->ops->free_bulk(cache->backend, blocks,
+						      n);
+			}
+		}
+	}
+}
+
+size_t sys_heap_cache_count(struct sys_heap_cache *cache)
+{
+	size_t count = 0;
+
+	for (int cpu = 0; cpu < CONFIG_MP_NUM_CPUS; cpu++) {
+		for (int cls = 0; cls < NUM_CLASSES; cls++) {
+			count += cache->mags[cpu][cls].count;
+		}
+	}
+
+	return count;
+}
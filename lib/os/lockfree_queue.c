@@ -0,0 +1,269 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <sys/lockfree_queue.h>
+#include <string.h>
+
+/*
+ * The head and tail counters run freely and wrap around, only their
+ * low bits index the buffer.
+ */
+
+static void notify(struct sys_sem *sem, struct k_poll_signal *signal)
+{
+	if (sem != NULL) {
+		(void)sys_sem_give(sem);
+	}
+
+#ifdef CONFIG_POLL
+	if (signal != NULL) {
+		(void)k_poll_signal_raise(signal, 0);
+	}
+#endif
+}
+
+/* Turns a relative timeout into a deadline, kept when waiting again */
+static k_timeout_t deadline(k_timeout_t timeout)
+{
+#ifdef CONFIG_TIMEOUT_64BIT
+	if (!K_TIMEOUT_EQ(timeout, K_FOREVER) &&
+	    Z_TICK_ABS(timeout.ticks) < 0) {
+		return K_TIMEOUT_ABS_TICKS(k_uptime_ticks() + timeout.ticks);
+	}
+#endif
+
+	return timeout;
+}
+
+void spsc_queue_init(struct spsc_queue *q, void *buf, size_t item_size,
+		     uint32_t capacity)
+{
+	__ASSERT(capacity != 0U && (capacity & (capacity - 1U)) == 0U,
+		 "capacity must be a power of 2");
+
+	(void)memset(q, 0, sizeof(*q));
+
+	q->mask = capacity - 1U;
+	q->item_size = item_size;
+	q->buf = buf;
+}
+
+void spsc_queue_notify_set(struct spsc_queue *q, struct sys_sem *sem,
+			   struct k_poll_signal *signal)
+{
+	__ASSERT(IS_ENABLED(CONFIG_POLL) || signal == NULL,
+		 "poll signals need CONFIG_POLL");
+
+	q->sem = sem;
+	q->signal = signal;
+}
+
+int spsc_queue_put(struct spsc_queue *q, const void *item)
+{
+	uint32_t tail = atomic_get(&q->tail);
+	uint32_t head = atomic_get(&q->head);
+
+	if (tail - head > q->mask) {
+		return -ENOMSG;
+	}
+
+	(void)memcpy(q->buf + (tail & q->mask) * q->item_size, item,
+		     q->item_size);
+	atomic_set(&q->tail, tail + 1U);
+
+	/* Read after publishing the item: either the consumer sees it, or
+	 * we see that it has taken everything and may be waiting.
+	 */
+	if ((uint32_t)atomic_get(&q->head) == tail) {
+		notify(q->sem, q->signal);
+	}
+
+	return 0;
+}
+
+int spsc_queue_get(struct spsc_queue *q, void *item)
+{
+	uint32_t head = atomic_get(&q->head);
+
+	if ((uint32_t)atomic_get(&q->tail) == head) {
+		return -ENOMSG;
+	}
+
+	(void)memcpy(item, q->buf + (head & q->mask) * q->item_size,
+		     q->item_size);
+	atomic_set(&q->head, head + 1U);
+
+	return 0;
+}
+
+int spsc_queue_get_wait(struct spsc_queue *q, void *item,
+			k_timeout_t timeout)
+{
+	__ASSERT(q->sem != NULL, "no semaphore to wait on");
+
+	if (spsc_queue_get(q, item) == 0) {
+		return 0;
+	}
+
+	if (K_TIMEOUT_EQ(timeout, K_NO_WAIT)) {
+		return -ENOMSG;
+	}
+
+	timeout = deadline(timeout);
+
+	/* The semaphore may be left given by an item already taken */
+	do {
+		if (sys_sem_take(q->sem, timeout) != 0) {
+			return -EAGAIN;
+		}
+	} while (spsc_queue_get(q, item) != 0);
+
+	return 0;
+}
+
+/*
+ * Each cell has a sequence number telling whose turn it is: it is pos
+ * when the cell is free for the item pos, and pos + 1 once that item is
+ * in, until it is taken.
+ */
+
+static inline size_t cell_size(struct mpmc_queue *q)
+{
+	return ROUND_UP(sizeof(atomic_t) + q->item_size, sizeof(atomic_t));
+}
+
+static inline atomic_t *cell_seq(struct mpmc_queue *q, uint32_t pos)
+{
+	return (atomic_t *)(q->buf + (pos & q->mask) * cell_size(q));
+}
+
+void mpmc_queue_init(struct mpmc_queue *q, void *buf, size_t item_size,
+		     uint32_t capacity)
+{
+	__ASSERT(capacity != 0U && (capacity & (capacity - 1U)) == 0U,
+		 "capacity must be a power of 2");
+	__ASSERT(((uintptr_t)buf & (sizeof(atomic_t) - 1U)) == 0U,
+		 "buffer must be aligned like atomic_t");
+
+	(void)memset(q, 0, sizeof(*q));
+
+	q->mask = capacity - 1U;
+	q->item_size = item_size;
+	q->buf = buf;
+
+	for (uint32_t pos = 0U; pos < capacity; pos++) {
+		atomic_set(cell_seq(q, pos), pos);
+	}
+}
+
+void mpmc_queue_notify_set(struct mpmc_queue *q, struct sys_sem *sem,
+			   struct k_poll_signal *signal)
+{
+	__ASSERT(IS_ENABLED(CONFIG_POLL) || signal == NULL,
+		 "poll signals need CONFIG_POLL");
+
+	q->sem = sem;
+	q->signal = signal;
+}
+
+int mpmc_queue_put(struct mpmc_queue *q, const void *item)
+{
+	uint32_t pos = atomic_get(&q->tail);
+	atomic_t *seq;
+	int32_t dif;
+
+	for (;;) {
+		seq = cell_seq(q, pos);
+		dif = (int32_t)((uint32_t)atomic_get(seq) - pos);
+
+		if (dif == 0) {
+			if (atomic_cas(&q->tail, pos, pos + 1U)) {
+				break;
+			}
+		} else if (dif < 0) {
+			/* the cell still holds the item of the previous lap */
+			return -ENOMSG;
+		}
+
+		pos = atomic_get(&q->tail);
+	}
+
+	(void)memcpy(seq + 1, item, q->item_size);
+	atomic_set(seq, pos + 1U);
+
+	/* Consumers only wait on the cell at the head, see spsc_queue_put() */
+	if ((uint32_t)atomic_get(&q->head) == pos) {
+		notify(q->sem, q->signal);
+	}
+
+	return 0;
+}
+
+int mpmc_queue_get(struct mpmc_queue *q, void *item)
+{
+	uint32_t pos = atomic_get(&q->head);
+	atomic_t *seq;
+	int32_t dif;
+
+	for (;;) {
+		seq = cell_seq(q, pos);
+		dif = (int32_t)((uint32_t)atomic_get(seq) - (pos + 1U));
+
+		if (dif == 0) {
+			if (atomic_cas(&q->head, pos, pos + 1U)) {
+				break;
+			}
+		} else if (dif < 0) {
+			/* the item of the cell isn't in yet */
+			return -ENOMSG;
+		}
+
+		pos = atomic_get(&q->head);
+	}
+
+	(void)memcpy(item, seq + 1, q->item_size);
+	atomic_set(seq, pos + q->mask + 1U);
+
+	return 0;
+}
+
+static bool mpmc_queue_ready(struct mpmc_queue *q)
+{
+	uint32_t pos = atomic_get(&q->head);
+
+	return (uint32_t)atomic_get(cell_seq(q, pos)) == pos + 1U;
+}
+
+int mpmc_queue_get_wait(struct mpmc_queue *q, void *item,
+			k_timeout_t timeout)
+{
+	__ASSERT(q->sem != NULL, "no semaphore to wait on");
+
+	if (mpmc_queue_get(q, item) == 0) {
+		return 0;
+	}
+
+	if (K_TIMEOUT_EQ(timeout, K_NO_WAIT)) {
+		return -ENOMSG;
+	}
+
+	timeout = deadline(timeout);
+
+	do {
+		if (sys_sem_take(q->sem, timeout) != 0) {
+			return -EAGAIN;
+		}
+	} while (mpmc_queue_get(q, item) != 0);
+
+	/* Producers only give the semaphore for the first item, wake up
+	 * the next consumer for the ones left.
+	 */
+	if (mpmc_queue_ready(q)) {
+		(void)sys_sem_give(q->sem);
+	}
+
+	return 0;
+}
@@ -221,23 +221,14 @@ static void data_unref(struct net_buf *buf, uint8_t *data)
 	pool->alloc->cb->unref(buf, data);
 }
 
-#if defined(CONFIG_NET_BUF_LOG)
-struct net_buf *net_buf_alloc_len_debug(struct net_buf_pool *pool, size_t size,
-					k_timeout_t timeout, const char *func,
-					int line)
-#else
-struct net_buf *net_buf_alloc_len(struct net_buf_pool *pool, size_t size,
-				  k_timeout_t timeout)
-#endif
+/* Take a free buffer from the pool itself */
+static struct net_buf *pool_get(struct net_buf_pool *pool,
+				k_timeout_t timeout, const char *func,
+				int line)
 {
-	uint64_t end = sys_clock_timeout_end_calc(timeout);
 	struct net_buf *buf;
 	unsigned int key;
 
-	__ASSERT_NO_MSG(pool);
-
-	NET_BUF_DBG("%s():%d: pool %p size %zu", func, line, pool, size);
-
 	/* We need to lock interrupts temporarily to prevent race conditions
 	 * when accessing pool->uninit_count.
 	 */
@@ -257,15 +248,14 @@ struct net_buf *net_buf_alloc_len(struct net_buf_pool *pool, size_t size,
 			buf = k_lifo_get(&pool->free, K_NO_WAIT);
 			if (buf) {
 				irq_unlock(key);
-				goto success;
+				return buf;
 			}
 		}
 
 		uninit_count = pool->uninit_count--;
 		irq_unlock(key);
 
-		buf = pool_get_uninit(pool, uninit_count);
-		goto success;
+		return pool_get_uninit(pool, uninit_count);
 	}
 
 	irq_unlock(key);
@@ -299,12 +289,109 @@ struct net_buf *net_buf_alloc_len(struct net_buf_pool *pool, size_t size,
 #else
 	buf = k_lifo_get(&pool->free, timeout);
 #endif
+
+	return buf;
+}
+
+#if defined(CONFIG_NET_BUF_CPU_CACHE)
+static size_t pool_cache_get_bulk(void *backend, void **objs, size_t count)
+{
+	struct net_buf_pool *pool = backend;
+	struct net_buf *buf;
+	unsigned int key;
+	size_t n;
+
+	key = irq_lock();
+
+	for (n = 0; n < count; n++) {
+		buf = NULL;
+
+		if (pool->uninit_count < pool->buf_count) {
+			buf = k_lifo_get(&pool->free, K_NO_WAIT);
+		}
+
+		if (!buf && pool->uninit_count) {
+			buf = pool_get_uninit(pool, pool->uninit_count--);
+		}
+
+		if (!buf) {
+			break;
+		}
+
+		objs[n] = buf;
+	}
+
+	irq_unlock(key);
+
+	return n;
+}
+
+static void *pool_cache_get(void *backend, k_timeout_t timeout)
+{
+	return pool_get(backend, timeout, __func__, __LINE__);
+}
+
+static void pool_cache_put_bulk(void *backend, void **objs, size_t count)
+{
+	struct net_buf_pool *pool = backend;
+	struct net_buf *buf;
+	size_t i;
+
+	/* Chain the buffers through their node to queue them in one go */
+	for (i = 0; i < count; i++) {
+		buf = objs[i];
+		buf->node.next = (i + 1 < count) ? objs[i + 1] : NULL;
+	}
+
+	(void)k_queue_append_list(&pool->free._queue, objs[0],
+				  objs[count - 1]);
+}
+
+const struct net_buf_cache_ops net_buf_pool_cache_ops = {
+	.get_bulk = pool_cache_get_bulk,
+	.get = pool_cache_get,
+	.put_bulk = pool_cache_put_bulk,
+};
+#endif /* CONFIG_NET_BUF_CPU_CACHE */
+
+static struct net_buf *buf_get(struct net_buf_pool *pool, k_timeout_t timeout,
+			       const char *func, int line)
+{
+#if defined(CONFIG_NET_BUF_CPU_CACHE)
+	if (pool->cache) {
+		return net_buf_cache_get(pool->cache, timeout);
+	}
+#endif
+
+	return pool_get(pool, timeout, func, line);
+}
+
+#if defined(CONFIG_NET_BUF_LOG)
+struct net_buf *net_buf_alloc_len_debug(struct net_buf_pool *pool, size_t size,
+					k_timeout_t timeout, const char *func,
+					int line)
+#else
+struct net_buf *net_buf_alloc_len(struct net_buf_pool *pool, size_t size,
+				  k_timeout_t timeout)
+#endif
+{
+	uint64_t end = sys_clock_timeout_end_calc(timeout);
+	struct net_buf *buf;
+
+	__ASSERT_NO_MSG(pool);
+
+	NET_BUF_DBG("%s():%d: pool %p size %zu", func, line, pool, size);
+
+#if defined(CONFIG_NET_BUF_LOG)
+	buf = buf_get(pool, timeout, func, line);
+#else
+	buf = buf_get(pool, timeout, __func__, __LINE__);
+#endif
 	if (!buf) {
 		NET_BUF_ERR("%s():%d: Failed to get free buffer", func, line);
 		return NULL;
 	}
 
-success:
 	NET_BUF_DBG("allocated buf %p", buf);
 
 	if (size) {
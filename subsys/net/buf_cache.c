@@ -0,0 +1,157 @@
+/* buf_cache.c - Per-CPU caches of free network buffers */
+
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <kernel.h>
+#include <string.h>
+#include <net/buf.h>
+
+#define MAG_SIZE CONFIG_NET_BUF_CPU_CACHE_SIZE
+
+/* Objects moved between a magazine and the backing allocator at once */
+#define BATCH (MAG_SIZE / 2)
+
+/* Must be called with interrupts locked, so that we stay on this CPU */
+static inline struct net_buf_cache_mag *cpu_mag(struct net_buf_cache *cache)
+{
+#if CONFIG_MP_NUM_CPUS > 1
+	return &cache->mags[arch_curr_cpu()->id];
+#else
+	return &cache->mags[0];
+#endif
+}
+
+void net_buf_cache_flush(struct net_buf_cache *cache)
+{
+	struct net_buf_cache_mag *mag;
+	k_spinlock_key_t key;
+	int i;
+
+	for (i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		mag = &cache->mags[i];
+		key = k_spin_lock(&mag->lock);
+
+		if (mag->count) {
+			cache->ops->put_bulk(cache->backend, mag->objs,
+					     mag->count);
+			mag->count = 0U;
+		}
+
+		k_spin_unlock(&mag->lock, key);
+	}
+}
+
+void *net_buf_cache_get(struct net_buf_cache *cache, k_timeout_t timeout)
+{
+	struct net_buf_cache_mag *mag;
+	k_spinlock_key_t key;
+	unsigned int irq;
+	void *obj = NULL;
+
+	irq = arch_irq_lock();
+	mag = cpu_mag(cache);
+	key = k_spin_lock(&mag->lock);
+
+	if (mag->count) {
+#if defined(CONFIG_NET_BUF_POOL_USAGE)
+		mag->hits++;
+#endif
+	} else {
+#if defined(CONFIG_NET_BUF_POOL_USAGE)
+		mag->misses++;
+#endif
+		mag->count = cache->ops->get_bulk(cache->backend, mag->objs,
+						  BATCH);
+	}
+
+	if (mag->count) {
+		obj = mag->objs[--mag->count];
+	}
+
+	k_spin_unlock(&mag->lock, key);
+	arch_irq_unlock(irq);
+
+	if (obj) {
+		return obj;
+	}
+
+	/* The free objects, if any, sit in the magazines of the other
+	 * CPUs. A waiter is announced before draining them, so that no
+	 * object is cached again until it has been served.
+	 */
+	if (!K_TIMEOUT_EQ(timeout, K_NO_WAIT)) {
+		atomic_inc(&cache->waiters);
+	}
+
+	net_buf_cache_flush(cache);
+	obj = cache->ops->get(cache->backend, timeout);
+
+	if (!K_TIMEOUT_EQ(timeout, K_NO_WAIT)) {
+		atomic_dec(&cache->waiters);
+	}
+
+	return obj;
+}
+
+void net_buf_cache_put(struct net_buf_cache *cache, void *obj)
+{
+	struct net_buf_cache_mag *mag;
+	k_spinlock_key_t key;
+	unsigned int irq;
+
+	irq = arch_irq_lock();
+	mag = cpu_mag(cache);
+	key = k_spin_lock(&mag->lock);
+
+	if (!atomic_get(&cache->waiters)) {
+		if (mag->count == MAG_SIZE) {
+			/* Keep the recently freed, cache-hot half */
+			cache->ops->put_bulk(cache->backend, mag->objs, BATCH);
+			memmove(mag->objs, mag->objs + BATCH,
+				(MAG_SIZE - BATCH) * sizeof(mag->objs[0]));
+			mag->count -= BATCH;
+		}
+
+		mag->objs[mag->count++] = obj;
+		obj = NULL;
+	}
+
+	k_spin_unlock(&mag->lock, key);
+	arch_irq_unlock(irq);
+
+	if (obj) {
+		cache->ops->put_bulk(cache->backend, &obj, 1);
+	}
+}
+
+size_t net_buf_cache_count(struct net_buf_cache *cache)
+{
+	size_t count = 0;
+	int i;
+
+	for (i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		count += cache->mags[i].count;
+	}
+
+	return count;
+}
+
+#if defined(CONFIG_NET_BUF_POOL_USAGE)
+void net_buf_cache_stats(struct net_buf_cache *cache, uint32_t *hits,
+			 uint32_t *misses)
+{
+	int i;
+
+	*hits = 0U;
+	*misses = 0U;
+
+	for (i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		*hits += cache->mags[i].hits;
+		*misses += cache->mags[i].misses;
+	}
+}
+#endif /* CONFIG_NET_BUF_POOL_USAGE */
@@ -54,10 +54,24 @@ LOG_MODULE_REGISTER(net_conn, CONFIG_NET_CONN_LOG_LEVEL);
 
 #define NET_CONN_RANK(_flags)		(_flags & 0x78)
 
+/* Used connections are kept in one of several lists, so that a unicast
+ * UDP/TCP packet only needs to look at the few connections that can
+ * possibly match it:
+ *  - fully specified 4-tuples, hashed by net_conn_hash()
+ *  - IP connections with a local port, hashed by that port
+ *  - everything else (wildcard port, packet and CAN sockets)
+ */
+#define CONN_HASH_SIZE			CONFIG_NET_CONN_HASH_SIZE
+#define CONN_LIST_OTHER			0
+#define CONN_LIST_LISTEN(_port)		(1 + (_port) % CONN_HASH_SIZE)
+#define CONN_LIST_TUPLE(_hash)		(1 + CONN_HASH_SIZE + \
+					 (_hash) % CONN_HASH_SIZE)
+#define CONN_LIST_COUNT			(1 + 2 * CONN_HASH_SIZE)
+
 static struct net_conn conns[CONFIG_NET_MAX_CONN];
 
 static sys_slist_t conn_unused;
-static sys_slist_t conn_used;
+static sys_slist_t conn_used[CONN_LIST_COUNT];
 
 #if (CONFIG_NET_CONN_LOG_LEVEL >= LOG_LEVEL_DBG)
 static inline
@@ -127,11 +141,70 @@ static struct net_conn *conn_get_unused(void)
 	return CONTAINER_OF(node, struct net_conn, node);
 }
 
+static bool conn_addr_is_spec(const struct sockaddr *addr)
+{
+	if (IS_ENABLED(CONFIG_NET_IPV6) && addr->sa_family == AF_INET6) {
+		return !net_ipv6_is_addr_unspecified(
+					&net_sin6(addr)->sin6_addr);
+	} else if (IS_ENABLED(CONFIG_NET_IPV4) && addr->sa_family == AF_INET) {
+		return net_sin(addr)->sin_addr.s_addr != 0U;
+	}
+
+	return false;
+}
+
+static const void *conn_ip_addr(const struct sockaddr *addr)
+{
+	if (IS_ENABLED(CONFIG_NET_IPV6) && addr->sa_family == AF_INET6) {
+		return &net_sin6(addr)->sin6_addr;
+	}
+
+	return &net_sin(addr)->sin_addr;
+}
+
+/* Which of the conn_used lists holds a connection with these parameters */
+static int conn_list_index(uint8_t family,
+			   const struct sockaddr *remote_addr,
+			   const struct sockaddr *local_addr,
+			   uint16_t remote_port,
+			   uint16_t local_port)
+{
+	if ((family != AF_INET && family != AF_INET6) || !local_port) {
+		return CONN_LIST_OTHER;
+	}
+
+	if (remote_addr && local_addr && remote_port &&
+	    remote_addr->sa_family == family &&
+	    conn_addr_is_spec(remote_addr) && conn_addr_is_spec(local_addr)) {
+		return CONN_LIST_TUPLE(net_conn_hash(family,
+						     conn_ip_addr(remote_addr),
+						     htons(remote_port),
+						     htons(local_port)));
+	}
+
+	return CONN_LIST_LISTEN(local_port);
+}
+
+static sys_slist_t *conn_list_get(struct net_conn *conn)
+{
+	int idx;
+
+	idx = conn_list_index(conn->family,
+			      (conn->flags & NET_CONN_REMOTE_ADDR_SET) ?
+						&conn->remote_addr : NULL,
+			      (conn->flags & NET_CONN_LOCAL_ADDR_SET) ?
+						&conn->local_addr : NULL,
+			      ntohs(net_sin(&conn->remote_addr)->sin_port),
+			      ntohs(net_sin(&conn->local_addr)->sin_port));
+
+	return &conn_used[idx];
+}
+
 static void conn_set_used(struct net_conn *conn)
 {
 	conn->flags |= NET_CONN_IN_USE;
 
-	sys_slist_prepend(&conn_used, &conn->node);
+	sys_slist_prepend(conn_list_get(conn), &conn->node);
 }
 
 static void conn_set_unused(struct net_conn *conn)
@@ -150,8 +223,13 @@ static struct net_conn *conn_find_handler(uint16_t proto, uint8_t family,
 {
 	struct net_conn *conn;
 	struct net_conn *tmp;
+	sys_slist_t *list;
+
+	/* An identical handler can only be in the list we would use */
+	list = &conn_used[conn_list_index(family, remote_addr, local_addr,
+					  remote_port, local_port)];
 
-	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&conn_used, conn, tmp, node) {
+	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(list, conn, tmp, node) {
 		if (conn->proto != proto) {
 			continue;
 		}
@@ -379,7 +457,7 @@ int net_conn_unregister(struct net_conn_handle *handle)
 
 	NET_DBG("Connection handler %p removed", conn);
 
-	sys_slist_find_and_remove(&conn_used, &conn->node);
+	sys_slist_find_and_remove(conn_list_get(conn), &conn->node);
 
 	conn_set_unused(conn);
 
@@ -546,6 +624,50 @@ static enum net_verdict conn_raw_socket(struct net_pkt *pkt,
 	return NET_CONTINUE;
 }
 
+/* Find the connection owning the 4-tuple of a unicast UDP/TCP packet */
+static struct net_conn *conn_lookup_tuple(struct net_pkt *pkt,
+					  union net_ip_header *ip_hdr,
+					  uint8_t proto,
+					  uint16_t src_port,
+					  uint16_t dst_port)
+{
+	const void *src_addr;
+	struct net_conn *conn;
+	uint32_t hash;
+
+	if (IS_ENABLED(CONFIG_NET_IPV6) && net_pkt_family(pkt) == AF_INET6) {
+		src_addr = &ip_hdr->ipv6->src;
+	} else {
+		src_addr = &ip_hdr->ipv4->src;
+	}
+
+	hash = net_conn_hash(net_pkt_family(pkt), src_addr, src_port,
+			     dst_port);
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&conn_used[CONN_LIST_TUPLE(hash)],
+				     conn, node) {
+		if (conn->proto != proto ||
+		    conn->family != net_pkt_family(pkt) ||
+		    net_sin(&conn->remote_addr)->sin_port != src_port ||
+		    net_sin(&conn->local_addr)->sin_port != dst_port) {
+			continue;
+		}
+
+		if (conn->context != NULL &&
+		    net_context_is_bound_to_iface(conn->context) &&
+		    net_pkt_iface(pkt) != net_context_get_iface(conn->context)) {
+			continue;
+		}
+
+		if (conn_addr_cmp(pkt, ip_hdr, &conn->remote_addr, true) &&
+		    conn_addr_cmp(pkt, ip_hdr, &conn->local_addr, false)) {
+			return conn;
+		}
+	}
+
+	return NULL;
+}
+
 enum net_verdict net_conn_input(struct net_pkt *pkt,
 				union net_ip_header *ip_hdr,
 				uint8_t proto,
@@ -562,6 +684,8 @@ enum net_verdict net_conn_input(struct net_pkt *pkt,
 	enum net_verdict ret;
 	uint16_t src_port;
 	uint16_t dst_port;
+	int lists[2];
+	int nlists;
 
 	if (IS_ENABLED(CONFIG_NET_UDP) && proto == IPPROTO_UDP) {
 		src_port = proto_hdr->udp->src_port;
@@ -623,155 +747,180 @@ enum net_verdict net_conn_input(struct net_pkt *pkt,
 		}
 	}
 
-	SYS_SLIST_FOR_EACH_CONTAINER(&conn_used, conn, node) {
-		if (conn->context != NULL &&
-		    net_context_is_bound_to_iface(conn->context) &&
-		    net_pkt_iface(pkt) != net_context_get_iface(conn->context)) {
-			continue;
-		}
+	/* A unicast UDP/TCP packet can only match its own 4-tuple, or
+	 * failing that a connection listening on its destination port or
+	 * one without a local port. Everything else needs to look at all
+	 * the connections.
+	 */
+	if ((IS_ENABLED(CONFIG_NET_UDP) || IS_ENABLED(CONFIG_NET_TCP)) &&
+	    (proto == IPPROTO_UDP || proto == IPPROTO_TCP) &&
+	    (net_pkt_family(pkt) == AF_INET ||
+	     net_pkt_family(pkt) == AF_INET6) &&
+	    !is_mcast_pkt && !is_bcast_pkt) {
+		best_match = conn_lookup_tuple(pkt, ip_hdr, proto,
+					       src_port, dst_port);
+
+		lists[0] = CONN_LIST_LISTEN(ntohs(dst_port));
+		lists[1] = CONN_LIST_OTHER;
+		nlists = best_match ? 0 : 2;
+	} else {
+		nlists = CONN_LIST_COUNT;
+	}
 
-		/* For packet socket data, the proto is set to ETH_P_ALL or IPPROTO_RAW
-		 * but the listener might have a specific protocol set. This is ok
-		 * and let the packet pass this check in this case.
-		 */
-		if (IS_ENABLED(CONFIG_NET_SOCKETS_PACKET_DGRAM) ||
-		    IS_ENABLED(CONFIG_NET_SOCKETS_PACKET)) {
-			if ((conn->proto != proto) && (proto != ETH_P_ALL) &&
-				(proto != IPPROTO_RAW)) {
-				continue;
-			}
-		} else {
-			if ((conn->proto != proto)) {
+	for (int i = 0; i < nlists; i++) {
+		sys_slist_t *list = &conn_used[nlists < CONN_LIST_COUNT ?
+					       lists[i] : i];
+
+		SYS_SLIST_FOR_EACH_CONTAINER(list, conn, node) {
+			if (conn->context != NULL &&
+			    net_context_is_bound_to_iface(conn->context) &&
+			    net_pkt_iface(pkt) != net_context_get_iface(conn->context)) {
 				continue;
 			}
-		}
 
-		if (conn->family != AF_UNSPEC &&
-		    conn->family != net_pkt_family(pkt)) {
-			/* If there are other listening connections than
-			 * AF_PACKET, the packet shall be also passed back to
-			 * net_conn_input() in IPv4/6 processing in order to
-			 * re-check if there is any listening socket interested
-			 * in this packet.
+			/* For packet socket data, the proto is set to ETH_P_ALL or IPPROTO_RAW
+			 * but the listener might have a specific protocol set. This is ok
+			 * and let the packet pass this check in this case.
 			 */
-			if (IS_ENABLED(CONFIG_NET_SOCKETS_PACKET) &&
-			    conn->family != AF_PACKET) {
-				raw_pkt_continue = true;
-			}
-
-			continue;
-		}
-
-		/* The code below shall be only executed when one enters
-		 * the net_conn_input() from net_packet_socket() which
-		 * is executed for e.g. AF_PACKET && SOCK_RAW
-		 *
-		 * Here we do need to check if we have ANY connection which
-		 * was setup with AF_PACKET
-		 */
-		if (IS_ENABLED(CONFIG_NET_SOCKETS_PACKET) &&
-		    conn->family == AF_PACKET) {
-			if (proto == ETH_P_ALL) {
-				/* We shall continue with ETH_P_ALL to IPPROTO_RAW: */
-				raw_pkt_continue = true;
+			if (IS_ENABLED(CONFIG_NET_SOCKETS_PACKET_DGRAM) ||
+			    IS_ENABLED(CONFIG_NET_SOCKETS_PACKET)) {
+				if ((conn->proto != proto) && (proto != ETH_P_ALL) &&
+					(proto != IPPROTO_RAW)) {
+					continue;
+				}
+			} else {
+				if ((conn->proto != proto)) {
+					continue;
+				}
 			}
 
-			/* With IPPROTO_RAW deliver only if protocol match: */
-			if ((proto == ETH_P_ALL && conn->proto != IPPROTO_RAW) ||
-			    conn->proto == proto) {
-				ret = conn_raw_socket(pkt, conn, proto);
-				if (ret == NET_DROP) {
-					goto drop;
-				} else if (ret == NET_OK) {
-					raw_pkt_delivered = true;
+			if (conn->family != AF_UNSPEC &&
+			    conn->family != net_pkt_family(pkt)) {
+				/* If there are other listening connections than
+				 * AF_PACKET, the packet shall be also passed back to
+				 * net_conn_input() in IPv4/6 processing in order to
+				 * re-check if there is any listening socket interested
+				 * in this packet.
+				 */
+				if (IS_ENABLED(CONFIG_NET_SOCKETS_PACKET) &&
+				    conn->family != AF_PACKET) {
+					raw_pkt_continue = true;
 				}
 
 				continue;
 			}
-		}
 
-		if (IS_ENABLED(CONFIG_NET_UDP) ||
-		    IS_ENABLED(CONFIG_NET_TCP)) {
-			if (net_sin(&conn->remote_addr)->sin_port) {
-				if (net_sin(&conn->remote_addr)->sin_port !=
-				    src_port) {
-					continue;
+			/* The code below shall be only executed when one enters
+			 * the net_conn_input() from net_packet_socket() which
+			 * is executed for e.g. AF_PACKET && SOCK_RAW
+			 *
+			 * Here we do need to check if we have ANY connection which
+			 * was setup with AF_PACKET
+			 */
+			if (IS_ENABLED(CONFIG_NET_SOCKETS_PACKET) &&
+			    conn->family == AF_PACKET) {
+				if (proto == ETH_P_ALL) {
+					/* We shall continue with ETH_P_ALL to IPPROTO_RAW: */
+					raw_pkt_continue = true;
 				}
-			}
 
-			if (net_sin(&conn->local_addr)->sin_port) {
-				if (net_sin(&conn->local_addr)->sin_port !=
-				    dst_port) {
-					continue;
-				}
-			}
+				/* With IPPROTO_RAW deliver only if protocol match: */
+				if ((proto == ETH_P_ALL && conn->proto != IPPROTO_RAW) ||
+				    conn->proto == proto) {
+					ret = conn_raw_socket(pkt, conn, proto);
+					if (ret == NET_DROP) {
+						goto drop;
+					} else if (ret == NET_OK) {
+						raw_pkt_delivered = true;
+					}
 
-			if (conn->flags & NET_CONN_REMOTE_ADDR_SET) {
-				if (!conn_addr_cmp(pkt, ip_hdr,
-						   &conn->remote_addr,
-						   true)) {
 					continue;
 				}
 			}
 
-			if (conn->flags & NET_CONN_LOCAL_ADDR_SET) {
-				if (!conn_addr_cmp(pkt, ip_hdr,
-						   &conn->local_addr,
-						   false)) {
-					continue;
+			if (IS_ENABLED(CONFIG_NET_UDP) ||
+			    IS_ENABLED(CONFIG_NET_TCP)) {
+				if (net_sin(&conn->remote_addr)->sin_port) {
+					if (net_sin(&conn->remote_addr)->sin_port !=
+					    src_port) {
+						continue;
+					}
 				}
-			}
-
-			/* If we have an existing best_match, and that one
-			 * specifies a remote port, then we've matched to a
-			 * LISTENING connection that should not override.
-			 */
-			if (best_match != NULL &&
-			    best_match->flags & NET_CONN_REMOTE_PORT_SPEC) {
-				continue;
-			}
 
-			if (best_rank < NET_CONN_RANK(conn->flags)) {
-				struct net_pkt *mcast_pkt;
+				if (net_sin(&conn->local_addr)->sin_port) {
+					if (net_sin(&conn->local_addr)->sin_port !=
+					    dst_port) {
+						continue;
+					}
+				}
 
-				if (!is_mcast_pkt) {
-					best_rank = NET_CONN_RANK(conn->flags);
-					best_match = conn;
+				if (conn->flags & NET_CONN_REMOTE_ADDR_SET) {
+					if (!conn_addr_cmp(pkt, ip_hdr,
+							   &conn->remote_addr,
+							   true)) {
+						continue;
+					}
+				}
 
-					continue;
+				if (conn->flags & NET_CONN_LOCAL_ADDR_SET) {
+					if (!conn_addr_cmp(pkt, ip_hdr,
+							   &conn->local_addr,
+							   false)) {
+						continue;
+					}
 				}
 
-				/* If we have a multicast packet, and we found
-				 * a match, then deliver the packet immediately
-				 * to the handler. As there might be several
-				 * sockets interested about these, we need to
-				 * clone the received pkt.
+				/* If we have an existing best_match, and that one
+				 * specifies a remote port, then we've matched to a
+				 * LISTENING connection that should not override.
 				 */
-
-				NET_DBG("[%p] mcast match found cb %p ud %p",
-					conn, conn->cb,	conn->user_data);
-
-				mcast_pkt = net_pkt_clone(pkt, CLONE_TIMEOUT);
-				if (!mcast_pkt) {
-					goto drop;
+				if (best_match != NULL &&
+				    best_match->flags & NET_CONN_REMOTE_PORT_SPEC) {
+					continue;
 				}
 
-				if (conn->cb(conn, mcast_pkt, ip_hdr,
-					     proto_hdr, conn->user_data) ==
-								NET_DROP) {
-					net_stats_update_per_proto_drop(
+				if (best_rank < NET_CONN_RANK(conn->flags)) {
+					struct net_pkt *mcast_pkt;
+
+					if (!is_mcast_pkt) {
+						best_rank = NET_CONN_RANK(conn->flags);
+						best_match = conn;
+
+						continue;
+					}
+
+					/* If we have a multicast packet, and we found
+					 * a match, then deliver the packet immediately
+					 * to the handler. As there might be several
+					 * sockets interested about these, we need to
+					 * clone the received pkt.
+					 */
+
+					NET_DBG("[%p] mcast match found cb %p ud %p",
+						conn, conn->cb,	conn->user_data);
+
+					mcast_pkt = net_pkt_clone(pkt, CLONE_TIMEOUT);
+					if (!mcast_pkt) {
+						goto drop;
+					}
+
+					if (conn->cb(conn, mcast_pkt, ip_hdr,
+						     proto_hdr, conn->user_data) ==
+									NET_DROP) {
+						net_stats_update_per_proto_drop(
+								pkt_iface, proto);
+						net_pkt_unref(mcast_pkt);
+					} else {
+						net_stats_update_per_proto_recv(
 							pkt_iface, proto);
-					net_pkt_unref(mcast_pkt);
-				} else {
-					net_stats_update_per_proto_recv(
-						pkt_iface, proto);
-				}
+					}
 
-				mcast_pkt_delivered = true;
+					mcast_pkt_delivered = true;
+				}
+			} else if (IS_ENABLED(CONFIG_NET_SOCKETS_CAN)) {
+				best_rank = 0;
+				best_match = conn;
 			}
-		} else if (IS_ENABLED(CONFIG_NET_SOCKETS_CAN)) {
-			best_rank = 0;
-			best_match = conn;
 		}
 	}
 
@@ -842,8 +991,10 @@ void net_conn_foreach(net_conn_foreach_cb_t cb, void *user_data)
 {
 	struct net_conn *conn;
 
-	SYS_SLIST_FOR_EACH_CONTAINER(&conn_used, conn, node) {
-		cb(conn, user_data);
+	for (int i = 0; i < CONN_LIST_COUNT; i++) {
+		SYS_SLIST_FOR_EACH_CONTAINER(&conn_used[i], conn, node) {
+			cb(conn, user_data);
+		}
 	}
 }
 
@@ -852,7 +1003,10 @@ void net_conn_init(void)
 	int i;
 
 	sys_slist_init(&conn_unused);
-	sys_slist_init(&conn_used);
+
+	for (i = 0; i < CONN_LIST_COUNT; i++) {
+		sys_slist_init(&conn_used[i]);
+	}
 
 	for (i = 0; i < CONFIG_NET_MAX_CONN; i++) {
 		sys_slist_prepend(&conn_unused, &conns[i].node);
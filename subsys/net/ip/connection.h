@@ -78,6 +78,33 @@ struct net_conn {
 	uint8_t flags;
 };
 
+/**
+ * @brief Hash a connection 4-tuple for the connection lookup tables.
+ *
+ * Only the remote address is hashed, the local address is usually one of
+ * a handful of interface addresses and adds little entropy.
+ *
+ * @param family Protocol family (AF_INET or AF_INET6)
+ * @param remote_addr Remote struct in_addr or struct in6_addr
+ * @param remote_port Remote port in network byte order
+ * @param local_port Local port in network byte order
+ *
+ * @return Hash value of the tuple.
+ */
+static inline uint32_t net_conn_hash(uint8_t family, const void *remote_addr,
+				     uint16_t remote_port, uint16_t local_port)
+{
+	const uint32_t *addr = remote_addr;
+	uint32_t hash = ((uint32_t)remote_port << 16) | local_port;
+	int words = family == AF_INET6 ? 4 : 1;
+
+	for (int i = 0; i < words; i++) {
+		hash = (hash ^ addr[i]) * 0x9e3779b1U;
+	}
+
+	return hash ^ (hash >> 16);
+}
+
 /**
  * @brief Register a callback to be called when UDP/TCP packet
  * is received corresponding to received packet.
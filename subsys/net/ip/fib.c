@@ -0,0 +1,300 @@
+/** @file
+ * @brief Longest prefix match table used by the routing tables.
+ *
+ * The prefixes are kept in a path compressed binary trie, so a lookup
+ * visits at most one node per distinct prefix length on the path to the
+ * destination instead of every route.
+ */
+
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <kernel.h>
+#include <string.h>
+#include <errno.h>
+
+#include <net/net_core.h>
+
+#include "fib.h"
+
+static inline uint8_t addr_bit(const uint8_t *addr, uint8_t bit)
+{
+	return (addr[bit / 8U] >> (7U - bit % 8U)) & 1U;
+}
+
+/* Number of leading bits that are the same in a and b, at most len */
+static uint8_t common_len(const uint8_t *a, const uint8_t *b, uint8_t len)
+{
+	uint8_t bits = 0U;
+	uint8_t diff;
+	int i;
+
+	for (i = 0; bits < len; i++, bits += 8U) {
+		diff = a[i] ^ b[i];
+		if (diff) {
+			bits += __builtin_clz(diff) - 24;
+			break;
+		}
+	}
+
+	return MIN(bits, len);
+}
+
+static inline bool node_matches(struct net_fib_node *node,
+				const uint8_t *addr)
+{
+	return common_len(node->prefix, addr, node->prefix_len) ==
+		node->prefix_len;
+}
+
+static struct net_fib_node *node_alloc(struct net_fib *fib,
+				       const uint8_t *prefix,
+				       uint8_t prefix_len,
+				       struct net_fib_node *parent)
+{
+	struct net_fib_node *node;
+	uint8_t bytes = (prefix_len + 7U) / 8U;
+
+	if (fib->free) {
+		node = fib->free;
+		fib->free = node->child[0];
+	} else if (fib->node_used < fib->node_count) {
+		node = &fib->nodes[fib->node_used++];
+	} else {
+		return NULL;
+	}
+
+	(void)memset(node, 0, sizeof(*node));
+
+	memcpy(node->prefix, prefix, bytes);
+	if (prefix_len % 8U) {
+		node->prefix[bytes - 1] &= 0xff << (8U - prefix_len % 8U);
+	}
+
+	node->prefix_len = prefix_len;
+	node->parent = parent;
+
+	return node;
+}
+
+static void node_free(struct net_fib *fib, struct net_fib_node *node)
+{
+	node->child[0] = fib->free;
+	fib->free = node;
+}
+
+static inline struct net_fib_node **node_link(struct net_fib *fib,
+					      struct net_fib_node *node)
+{
+	struct net_fib_node *parent = node->parent;
+
+	if (!parent) {
+		return &fib->root;
+	}
+
+	return &parent->child[parent->child[1] == node];
+}
+
+static void cache_flush(struct net_fib *fib)
+{
+#if CONFIG_NET_ROUTE_CACHE_SIZE > 0
+	int i;
+
+	for (i = 0; i < CONFIG_NET_ROUTE_CACHE_SIZE; i++) {
+		fib->cache[i].valid = false;
+	}
+#endif
+}
+
+int net_fib_insert(struct net_fib *fib, const uint8_t *prefix,
+		   uint8_t prefix_len, sys_snode_t *route)
+{
+	struct net_fib_node **link = &fib->root;
+	struct net_fib_node *parent = NULL;
+	struct net_fib_node *node, *new, *glue;
+	uint8_t common = 0U;
+
+	NET_ASSERT(prefix_len <= fib->addr_len * 8U);
+
+	while ((node = *link) != NULL) {
+		common = common_len(node->prefix, prefix,
+				    MIN(node->prefix_len, prefix_len));
+		if (common < node->prefix_len) {
+			break;
+		}
+
+		if (node->prefix_len == prefix_len) {
+			goto add;
+		}
+
+		parent = node;
+		link = &node->child[addr_bit(prefix, node->prefix_len)];
+	}
+
+	new = node_alloc(fib, prefix, prefix_len, parent);
+	if (!new) {
+		return -ENOMEM;
+	}
+
+	if (!node) {
+		/* Empty slot below the longest matching prefix */
+		*link = new;
+	} else if (common == prefix_len) {
+		/* The new prefix is a part of the prefix of node */
+		new->child[addr_bit(node->prefix, prefix_len)] = node;
+		node->parent = new;
+		*link = new;
+	} else {
+		/* The prefixes diverge, join them under a common node */
+		glue = node_alloc(fib, prefix, common, parent);
+		if (!glue) {
+			node_free(fib, new);
+			return -ENOMEM;
+		}
+
+		glue->child[addr_bit(prefix, common)] = new;
+		glue->child[addr_bit(node->prefix, common)] = node;
+		new->parent = glue;
+		node->parent = glue;
+		*link = glue;
+	}
+
+	node = new;
+
+add:
+	sys_slist_append(&node->routes, route);
+	cache_flush(fib);
+
+	return 0;
+}
+
+/* Drop the nodes that are no longer needed after a route was removed */
+static void prune(struct net_fib *fib, struct net_fib_node *node)
+{
+	struct net_fib_node *parent, *child;
+
+	while (node && sys_slist_is_empty(&node->routes) &&
+	       !(node->child[0] && node->child[1])) {
+		parent = node->parent;
+		child = node->child[0] ? node->child[0] : node->child[1];
+
+		*node_link(fib, node) = child;
+		if (child) {
+			child->parent = parent;
+		}
+
+		node_free(fib, node);
+		node = parent;
+	}
+}
+
+int net_fib_remove(struct net_fib *fib, const uint8_t *prefix,
+		   uint8_t prefix_len, sys_snode_t *route)
+{
+	struct net_fib_node *node;
+
+	node = net_fib_get(fib, prefix, prefix_len);
+	if (!node || !sys_slist_find_and_remove(&node->routes, route)) {
+		return -ENOENT;
+	}
+
+	prune(fib, node);
+	cache_flush(fib);
+
+	return 0;
+}
+
+struct net_fib_node *net_fib_get(struct net_fib *fib, const uint8_t *prefix,
+				 uint8_t prefix_len)
+{
+	struct net_fib_node *node = fib->root;
+
+	while (node && node->prefix_len <= prefix_len &&
+	       node_matches(node, prefix)) {
+		if (node->prefix_len == prefix_len) {
+			return sys_slist_is_empty(&node->routes) ?
+				NULL : node;
+		}
+
+		node = node->child[addr_bit(prefix, node->prefix_len)];
+	}
+
+	return NULL;
+}
+
+struct net_fib_node *net_fib_match(struct net_fib *fib, const uint8_t *addr)
+{
+	struct net_fib_node *node = fib->root;
+	struct net_fib_node *found = NULL;
+	uint8_t max_len = fib->addr_len * 8U;
+
+	while (node && node_matches(node, addr)) {
+		if (!sys_slist_is_empty(&node->routes)) {
+			found = node;
+		}
+
+		if (node->prefix_len == max_len) {
+			break;
+		}
+
+		node = node->child[addr_bit(addr, node->prefix_len)];
+	}
+
+	return found;
+}
+
+struct net_fib_node *net_fib_match_next(struct net_fib_node *node)
+{
+	/* The prefixes of the parents are parts of the prefix of the node,
+	 * so they match the address too.
+	 */
+	do {
+		node = node->parent;
+	} while (node && sys_slist_is_empty(&node->routes));
+
+	return node;
+}
+
+#if CONFIG_NET_ROUTE_CACHE_SIZE > 0
+static struct net_fib_cache_entry *cache_entry(struct net_fib *fib,
+					       const uint8_t *addr)
+{
+	uint32_t hash = 2166136261U;
+	int i;
+
+	for (i = 0; i < fib->addr_len; i++) {
+		hash = (hash ^ addr[i]) * 16777619U;
+	}
+
+	return &fib->cache[hash % CONFIG_NET_ROUTE_CACHE_SIZE];
+}
+
+bool net_fib_cache_get(struct net_fib *fib, struct net_if *iface,
+		       const uint8_t *addr, sys_snode_t **route)
+{
+	struct net_fib_cache_entry *entry = cache_entry(fib, addr);
+
+	if (!entry->valid || entry->iface != iface ||
+	    memcmp(entry->addr, addr, fib->addr_len)) {
+		return false;
+	}
+
+	*route = entry->route;
+
+	return true;
+}
+
+void net_fib_cache_set(struct net_fib *fib, struct net_if *iface,
+		       const uint8_t *addr, sys_snode_t *route)
+{
+	struct net_fib_cache_entry *entry = cache_entry(fib, addr);
+
+	memcpy(entry->addr, addr, fib->addr_len);
+	entry->iface = iface;
+	entry->route = route;
+	entry->valid = true;
+}
+#endif /* CONFIG_NET_ROUTE_CACHE_SIZE > 0 */
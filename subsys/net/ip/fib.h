@@ -0,0 +1,231 @@
+/** @file
+ * @brief Longest prefix match table used by the routing tables
+ *
+ * This is not to be included by the application.
+ */
+
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __FIB_H
+#define __FIB_H
+
+#include <kernel.h>
+#include <sys/slist.h>
+
+#include <net/net_ip.h>
+#include <net/net_if.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Longest address (IPv6) that can be stored */
+#define NET_FIB_ADDR_LEN_MAX sizeof(struct in6_addr)
+
+/**
+ * @brief Node of the prefix trie.
+ *
+ * The prefix of a node extends the prefix of its parent. The next bit
+ * of the address after the prefix selects the child. A node without
+ * routes is only kept if it has two children.
+ */
+struct net_fib_node {
+	/** Parent node, NULL for the root */
+	struct net_fib_node *parent;
+
+	/** Children, also used to link the free nodes */
+	struct net_fib_node *child[2];
+
+	/** Routes for this prefix, one per network interface */
+	sys_slist_t routes;
+
+	/** Prefix, the bits after prefix_len are zero */
+	uint8_t prefix[NET_FIB_ADDR_LEN_MAX];
+
+	/** Prefix length in bits */
+	uint8_t prefix_len;
+};
+
+/**
+ * @brief Entry of the lookup cache.
+ */
+struct net_fib_cache_entry {
+	/** Interface given to the lookup, can be NULL */
+	struct net_if *iface;
+
+	/** Result of the lookup, can be NULL */
+	sys_snode_t *route;
+
+	/** Destination address */
+	uint8_t addr[NET_FIB_ADDR_LEN_MAX];
+
+	/** Is this entry in use */
+	bool valid;
+};
+
+/**
+ * @brief Prefix trie with a small cache of recent lookups.
+ *
+ * The routes are linked to the trie through a sys_snode_t. The functions
+ * do not lock, the routing table that owns the trie must serialize the
+ * calls.
+ */
+struct net_fib {
+	/** Root of the trie */
+	struct net_fib_node *root;
+
+	/** Nodes that have been used and released */
+	struct net_fib_node *free;
+
+	/** Node storage */
+	struct net_fib_node *nodes;
+
+	/** Number of nodes in the storage */
+	uint16_t node_count;
+
+	/** Number of nodes taken from the storage so far */
+	uint16_t node_used;
+
+	/** Address length in bytes */
+	uint8_t addr_len;
+
+#if CONFIG_NET_ROUTE_CACHE_SIZE > 0
+	/** Lookup results by destination address */
+	struct net_fib_cache_entry cache[CONFIG_NET_ROUTE_CACHE_SIZE];
+#endif
+};
+
+/**
+ * @brief Statically define a prefix trie.
+ *
+ * A trie with n prefixes needs at most 2 * n - 1 nodes.
+ *
+ * @param _name Name of the trie variable.
+ * @param _addr_len Address length in bytes.
+ * @param _max_routes Maximum number of different prefixes.
+ */
+#define NET_FIB_DEFINE(_name, _addr_len, _max_routes)			\
+	static struct net_fib_node _name##_nodes[2 * (_max_routes)];	\
+	static struct net_fib _name = {					\
+		.nodes = _name##_nodes,					\
+		.node_count = ARRAY_SIZE(_name##_nodes),		\
+		.addr_len = (_addr_len),				\
+	}
+
+/**
+ * @brief Add a route to the trie.
+ *
+ * @param fib Prefix trie.
+ * @param prefix Address of the route.
+ * @param prefix_len Prefix length in bits.
+ * @param route Node of the route.
+ *
+ * @return 0 if ok, -ENOMEM if the trie is full.
+ */
+int net_fib_insert(struct net_fib *fib, const uint8_t *prefix,
+		   uint8_t prefix_len, sys_snode_t *route);
+
+/**
+ * @brief Remove a route from the trie.
+ *
+ * @param fib Prefix trie.
+ * @param prefix Address of the route.
+ * @param prefix_len Prefix length in bits.
+ * @param route Node of the route.
+ *
+ * @return 0 if ok, -ENOENT if the route is not in the trie.
+ */
+int net_fib_remove(struct net_fib *fib, const uint8_t *prefix,
+		   uint8_t prefix_len, sys_snode_t *route);
+
+/**
+ * @brief Get the node of an exact prefix.
+ *
+ * @param fib Prefix trie.
+ * @param prefix Address of the prefix.
+ * @param prefix_len Prefix length in bits.
+ *
+ * @return Node of the prefix, NULL if it has no routes.
+ */
+struct net_fib_node *net_fib_get(struct net_fib *fib, const uint8_t *prefix,
+				 uint8_t prefix_len);
+
+/**
+ * @brief Find the longest prefix that matches an address.
+ *
+ * @param fib Prefix trie.
+ * @param addr Address to look for.
+ *
+ * @return Node of the longest matching prefix that has routes, NULL if
+ * there is none.
+ */
+struct net_fib_node *net_fib_match(struct net_fib *fib, const uint8_t *addr);
+
+/**
+ * @brief Continue a lookup with the next shorter matching prefix.
+ *
+ * @param node Node returned by net_fib_match() or net_fib_match_next().
+ *
+ * @return Node of the next shorter prefix that has routes, NULL if
+ * there is none.
+ */
+struct net_fib_node *net_fib_match_next(struct net_fib_node *node);
+
+#if CONFIG_NET_ROUTE_CACHE_SIZE > 0
+/**
+ * @brief Get a cached lookup result.
+ *
+ * @param fib Prefix trie.
+ * @param iface Interface given to the lookup.
+ * @param addr Destination address.
+ * @param route Cached result, can be NULL.
+ *
+ * @return True if the result was in the cache.
+ */
+bool net_fib_cache_get(struct net_fib *fib, struct net_if *iface,
+		       const uint8_t *addr, sys_snode_t **route);
+
+/**
+ * @brief Cache a lookup result. The cache is flushed whenever a route is
+ * added or removed.
+ *
+ * @param fib Prefix trie.
+ * @param iface Interface given to the lookup.
+ * @param addr Destination address.
+ * @param route Result of the lookup, can be NULL.
+ */
+void net_fib_cache_set(struct net_fib *fib, struct net_if *iface,
+		       const uint8_t *addr, sys_snode_t *route);
+#else
+static inline bool net_fib_cache_get(struct net_fib *fib,
+				     struct net_if *iface,
+				     const uint8_t *addr, sys_snode_t **route)
+{
+	ARG_UNUSED(fib);
+	ARG_UNUSED(iface);
+	ARG_UNUSED(addr);
+	ARG_UNUSED(route);
+
+	return false;
+}
+
+static inline void net_fib_cache_set(struct net_fib *fib,
+				     struct net_if *iface,
+				     const uint8_t *addr, sys_snode_t *route)
+{
+	ARG_UNUSED(fib);
+	ARG_UNUSED(iface);
+	ARG_UNUSED(addr);
+	ARG_UNUSED(route);
+}
+#endif /* CONFIG_NET_ROUTE_CACHE_SIZE > 0 */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FIB_H */
@@ -281,7 +281,7 @@ enum net_verdict net_ipv4_input(struct net_pkt *pkt)
 		goto drop;
 	}
 
-	if (net_if_need_calc_rx_checksum(net_pkt_iface(pkt)) &&
+	if (net_pkt_need_calc_rx_checksum(pkt) &&
 	    net_calc_chksum_ipv4(pkt) != 0U) {
 		NET_DBG("DROP: invalid chksum");
 		goto drop;
@@ -319,6 +319,17 @@ enum net_verdict net_ipv4_input(struct net_pkt *pkt)
 		log_strdup(net_sprint_ipv4_addr(&hdr->src)),
 		log_strdup(net_sprint_ipv4_addr(&hdr->dst)));
 
+	/* Without reassembly the fragments are handled as whole packets */
+	if (IS_ENABLED(CONFIG_NET_IPV4_FRAGMENT) &&
+	    ((hdr->offset[0] & ((NET_IPV4_MF << 5) | 0x1f)) ||
+	     hdr->offset[1])) {
+		verdict = net_ipv4_handle_fragment_hdr(pkt, hdr);
+		if (verdict == NET_DROP) {
+			goto drop;
+		}
+		return verdict;
+	}
+
 	switch (hdr->proto) {
 	case IPPROTO_ICMP:
 		verdict = net_icmpv4_input(pkt, hdr);
@@ -364,6 +375,10 @@ enum net_verdict net_ipv4_input(struct net_pkt *pkt)
 
 	ip.ipv4 = hdr;
 
+	if (hdr->proto == IPPROTO_TCP && net_tcp_gro_receive(pkt)) {
+		return NET_OK;
+	}
+
 	verdict = net_conn_input(pkt, &ip, hdr->proto, &proto_hdr);
 	if (verdict != NET_DROP) {
 		return verdict;
@@ -183,4 +183,55 @@ static inline int net_ipv4_parse_hdr_options(struct net_pkt *pkt,
 }
 #endif
 
+struct net_reass;
+
+/**
+ * @typedef net_ipv4_frag_cb_t
+ * @brief Callback used while iterating over pending IPv4 fragments.
+ *
+ * @param reass IPv4 fragment reassembly, see reassembly.h
+ * @param user_data A valid pointer on some user data or NULL
+ */
+typedef void (*net_ipv4_frag_cb_t)(struct net_reass *reass,
+				   void *user_data);
+
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+/**
+ * @brief Handles an IPv4 fragment.
+ *
+ * The cursor of the packet must be after the IPv4 header options.
+ *
+ * @param pkt Network packet
+ * @param hdr IPv4 header of the packet
+ *
+ * @return NET_OK if the fragment was taken, NET_DROP otherwise.
+ */
+enum net_verdict net_ipv4_handle_fragment_hdr(struct net_pkt *pkt,
+					      struct net_ipv4_hdr *hdr);
+
+/**
+ * @brief Go through all the currently pending IPv4 fragments.
+ *
+ * @param cb Callback to call for each pending IPv4 fragment.
+ * @param user_data User specified data or NULL.
+ */
+void net_ipv4_frag_foreach(net_ipv4_frag_cb_t cb, void *user_data);
+#else
+static inline enum net_verdict
+net_ipv4_handle_fragment_hdr(struct net_pkt *pkt, struct net_ipv4_hdr *hdr)
+{
+	ARG_UNUSED(pkt);
+	ARG_UNUSED(hdr);
+
+	return NET_DROP;
+}
+
+static inline void net_ipv4_frag_foreach(net_ipv4_frag_cb_t cb,
+					 void *user_data)
+{
+	ARG_UNUSED(cb);
+	ARG_UNUSED(user_data);
+}
+#endif
+
 #endif /* __IPV4_H */
@@ -0,0 +1,142 @@
+/** @file
+ * @brief IPv4 Fragment related functions
+ */
+
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_ipv4, CONFIG_NET_IPV4_LOG_LEVEL);
+
+#include <errno.h>
+#include <net/net_core.h>
+#include <net/net_pkt.h>
+#include <net/net_stats.h>
+#include "net_private.h"
+#include "ipv4.h"
+#include "reassembly.h"
+
+/* Fragment offset and more fragments bits in the first byte of the
+ * offset field of the header.
+ */
+#define IPV4_OFFSET_MASK 0x1f
+#define IPV4_MF_MASK (NET_IPV4_MF << 5)
+
+static void reassemble_packet(struct net_pkt *pkt)
+{
+	NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access, struct net_ipv4_hdr);
+	struct net_ipv4_hdr *hdr;
+	uint16_t old_val, new_val;
+
+	net_pkt_cursor_init(pkt);
+
+	hdr = (struct net_ipv4_hdr *)net_pkt_get_data(pkt, &ipv4_access);
+	if (!hdr) {
+		goto error;
+	}
+
+	/* The first fragment becomes a whole packet: fix its length and
+	 * clear the fragment bits but the don't fragment one.
+	 */
+	old_val = hdr->len;
+	hdr->len = htons(net_pkt_get_len(pkt));
+	hdr->chksum = net_calc_chksum_update16(hdr->chksum, old_val, hdr->len);
+
+	old_val = UNALIGNED_GET((uint16_t *)hdr->offset);
+	hdr->offset[0] &= ~(IPV4_MF_MASK | IPV4_OFFSET_MASK);
+	hdr->offset[1] = 0U;
+	new_val = UNALIGNED_GET((uint16_t *)hdr->offset);
+	hdr->chksum = net_calc_chksum_update16(hdr->chksum, old_val, new_val);
+
+	net_pkt_set_data(pkt, &ipv4_access);
+
+	NET_DBG("New pkt %p IPv4 len is %zd bytes", pkt, net_pkt_get_len(pkt));
+
+	/* The checksums of the first fragment do not cover the datagram */
+	net_pkt_set_chksum_done(pkt, false);
+
+	/* Feed the packet back through the RX queue so that we do not run
+	 * out of stack. It has no link layer header, process_data() must
+	 * not pass it to L2.
+	 */
+	net_pkt_set_ip_reassembled(pkt, true);
+
+	if (net_recv_data(net_pkt_iface(pkt), pkt) >= 0) {
+		return;
+	}
+error:
+	net_pkt_unref(pkt);
+}
+
+struct frag_foreach_data {
+	net_ipv4_frag_cb_t cb;
+	void *user_data;
+};
+
+static void frag_foreach_cb(struct net_reass *reass, void *user_data)
+{
+	struct frag_foreach_data *data = user_data;
+
+	data->cb(reass, data->user_data);
+}
+
+void net_ipv4_frag_foreach(net_ipv4_frag_cb_t cb, void *user_data)
+{
+	struct frag_foreach_data data = {
+		.cb = cb,
+		.user_data = user_data,
+	};
+
+	net_reass_foreach(AF_INET, frag_foreach_cb, &data);
+}
+
+enum net_verdict net_ipv4_handle_fragment_hdr(struct net_pkt *pkt,
+					      struct net_ipv4_hdr *hdr)
+{
+	struct net_reass_key key = { 0 };
+	struct net_pkt *done;
+	uint16_t hdr_len;
+	uint16_t offset;
+	bool more;
+	int ret;
+
+	key.src.family = AF_INET;
+	key.dst.family = AF_INET;
+	net_ipaddr_copy(&key.src.in_addr, &hdr->src);
+	net_ipaddr_copy(&key.dst.in_addr, &hdr->dst);
+	key.id = (hdr->id[0] << 8) | hdr->id[1];
+	key.proto = hdr->proto;
+
+	more = !!(hdr->offset[0] & IPV4_MF_MASK);
+	offset = (((hdr->offset[0] & IPV4_OFFSET_MASK) << 8) |
+		  hdr->offset[1]) * 8U;
+
+	hdr_len = net_pkt_ip_hdr_len(pkt) + net_pkt_ipv4_opts_len(pkt);
+
+	if (more && (net_pkt_get_len(pkt) - hdr_len) % 8) {
+		NET_DBG("DROP: fragment length not multiple of 8");
+		return NET_DROP;
+	}
+
+	NET_DBG("IPv4 fragment id 0x%x offset %u %s", key.id, offset,
+		more ? "more" : "last");
+
+	ret = net_reass_add(&key,
+			    CONFIG_NET_IPV4_FRAGMENT_TIMEOUT * MSEC_PER_SEC,
+			    pkt, hdr_len, offset, more, &done);
+	if (ret < 0) {
+		NET_DBG("Cannot reassemble id 0x%x (%d), dropping pkt %p",
+			key.id, ret, pkt);
+		return NET_DROP;
+	}
+
+	if (ret > 0) {
+		/* The last fragment received, reassemble the packet */
+		reassemble_packet(done);
+	}
+
+	return NET_OK;
+}
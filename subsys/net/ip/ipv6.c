@@ -279,6 +279,15 @@ static enum net_verdict ipv6_route_packet(struct net_pkt *pkt,
 	struct net_route_entry *route;
 	struct in6_addr *nexthop;
 	bool found;
+	int ret;
+
+	ret = net_route_flow_packet(pkt, &hdr->src, &hdr->dst);
+	if (ret == 0) {
+		return NET_OK;
+	} else if (ret != -ENOENT) {
+		NET_DBG("Cannot forward pkt %p (%d)", pkt, ret);
+		goto drop;
+	}
 
 	/* Check if the packet can be routed */
 	if (IS_ENABLED(CONFIG_NET_ROUTING)) {
@@ -290,8 +299,6 @@ static enum net_verdict ipv6_route_packet(struct net_pkt *pkt,
 	}
 
 	if (found) {
-		int ret;
-
 		if (IS_ENABLED(CONFIG_NET_ROUTING) &&
 		    (net_ipv6_is_ll_addr(&hdr->src) ||
 		     net_ipv6_is_ll_addr(&hdr->dst))) {
@@ -322,6 +329,10 @@ static enum net_verdict ipv6_route_packet(struct net_pkt *pkt,
 			add_route(net_pkt_orig_iface(pkt), &hdr->src, 128);
 		}
 
+		/* The header is not available once the packet is sent */
+		net_route_flow_add(net_pkt_orig_iface(pkt), &hdr->src,
+				   &hdr->dst, nexthop);
+
 		ret = net_route_packet(pkt, nexthop);
 		if (ret < 0) {
 			NET_DBG("Cannot re-route pkt %p via %s "
@@ -333,7 +344,6 @@ static enum net_verdict ipv6_route_packet(struct net_pkt *pkt,
 		}
 	} else {
 		struct net_if *iface = NULL;
-		int ret;
 
 		if (net_if_ipv6_addr_onlink(&iface, &hdr->dst)) {
 			ret = net_route_packet_if(pkt, iface);
@@ -651,6 +661,10 @@ enum net_verdict net_ipv6_input(struct net_pkt *pkt, bool is_loopback)
 
 	ip.ipv6 = hdr;
 
+	if (nexthdr == IPPROTO_TCP && net_tcp_gro_receive(pkt)) {
+		return NET_OK;
+	}
+
 	verdict = net_conn_input(pkt, &ip, nexthdr, &proto_hdr);
 	if (verdict != NET_DROP) {
 		return verdict;
@@ -80,6 +80,9 @@ const char *net_ipv6_nbr_state2str(enum net_ipv6_nbr_state state);
  * @brief IPv6 neighbor information.
  */
 struct net_ipv6_nbr_data {
+	/** Link in the hash bucket of the IPv6 address. */
+	sys_snode_t node;
+
 	/** Any pending packet waiting ND to finish. */
 	struct net_pkt *pending;
 
@@ -384,43 +387,16 @@ static inline void net_ipv6_nbr_set_reachable_timer(struct net_if *iface,
 }
 #endif
 
-/* We do not have to accept larger than 1500 byte IPv6 packet (RFC 2460 ch 5).
- * This means that we should receive everything within first two fragments.
- * The first one being 1280 bytes and the second one 220 bytes.
- */
-#if !defined(NET_IPV6_FRAGMENTS_MAX_PKT)
-#define NET_IPV6_FRAGMENTS_MAX_PKT 2
-#endif
-
-/** Store pending IPv6 fragment information that is needed for reassembly. */
-struct net_ipv6_reassembly {
-	/** IPv6 source address of the fragment */
-	struct in6_addr src;
-
-	/** IPv6 destination address of the fragment */
-	struct in6_addr dst;
-
-	/**
-	 * Timeout for cancelling the reassembly. The timer is used
-	 * also to detect if this reassembly slot is used or not.
-	 */
-	struct k_delayed_work timer;
-
-	/** Pointers to pending fragments */
-	struct net_pkt *pkt[NET_IPV6_FRAGMENTS_MAX_PKT];
-
-	/** IPv6 fragment identification */
-	uint32_t id;
-};
+struct net_reass;
 
 /**
  * @typedef net_ipv6_frag_cb_t
  * @brief Callback used while iterating over pending IPv6 fragments.
  *
- * @param reass IPv6 fragment reassembly struct
+ * @param reass IPv6 fragment reassembly, see reassembly.h
  * @param user_data A valid pointer on some user data or NULL
  */
-typedef void (*net_ipv6_frag_cb_t)(struct net_ipv6_reassembly *reass,
+typedef void (*net_ipv6_frag_cb_t)(struct net_reass *reass,
 				   void *user_data);
 
 /**
@@ -28,24 +28,13 @@ LOG_MODULE_DECLARE(net_ipv6, CONFIG_NET_IPV6_LOG_LEVEL);
 #include "6lo.h"
 #include "route.h"
 #include "net_stats.h"
+#include "reassembly.h"
 
 /* Timeout for various buffer allocations in this file. */
 #define NET_BUF_TIMEOUT K_MSEC(50)
 
-#if defined(CONFIG_NET_IPV6_FRAGMENT_TIMEOUT)
-#define IPV6_REASSEMBLY_TIMEOUT K_SECONDS(CONFIG_NET_IPV6_FRAGMENT_TIMEOUT)
-#else
-#define IPV6_REASSEMBLY_TIMEOUT K_SECONDS(5)
-#endif /* CONFIG_NET_IPV6_FRAGMENT_TIMEOUT */
-
 #define FRAG_BUF_WAIT K_MSEC(10) /* how long to max wait for a buffer */
 
-static void reassembly_timeout(struct k_work *work);
-static bool reassembly_init_done;
-
-static struct net_ipv6_reassembly
-reassembly[CONFIG_NET_IPV6_FRAGMENT_MAX_COUNT];
-
 int net_ipv6_find_last_ext_hdr(struct net_pkt *pkt, uint16_t *next_hdr_off,
 			       uint16_t *last_hdr_off)
 {
@@ -121,110 +110,7 @@ fail:
 	return -EINVAL;
 }
 
-static struct net_ipv6_reassembly *reassembly_get(uint32_t id,
-						  struct in6_addr *src,
-						  struct in6_addr *dst)
-{
-	int i, avail = -1;
-
-	for (i = 0; i < CONFIG_NET_IPV6_FRAGMENT_MAX_COUNT; i++) {
-
-		if (k_delayed_work_remaining_get(&reassembly[i].timer) &&
-		    reassembly[i].id == id &&
-		    net_ipv6_addr_cmp(src, &reassembly[i].src) &&
-		    net_ipv6_addr_cmp(dst, &reassembly[i].dst)) {
-			return &reassembly[i];
-		}
-
-		if (k_delayed_work_remaining_get(&reassembly[i].timer)) {
-			continue;
-		}
-
-		if (avail < 0) {
-			avail = i;
-		}
-	}
-
-	if (avail < 0) {
-		return NULL;
-	}
-
-	k_delayed_work_submit(&reassembly[avail].timer,
-			      IPV6_REASSEMBLY_TIMEOUT);
-
-	net_ipaddr_copy(&reassembly[avail].src, src);
-	net_ipaddr_copy(&reassembly[avail].dst, dst);
-
-	reassembly[avail].id = id;
-
-	return &reassembly[avail];
-}
-
-static bool reassembly_cancel(uint32_t id,
-			      struct in6_addr *src,
-			      struct in6_addr *dst)
-{
-	int i, j;
-
-	NET_DBG("Cancel 0x%x", id);
-
-	for (i = 0; i < CONFIG_NET_IPV6_FRAGMENT_MAX_COUNT; i++) {
-		int32_t remaining;
-
-		if (reassembly[i].id != id ||
-		    !net_ipv6_addr_cmp(src, &reassembly[i].src) ||
-		    !net_ipv6_addr_cmp(dst, &reassembly[i].dst)) {
-			continue;
-		}
-
-		remaining = k_delayed_work_remaining_get(&reassembly[i].timer);
-		if (remaining) {
-			k_delayed_work_cancel(&reassembly[i].timer);
-		}
-
-		NET_DBG("IPv6 reassembly id 0x%x remaining %d ms",
-			reassembly[i].id, remaining);
-
-		reassembly[i].id = 0U;
-
-		for (j = 0; j < NET_IPV6_FRAGMENTS_MAX_PKT; j++) {
-			if (!reassembly[i].pkt[j]) {
-				continue;
-			}
-
-			NET_DBG("[%d] IPv6 reassembly pkt %p %zd bytes data",
-				j, reassembly[i].pkt[j],
-				net_pkt_get_len(reassembly[i].pkt[j]));
-
-			net_pkt_unref(reassembly[i].pkt[j]);
-			reassembly[i].pkt[j] = NULL;
-		}
-
-		return true;
-	}
-
-	return false;
-}
-
-static void reassembly_info(char *str, struct net_ipv6_reassembly *reass)
-{
-	NET_DBG("%s id 0x%x src %s dst %s remain %d ms", str, reass->id,
-		log_strdup(net_sprint_ipv6_addr(&reass->src)),
-		log_strdup(net_sprint_ipv6_addr(&reass->dst)),
-		k_delayed_work_remaining_get(&reass->timer));
-}
-
-static void reassembly_timeout(struct k_work *work)
-{
-	struct net_ipv6_reassembly *reass =
-		CONTAINER_OF(work, struct net_ipv6_reassembly, timer);
-
-	reassembly_info("Reassembly cancelled", reass);
-
-	reassembly_cancel(reass->id, &reass->src, &reass->dst);
-}
-
-static void reassemble_packet(struct net_ipv6_reassembly *reass)
+static void reassemble_packet(struct net_pkt *pkt)
 {
 	NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv6_access, struct net_ipv6_hdr);
 	NET_PKT_DATA_ACCESS_DEFINE(frag_access, struct net_ipv6_frag_hdr);
@@ -233,57 +119,12 @@ static void reassemble_packet(struct net_ipv6_reassembly *reass)
 		struct net_ipv6_frag_hdr *frag_hdr;
 	} ipv6;
 
-	struct net_pkt *pkt;
-	struct net_buf *last;
 	uint8_t next_hdr;
-	int i, len;
-
-	k_delayed_work_cancel(&reass->timer);
-
-	NET_ASSERT(reass->pkt[0]);
-
-	last = net_buf_frag_last(reass->pkt[0]->buffer);
-
-	/* We start from 2nd packet which is then appended to
-	 * the first one.
-	 */
-	for (i = 1; i < NET_IPV6_FRAGMENTS_MAX_PKT; i++) {
-		int removed_len;
-
-		pkt = reass->pkt[i];
-
-		net_pkt_cursor_init(pkt);
-
-		/* Get rid of IPv6 and fragment header which are at
-		 * the beginning of the fragment.
-		 */
-		removed_len = net_pkt_ipv6_fragment_start(pkt) +
-			      sizeof(struct net_ipv6_frag_hdr);
-
-		NET_DBG("Removing %d bytes from start of pkt %p",
-			removed_len, pkt->buffer);
-
-		if (net_pkt_pull(pkt, removed_len)) {
-			NET_ERR("Failed to pull headers");
-			reassembly_cancel(reass->id, &reass->src, &reass->dst);
-			return;
-		}
-
-		/* Attach the data to previous pkt */
-		last->frags = pkt->buffer;
-		last = net_buf_frag_last(pkt->buffer);
-
-		pkt->buffer = NULL;
-		reass->pkt[i] = NULL;
+	int len;
 
-		net_pkt_unref(pkt);
-	}
-
-	pkt = reass->pkt[0];
-	reass->pkt[0] = NULL;
-
-	/* Next we need to strip away the fragment header from the first packet
-	 * and set the various pointers and values in packet.
+	/* The payload of all the fragments follows the fragment header of
+	 * the first one. Next we need to strip away that fragment header and
+	 * set the various pointers and values in packet.
 	 */
 	net_pkt_cursor_init(pkt);
 
@@ -336,12 +177,17 @@ static void reassemble_packet(struct net_ipv6_reassembly *reass)
 	NET_DBG("New pkt %p IPv6 len is %d bytes", pkt,
 		len + NET_IPV6H_LEN);
 
+	/* The checksums of the first fragment do not cover the datagram */
+	net_pkt_set_chksum_done(pkt, false);
+
 	/* We need to use the queue when feeding the packet back into the
 	 * IP stack as we might run out of stack if we call processing_data()
 	 * directly. As the packet does not contain link layer header, we
 	 * MUST NOT pass it to L2 so there will be a special check for that
 	 * in process_data() when handling the packet.
 	 */
+	net_pkt_set_ip_reassembled(pkt, true);
+
 	if (net_recv_data(net_pkt_iface(pkt), pkt) >= 0) {
 		return;
 	}
@@ -349,104 +195,38 @@ error:
 	net_pkt_unref(pkt);
 }
 
-void net_ipv6_frag_foreach(net_ipv6_frag_cb_t cb, void *user_data)
-{
-	int i;
-
-	for (i = 0; reassembly_init_done &&
-		     i < CONFIG_NET_IPV6_FRAGMENT_MAX_COUNT; i++) {
-		if (!k_delayed_work_remaining_get(&reassembly[i].timer)) {
-			continue;
-		}
-
-		cb(&reassembly[i], user_data);
-	}
-}
+struct frag_foreach_data {
+	net_ipv6_frag_cb_t cb;
+	void *user_data;
+};
 
-/* Verify that we have all the fragments received and in correct order.
- */
-static bool fragment_verify(struct net_ipv6_reassembly *reass)
+static void frag_foreach_cb(struct net_reass *reass, void *user_data)
 {
-	uint16_t offset;
-	int i, prev_len;
-
-	prev_len = net_pkt_get_len(reass->pkt[0]);
-	offset = net_pkt_ipv6_fragment_offset(reass->pkt[0]);
+	struct frag_foreach_data *data = user_data;
 
-	NET_DBG("pkt %p offset %u", reass->pkt[0], offset);
-
-	if (offset != 0U) {
-		return false;
-	}
-
-	for (i = 1; i < NET_IPV6_FRAGMENTS_MAX_PKT; i++) {
-		offset = net_pkt_ipv6_fragment_offset(reass->pkt[i]);
-
-		NET_DBG("pkt %p offset %u prev_len %d", reass->pkt[i],
-			offset, prev_len);
-
-		if (prev_len < offset) {
-			/* Something wrong with the offset value */
-			return false;
-		}
-
-		prev_len = net_pkt_get_len(reass->pkt[i]);
-	}
-
-	return true;
+	data->cb(reass, data->user_data);
 }
 
-static int shift_packets(struct net_ipv6_reassembly *reass, int pos)
+void net_ipv6_frag_foreach(net_ipv6_frag_cb_t cb, void *user_data)
 {
-	int i;
-
-	for (i = pos + 1; i < NET_IPV6_FRAGMENTS_MAX_PKT; i++) {
-		if (!reass->pkt[i]) {
-			NET_DBG("Moving [%d] %p (offset 0x%x) to [%d]",
-				pos, reass->pkt[pos],
-				net_pkt_ipv6_fragment_offset(reass->pkt[pos]),
-				i);
-
-			/* Do we have enough space in packet array to make
-			 * the move?
-			 */
-			if (((i - pos) + 1) >
-			    (NET_IPV6_FRAGMENTS_MAX_PKT - i)) {
-				return -ENOMEM;
-			}
-
-			memmove(&reass->pkt[i], &reass->pkt[pos],
-				sizeof(void *) * (i - pos));
+	struct frag_foreach_data data = {
+		.cb = cb,
+		.user_data = user_data,
+	};
 
-			return 0;
-		}
-	}
-
-	return -EINVAL;
+	net_reass_foreach(AF_INET6, frag_foreach_cb, &data);
 }
 
 enum net_verdict net_ipv6_handle_fragment_hdr(struct net_pkt *pkt,
 					      struct net_ipv6_hdr *hdr,
 					      uint8_t nexthdr)
 {
-	struct net_ipv6_reassembly *reass = NULL;
+	struct net_reass_key key = { 0 };
+	struct net_pkt *done;
+	uint16_t hdr_len;
 	uint16_t flag;
-	bool found;
 	uint8_t more;
-	uint32_t id;
-	int i;
-
-	if (!reassembly_init_done) {
-		/* Static initializing does not work here because of the array
-		 * so we must do it at runtime.
-		 */
-		for (i = 0; i < CONFIG_NET_IPV6_FRAGMENT_MAX_COUNT; i++) {
-			k_delayed_work_init(&reassembly[i].timer,
-					    reassembly_timeout);
-		}
-
-		reassembly_init_done = true;
-	}
+	int ret;
 
 	/* Each fragment has a fragment header, however since we already
 	 * read the nexthdr part of it, we are not going to use
@@ -455,110 +235,49 @@ enum net_verdict net_ipv6_handle_fragment_hdr(struct net_pkt *pkt,
 	 */
 	if (net_pkt_skip(pkt, 1) || /* reserved */
 	    net_pkt_read_be16(pkt, &flag) ||
-	    net_pkt_read_be32(pkt, &id)) {
-		goto drop;
+	    net_pkt_read_be32(pkt, &key.id)) {
+		return NET_DROP;
 	}
 
-	reass = reassembly_get(id, &hdr->src, &hdr->dst);
-	if (!reass) {
-		NET_DBG("Cannot get reassembly slot, dropping pkt %p", pkt);
-		goto drop;
-	}
+	key.src.family = AF_INET6;
+	key.dst.family = AF_INET6;
+	net_ipaddr_copy(&key.src.in6_addr, &hdr->src);
+	net_ipaddr_copy(&key.dst.in6_addr, &hdr->dst);
 
 	more = flag & 0x01;
 	net_pkt_set_ipv6_fragment_offset(pkt, flag & 0xfff8);
 
-	if (!reass->pkt[0]) {
-		NET_DBG("Storing pkt %p to slot %d offset %d",
-			pkt, 0, net_pkt_ipv6_fragment_offset(pkt));
-		reass->pkt[0] = pkt;
-
-		reassembly_info("Reassembly 1st pkt", reass);
-
-		/* Wait for more fragments to receive. */
-		goto accept;
-	}
-
-	/* The fragments might come in wrong order so place them
-	 * in reassembly chain in correct order.
-	 */
-	for (i = 0, found = false; i < NET_IPV6_FRAGMENTS_MAX_PKT; i++) {
-		if (reass->pkt[i]) {
-			if (net_pkt_ipv6_fragment_offset(reass->pkt[i]) <
-			    net_pkt_ipv6_fragment_offset(pkt)) {
-				continue;
-			}
-
-			/* Make room for this fragment. If there is no room,
-			 * then it will discard the whole reassembly.
-			 */
-			if (shift_packets(reass, i)) {
-				break;
-			}
-		}
-
-		NET_DBG("Storing pkt %p to slot %d offset %d",
-			pkt, i, net_pkt_ipv6_fragment_offset(pkt));
-		reass->pkt[i] = pkt;
-		found = true;
-
-		break;
-	}
+	hdr_len = net_pkt_ipv6_fragment_start(pkt) +
+		  sizeof(struct net_ipv6_frag_hdr);
 
-	if (!found) {
-		/* We could not add this fragment into our saved fragment
-		 * list. We must discard the whole packet at this point.
+	if (more && (net_pkt_get_len(pkt) - hdr_len) % 8) {
+		/* Fragment length is not multiple of 8, discard
+		 * the packet and send parameter problem error.
 		 */
-		NET_DBG("No slots available for 0x%x", reass->id);
-		net_pkt_unref(pkt);
-		goto drop;
+		net_icmpv6_send_error(pkt, NET_ICMPV6_PARAM_PROBLEM,
+				      NET_ICMPV6_PARAM_PROB_OPTION, 0);
+		return NET_DROP;
 	}
 
-	if (more) {
-		if (net_pkt_get_len(pkt) % 8) {
-			/* Fragment length is not multiple of 8, discard
-			 * the packet and send parameter problem error.
-			 */
-			net_icmpv6_send_error(pkt, NET_ICMPV6_PARAM_PROBLEM,
-					      NET_ICMPV6_PARAM_PROB_OPTION, 0);
-			goto drop;
-		}
-
-		reassembly_info("Reassembly nth pkt", reass);
+	NET_DBG("IPv6 fragment id 0x%x offset %u %s", key.id,
+		net_pkt_ipv6_fragment_offset(pkt), more ? "more" : "last");
 
-		NET_DBG("More fragments to be received");
-		goto accept;
+	ret = net_reass_add(&key,
+			    CONFIG_NET_IPV6_FRAGMENT_TIMEOUT * MSEC_PER_SEC,
+			    pkt, hdr_len, net_pkt_ipv6_fragment_offset(pkt),
+			    more, &done);
+	if (ret < 0) {
+		NET_DBG("Cannot reassemble id 0x%x (%d), dropping pkt %p",
+			key.id, ret, pkt);
+		return NET_DROP;
 	}
 
-	reassembly_info("Reassembly last pkt", reass);
-
-	if (!fragment_verify(reass)) {
-		NET_DBG("Reassembled IPv6 verify failed, dropping id %u",
-			reass->id);
-
-		/* Let the caller release the already inserted pkt */
-		if (i < NET_IPV6_FRAGMENTS_MAX_PKT) {
-			reass->pkt[i] = NULL;
-		}
-
-		net_pkt_unref(pkt);
-		goto drop;
+	if (ret > 0) {
+		/* The last fragment received, reassemble the packet */
+		reassemble_packet(done);
 	}
 
-	/* The last fragment received, reassemble the packet */
-	reassemble_packet(reass);
-
-accept:
 	return NET_OK;
-
-drop:
-	if (reass) {
-		if (reassembly_cancel(reass->id, &reass->src, &reass->dst)) {
-			return NET_OK;
-		}
-	}
-
-	return NET_DROP;
 }
 
 #define BUF_ALLOC_TIMEOUT K_MSEC(100)
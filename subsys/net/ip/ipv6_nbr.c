@@ -97,6 +97,21 @@ NET_NBR_TABLE_INIT(NET_NBR_GLOBAL,
 		   net_neighbor_pool,
 		   net_neighbor_table_clear);
 
+/* Neighbors are indexed by a hash of their IPv6 address, so that looking
+ * up the next hop of a packet does not depend on the number of neighbors.
+ *
+ * Lookups are done for every packet sent and do not take a lock. The
+ * buckets are only changed with nbr_hash_lock held, and nbr_hash_seq is
+ * odd while a change is in progress. As the neighbors are never freed,
+ * a lookup that raced with a change at worst walks a stale chain, and
+ * it is retried when the sequence tells so.
+ */
+#define NBR_HASH_SIZE CONFIG_NET_IPV6_MAX_NEIGHBORS
+
+static sys_slist_t nbr_hash[NBR_HASH_SIZE];
+static struct k_spinlock nbr_hash_lock;
+static atomic_t nbr_hash_seq;
+
 const char *net_ipv6_nbr_state2str(enum net_ipv6_nbr_state state)
 {
 	switch (state) {
@@ -124,17 +139,44 @@ static inline struct net_nbr *get_nbr(int idx)
 
 static inline struct net_nbr *get_nbr_from_data(struct net_ipv6_nbr_data *data)
 {
-	int i;
+	/* The data of the neighbors always starts at the __nbr storage */
+	return CONTAINER_OF((uint8_t *)data, struct net_nbr, __nbr);
+}
 
-	for (i = 0; i < CONFIG_NET_IPV6_MAX_NEIGHBORS; i++) {
-		struct net_nbr *nbr = get_nbr(i);
+static inline sys_slist_t *nbr_hash_bucket(const struct in6_addr *addr)
+{
+	uint32_t hash;
 
-		if (nbr->data == (uint8_t *)data) {
-			return nbr;
-		}
-	}
+	/* The interface identifier differs the most between neighbors */
+	hash = UNALIGNED_GET(&addr->s6_addr32[2]) ^
+	       UNALIGNED_GET(&addr->s6_addr32[3]);
+	hash *= 2654435761U;
 
-	return NULL;
+	return &nbr_hash[(hash >> 16) % NBR_HASH_SIZE];
+}
+
+static void nbr_hash_add(struct net_nbr *nbr)
+{
+	struct net_ipv6_nbr_data *data = net_ipv6_nbr_data(nbr);
+	k_spinlock_key_t key = k_spin_lock(&nbr_hash_lock);
+
+	atomic_inc(&nbr_hash_seq);
+	sys_slist_prepend(nbr_hash_bucket(&data->addr), &data->node);
+	atomic_inc(&nbr_hash_seq);
+
+	k_spin_unlock(&nbr_hash_lock, key);
+}
+
+static void nbr_hash_del(struct net_nbr *nbr)
+{
+	struct net_ipv6_nbr_data *data = net_ipv6_nbr_data(nbr);
+	k_spinlock_key_t key = k_spin_lock(&nbr_hash_lock);
+
+	atomic_inc(&nbr_hash_seq);
+	sys_slist_find_and_remove(nbr_hash_bucket(&data->addr), &data->node);
+	atomic_inc(&nbr_hash_seq);
+
+	k_spin_unlock(&nbr_hash_lock, key);
 }
 
 static void ipv6_nbr_set_state(struct net_nbr *nbr,
@@ -259,25 +301,45 @@ static struct net_nbr *nbr_lookup(struct net_nbr_table *table,
 				  struct net_if *iface,
 				  const struct in6_addr *addr)
 {
-	int i;
+	sys_slist_t *bucket = nbr_hash_bucket(addr);
+	struct net_ipv6_nbr_data *data;
+	struct net_nbr *found;
+	atomic_val_t seq;
+	int count;
 
-	for (i = 0; i < CONFIG_NET_IPV6_MAX_NEIGHBORS; i++) {
-		struct net_nbr *nbr = get_nbr(i);
+	ARG_UNUSED(table);
 
-		if (!nbr->ref) {
-			continue;
-		}
+	do {
+		seq = atomic_get(&nbr_hash_seq);
+		found = NULL;
+		count = 0;
 
-		if (iface && nbr->iface != iface) {
-			continue;
-		}
+		/* A chain being changed could loop, the sequence check
+		 * below catches that once the walk is cut.
+		 */
+		SYS_SLIST_FOR_EACH_CONTAINER(bucket, data, node) {
+			struct net_nbr *nbr = get_nbr_from_data(data);
+
+			if (++count > CONFIG_NET_IPV6_MAX_NEIGHBORS) {
+				break;
+			}
+
+			if (!nbr->ref) {
+				continue;
+			}
 
-		if (net_ipv6_addr_cmp(&net_ipv6_nbr_data(nbr)->addr, addr)) {
-			return nbr;
+			if (iface && nbr->iface != iface) {
+				continue;
+			}
+
+			if (net_ipv6_addr_cmp(&data->addr, addr)) {
+				found = nbr;
+				break;
+			}
 		}
-	}
+	} while ((seq & 1) || seq != atomic_get(&nbr_hash_seq));
 
-	return NULL;
+	return found;
 }
 
 static inline void nbr_clear_ns_pending(struct net_ipv6_nbr_data *data)
@@ -430,6 +492,7 @@ static struct net_nbr *nbr_new(struct net_if *iface,
 	}
 
 	nbr_init(nbr, iface, addr, is_router, state);
+	nbr_hash_add(nbr);
 
 	NET_DBG("nbr %p iface %p/%d state %d IPv6 %s",
 		nbr, iface, net_if_get_by_iface(iface), state,
@@ -653,7 +716,7 @@ void net_neighbor_data_remove(struct net_nbr *nbr)
 {
 	NET_DBG("Neighbor %p removed", nbr);
 
-	return;
+	nbr_hash_del(nbr);
 }
 
 void net_neighbor_table_clear(struct net_nbr_table *table)
@@ -787,9 +850,10 @@ enum net_verdict net_ipv6_prepare_for_send(struct net_pkt *pkt)
 
 #if defined(CONFIG_NET_IPV6_FRAGMENT)
 	/* If we have already fragmented the packet, the fragment id will
-	 * contain a proper value and we can skip other checks.
+	 * contain a proper value and we can skip other checks. TCP
+	 * segmentation offload packets are cut to segments at the L2.
 	 */
-	if (net_pkt_ipv6_fragment_id(pkt) == 0U) {
+	if (net_pkt_ipv6_fragment_id(pkt) == 0U && !net_pkt_gso_size(pkt)) {
 		uint16_t mtu = net_if_get_mtu(net_pkt_iface(pkt));
 		size_t pkt_len = net_pkt_get_len(pkt);
 
@@ -839,11 +903,13 @@ ignore_frag_error:
 	 * the next hop from routing table if we have multi interface routing
 	 * enabled. The reason for this is that the neighbor cache will not
 	 * contain public IPv6 address information so in that case we should
-	 * not enter this branch.
+	 * not enter this branch. A forwarded packet has already been routed
+	 * to its next hop.
 	 */
 	if ((net_pkt_lladdr_dst(pkt)->addr &&
 	     ((IS_ENABLED(CONFIG_NET_ROUTING) &&
-	      net_ipv6_is_ll_addr(&ip_hdr->dst)) ||
+	      (net_pkt_forwarding(pkt) ||
+	       net_ipv6_is_ll_addr(&ip_hdr->dst))) ||
 	      !IS_ENABLED(CONFIG_NET_ROUTING))) ||
 	    net_ipv6_is_addr_mcast(&ip_hdr->dst) ||
 	    /* Workaround Linux bug, see:
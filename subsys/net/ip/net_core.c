@@ -68,12 +68,12 @@ static inline enum net_verdict process_data(struct net_pkt *pkt,
 		return ret;
 	}
 
-#if defined(CONFIG_NET_IPV6_FRAGMENT)
+#if defined(CONFIG_NET_REASSEMBLY)
 	/* If the packet is routed back to us when we have reassembled
-	 * an IPv6 packet, then do not pass it to L2 as the packet does
+	 * an IP packet, then do not pass it to L2 as the packet does
 	 * not have link layer headers in it.
 	 */
-	if (net_pkt_ipv6_fragment_start(pkt)) {
+	if (net_pkt_is_ip_reassembled(pkt)) {
 		locally_routed = true;
 	}
 #endif
@@ -328,6 +328,12 @@ int net_send_data(struct net_pkt *pkt)
 		 * to RX processing.
 		 */
 		NET_DBG("Loopback pkt %p back to us", pkt);
+
+		/* The checksums were just calculated by us */
+		if (IS_ENABLED(CONFIG_NET_LOOPBACK_SKIP_CHECKSUM)) {
+			net_pkt_set_chksum_done(pkt, true);
+		}
+
 		processing_data(pkt, true);
 		return 0;
 	}
@@ -367,20 +373,26 @@ static void net_rx(struct net_if *iface, struct net_pkt *pkt)
 static void process_rx_packet(struct k_work *work)
 {
 	struct net_pkt *pkt;
+	uint8_t queue;
 
 	pkt = CONTAINER_OF(work, struct net_pkt, work);
+	queue = net_tc_rx_queue_current();
+	NET_ASSERT(queue < NET_TC_RX_QUEUE_COUNT);
 
 	net_pkt_set_rx_stats_tick(pkt, k_cycle_get_32());
 
 	net_capture_pkt(net_pkt_iface(pkt), pkt);
 
+	net_tcp_gro_begin(queue);
 	net_rx(net_pkt_iface(pkt), pkt);
+	net_tcp_gro_end(queue);
 }
 
 static void net_queue_rx(struct net_if *iface, struct net_pkt *pkt)
 {
 	uint8_t prio = net_pkt_priority(pkt);
 	uint8_t tc = net_rx_priority2tc(prio);
+	uint8_t queue = net_tc_rx_queue(tc, pkt);
 
 	k_work_init(net_pkt_work(pkt), process_rx_packet);
 
@@ -394,7 +406,8 @@ static void net_queue_rx(struct net_if *iface, struct net_pkt *pkt)
 	NET_DBG("TC %d with prio %d pkt %p", tc, prio, pkt);
 #endif
 
-	net_tc_submit_to_rx_queue(tc, pkt);
+	net_tcp_gro_queued(queue);
+	net_tc_submit_to_rx_queue(queue, pkt);
 }
 
 /* Called by driver when an IP packet has been received */
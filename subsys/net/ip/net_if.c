@@ -23,7 +23,9 @@ LOG_MODULE_REGISTER(net_if, CONFIG_NET_IF_LOG_LEVEL);
 
 #include "net_private.h"
 #include "ipv6.h"
+#include "route.h"
 #include "ipv4_autoconf_internal.h"
+#include "tcp_internal.h"
 
 #include "net_stats.h"
 
@@ -203,6 +205,54 @@ static void update_txtime_stats_detail(struct net_pkt *pkt,
 	}
 }
 
+/* TCP segmentation offload packets are cut to segments here, unless the
+ * device does it.
+ */
+static bool need_tx_segmentation(struct net_if *iface, struct net_pkt *pkt)
+{
+	if (!net_pkt_gso_size(pkt)) {
+		return false;
+	}
+
+#if defined(CONFIG_NET_L2_ETHERNET)
+	if (net_if_l2(iface) == &NET_L2_GET_NAME(ETHERNET) &&
+	    (net_eth_get_hw_capabilities(iface) & ETHERNET_HW_TX_SEG)) {
+		return false;
+	}
+#endif
+
+	return true;
+}
+
+static int l2_send_segmented(struct net_if *iface, struct net_pkt *pkt)
+{
+	struct net_pkt *seg;
+	size_t offset = 0;
+	int sent = 0;
+	int ret;
+
+	while ((ret = net_tcp_gso_segment(pkt, &offset, &seg)) > 0) {
+		ret = net_if_l2(iface)->send(iface, seg);
+		if (ret < 0) {
+			net_pkt_unref(seg);
+			break;
+		}
+
+		sent += ret;
+	}
+
+	if (ret < 0 && sent == 0) {
+		return ret;
+	}
+
+	/* TCP recovers the segments that did not make it like any other
+	 * lost segment.
+	 */
+	net_pkt_unref(pkt);
+
+	return sent;
+}
+
 static bool net_if_tx(struct net_if *iface, struct net_pkt *pkt)
 {
 	struct net_linkaddr ll_dst = {
@@ -269,7 +319,11 @@ static bool net_if_tx(struct net_if *iface, struct net_pkt *pkt)
 			}
 		}
 
-		status = net_if_l2(iface)->send(iface, pkt);
+		if (need_tx_segmentation(iface, pkt)) {
+			status = l2_send_segmented(iface, pkt);
+		} else {
+			status = net_if_l2(iface)->send(iface, pkt);
+		}
 
 		if (IS_ENABLED(CONFIG_NET_CONTEXT_TIMESTAMP) && status >= 0 &&
 		    context) {
@@ -384,7 +438,7 @@ void net_if_queue_tx(struct net_if *iface, struct net_pkt *pkt)
 	iface->tx_pending++;
 #endif
 
-	if (!net_tc_submit_to_tx_queue(tc, pkt)) {
+	if (!net_tc_submit_to_tx_queue(net_tc_tx_queue(tc, pkt), pkt)) {
 #if defined(CONFIG_NET_POWER_MANAGEMENT)
 		iface->tx_pending--
 #endif
@@ -705,6 +759,8 @@ static void iface_router_notify_deletion(struct net_if_router *router,
 						router->iface,
 						&router->address.in6_addr,
 						sizeof(struct in6_addr));
+
+		net_route_flow_flush();
 	} else if (IS_ENABLED(CONFIG_NET_IPV4) &&
 		   router->address.family == AF_INET) {
 		NET_DBG("IPv4 router %s %s",
@@ -834,6 +890,8 @@ static struct net_if_router *iface_router_add(struct net_if *iface,
 					&routers[i].address.in6_addr,
 					sizeof(struct in6_addr));
 
+			net_route_flow_flush();
+
 			NET_DBG("interface %p router %s lifetime %u default %d "
 				"added", iface,
 				log_strdup(net_sprint_ipv6_addr(
@@ -898,6 +956,11 @@ void net_if_router_rm(struct net_if_router *router)
 
 	router->is_used = false;
 
+	if (IS_ENABLED(CONFIG_NET_IPV6) &&
+	    router->address.family == AF_INET6) {
+		net_route_flow_flush();
+	}
+
 	/* FIXME - remove timer */
 
 	k_mutex_unlock(&lock);
@@ -3090,10 +3153,18 @@ struct net_if *net_if_ipv4_select_src_iface(const struct in_addr *dst)
 		}
 	}
 
-	if (selected == NULL) {
-		selected = net_if_get_default();
+	if (IS_ENABLED(CONFIG_NET_ROUTE_IPV4)) {
+		struct net_route_entry_ipv4 *route;
+
+		route = net_route_ipv4_lookup(NULL, (struct in_addr *)dst);
+		if (route) {
+			selected = route->iface;
+			goto out;
+		}
 	}
 
+	selected = net_if_get_default();
+
 out:
 	k_mutex_unlock(&lock);
 
@@ -128,6 +128,96 @@ NET_BUF_POOL_VAR_DEFINE(tx_bufs, CONFIG_NET_BUF_TX_COUNT,
 
 #endif /* CONFIG_NET_BUF_FIXED_DATA_SIZE */
 
+#if defined(CONFIG_NET_BUF_CPU_CACHE)
+static size_t slab_cache_get_bulk(void *backend, void **objs, size_t count)
+{
+	size_t n;
+
+	for (n = 0; n < count; n++) {
+		if (k_mem_slab_alloc(backend, &objs[n], K_NO_WAIT)) {
+			break;
+		}
+	}
+
+	return n;
+}
+
+static void *slab_cache_get(void *backend, k_timeout_t timeout)
+{
+	void *obj;
+
+	if (k_mem_slab_alloc(backend, &obj, timeout)) {
+		return NULL;
+	}
+
+	return obj;
+}
+
+static void slab_cache_put_bulk(void *backend, void **objs, size_t count)
+{
+	while (count--) {
+		k_mem_slab_free(backend, objs++);
+	}
+}
+
+static const struct net_buf_cache_ops slab_cache_ops = {
+	.get_bulk = slab_cache_get_bulk,
+	.get = slab_cache_get,
+	.put_bulk = slab_cache_put_bulk,
+};
+
+static struct net_buf_cache rx_pkts_cache =
+	NET_BUF_CACHE_INITIALIZER(&slab_cache_ops, &rx_pkts);
+static struct net_buf_cache tx_pkts_cache =
+	NET_BUF_CACHE_INITIALIZER(&slab_cache_ops, &tx_pkts);
+static struct net_buf_cache rx_bufs_cache =
+	NET_BUF_POOL_CACHE_INITIALIZER(rx_bufs);
+static struct net_buf_cache tx_bufs_cache =
+	NET_BUF_POOL_CACHE_INITIALIZER(tx_bufs);
+
+/* Packets from the slabs of net_context have no cache */
+static struct net_buf_cache *slab_cache(struct k_mem_slab *slab)
+{
+	if (slab == &rx_pkts) {
+		return &rx_pkts_cache;
+	} else if (slab == &tx_pkts) {
+		return &tx_pkts_cache;
+	}
+
+	return NULL;
+}
+#endif /* CONFIG_NET_BUF_CPU_CACHE */
+
+static int pkt_slab_alloc(struct k_mem_slab *slab, struct net_pkt **pkt,
+			  k_timeout_t timeout)
+{
+#if defined(CONFIG_NET_BUF_CPU_CACHE)
+	struct net_buf_cache *cache = slab_cache(slab);
+
+	if (cache) {
+		*pkt = net_buf_cache_get(cache, timeout);
+
+		return *pkt ? 0 : -ENOMEM;
+	}
+#endif
+
+	return k_mem_slab_alloc(slab, (void **)pkt, timeout);
+}
+
+static void pkt_slab_free(struct net_pkt *pkt)
+{
+#if defined(CONFIG_NET_BUF_CPU_CACHE)
+	struct net_buf_cache *cache = slab_cache(pkt->slab);
+
+	if (cache) {
+		net_buf_cache_put(cache, pkt);
+		return;
+	}
+#endif
+
+	k_mem_slab_free(pkt->slab, (void **)&pkt);
+}
+
 /* Allocation tracking is only available if separately enabled */
 #if defined(CONFIG_NET_DEBUG_NET_PKT_ALLOC)
 struct net_pkt_alloc {
@@ -591,7 +681,7 @@ done:
 		net_pkt_cursor_init(pkt);
 	}
 
-	k_mem_slab_free(pkt->slab, (void **)&pkt);
+	pkt_slab_free(pkt);
 }
 
 #if NET_LOG_LEVEL >= LOG_LEVEL_DBG
@@ -834,6 +924,20 @@ void net_pkt_get_info(struct k_mem_slab **rx,
 	}
 }
 
+#if defined(CONFIG_NET_BUF_CPU_CACHE)
+void net_pkt_get_cache_info(struct net_buf_cache **rx,
+			    struct net_buf_cache **tx)
+{
+	if (rx) {
+		*rx = &rx_pkts_cache;
+	}
+
+	if (tx) {
+		*tx = &tx_pkts_cache;
+	}
+}
+#endif /* CONFIG_NET_BUF_CPU_CACHE */
+
 #if defined(CONFIG_NET_DEBUG_NET_PKT_ALLOC)
 void net_pkt_print(void)
 {
@@ -951,6 +1055,11 @@ static size_t pkt_buffer_length(struct net_pkt *pkt,
 	sa_family_t family = net_pkt_family(pkt);
 	size_t max_len;
 
+	/* Cut to segments fitting the MTU only when it reaches the L2 */
+	if (net_pkt_gso_size(pkt)) {
+		return size;
+	}
+
 	if (net_pkt_iface(pkt)) {
 		max_len = net_if_get_mtu(net_pkt_iface(pkt));
 	} else {
@@ -1188,7 +1297,7 @@ static struct net_pkt *pkt_alloc(struct k_mem_slab *slab, k_timeout_t timeout)
 		timeout = K_NO_WAIT;
 	}
 
-	ret = k_mem_slab_alloc(slab, (void **)&pkt, timeout);
+	ret = pkt_slab_alloc(slab, &pkt, timeout);
 	if (ret) {
 		return NULL;
 	}
@@ -1741,6 +1850,8 @@ static void clone_pkt_attributes(struct net_pkt *pkt, struct net_pkt *clone_pkt)
 	net_pkt_set_priority(clone_pkt, net_pkt_priority(pkt));
 	net_pkt_set_orig_iface(clone_pkt, net_pkt_orig_iface(pkt));
 	net_pkt_set_captured(clone_pkt, net_pkt_is_captured(pkt));
+	net_pkt_set_chksum_done(clone_pkt, net_pkt_is_chksum_done(pkt));
+	net_pkt_set_ip_reassembled(clone_pkt, net_pkt_is_ip_reassembled(pkt));
 
 	if (IS_ENABLED(CONFIG_NET_IPV4) && net_pkt_family(pkt) == AF_INET) {
 		net_pkt_set_ipv4_ttl(clone_pkt, net_pkt_ipv4_ttl(pkt));
@@ -2037,6 +2148,11 @@ int net_pkt_set_data(struct net_pkt *pkt,
 
 void net_pkt_init(void)
 {
+#if defined(CONFIG_NET_BUF_CPU_CACHE)
+	rx_bufs.cache = &rx_bufs_cache;
+	tx_bufs.cache = &tx_bufs_cache;
+#endif
+
 #if CONFIG_NET_PKT_LOG_LEVEL >= LOG_LEVEL_DBG
 	NET_DBG("Allocating %u RX (%zu bytes), %u TX (%zu bytes), "
 		"%d RX data (%u bytes) and %d TX data (%u bytes) buffers",
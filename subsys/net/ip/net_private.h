@@ -86,8 +86,26 @@ static inline enum net_verdict net_ipv6_input(struct net_pkt *pkt,
 	return NET_CONTINUE;
 }
 #endif
-extern bool net_tc_submit_to_tx_queue(uint8_t tc, struct net_pkt *pkt);
-extern void net_tc_submit_to_rx_queue(uint8_t tc, struct net_pkt *pkt);
+
+/* Number of queues, each served by its own thread, per traffic class */
+#if defined(CONFIG_NET_TC_RSS)
+#define NET_TC_RSS_QUEUES CONFIG_NET_TC_RSS_QUEUES
+#else
+#define NET_TC_RSS_QUEUES 1
+#endif
+
+#define NET_TC_TX_QUEUE_COUNT (NET_TC_TX_COUNT * NET_TC_RSS_QUEUES)
+#define NET_TC_RX_QUEUE_COUNT (NET_TC_RX_COUNT * NET_TC_RSS_QUEUES)
+
+/* Select the queue of traffic class tc for the flow of the packet */
+extern uint8_t net_tc_tx_queue(uint8_t tc, struct net_pkt *pkt);
+extern uint8_t net_tc_rx_queue(uint8_t tc, struct net_pkt *pkt);
+/* Queue served by the calling RX thread, NET_TC_RX_QUEUE_COUNT when
+ * called from another thread
+ */
+extern uint8_t net_tc_rx_queue_current(void);
+extern bool net_tc_submit_to_tx_queue(uint8_t queue, struct net_pkt *pkt);
+extern void net_tc_submit_to_rx_queue(uint8_t queue, struct net_pkt *pkt);
 extern enum net_verdict net_promisc_mode_input(struct net_pkt *pkt);
 
 char *net_sprint_addr(sa_family_t af, const void *addr);
@@ -209,6 +227,38 @@ static inline uint16_t net_calc_chksum_tcp(struct net_pkt *pkt)
 	return net_calc_chksum(pkt, IPPROTO_TCP);
 }
 
+/**
+ * @brief Update a checksum after a part of the data it covers was rewritten,
+ *        without summing up the whole data again (RFC 1624).
+ *
+ * @param chksum Current checksum, in network byte order
+ * @param old_data Data before the rewrite
+ * @param new_data Data after the rewrite
+ * @param len Length of the rewritten data. It must be even and start at
+ *        an even offset of the checksummed data.
+ *
+ * @return Updated checksum, in network byte order
+ */
+extern uint16_t net_calc_chksum_update(uint16_t chksum, const void *old_data,
+				       const void *new_data, size_t len);
+
+static inline uint16_t net_calc_chksum_update16(uint16_t chksum,
+						uint16_t old_val,
+						uint16_t new_val)
+{
+	return net_calc_chksum_update(chksum, &old_val, &new_val,
+				      sizeof(uint16_t));
+}
+
+/* The checksums of an incoming packet need to be verified unless the
+ * network hardware, or the sender in this host, already did it.
+ */
+static inline bool net_pkt_need_calc_rx_checksum(struct net_pkt *pkt)
+{
+	return !net_pkt_is_chksum_done(pkt) &&
+	       net_if_need_calc_rx_checksum(net_pkt_iface(pkt));
+}
+
 static inline char *net_sprint_ll_addr(const uint8_t *ll, uint8_t ll_len)
 {
 	static char buf[sizeof("xx:xx:xx:xx:xx:xx:xx:xx")];
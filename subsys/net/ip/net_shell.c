@@ -38,6 +38,11 @@ LOG_MODULE_REGISTER(net_shell, LOG_LEVEL_DBG);
 #endif
 
 #include "ipv6.h"
+#include "ipv4.h"
+
+#if defined(CONFIG_NET_REASSEMBLY)
+#include "reassembly.h"
+#endif
 
 #if defined(CONFIG_NET_ARP)
 #include "ethernet/arp.h"
@@ -259,6 +264,7 @@ static struct ethernet_capabilities eth_hw_caps[] = {
 	EC(ETHERNET_HW_RX_CHKSUM_OFFLOAD, "RX checksum offload"),
 	EC(ETHERNET_HW_VLAN,              "Virtual LAN"),
 	EC(ETHERNET_HW_VLAN_TAG_STRIP,    "VLAN Tag stripping"),
+	EC(ETHERNET_HW_TX_SEG,            "TCP segmentation offload"),
 	EC(ETHERNET_AUTO_NEGOTIATION_SET, "Auto negotiation"),
 	EC(ETHERNET_LINK_10BASE_T,        "10 Mbits"),
 	EC(ETHERNET_LINK_100BASE_T,       "100 Mbits"),
@@ -761,6 +767,45 @@ static void iface_per_route_cb(struct net_if *iface, void *user_data)
 }
 #endif /* CONFIG_NET_ROUTE */
 
+#if defined(CONFIG_NET_ROUTE_IPV4)
+static void route_ipv4_cb(struct net_route_entry_ipv4 *entry,
+			  void *user_data)
+{
+	struct net_shell_user_data *data = user_data;
+	const struct shell *shell = data->shell;
+	struct net_if *iface = data->user_data;
+
+	if (entry->iface != iface) {
+		return;
+	}
+
+	PR("IPv4 prefix : %s/%d\t", net_sprint_ipv4_addr(&entry->addr),
+	   entry->prefix_len);
+
+	if (net_ipv4_is_addr_unspecified(&entry->gw)) {
+		PR("gateway : <on-link>\n");
+	} else {
+		PR("gateway : %s\n", net_sprint_ipv4_addr(&entry->gw));
+	}
+}
+
+static void iface_per_route_ipv4_cb(struct net_if *iface, void *user_data)
+{
+	struct net_shell_user_data *data = user_data;
+	const struct shell *shell = data->shell;
+	const char *extra;
+
+	PR("\nIPv4 routes for interface %d (%p) (%s)\n",
+	   net_if_get_by_iface(iface), iface,
+	   iface2str(iface, &extra));
+	PR("=========================================%s\n", extra);
+
+	data->user_data = iface;
+
+	net_route_ipv4_foreach(route_ipv4_cb, data);
+}
+#endif /* CONFIG_NET_ROUTE_IPV4 */
+
 #if defined(CONFIG_NET_ROUTE_MCAST) && defined(CONFIG_NET_NATIVE)
 static void route_mcast_cb(struct net_route_entry_mcast *entry,
 			   void *user_data)
@@ -1260,9 +1305,10 @@ static void net_shell_print_statistics(struct net_if *iface, void *user_data)
 	   GET_STAT(iface, tcp.rexmit),
 	   GET_STAT(iface, tcp.chkerr),
 	   GET_STAT(iface, tcp.ackerr));
-	PR("TCP seg rsterr %d\trst\t%d\n",
+	PR("TCP seg rsterr %d\trst\t%d\tfast re-xmit\t%d\n",
 	   GET_STAT(iface, tcp.rsterr),
-	   GET_STAT(iface, tcp.rst));
+	   GET_STAT(iface, tcp.rst),
+	   GET_STAT(iface, tcp.fast_rexmit));
 	PR("TCP conn drop  %d\tconnrst\t%d\n",
 	   GET_STAT(iface, tcp.conndrop),
 	   GET_STAT(iface, tcp.connrst));
@@ -1557,50 +1603,37 @@ static void tcp_sent_list_cb(struct tcp *conn, void *user_data)
 #endif /* CONFIG_NET_TCP_LOG_LEVEL >= LOG_LEVEL_DBG */
 #endif /* TCP2 */
 
-#if defined(CONFIG_NET_IPV6_FRAGMENT)
-static void ipv6_frag_cb(struct net_ipv6_reassembly *reass,
-			 void *user_data)
+#if defined(CONFIG_NET_REASSEMBLY)
+static void reass_cb(struct net_reass *reass, void *user_data)
 {
 	struct net_shell_user_data *data = user_data;
 	const struct shell *shell = data->shell;
 	int *count = data->user_data;
+	sa_family_t family = reass->key.src.family;
 	char src[ADDR_LEN];
 	int i;
 
 	if (!*count) {
-		PR("\nIPv6 reassembly Id         Remain "
-		   "Src             \tDst\n");
+		PR("\n%s reassembly Id         Remain Bytes "
+		   "Src             \tDst\n",
+		   family == AF_INET6 ? "IPv6" : "IPv4");
 	}
 
-	snprintk(src, ADDR_LEN, "%s", net_sprint_ipv6_addr(&reass->src));
-
-	PR("%p      0x%08x  %5d %16s\t%16s\n",
-	   reass, reass->id,
-	   k_delayed_work_remaining_get(&reass->timer),
-	   src, net_sprint_ipv6_addr(&reass->dst));
-
-	for (i = 0; i < NET_IPV6_FRAGMENTS_MAX_PKT; i++) {
-		if (reass->pkt[i]) {
-			struct net_buf *frag = reass->pkt[i]->frags;
+	snprintk(src, ADDR_LEN, "%s",
+		 net_sprint_addr(family, &reass->key.src.in6_addr));
 
-			PR("[%d] pkt %p->", i, reass->pkt[i]);
+	PR("%p      0x%08x  %5d %5u %16s\t%16s\n",
+	   reass, reass->key.id, net_reass_remaining(reass), reass->mem,
+	   src, net_sprint_addr(family, &reass->key.dst.in6_addr));
 
-			while (frag) {
-				PR("%p", frag);
-
-				frag = frag->frags;
-				if (frag) {
-					PR("->");
-				}
-			}
-
-			PR("\n");
-		}
+	for (i = 0; i < reass->count; i++) {
+		PR("[%d] %u-%u\n", i, reass->ranges[i].start,
+		   reass->ranges[i].end);
 	}
 
 	(*count)++;
 }
-#endif /* CONFIG_NET_IPV6_FRAGMENT */
+#endif /* CONFIG_NET_REASSEMBLY */
 
 #if defined(CONFIG_NET_DEBUG_NET_PKT_ALLOC)
 static void allocs_cb(struct net_pkt *pkt,
@@ -2071,11 +2104,17 @@ static int cmd_net_conn(const struct shell *shell, size_t argc, char *argv[])
 #if defined(CONFIG_NET_IPV6_FRAGMENT)
 	count = 0;
 
-	net_ipv6_frag_foreach(ipv6_frag_cb, &user_data);
+	net_ipv6_frag_foreach(reass_cb, &user_data);
 
 	/* Do not print anything if no fragments are pending atm */
 #endif
 
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+	count = 0;
+
+	net_ipv4_frag_foreach(reass_cb, &user_data);
+#endif
+
 #else
 	PR_INFO("Set %s to enable %s support.\n",
 		"CONFIG_NET_OFFLOAD or CONFIG_NET_NATIVE",
@@ -2227,6 +2266,81 @@ static int cmd_net_dns_cancel(const struct shell *shell, size_t argc,
 	return 0;
 }
 
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+static void dns_cache_cb(const char *query, enum dns_query_type type,
+			 const struct dns_addrinfo *info, int status,
+			 uint32_t ttl, void *user_data)
+{
+	struct net_shell_user_data *data = user_data;
+	const struct shell *shell = data->shell;
+	int *count = data->user_data;
+	char addr[NET_IPV6_ADDR_LEN];
+
+	if (!info) {
+		snprintk(addr, sizeof(addr), "<not found, %d>", status);
+	} else if (info->ai_family == AF_INET) {
+		net_addr_ntop(AF_INET, &net_sin(&info->ai_addr)->sin_addr,
+			      addr, sizeof(addr));
+	} else {
+		net_addr_ntop(AF_INET6, &net_sin6(&info->ai_addr)->sin6_addr,
+			      addr, sizeof(addr));
+	}
+
+	PR("%-4s %6u %s %s\n", type == DNS_QUERY_TYPE_A ? "A" : "AAAA", ttl,
+	   query, addr);
+
+	(*count)++;
+}
+#endif
+
+static int cmd_net_dns_cache(const struct shell *shell, size_t argc,
+			     char *argv[])
+{
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	struct net_shell_user_data user_data;
+	int count = 0;
+#endif
+
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	user_data.shell = shell;
+	user_data.user_data = &count;
+
+	PR("Type    TTL Name Address\n");
+
+	dns_resolve_cache_foreach(dns_cache_cb, &user_data);
+
+	if (count == 0) {
+		PR("No cached DNS answers.\n");
+	}
+#else
+	PR_INFO("Set %s to enable %s support.\n", "CONFIG_DNS_RESOLVER_CACHE",
+		"DNS cache");
+#endif
+
+	return 0;
+}
+
+static int cmd_net_dns_flush(const struct shell *shell, size_t argc,
+			     char *argv[])
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	dns_resolve_cache_flush();
+
+	PR("DNS cache flushed.\n");
+#else
+	PR_INFO("Set %s to enable %s support.\n", "CONFIG_DNS_RESOLVER_CACHE",
+		"DNS cache");
+#endif
+
+	return 0;
+}
+
 static int cmd_net_dns_query(const struct shell *shell, size_t argc,
 			     char *argv[])
 {
@@ -3649,6 +3763,41 @@ static void context_info(struct net_context *context, void *user_data)
 }
 #endif /* CONFIG_NET_OFFLOAD || CONFIG_NET_NATIVE */
 
+#if defined(CONFIG_NET_BUF_CPU_CACHE) && defined(CONFIG_NET_BUF_POOL_USAGE)
+static void print_buf_cache(const struct shell *shell,
+			    struct net_buf_cache *cache, const char *name)
+{
+	uint32_t hits, misses;
+
+	if (!cache) {
+		return;
+	}
+
+	net_buf_cache_stats(cache, &hits, &misses);
+
+	PR("%zu\t%-10u\t%-10u\t%s\n", net_buf_cache_count(cache),
+	   hits, misses, name);
+}
+
+static void print_buf_caches(const struct shell *shell,
+			     struct net_buf_pool *rx_data,
+			     struct net_buf_pool *tx_data)
+{
+	struct net_buf_cache *rx, *tx;
+
+	net_pkt_get_cache_info(&rx, &tx);
+
+	PR("\nPer-CPU caches (%d objects per CPU):\n",
+	   CONFIG_NET_BUF_CPU_CACHE_SIZE);
+	PR("Cached\tHits\t\tMisses\t\tName\n");
+
+	print_buf_cache(shell, rx, "RX");
+	print_buf_cache(shell, tx, "TX");
+	print_buf_cache(shell, rx_data->cache, "RX DATA");
+	print_buf_cache(shell, tx_data->cache, "TX DATA");
+}
+#endif /* CONFIG_NET_BUF_CPU_CACHE && CONFIG_NET_BUF_POOL_USAGE */
+
 static int cmd_net_mem(const struct shell *shell, size_t argc, char *argv[])
 {
 	ARG_UNUSED(argc);
@@ -3680,6 +3829,10 @@ static int cmd_net_mem(const struct shell *shell, size_t argc, char *argv[])
 	PR("%p\t%d\t%d\tTX DATA (%s)\n",
 	       tx_data, tx_data->buf_count,
 	       atomic_get(&tx_data->avail_count), tx_data->name);
+
+#if defined(CONFIG_NET_BUF_CPU_CACHE)
+	print_buf_caches(shell, rx_data, tx_data);
+#endif
 #else
 	PR("Address\t\tTotal\tName\n");
 
@@ -4420,19 +4573,24 @@ static int cmd_net_route(const struct shell *shell, size_t argc, char *argv[])
 	ARG_UNUSED(argv);
 
 #if defined(CONFIG_NET_NATIVE)
-#if defined(CONFIG_NET_ROUTE) || defined(CONFIG_NET_ROUTE_MCAST)
+#if defined(CONFIG_NET_ROUTE) || defined(CONFIG_NET_ROUTE_MCAST) || \
+	defined(CONFIG_NET_ROUTE_IPV4)
 	struct net_shell_user_data user_data;
-#endif
 
-#if defined(CONFIG_NET_ROUTE) || defined(CONFIG_NET_ROUTE_MCAST)
 	user_data.shell = shell;
 #endif
 
 #if defined(CONFIG_NET_ROUTE)
 	net_if_foreach(iface_per_route_cb, &user_data);
-#else
-	PR_INFO("Set %s to enable %s support.\n", "CONFIG_NET_ROUTE",
-		"network route");
+#endif
+
+#if defined(CONFIG_NET_ROUTE_IPV4)
+	net_if_foreach(iface_per_route_ipv4_cb, &user_data);
+#endif
+
+#if !defined(CONFIG_NET_ROUTE) && !defined(CONFIG_NET_ROUTE_IPV4)
+	PR_INFO("Set %s or %s to enable %s support.\n", "CONFIG_NET_ROUTE",
+		"CONFIG_NET_ROUTE_IPV4", "network route");
 #endif
 
 #if defined(CONFIG_NET_ROUTE_MCAST)
@@ -5689,8 +5847,12 @@ SHELL_STATIC_SUBCMD_SET_CREATE(net_cmd_capture,
 );
 
 SHELL_STATIC_SUBCMD_SET_CREATE(net_cmd_dns,
+	SHELL_CMD(cache, NULL, "Show the cached DNS answers.",
+		  cmd_net_dns_cache),
 	SHELL_CMD(cancel, NULL, "Cancel all pending requests.",
 		  cmd_net_dns_cancel),
+	SHELL_CMD(flush, NULL, "Drop the cached DNS answers.",
+		  cmd_net_dns_flush),
 	SHELL_CMD(query, NULL,
 		  "'net dns <hostname> [A or AAAA]' queries IPv4 address "
 		  "(default) or IPv6 address for a host name.",
@@ -152,6 +152,8 @@ static inline void stats(struct net_if *iface)
 		NET_INFO("TCP conn drop  %d\tconnrst\t%d",
 			 GET_STAT(iface, tcp.conndrop),
 			 GET_STAT(iface, tcp.connrst));
+		NET_INFO("TCP fast re-xmit %d",
+			 GET_STAT(iface, tcp.fast_rexmit));
 #endif
 
 		NET_INFO("Bytes received %u", GET_STAT(iface, bytes.received));
@@ -13,6 +13,8 @@ LOG_MODULE_REGISTER(net_tc, CONFIG_NET_TC_LOG_LEVEL);
 #include <net/net_core.h>
 #include <net/net_pkt.h>
 #include <net/net_stats.h>
+#include <net/net_l2.h>
+#include <net/ethernet.h>
 
 #include "net_private.h"
 #include "net_stats.h"
@@ -21,34 +23,213 @@ LOG_MODULE_REGISTER(net_tc, CONFIG_NET_TC_LOG_LEVEL);
 /* Template for thread name. The "xx" is either "TX" denoting transmit thread,
  * or "RX" denoting receive thread. The "q[y]" denotes the traffic class queue
  * where y indicates the traffic class id. The value of y can be from 0 to 7.
+ * If CONFIG_NET_TC_RSS is enabled, the name is "xx_q[y.z]" where z is the
+ * index of the queue within the traffic class.
  */
-#define MAX_NAME_LEN sizeof("xx_q[y]")
+#define MAX_NAME_LEN sizeof("xx_q[y.z]")
 
 /* Stacks for TX work queue */
-K_KERNEL_STACK_ARRAY_DEFINE(tx_stack, NET_TC_TX_COUNT,
+K_KERNEL_STACK_ARRAY_DEFINE(tx_stack, NET_TC_TX_QUEUE_COUNT,
 			    CONFIG_NET_TX_STACK_SIZE);
 
 /* Stacks for RX work queue */
-K_KERNEL_STACK_ARRAY_DEFINE(rx_stack, NET_TC_RX_COUNT,
+K_KERNEL_STACK_ARRAY_DEFINE(rx_stack, NET_TC_RX_QUEUE_COUNT,
 			    CONFIG_NET_RX_STACK_SIZE);
 
-static struct net_traffic_class tx_classes[NET_TC_TX_COUNT];
-static struct net_traffic_class rx_classes[NET_TC_RX_COUNT];
+/* The queues of traffic class tc are at indexes
+ * tc * NET_TC_RSS_QUEUES ... (tc + 1) * NET_TC_RSS_QUEUES - 1
+ */
+static struct net_traffic_class tx_classes[NET_TC_TX_QUEUE_COUNT];
+static struct net_traffic_class rx_classes[NET_TC_RX_QUEUE_COUNT];
 
-bool net_tc_submit_to_tx_queue(uint8_t tc, struct net_pkt *pkt)
+#if defined(CONFIG_NET_TC_RSS)
+static inline uint32_t flow_hash_add(uint32_t hash, uint32_t word)
+{
+	return (hash ^ word) * 0x9e3779b1U;
+}
+
+/* Hash the addresses, and for TCP and UDP the ports, of the IP packet that
+ * starts at the cursor. Returns 0 for anything else.
+ */
+static uint32_t flow_hash_ip(struct net_pkt *pkt)
+{
+	union {
+		struct net_ipv4_hdr ipv4;
+		struct net_ipv6_hdr ipv6;
+	} hdr;
+	uint8_t *data = (uint8_t *)&hdr;
+	uint32_t hash = 0U;
+	size_t opts_len = 0;
+	uint32_t ports;
+	uint8_t proto;
+	int i;
+
+	if (net_pkt_read_u8(pkt, data)) {
+		return 0U;
+	}
+
+	switch (data[0] >> 4) {
+	case 4:
+		if (net_pkt_read(pkt, data + 1, sizeof(hdr.ipv4) - 1)) {
+			return 0U;
+		}
+
+		hash = flow_hash_add(hash, hdr.ipv4.src.s_addr);
+		hash = flow_hash_add(hash, hdr.ipv4.dst.s_addr);
+
+		/* All the fragments of a datagram have to end up in the same
+		 * queue, and only the first one has the ports.
+		 */
+		if ((hdr.ipv4.offset[0] & 0x3f) || hdr.ipv4.offset[1]) {
+			return hash;
+		}
+
+		proto = hdr.ipv4.proto;
+		opts_len = (hdr.ipv4.vhl & 0x0f) * 4U - sizeof(hdr.ipv4);
+		break;
+	case 6:
+		if (net_pkt_read(pkt, data + 1, sizeof(hdr.ipv6) - 1)) {
+			return 0U;
+		}
+
+		for (i = 0; i < 4; i++) {
+			hash = flow_hash_add(hash, hdr.ipv6.src.s6_addr32[i]);
+			hash = flow_hash_add(hash, hdr.ipv6.dst.s6_addr32[i]);
+		}
+
+		/* Ports behind extension headers are not looked for */
+		proto = hdr.ipv6.nexthdr;
+		break;
+	default:
+		return 0U;
+	}
+
+	if ((proto == IPPROTO_TCP || proto == IPPROTO_UDP) &&
+	    !net_pkt_skip(pkt, opts_len) && !net_pkt_read_be32(pkt, &ports)) {
+		hash = flow_hash_add(hash, ports);
+	}
+
+	return hash;
+}
+
+/* Skip the link layer header of a received packet. Returns false if the
+ * packet does not carry IP or if the framing of the link layer is not known.
+ */
+static bool flow_hash_skip_l2(struct net_pkt *pkt)
+{
+	struct net_if *iface = net_pkt_iface(pkt);
+	uint16_t type;
+
+#if defined(CONFIG_NET_L2_DUMMY)
+	if (net_if_l2(iface) == &NET_L2_GET_NAME(DUMMY)) {
+		return true;
+	}
+#endif
+
+#if defined(CONFIG_NET_L2_ETHERNET)
+	if (net_if_l2(iface) == &NET_L2_GET_NAME(ETHERNET)) {
+		if (net_pkt_skip(pkt, offsetof(struct net_eth_hdr, type)) ||
+		    net_pkt_read_be16(pkt, &type)) {
+			return false;
+		}
+
+		if (type == NET_ETH_PTYPE_VLAN &&
+		    (net_pkt_skip(pkt, sizeof(uint16_t)) ||
+		     net_pkt_read_be16(pkt, &type))) {
+			return false;
+		}
+
+		return type == NET_ETH_PTYPE_IP || type == NET_ETH_PTYPE_IPV6;
+	}
+#endif
+
+	ARG_UNUSED(iface);
+	ARG_UNUSED(type);
+
+	return false;
+}
+
+static uint32_t flow_hash(struct net_pkt *pkt, bool rx)
+{
+	bool overwrite = net_pkt_is_being_overwritten(pkt);
+	struct net_pkt_cursor backup;
+	uint32_t hash = 0U;
+
+	net_pkt_cursor_backup(pkt, &backup);
+	net_pkt_set_overwrite(pkt, true);
+	net_pkt_cursor_init(pkt);
+
+	/* Sent IP packets do not have the link layer header yet */
+	if (rx ? flow_hash_skip_l2(pkt) :
+	    (net_pkt_family(pkt) == AF_INET ||
+	     net_pkt_family(pkt) == AF_INET6)) {
+		hash = flow_hash_ip(pkt);
+	}
+
+	net_pkt_cursor_restore(pkt, &backup);
+	net_pkt_set_overwrite(pkt, overwrite);
+
+	return hash ^ (hash >> 16);
+}
+#endif /* CONFIG_NET_TC_RSS */
+
+uint8_t net_tc_tx_queue(uint8_t tc, struct net_pkt *pkt)
+{
+#if defined(CONFIG_NET_TC_RSS)
+	return tc * NET_TC_RSS_QUEUES +
+		flow_hash(pkt, false) % NET_TC_RSS_QUEUES;
+#else
+	ARG_UNUSED(pkt);
+
+	return tc;
+#endif
+}
+
+uint8_t net_tc_rx_queue(uint8_t tc, struct net_pkt *pkt)
+{
+#if defined(CONFIG_NET_TC_RSS)
+	return tc * NET_TC_RSS_QUEUES +
+		flow_hash(pkt, true) % NET_TC_RSS_QUEUES;
+#else
+	ARG_UNUSED(pkt);
+
+	return tc;
+#endif
+}
+
+uint8_t net_tc_rx_queue_current(void)
+{
+	uintptr_t thread = (uintptr_t)k_current_get();
+	uintptr_t first = (uintptr_t)&rx_classes[0].work_q.thread;
+	size_t queue;
+
+	if (thread < first) {
+		return NET_TC_RX_QUEUE_COUNT;
+	}
+
+	queue = (thread - first) / sizeof(rx_classes[0]);
+	if (queue >= ARRAY_SIZE(rx_classes) ||
+	    thread != (uintptr_t)&rx_classes[queue].work_q.thread) {
+		return NET_TC_RX_QUEUE_COUNT;
+	}
+
+	return queue;
+}
+
+bool net_tc_submit_to_tx_queue(uint8_t queue, struct net_pkt *pkt)
 {
 	net_pkt_set_tx_stats_tick(pkt, k_cycle_get_32());
 
-	k_work_submit_to_queue(&tx_classes[tc].work_q, net_pkt_work(pkt));
+	k_work_submit_to_queue(&tx_classes[queue].work_q, net_pkt_work(pkt));
 
 	return true;
 }
 
-void net_tc_submit_to_rx_queue(uint8_t tc, struct net_pkt *pkt)
+void net_tc_submit_to_rx_queue(uint8_t queue, struct net_pkt *pkt)
 {
 	net_pkt_set_rx_stats_tick(pkt, k_cycle_get_32());
 
-	k_work_submit_to_queue(&rx_classes[tc].work_q, net_pkt_work(pkt));
+	k_work_submit_to_queue(&rx_classes[queue].work_q, net_pkt_work(pkt));
 }
 
 int net_tx_priority2tc(enum net_priority prio)
@@ -205,11 +386,12 @@ void net_tc_tx_init(void)
 	net_if_foreach(net_tc_tx_stats_priority_setup, NULL);
 #endif
 
-	for (i = 0; i < NET_TC_TX_COUNT; i++) {
+	for (i = 0; i < NET_TC_TX_QUEUE_COUNT; i++) {
 		uint8_t thread_priority;
 		int priority;
 
-		thread_priority = tx_tc2thread(i);
+		/* The queues of a traffic class share its priority */
+		thread_priority = tx_tc2thread(i / NET_TC_RSS_QUEUES);
 
 		priority = IS_ENABLED(CONFIG_NET_TC_THREAD_COOPERATIVE) ?
 			K_PRIO_COOP(thread_priority) :
@@ -232,7 +414,14 @@ void net_tc_tx_init(void)
 		if (IS_ENABLED(CONFIG_THREAD_NAME)) {
 			char name[MAX_NAME_LEN];
 
-			snprintk(name, sizeof(name), "tx_q[%d]", i);
+			if (NET_TC_RSS_QUEUES > 1) {
+				snprintk(name, sizeof(name), "tx_q[%d.%d]",
+					 i / NET_TC_RSS_QUEUES,
+					 i % NET_TC_RSS_QUEUES);
+			} else {
+				snprintk(name, sizeof(name), "tx_q[%d]", i);
+			}
+
 			k_thread_name_set(&tx_classes[i].work_q.thread, name);
 		}
 	}
@@ -248,11 +437,12 @@ void net_tc_rx_init(void)
 	net_if_foreach(net_tc_rx_stats_priority_setup, NULL);
 #endif
 
-	for (i = 0; i < NET_TC_RX_COUNT; i++) {
+	for (i = 0; i < NET_TC_RX_QUEUE_COUNT; i++) {
 		uint8_t thread_priority;
 		int priority;
 
-		thread_priority = rx_tc2thread(i);
+		/* The queues of a traffic class share its priority */
+		thread_priority = rx_tc2thread(i / NET_TC_RSS_QUEUES);
 
 		priority = IS_ENABLED(CONFIG_NET_TC_THREAD_COOPERATIVE) ?
 			K_PRIO_COOP(thread_priority) :
@@ -275,7 +465,14 @@ void net_tc_rx_init(void)
 		if (IS_ENABLED(CONFIG_THREAD_NAME)) {
 			char name[MAX_NAME_LEN];
 
-			snprintk(name, sizeof(name), "rx_q[%d]", i);
+			if (NET_TC_RSS_QUEUES > 1) {
+				snprintk(name, sizeof(name), "rx_q[%d.%d]",
+					 i / NET_TC_RSS_QUEUES,
+					 i % NET_TC_RSS_QUEUES);
+			} else {
+				snprintk(name, sizeof(name), "rx_q[%d]", i);
+			}
+
 			k_thread_name_set(&rx_classes[i].work_q.thread, name);
 		}
 	}
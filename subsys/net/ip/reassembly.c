@@ -0,0 +1,441 @@
+/** @file
+ * @brief IP fragment reassembly shared by IPv6 and IPv4
+ */
+
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_reass, CONFIG_NET_CORE_LOG_LEVEL);
+
+#include <kernel.h>
+#include <string.h>
+#include <errno.h>
+
+#include <net/net_core.h>
+#include <net/net_ip.h>
+#include <net/net_pkt.h>
+
+#include "net_private.h"
+#include "reassembly.h"
+
+#if defined(CONFIG_NET_IPV6_FRAGMENT)
+#define REASS_IPV6_COUNT CONFIG_NET_IPV6_FRAGMENT_MAX_COUNT
+#else
+#define REASS_IPV6_COUNT 0
+#endif
+
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+#define REASS_IPV4_COUNT CONFIG_NET_IPV4_FRAGMENT_MAX_COUNT
+#else
+#define REASS_IPV4_COUNT 0
+#endif
+
+/* Both address families share the reassemblies */
+#define REASS_COUNT (REASS_IPV6_COUNT + REASS_IPV4_COUNT)
+
+/* Twice as many hash buckets as reassemblies keeps the chains short */
+#define REASS_BUCKETS (2 * REASS_COUNT)
+
+static struct net_reass reassembly[REASS_COUNT];
+static sys_slist_t buckets[REASS_BUCKETS];
+
+/* Bytes of payload held by all the reassemblies */
+static size_t reass_mem;
+
+/* Gives up the reassemblies that timed out */
+static void expiry_timeout(struct k_work *work);
+static K_DELAYED_WORK_DEFINE(expiry_timer, expiry_timeout);
+static uint32_t expiry_next;
+static bool expiry_pending;
+
+/* Protects all of the above */
+static struct k_spinlock lock;
+
+static inline bool reass_in_use(struct net_reass *reass)
+{
+	return reass->count > 0U;
+}
+
+static uint32_t key_hash(const struct net_reass_key *key)
+{
+	uint32_t hash;
+
+	if (key->src.family == AF_INET6) {
+		hash = key->src.in6_addr.s6_addr32[3] ^
+		       key->dst.in6_addr.s6_addr32[3];
+	} else {
+		hash = key->src.in_addr.s_addr ^ key->dst.in_addr.s_addr;
+	}
+
+	/* The id changes the most between datagrams */
+	hash ^= key->id * 2654435761U;
+	hash ^= hash >> 16;
+
+	return hash % REASS_BUCKETS;
+}
+
+static bool key_equal(const struct net_reass_key *a,
+		      const struct net_reass_key *b)
+{
+	if (a->id != b->id || a->proto != b->proto ||
+	    a->src.family != b->src.family) {
+		return false;
+	}
+
+	if (a->src.family == AF_INET6) {
+		return net_ipv6_addr_cmp(&a->src.in6_addr, &b->src.in6_addr) &&
+		       net_ipv6_addr_cmp(&a->dst.in6_addr, &b->dst.in6_addr);
+	}
+
+	return net_ipv4_addr_cmp(&a->src.in_addr, &b->src.in_addr) &&
+	       net_ipv4_addr_cmp(&a->dst.in_addr, &b->dst.in_addr);
+}
+
+/* Must be called with the lock held */
+static void reass_free(struct net_reass *reass)
+{
+	int i;
+
+	for (i = 0; i < reass->count; i++) {
+		if (reass->ranges[i].buf) {
+			net_buf_unref(reass->ranges[i].buf);
+		}
+	}
+
+	if (reass->pkt) {
+		net_pkt_unref(reass->pkt);
+	}
+
+	sys_slist_find_and_remove(&buckets[key_hash(&reass->key)],
+				  &reass->node);
+
+	reass_mem -= reass->mem;
+
+	(void)memset(reass, 0, sizeof(*reass));
+}
+
+/* Must be called with the lock held */
+static struct net_reass *reass_oldest(struct net_reass *skip)
+{
+	struct net_reass *oldest = NULL;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(reassembly); i++) {
+		struct net_reass *reass = &reassembly[i];
+
+		if (reass == skip || !reass_in_use(reass)) {
+			continue;
+		}
+
+		if (!oldest || (int32_t)(reass->started - oldest->started) < 0) {
+			oldest = reass;
+		}
+	}
+
+	return oldest;
+}
+
+/* Must be called with the lock held */
+static struct net_reass *reass_get(const struct net_reass_key *key,
+				   uint32_t timeout_ms)
+{
+	sys_slist_t *bucket = &buckets[key_hash(key)];
+	struct net_reass *reass;
+	int i;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(bucket, reass, node) {
+		if (key_equal(&reass->key, key)) {
+			return reass;
+		}
+	}
+
+	reass = NULL;
+
+	for (i = 0; i < ARRAY_SIZE(reassembly); i++) {
+		if (!reass_in_use(&reassembly[i])) {
+			reass = &reassembly[i];
+			break;
+		}
+	}
+
+	/* Newer datagrams are more likely to complete */
+	if (!reass) {
+		reass = reass_oldest(NULL);
+
+		NET_DBG("No free reassembly, giving up id 0x%x",
+			reass->key.id);
+
+		reass_free(reass);
+	}
+
+	reass->key = *key;
+	reass->started = k_uptime_get_32();
+	reass->expires = reass->started + timeout_ms;
+
+	sys_slist_append(bucket, &reass->node);
+
+	if (!expiry_pending ||
+	    (int32_t)(reass->expires - expiry_next) < 0) {
+		expiry_next = reass->expires;
+		expiry_pending = true;
+
+		k_delayed_work_submit(&expiry_timer, K_MSEC(timeout_ms));
+	}
+
+	return reass;
+}
+
+static void expiry_timeout(struct k_work *work)
+{
+	k_spinlock_key_t key;
+	int32_t left, next = 0;
+	uint32_t now;
+	int i;
+
+	ARG_UNUSED(work);
+
+	key = k_spin_lock(&lock);
+
+	now = k_uptime_get_32();
+	expiry_pending = false;
+
+	for (i = 0; i < ARRAY_SIZE(reassembly); i++) {
+		struct net_reass *reass = &reassembly[i];
+
+		if (!reass_in_use(reass)) {
+			continue;
+		}
+
+		left = (int32_t)(reass->expires - now);
+		if (left <= 0) {
+			NET_DBG("Reassembly id 0x%x timed out", reass->key.id);
+			reass_free(reass);
+			continue;
+		}
+
+		if (!expiry_pending || left < next) {
+			next = left;
+			expiry_pending = true;
+		}
+	}
+
+	if (expiry_pending) {
+		expiry_next = now + next;
+		k_delayed_work_submit(&expiry_timer, K_MSEC(next));
+	}
+
+	k_spin_unlock(&lock, key);
+}
+
+/* Detaches the payload of a fragment and releases the rest */
+static struct net_buf *pkt_payload_take(struct net_pkt *pkt, uint16_t hdr_len)
+{
+	struct net_buf *buf = pkt->buffer;
+
+	pkt->buffer = NULL;
+	net_pkt_unref(pkt);
+
+	while (buf && hdr_len >= buf->len) {
+		hdr_len -= buf->len;
+		buf = net_buf_frag_del(NULL, buf);
+	}
+
+	net_buf_pull(buf, hdr_len);
+
+	return buf;
+}
+
+/* Data of a range starting at offset 0 follows the headers of the first
+ * fragment.
+ */
+static struct net_buf *range_last(struct net_reass *reass, int idx)
+{
+	struct net_reass_range *range = &reass->ranges[idx];
+
+	return net_buf_frag_last(range->start ? range->buf :
+				 reass->pkt->buffer);
+}
+
+static void range_remove(struct net_reass *reass, int idx)
+{
+	reass->count--;
+
+	memmove(&reass->ranges[idx], &reass->ranges[idx + 1],
+		(reass->count - idx) * sizeof(reass->ranges[0]));
+}
+
+int net_reass_add(const struct net_reass_key *key, uint32_t timeout_ms,
+		  struct net_pkt *pkt, uint16_t hdr_len, uint16_t offset,
+		  bool more, struct net_pkt **done)
+{
+	struct net_reass_range *prev, *next;
+	struct net_reass *reass, *oldest;
+	k_spinlock_key_t lock_key;
+	struct net_buf *buf;
+	size_t len, end;
+	int i, ret;
+
+	len = net_pkt_get_len(pkt);
+	len = len > hdr_len ? len - hdr_len : 0;
+	end = offset + len;
+
+	/* Dropped before it can take, or evict, a reassembly */
+	if (!len || end > UINT16_MAX) {
+		return -EINVAL;
+	}
+
+	lock_key = k_spin_lock(&lock);
+
+	reass = reass_get(key, timeout_ms);
+
+	/* Only the last fragment knows the length of the datagram */
+	if (more ? (reass->len && end > reass->len) :
+	    ((reass->len && reass->len != end) ||
+	     (reass->count && reass->ranges[reass->count - 1].end > end))) {
+		NET_DBG("Fragment %u-%zu outside of id 0x%x", offset, end,
+			key->id);
+		ret = -EINVAL;
+		goto fail;
+	}
+
+	/* The fragment goes between prev and next */
+	for (i = 0; i < reass->count; i++) {
+		if (reass->ranges[i].start > offset) {
+			break;
+		}
+	}
+
+	prev = i > 0 ? &reass->ranges[i - 1] : NULL;
+	next = i < reass->count ? &reass->ranges[i] : NULL;
+
+	if (prev && prev->end > offset) {
+		if (prev->end >= end) {
+			/* Duplicate */
+			k_spin_unlock(&lock, lock_key);
+			net_pkt_unref(pkt);
+			return 0;
+		}
+
+		NET_DBG("Fragment %u-%zu overlaps in id 0x%x", offset, end,
+			key->id);
+		ret = -EINVAL;
+		goto fail;
+	}
+
+	if (next && next->start < end) {
+		NET_DBG("Fragment %u-%zu overlaps in id 0x%x", offset, end,
+			key->id);
+		ret = -EINVAL;
+		goto fail;
+	}
+
+	if ((!prev || prev->end != offset) && (!next || next->start != end) &&
+	    reass->count == ARRAY_SIZE(reass->ranges)) {
+		NET_DBG("Too many holes in id 0x%x", key->id);
+		ret = -ENOMEM;
+		goto fail;
+	}
+
+	/* Make room by giving up the oldest datagrams */
+	while (reass_mem + len > CONFIG_NET_REASSEMBLY_MEM) {
+		oldest = reass_oldest(reass);
+		if (!oldest) {
+			NET_DBG("No memory for id 0x%x", key->id);
+			ret = -ENOMEM;
+			goto fail;
+		}
+
+		NET_DBG("Out of memory, giving up id 0x%x", oldest->key.id);
+		reass_free(oldest);
+	}
+
+	if (offset) {
+		buf = pkt_payload_take(pkt, hdr_len);
+	} else {
+		reass->pkt = pkt;
+		buf = NULL;
+	}
+
+	if (prev && prev->end == offset) {
+		range_last(reass, i - 1)->frags = buf;
+		prev->end = end;
+
+		if (next && next->start == end) {
+			range_last(reass, i - 1)->frags = next->buf;
+			prev->end = next->end;
+
+			range_remove(reass, i);
+		}
+	} else if (next && next->start == end) {
+		net_buf_frag_last(offset ? buf : pkt->buffer)->frags =
+			next->buf;
+		next->buf = buf;
+		next->start = offset;
+	} else {
+		memmove(&reass->ranges[i + 1], &reass->ranges[i],
+			(reass->count - i) * sizeof(reass->ranges[0]));
+		reass->count++;
+
+		reass->ranges[i].buf = buf;
+		reass->ranges[i].start = offset;
+		reass->ranges[i].end = end;
+	}
+
+	reass->mem += len;
+	reass_mem += len;
+
+	if (!more) {
+		reass->len = end;
+	}
+
+	if (reass->count == 1U && reass->ranges[0].start == 0U &&
+	    reass->ranges[0].end == reass->len) {
+		NET_DBG("Reassembled id 0x%x, %u bytes", key->id, reass->len);
+
+		*done = reass->pkt;
+		reass->pkt = NULL;
+
+		reass_free(reass);
+
+		ret = 1;
+	} else {
+		ret = 0;
+	}
+
+	k_spin_unlock(&lock, lock_key);
+
+	return ret;
+
+fail:
+	reass_free(reass);
+
+	k_spin_unlock(&lock, lock_key);
+
+	return ret;
+}
+
+int32_t net_reass_remaining(struct net_reass *reass)
+{
+	int32_t left = (int32_t)(reass->expires - k_uptime_get_32());
+
+	return MAX(left, 0);
+}
+
+void net_reass_foreach(sa_family_t family, net_reass_cb_t cb,
+		       void *user_data)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(reassembly); i++) {
+		if (!reass_in_use(&reassembly[i]) ||
+		    reassembly[i].key.src.family != family) {
+			continue;
+		}
+
+		cb(&reassembly[i], user_data);
+	}
+}
@@ -0,0 +1,152 @@
+/** @file
+ * @brief IP fragment reassembly shared by IPv6 and IPv4
+ *
+ * This is not to be included by the application.
+ */
+
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __REASSEMBLY_H
+#define __REASSEMBLY_H
+
+#include <kernel.h>
+#include <sys/slist.h>
+
+#include <net/net_ip.h>
+#include <net/net_pkt.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Range of the original payload received so far.
+ *
+ * Contiguous ranges are merged, so their number only grows with the
+ * holes left by missing or reordered fragments.
+ */
+struct net_reass_range {
+	/** Payload of the range, the range starting at offset 0 keeps its
+	 *  payload after the headers in the first fragment instead.
+	 */
+	struct net_buf *buf;
+
+	/** Offset of the first byte of the range */
+	uint16_t start;
+
+	/** Offset after the last byte of the range */
+	uint16_t end;
+};
+
+/**
+ * @brief Identifies the fragments of a datagram (RFC 791, RFC 8200).
+ */
+struct net_reass_key {
+	/** Source address */
+	struct net_addr src;
+
+	/** Destination address */
+	struct net_addr dst;
+
+	/** Fragment identification */
+	uint32_t id;
+
+	/** Upper layer protocol, 0 for IPv6 */
+	uint8_t proto;
+};
+
+/**
+ * @brief Reassembly of one datagram.
+ */
+struct net_reass {
+	/** Link in the hash bucket of the key */
+	sys_snode_t node;
+
+	/** Fragments of this datagram */
+	struct net_reass_key key;
+
+	/** First fragment, with the headers that are kept */
+	struct net_pkt *pkt;
+
+	/** When the reassembly started, in ms of uptime */
+	uint32_t started;
+
+	/** When the reassembly is given up, in ms of uptime */
+	uint32_t expires;
+
+	/** Length of the payload, 0 until the last fragment is received */
+	uint16_t len;
+
+	/** Bytes of payload held */
+	uint16_t mem;
+
+	/** Number of ranges in use */
+	uint8_t count;
+
+	/** Received ranges, sorted by offset */
+	struct net_reass_range ranges[CONFIG_NET_REASSEMBLY_MAX_RANGES];
+};
+
+/**
+ * @typedef net_reass_cb_t
+ * @brief Callback used while iterating over pending reassemblies.
+ *
+ * @param reass Reassembly of one datagram
+ * @param user_data A valid pointer on some user data or NULL
+ */
+typedef void (*net_reass_cb_t)(struct net_reass *reass, void *user_data);
+
+/**
+ * @brief Add a fragment to the reassembly of its datagram.
+ *
+ * The reassembly is created if this is the first fragment received for
+ * the key. If the fragments held would go over the memory budget, the
+ * oldest other reassemblies are given up to make room.
+ *
+ * @param key Datagram the fragment belongs to
+ * @param timeout_ms How long to wait for the other fragments, only used
+ *        when the reassembly is created
+ * @param pkt Fragment
+ * @param hdr_len Length of the headers before the payload of the fragment
+ * @param offset Offset of the payload of the fragment in the datagram
+ * @param more Is this not the last fragment
+ * @param done The first fragment with the payload of all the fragments
+ *        appended, once the datagram is complete
+ *
+ * @return 1 if the datagram is complete, 0 if the fragment was taken and
+ *         more are needed, a negative errno if the fragment is invalid or
+ *         cannot be held. On error the fragment is not taken and the
+ *         reassembly of its datagram is given up.
+ */
+int net_reass_add(const struct net_reass_key *key, uint32_t timeout_ms,
+		  struct net_pkt *pkt, uint16_t hdr_len, uint16_t offset,
+		  bool more, struct net_pkt **done);
+
+/**
+ * @brief Time left before a reassembly is given up.
+ *
+ * @param reass Reassembly of one datagram
+ *
+ * @return Remaining time in ms
+ */
+int32_t net_reass_remaining(struct net_reass *reass);
+
+/**
+ * @brief Go through the pending reassemblies of an address family.
+ *
+ * @param family AF_INET or AF_INET6
+ * @param cb Callback to call for each pending reassembly
+ * @param user_data User specified data or NULL
+ */
+void net_reass_foreach(sa_family_t family, net_reass_cb_t cb,
+		       void *user_data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __REASSEMBLY_H */
@@ -28,6 +28,7 @@ LOG_MODULE_REGISTER(net_route, CONFIG_NET_ROUTE_LOG_LEVEL);
 #include "icmpv6.h"
 #include "nbr.h"
 #include "route.h"
+#include "fib.h"
 
 #if !defined(NET_ROUTE_EXTRA_DATA_SIZE)
 #define NET_ROUTE_EXTRA_DATA_SIZE 0
@@ -36,7 +37,13 @@ LOG_MODULE_REGISTER(net_route, CONFIG_NET_ROUTE_LOG_LEVEL);
 /* We keep track of the routes in a separate list so that we can remove
  * the oldest routes (at tail) if needed.
  */
-static sys_slist_t routes;
+static sys_dlist_t routes = SYS_DLIST_STATIC_INIT(&routes);
+
+/* The routes by prefix, for the longest prefix match lookups */
+NET_FIB_DEFINE(route_fib, sizeof(struct in6_addr), CONFIG_NET_MAX_ROUTES);
+
+/* Protects the lookup trie and the routes list */
+static struct k_spinlock lock;
 
 static void net_route_nexthop_remove(struct net_nbr *nbr)
 {
@@ -86,6 +93,12 @@ static struct net_nbr *get_nexthop_route(void)
 	return NULL;
 }
 
+static void put_nexthop_route(struct net_route_nexthop *nexthop_route)
+{
+	net_nbr_unref(CONTAINER_OF((uint8_t *)nexthop_route, struct net_nbr,
+				   __nbr));
+}
+
 static void net_route_entry_remove(struct net_nbr *nbr)
 {
 	NET_DBG("Route %p removed", nbr);
@@ -253,45 +266,86 @@ static int nbr_nexthop_put(struct net_nbr *nbr)
 /* Route was accessed, so place it in front of the routes list */
 static inline void update_route_access(struct net_route_entry *route)
 {
-	sys_slist_find_and_remove(&routes, &route->node);
-	sys_slist_prepend(&routes, &route->node);
+	sys_dlist_remove(&route->node);
+	sys_dlist_prepend(&routes, &route->node);
 }
 
-struct net_route_entry *net_route_lookup(struct net_if *iface,
-					 struct in6_addr *dst)
+/* Route of iface for the given prefix, NULL if none */
+static struct net_route_entry *route_get(struct net_if *iface,
+					 struct in6_addr *addr,
+					 uint8_t prefix_len)
 {
-	struct net_route_entry *route, *found = NULL;
-	uint8_t longest_match = 0U;
-	int i;
+	struct net_route_entry *route;
+	struct net_fib_node *fnode;
+	k_spinlock_key_t key;
 
-	for (i = 0; i < CONFIG_NET_MAX_ROUTES && longest_match < 128; i++) {
-		struct net_nbr *nbr = get_nbr(i);
+	key = k_spin_lock(&lock);
 
-		if (!nbr->ref) {
-			continue;
+	fnode = net_fib_get(&route_fib, addr->s6_addr, prefix_len);
+	if (fnode) {
+		SYS_SLIST_FOR_EACH_CONTAINER(&fnode->routes, route, fib_node) {
+			if (route->iface == iface) {
+				goto out;
+			}
 		}
+	}
 
-		if (iface && nbr->iface != iface) {
-			continue;
-		}
+	route = NULL;
+out:
+	k_spin_unlock(&lock, key);
 
-		route = net_route_data(nbr);
+	return route;
+}
+
+/* Must be called with the lock held */
+static struct net_route_entry *route_match(struct net_if *iface,
+					   struct in6_addr *dst)
+{
+	struct net_route_entry *route;
+	struct net_fib_node *fnode;
+	sys_snode_t *cached;
+
+	if (net_fib_cache_get(&route_fib, iface, dst->s6_addr, &cached)) {
+		return cached ? CONTAINER_OF(cached, struct net_route_entry,
+					     fib_node) : NULL;
+	}
 
-		if (route->prefix_len >= longest_match &&
-		    net_ipv6_is_prefix(dst->s6_addr,
-				       route->addr.s6_addr,
-				       route->prefix_len)) {
-			found = route;
-			longest_match = route->prefix_len;
+	for (fnode = net_fib_match(&route_fib, dst->s6_addr); fnode;
+	     fnode = net_fib_match_next(fnode)) {
+		SYS_SLIST_FOR_EACH_CONTAINER(&fnode->routes, route, fib_node) {
+			if (!iface || route->iface == iface) {
+				goto out;
+			}
 		}
 	}
 
-	if (found) {
-		net_route_info("Found", found, dst);
+	route = NULL;
+out:
+	net_fib_cache_set(&route_fib, iface, dst->s6_addr,
+			  route ? &route->fib_node : NULL);
 
+	return route;
+}
+
+struct net_route_entry *net_route_lookup(struct net_if *iface,
+					 struct in6_addr *dst)
+{
+	struct net_route_entry *found;
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&lock);
+
+	found = route_match(iface, dst);
+	if (found) {
 		update_route_access(found);
 	}
 
+	k_spin_unlock(&lock, key);
+
+	if (found) {
+		net_route_info("Found", found, dst);
+	}
+
 	return found;
 }
 
@@ -304,6 +358,8 @@ struct net_route_entry *net_route_add(struct net_if *iface,
 	struct net_nbr *nbr, *nbr_nexthop, *tmp;
 	struct net_route_nexthop *nexthop_route;
 	struct net_route_entry *route;
+	k_spinlock_key_t key;
+	int ret;
 #if defined(CONFIG_NET_MGMT_EVENT_INFO)
        struct net_event_ipv6_route info;
 #endif
@@ -333,7 +389,7 @@ struct net_route_entry *net_route_add(struct net_if *iface,
 		log_strdup(net_sprint_ll_addr(nexthop_lladdr->addr,
 					      nexthop_lladdr->len)));
 
-	route = net_route_lookup(iface, addr);
+	route = route_get(iface, addr, prefix_len);
 	if (route) {
 		/* Update nexthop if not the same */
 		struct in6_addr *nexthop_addr;
@@ -353,9 +409,7 @@ struct net_route_entry *net_route_add(struct net_if *iface,
 	nbr = nbr_new(iface, addr, prefix_len);
 	if (!nbr) {
 		/* Remove the oldest route and try again */
-		sys_snode_t *last = sys_slist_peek_tail(&routes);
-
-		sys_slist_find_and_remove(&routes, last);
+		sys_dnode_t *last = sys_dlist_peek_tail(&routes);
 
 		route = CONTAINER_OF(last,
 				     struct net_route_entry,
@@ -401,8 +455,6 @@ struct net_route_entry *net_route_add(struct net_if *iface,
 	route = net_route_data(nbr);
 	route->iface = iface;
 
-	sys_slist_prepend(&routes, &route->node);
-
 	tmp = nbr_nexthop_get(iface, nexthop);
 
 	NET_ASSERT(tmp == nbr_nexthop);
@@ -412,6 +464,19 @@ struct net_route_entry *net_route_add(struct net_if *iface,
 	sys_slist_init(&route->nexthop);
 	sys_slist_prepend(&route->nexthop, &nexthop_route->node);
 
+	key = k_spin_lock(&lock);
+
+	sys_dlist_prepend(&routes, &route->node);
+
+	/* The trie has room for all the routes */
+	ret = net_fib_insert(&route_fib, addr->s6_addr, prefix_len,
+			     &route->fib_node);
+	NET_ASSERT(ret == 0);
+
+	k_spin_unlock(&lock, key);
+
+	net_route_flow_flush();
+
 	net_route_info("Added", route, addr);
 
 #if defined(CONFIG_NET_MGMT_EVENT_INFO)
@@ -432,7 +497,8 @@ struct net_route_entry *net_route_add(struct net_if *iface,
 int net_route_del(struct net_route_entry *route)
 {
 	struct net_nbr *nbr;
-	struct net_route_nexthop *nexthop_route;
+	struct net_route_nexthop *nexthop_route, *next_route;
+	k_spinlock_key_t key;
 #if defined(CONFIG_NET_MGMT_EVENT_INFO)
        struct net_event_ipv6_route info;
 #endif
@@ -454,7 +520,17 @@ int net_route_del(struct net_route_entry *route)
 	net_mgmt_event_notify(NET_EVENT_IPV6_ROUTE_DEL, route->iface);
 #endif
 
-	sys_slist_find_and_remove(&routes, &route->node);
+	key = k_spin_lock(&lock);
+
+	if (sys_dnode_is_linked(&route->node)) {
+		sys_dlist_remove(&route->node);
+		(void)net_fib_remove(&route_fib, route->addr.s6_addr,
+				     route->prefix_len, &route->fib_node);
+	}
+
+	k_spin_unlock(&lock, key);
+
+	net_route_flow_flush();
 
 	nbr = net_route_get_nbr(route);
 	if (!nbr) {
@@ -463,12 +539,20 @@ int net_route_del(struct net_route_entry *route)
 
 	net_route_info("Deleted", route, &route->addr);
 
-	SYS_SLIST_FOR_EACH_CONTAINER(&route->nexthop, nexthop_route, node) {
-		if (!nexthop_route->nbr) {
+	/* The nexthop entry can be reused as soon as its reference is
+	 * dropped, so read it first.
+	 */
+	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&route->nexthop, nexthop_route,
+					  next_route, node) {
+		struct net_nbr *nbr_nexthop = nexthop_route->nbr;
+
+		put_nexthop_route(nexthop_route);
+
+		if (!nbr_nexthop) {
 			continue;
 		}
 
-		nbr_nexthop_put(nexthop_route->nbr);
+		nbr_nexthop_put(nbr_nexthop);
 	}
 
 	nbr_free(nbr);
@@ -821,17 +905,10 @@ bool net_route_get_info(struct net_if *iface,
 	return false;
 }
 
-int net_route_packet(struct net_pkt *pkt, struct in6_addr *nexthop)
+static int route_packet_nbr(struct net_pkt *pkt, struct net_nbr *nbr,
+			    struct in6_addr *nexthop)
 {
 	struct net_linkaddr_storage *lladdr;
-	struct net_nbr *nbr;
-
-	nbr = net_ipv6_nbr_lookup(NULL, nexthop);
-	if (!nbr) {
-		NET_DBG("Cannot find %s neighbor",
-			log_strdup(net_sprint_ipv6_addr(nexthop)));
-		return -ENOENT;
-	}
 
 	lladdr = net_nbr_get_lladdr(nbr->idx);
 	if (!lladdr) {
@@ -890,6 +967,20 @@ int net_route_packet(struct net_pkt *pkt, struct in6_addr *nexthop)
 	return net_send_data(pkt);
 }
 
+int net_route_packet(struct net_pkt *pkt, struct in6_addr *nexthop)
+{
+	struct net_nbr *nbr;
+
+	nbr = net_ipv6_nbr_lookup(NULL, nexthop);
+	if (!nbr) {
+		NET_DBG("Cannot find %s neighbor",
+			log_strdup(net_sprint_ipv6_addr(nexthop)));
+		return -ENOENT;
+	}
+
+	return route_packet_nbr(pkt, nbr, nexthop);
+}
+
 int net_route_packet_if(struct net_pkt *pkt, struct net_if *iface)
 {
 	/* The destination is reachable via iface. But since no valid nexthop
@@ -908,6 +999,105 @@ int net_route_packet_if(struct net_pkt *pkt, struct net_if *iface)
 	return net_send_data(pkt);
 }
 
+#if CONFIG_NET_ROUTE_FLOW_CACHE_SIZE > 0
+/* A forwarded flow and the neighbor it is sent to */
+struct route_flow {
+	struct net_if *iface;
+	struct net_nbr *nbr;
+	struct in6_addr src;
+	struct in6_addr dst;
+	struct in6_addr nexthop;
+};
+
+static struct route_flow flows[CONFIG_NET_ROUTE_FLOW_CACHE_SIZE];
+
+static struct route_flow *flow_get(struct net_if *iface,
+				   const struct in6_addr *src,
+				   const struct in6_addr *dst)
+{
+	uint32_t hash = (uint32_t)(uintptr_t)iface;
+	int i;
+
+	for (i = 0; i < sizeof(struct in6_addr) / sizeof(uint32_t); i++) {
+		hash ^= UNALIGNED_GET(&src->s6_addr32[i]);
+		hash = (hash ^ UNALIGNED_GET(&dst->s6_addr32[i])) * 0x9e3779b1U;
+	}
+
+	return &flows[(hash >> 16) % CONFIG_NET_ROUTE_FLOW_CACHE_SIZE];
+}
+
+void net_route_flow_add(struct net_if *iface, const struct in6_addr *src,
+			const struct in6_addr *dst, struct in6_addr *nexthop)
+{
+	struct route_flow *flow;
+	k_spinlock_key_t key;
+	struct net_nbr *nbr;
+
+	nbr = net_ipv6_nbr_lookup(NULL, nexthop);
+	if (!nbr || nbr->idx == NET_NBR_LLADDR_UNKNOWN) {
+		return;
+	}
+
+	key = k_spin_lock(&lock);
+
+	flow = flow_get(iface, src, dst);
+	flow->iface = iface;
+	flow->nbr = nbr;
+	net_ipaddr_copy(&flow->src, src);
+	net_ipaddr_copy(&flow->dst, dst);
+	net_ipaddr_copy(&flow->nexthop, nexthop);
+
+	k_spin_unlock(&lock, key);
+}
+
+int net_route_flow_packet(struct net_pkt *pkt, const struct in6_addr *src,
+			  const struct in6_addr *dst)
+{
+	struct net_if *iface = net_pkt_iface(pkt);
+	struct in6_addr nexthop;
+	struct route_flow *flow;
+	k_spinlock_key_t key;
+	struct net_nbr *nbr;
+
+	key = k_spin_lock(&lock);
+
+	flow = flow_get(iface, src, dst);
+	if (flow->iface != iface || !net_ipv6_addr_cmp(&flow->dst, dst) ||
+	    !net_ipv6_addr_cmp(&flow->src, src)) {
+		k_spin_unlock(&lock, key);
+		return -ENOENT;
+	}
+
+	nbr = flow->nbr;
+	net_ipaddr_copy(&nexthop, &flow->nexthop);
+
+	k_spin_unlock(&lock, key);
+
+	/* The neighbor entry may have been released or reused since the
+	 * flow was added.
+	 */
+	if (!nbr->ref || nbr->idx == NET_NBR_LLADDR_UNKNOWN ||
+	    !net_ipv6_addr_cmp(&net_ipv6_nbr_data(nbr)->addr, &nexthop)) {
+		return -ENOENT;
+	}
+
+	net_pkt_set_orig_iface(pkt, iface);
+
+	return route_packet_nbr(pkt, nbr, &nexthop);
+}
+
+void net_route_flow_flush(void)
+{
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&lock);
+
+	(void)memset(flows, 0, sizeof(flows));
+
+	k_spin_unlock(&lock, key);
+}
+#endif /* CONFIG_NET_ROUTE_FLOW_CACHE_SIZE > 0 */
+
 void net_route_init(void)
 {
 	NET_DBG("Allocated %d routing entries (%zu bytes)",
@@ -14,7 +14,9 @@
 #define __ROUTE_H
 
 #include <kernel.h>
+#include <errno.h>
 #include <sys/slist.h>
+#include <sys/dlist.h>
 
 #include <net/net_ip.h>
 
@@ -46,7 +48,10 @@ struct net_route_entry {
 	 * we can remove it if we run out of available routes.
 	 * The oldest one is the last entry in the list.
 	 */
-	sys_snode_t node;
+	sys_dnode_t node;
+
+	/** Node in the list of routes of the prefix in the lookup trie. */
+	sys_snode_t fib_node;
 
 	/** List of neighbors that the routes go through. */
 	sys_slist_t nexthop;
@@ -290,6 +295,150 @@ int net_route_packet(struct net_pkt *pkt, struct in6_addr *nexthop);
  */
 int net_route_packet_if(struct net_pkt *pkt, struct net_if *iface);
 
+#if CONFIG_NET_ROUTE_FLOW_CACHE_SIZE > 0
+/**
+ * @brief Remember the next hop of a forwarded flow.
+ *
+ * @param iface Network interface the flow is received from.
+ * @param src Source IPv6 address of the flow.
+ * @param dst Destination IPv6 address of the flow.
+ * @param nexthop Next hop neighbor IPv6 address.
+ */
+void net_route_flow_add(struct net_if *iface, const struct in6_addr *src,
+			const struct in6_addr *dst, struct in6_addr *nexthop);
+
+/**
+ * @brief Forward a packet to the cached next hop of its flow.
+ *
+ * @param pkt Received network packet that is not for us.
+ * @param src Source IPv6 address of the packet.
+ * @param dst Destination IPv6 address of the packet.
+ *
+ * @return 0 if the packet was sent, -ENOENT if the flow is not cached,
+ * other <0 value if the packet could not be sent.
+ */
+int net_route_flow_packet(struct net_pkt *pkt, const struct in6_addr *src,
+			  const struct in6_addr *dst);
+
+/**
+ * @brief Forget all the cached flows.
+ */
+void net_route_flow_flush(void);
+#else
+static inline void net_route_flow_add(struct net_if *iface,
+				      const struct in6_addr *src,
+				      const struct in6_addr *dst,
+				      struct in6_addr *nexthop)
+{
+	ARG_UNUSED(iface);
+	ARG_UNUSED(src);
+	ARG_UNUSED(dst);
+	ARG_UNUSED(nexthop);
+}
+
+static inline int net_route_flow_packet(struct net_pkt *pkt,
+					const struct in6_addr *src,
+					const struct in6_addr *dst)
+{
+	ARG_UNUSED(pkt);
+	ARG_UNUSED(src);
+	ARG_UNUSED(dst);
+
+	return -ENOENT;
+}
+
+static inline void net_route_flow_flush(void)
+{
+}
+#endif /* CONFIG_NET_ROUTE_FLOW_CACHE_SIZE > 0 */
+
+/**
+ * @brief IPv4 route entry.
+ */
+struct net_route_entry_ipv4 {
+	/** Node in the list of routes of the prefix in the lookup trie. */
+	sys_snode_t fib_node;
+
+	/** Network interface for the route, NULL if the entry is free. */
+	struct net_if *iface;
+
+	/** IPv4 address/prefix of the route. */
+	struct in_addr addr;
+
+	/** Gateway, unspecified if the prefix is reachable directly
+	 * through the interface.
+	 */
+	struct in_addr gw;
+
+	/** IPv4 address/prefix length. */
+	uint8_t prefix_len;
+};
+
+typedef void (*net_route_ipv4_cb_t)(struct net_route_entry_ipv4 *entry,
+				    void *user_data);
+
+#if defined(CONFIG_NET_ROUTE_IPV4)
+/**
+ * @brief Add a route to the IPv4 routing table. If the interface already
+ * has a route with the same prefix, its gateway is updated.
+ *
+ * @param iface Network interface that this route is tied to.
+ * @param addr IPv4 address.
+ * @param prefix_len Length of the IPv4 address/prefix.
+ * @param gw IPv4 address of the gateway, or unspecified address if the
+ * destinations are reachable directly through the interface.
+ *
+ * @return Return created route entry, NULL if the table is full.
+ */
+struct net_route_entry_ipv4 *net_route_ipv4_add(struct net_if *iface,
+						struct in_addr *addr,
+						uint8_t prefix_len,
+						struct in_addr *gw);
+
+/**
+ * @brief Delete a route from the IPv4 routing table.
+ *
+ * @param route Existing route entry.
+ *
+ * @return 0 if ok, <0 if error
+ */
+int net_route_ipv4_del(struct net_route_entry_ipv4 *route);
+
+/**
+ * @brief Lookup the IPv4 route with the longest prefix that matches
+ * a given destination.
+ *
+ * @param iface Network interface. If NULL, then check against all interfaces.
+ * @param dst Destination IPv4 address.
+ *
+ * @return Return route entry related to a given destination address, NULL
+ * if not found.
+ */
+struct net_route_entry_ipv4 *net_route_ipv4_lookup(struct net_if *iface,
+						   struct in_addr *dst);
+
+/**
+ * @brief Go through all the IPv4 routing entries and call callback
+ * for each entry that is in use.
+ *
+ * @param cb User supplied callback function to call.
+ * @param user_data User specified data.
+ *
+ * @return Total number of routing entries found.
+ */
+int net_route_ipv4_foreach(net_route_ipv4_cb_t cb, void *user_data);
+#else
+static inline
+struct net_route_entry_ipv4 *net_route_ipv4_lookup(struct net_if *iface,
+						   struct in_addr *dst)
+{
+	ARG_UNUSED(iface);
+	ARG_UNUSED(dst);
+
+	return NULL;
+}
+#endif /* CONFIG_NET_ROUTE_IPV4 */
+
 #if defined(CONFIG_NET_ROUTE) && defined(CONFIG_NET_NATIVE)
 void net_route_init(void);
 #else
@@ -0,0 +1,191 @@
+/** @file
+ * @brief IPv4 route handling.
+ */
+
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_route_ipv4, CONFIG_NET_ROUTE_LOG_LEVEL);
+
+#include <kernel.h>
+#include <string.h>
+#include <errno.h>
+
+#include <net/net_core.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+
+#include "net_private.h"
+#include "route.h"
+#include "fib.h"
+
+static struct net_route_entry_ipv4 routes[CONFIG_NET_MAX_IPV4_ROUTES];
+
+NET_FIB_DEFINE(route_fib, sizeof(struct in_addr), CONFIG_NET_MAX_IPV4_ROUTES);
+
+/* Protects the routes and the lookup trie */
+static struct k_spinlock lock;
+
+/* Must be called with the lock held */
+static struct net_route_entry_ipv4 *route_get(struct net_if *iface,
+					      struct in_addr *addr,
+					      uint8_t prefix_len)
+{
+	struct net_route_entry_ipv4 *route;
+	struct net_fib_node *fnode;
+
+	fnode = net_fib_get(&route_fib, addr->s4_addr, prefix_len);
+	if (!fnode) {
+		return NULL;
+	}
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&fnode->routes, route, fib_node) {
+		if (route->iface == iface) {
+			return route;
+		}
+	}
+
+	return NULL;
+}
+
+struct net_route_entry_ipv4 *net_route_ipv4_add(struct net_if *iface,
+						struct in_addr *addr,
+						uint8_t prefix_len,
+						struct in_addr *gw)
+{
+	struct net_route_entry_ipv4 *route;
+	k_spinlock_key_t key;
+	int i;
+
+	NET_ASSERT(iface);
+	NET_ASSERT(addr);
+	NET_ASSERT(gw);
+
+	if (prefix_len > 32) {
+		return NULL;
+	}
+
+	key = k_spin_lock(&lock);
+
+	route = route_get(iface, addr, prefix_len);
+	if (route) {
+		net_ipaddr_copy(&route->gw, gw);
+		goto out;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(routes); i++) {
+		if (!routes[i].iface) {
+			route = &routes[i];
+			break;
+		}
+	}
+
+	if (!route) {
+		NET_DBG("IPv4 routing table is full");
+		goto out;
+	}
+
+	route->iface = iface;
+	route->prefix_len = prefix_len;
+	net_ipaddr_copy(&route->addr, addr);
+	net_ipaddr_copy(&route->gw, gw);
+
+	/* The trie has room for all the routes */
+	i = net_fib_insert(&route_fib, addr->s4_addr, prefix_len,
+			   &route->fib_node);
+	NET_ASSERT(i == 0);
+
+out:
+	k_spin_unlock(&lock, key);
+
+	if (route) {
+		NET_DBG("Added route to %s/%d via %s (iface %p)",
+			log_strdup(net_sprint_ipv4_addr(addr)), prefix_len,
+			log_strdup(net_sprint_ipv4_addr(gw)), iface);
+	}
+
+	return route;
+}
+
+int net_route_ipv4_del(struct net_route_entry_ipv4 *route)
+{
+	k_spinlock_key_t key;
+	int ret;
+
+	if (!route) {
+		return -EINVAL;
+	}
+
+	key = k_spin_lock(&lock);
+
+	if (!route->iface) {
+		ret = -ENOENT;
+		goto out;
+	}
+
+	ret = net_fib_remove(&route_fib, route->addr.s4_addr,
+			     route->prefix_len, &route->fib_node);
+	route->iface = NULL;
+
+out:
+	k_spin_unlock(&lock, key);
+
+	return ret;
+}
+
+struct net_route_entry_ipv4 *net_route_ipv4_lookup(struct net_if *iface,
+						   struct in_addr *dst)
+{
+	struct net_route_entry_ipv4 *route;
+	struct net_fib_node *fnode;
+	k_spinlock_key_t key;
+	sys_snode_t *cached;
+
+	key = k_spin_lock(&lock);
+
+	if (net_fib_cache_get(&route_fib, iface, dst->s4_addr, &cached)) {
+		route = cached ? CONTAINER_OF(cached,
+					      struct net_route_entry_ipv4,
+					      fib_node) : NULL;
+		goto out;
+	}
+
+	for (fnode = net_fib_match(&route_fib, dst->s4_addr); fnode;
+	     fnode = net_fib_match_next(fnode)) {
+		SYS_SLIST_FOR_EACH_CONTAINER(&fnode->routes, route, fib_node) {
+			if (!iface || route->iface == iface) {
+				goto found;
+			}
+		}
+	}
+
+	route = NULL;
+found:
+	net_fib_cache_set(&route_fib, iface, dst->s4_addr,
+			  route ? &route->fib_node : NULL);
+out:
+	k_spin_unlock(&lock, key);
+
+	return route;
+}
+
+int net_route_ipv4_foreach(net_route_ipv4_cb_t cb, void *user_data)
+{
+	int i, ret = 0;
+
+	for (i = 0; i < ARRAY_SIZE(routes); i++) {
+		if (!routes[i].iface) {
+			continue;
+		}
+
+		cb(&routes[i], user_data);
+
+		ret++;
+	}
+
+	return ret;
+}
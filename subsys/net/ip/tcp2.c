@@ -37,13 +37,21 @@ static int tcp_window = NET_IPV6_MTU;
 
 static sys_slist_t tcp_conns = SYS_SLIST_STATIC_INIT(&tcp_conns);
 
+/* Connections with known endpoints, hashed by their 4-tuple */
+static sys_slist_t tcp_conn_hash[CONFIG_NET_CONN_HASH_SIZE];
+
 static K_MUTEX_DEFINE(tcp_lock);
 
 static K_MEM_SLAB_DEFINE(tcp_conns_slab, sizeof(struct tcp),
 				CONFIG_NET_MAX_CONTEXTS, 4);
 
-static struct k_work_q tcp_work_q;
-static K_KERNEL_STACK_DEFINE(work_q_stack, CONFIG_NET_TCP_WORKQ_STACK_SIZE);
+/* Connections are spread over the work queues at allocation, so that
+ * a connection's timers always run on the same queue.
+ */
+static struct k_work_q tcp_work_q[CONFIG_NET_TCP_WORKQ_COUNT];
+static K_KERNEL_STACK_ARRAY_DEFINE(work_q_stack, CONFIG_NET_TCP_WORKQ_COUNT,
+				   CONFIG_NET_TCP_WORKQ_STACK_SIZE);
+static unsigned int tcp_work_q_next;
 
 static void tcp_in(struct tcp *conn, struct net_pkt *pkt);
 
@@ -352,38 +360,68 @@ static void tcp_send_queue_flush(struct tcp *conn)
 	}
 }
 
-#if CONFIG_NET_TCP_LOG_LEVEL >= LOG_LEVEL_DBG
-#define tcp_conn_unref(conn)				\
-	tcp_conn_unref_debug(conn, __func__, __LINE__)
-
-static int tcp_conn_unref_debug(struct tcp *conn, const char *caller, int line)
-#else
-static int tcp_conn_unref(struct tcp *conn)
-#endif
+static sys_slist_t *tcp_conn_bucket(union tcp_endpoint *src,
+				    union tcp_endpoint *dst)
 {
-	int ref_count = atomic_get(&conn->ref_count);
-	struct net_pkt *pkt;
+	uint32_t hash;
 
-#if CONFIG_NET_TCP_LOG_LEVEL >= LOG_LEVEL_DBG
-	NET_DBG("conn: %p, ref_count=%d (%s():%d)", conn, ref_count,
-		caller, line);
-#endif
+	if (dst->sa.sa_family == AF_INET6) {
+		hash = net_conn_hash(AF_INET6, &dst->sin6.sin6_addr,
+				     dst->sin6.sin6_port, src->sin6.sin6_port);
+	} else {
+		hash = net_conn_hash(AF_INET, &dst->sin.sin_addr,
+				     dst->sin.sin_port, src->sin.sin_port);
+	}
 
-#if !defined(CONFIG_NET_TEST_PROTOCOL)
-	if (conn->in_connect) {
-		NET_DBG("conn: %p is waiting on connect semaphore", conn);
-		tcp_send_queue_flush(conn);
-		goto out;
+	return &tcp_conn_hash[hash % ARRAY_SIZE(tcp_conn_hash)];
+}
+
+static void tcp_conn_hash_del(struct tcp *conn)
+{
+	if (conn->hash_list) {
+		sys_slist_find_and_remove(conn->hash_list, &conn->hash_next);
+		conn->hash_list = NULL;
 	}
-#endif /* CONFIG_NET_TEST_PROTOCOL */
+}
 
+/* To be called once the connection endpoints are known */
+static void tcp_conn_hash_add(struct tcp *conn)
+{
+	k_mutex_lock(&tcp_lock, K_FOREVER);
+
+	tcp_conn_hash_del(conn);
+
+	conn->hash_list = tcp_conn_bucket(&conn->src, &conn->dst);
+	sys_slist_prepend(conn->hash_list, &conn->hash_next);
+
+	k_mutex_unlock(&tcp_lock);
+}
+
+/* Drops a reference, the last one tears the connection down */
+static int tcp_conn_release(struct tcp *conn)
+{
+	struct net_pkt *pkt;
+	int ref_count;
+
+	/* The global lock only covers the connection tables. Lookups take
+	 * their reference under it, so once the connection is unlinked
+	 * nobody else can find it, and the rest of the teardown does not
+	 * need to hold up other connections.
+	 */
 	k_mutex_lock(&tcp_lock, K_FOREVER);
 
 	ref_count = atomic_dec(&conn->ref_count) - 1;
+	if (ref_count == 0) {
+		tcp_conn_hash_del(conn);
+		sys_slist_find_and_remove(&tcp_conns, &conn->next);
+	}
+
+	k_mutex_unlock(&tcp_lock);
+
 	if (ref_count) {
 		tp_out(net_context_get_family(conn->context), conn->iface,
 		       "TP_TRACE", "event", "CONN_DELETE");
-		goto unlock;
+		goto out;
 	}
 
 	/* If there is any pending data, pass that to application */
@@ -404,7 +442,7 @@ static int tcp_conn_unref(struct tcp *conn)
 
 	if (conn->context->recv_cb) {
 		conn->context->recv_cb(conn->context, NULL, NULL, NULL,
-					-ECONNRESET, conn->recv_user_data);
+					conn->close_err, conn->recv_user_data);
 	}
 
 	conn->context->tcp = NULL;
@@ -423,18 +461,38 @@ static int tcp_conn_unref(struct tcp *conn)
 	k_delayed_work_cancel(&conn->timewait_timer);
 	k_delayed_work_cancel(&conn->fin_timer);
 
-	sys_slist_find_and_remove(&tcp_conns, &conn->next);
-
 	memset(conn, 0, sizeof(*conn));
 
 	k_mem_slab_free(&tcp_conns_slab, (void **)&conn);
-
-unlock:
-	k_mutex_unlock(&tcp_lock);
 out:
 	return ref_count;
 }
 
+#if CONFIG_NET_TCP_LOG_LEVEL >= LOG_LEVEL_DBG
+#define tcp_conn_unref(conn)				\
+	tcp_conn_unref_debug(conn, __func__, __LINE__)
+
+static int tcp_conn_unref_debug(struct tcp *conn, const char *caller, int line)
+#else
+static int tcp_conn_unref(struct tcp *conn)
+#endif
+{
+#if CONFIG_NET_TCP_LOG_LEVEL >= LOG_LEVEL_DBG
+	NET_DBG("conn: %p, ref_count=%d (%s():%d)", conn,
+		(int)atomic_get(&conn->ref_count), caller, line);
+#endif
+
+#if !defined(CONFIG_NET_TEST_PROTOCOL)
+	if (conn->in_connect) {
+		NET_DBG("conn: %p is waiting on connect semaphore", conn);
+		tcp_send_queue_flush(conn);
+		return atomic_get(&conn->ref_count);
+	}
+#endif /* CONFIG_NET_TEST_PROTOCOL */
+
+	return tcp_conn_release(conn);
+}
+
 int net_tcp_unref(struct net_context *context)
 {
 	int ref_count = 0;
@@ -471,6 +529,7 @@ static bool tcp_send_process_no_lock(struct tcp *conn)
 				conn->send_retries--;
 			}
 		} else {
+			conn->close_err = -ETIMEDOUT;
 			unref = true;
 			goto out;
 		}
@@ -497,7 +556,7 @@ static bool tcp_send_process_no_lock(struct tcp *conn)
 	}
 
 	if (conn->in_retransmission) {
-		k_delayed_work_submit_to_queue(&tcp_work_q, &conn->send_timer,
+		k_delayed_work_submit_to_queue(conn->work_q, &conn->send_timer,
 					       K_MSEC(tcp_rto));
 	}
 
@@ -542,7 +601,7 @@ static void tcp_send_timer_cancel(struct tcp *conn)
 		conn->in_retransmission = false;
 	} else {
 		conn->send_retries = tcp_retries;
-		k_delayed_work_submit_to_queue(&tcp_work_q, &conn->send_timer,
+		k_delayed_work_submit_to_queue(conn->work_q, &conn->send_timer,
 					       K_MSEC(tcp_rto));
 	}
 }
@@ -613,8 +672,10 @@ static bool tcp_options_check(struct tcp_options *recv_options,
 
 	NET_DBG("len=%zd", len);
 
-	recv_options->mss_found = false;
-	recv_options->wnd_found = false;
+	/* MSS, window scale and SACK permitted are only sent on SYN, so
+	 * only the SACK blocks are cleared for each segment.
+	 */
+	recv_options->sack_count = 0U;
 
 	for ( ; options && len >= 1; options += opt_len, len -= opt_len) {
 		opt = options[0];
@@ -661,6 +722,37 @@ static bool tcp_options_check(struct tcp_options *recv_options,
 			recv_options->window = opt;
 			recv_options->wnd_found = true;
 			break;
+		case TCPOPT_SACK_PERM:
+			if (opt_len != TCPOLEN_SACK_PERM) {
+				result = false;
+				goto end;
+			}
+
+			recv_options->sack_perm_found = true;
+			break;
+		case TCPOPT_SACK: {
+			int i, count = (opt_len - 2) / TCPOLEN_SACK_BLOCK;
+
+			if ((opt_len - 2) % TCPOLEN_SACK_BLOCK || count == 0 ||
+			    count > TCP_SACK_BLOCKS_MAX) {
+				result = false;
+				goto end;
+			}
+
+			for (i = 0; i < count; i++) {
+				uint8_t *block = options + 2 +
+					i * TCPOLEN_SACK_BLOCK;
+
+				recv_options->sack[i].start =
+					ntohl(UNALIGNED_GET((uint32_t *)block));
+				recv_options->sack[i].end =
+					ntohl(UNALIGNED_GET((uint32_t *)
+							    (block + 4)));
+			}
+
+			recv_options->sack_count = count;
+			break;
+		}
 		default:
 			continue;
 		}
@@ -755,11 +847,55 @@ static int tcp_finalize_pkt(struct net_pkt *pkt)
 	return -EINVAL;
 }
 
+/* Options are only put on segments without data so that the segment
+ * size does not need to account for them.
+ */
+static size_t tcp_options_build(struct tcp *conn, uint8_t flags,
+				bool has_data, uint8_t *options)
+{
+	size_t len = 0;
+
+	if (!IS_ENABLED(CONFIG_NET_TCP_SACK) || (flags & RST)) {
+		return 0;
+	}
+
+	if (flags & SYN) {
+		/* A SYN-ACK may only offer SACK if the SYN did */
+		if (!(flags & ACK) || conn->sack_ok) {
+			options[len++] = TCPOPT_NOP;
+			options[len++] = TCPOPT_NOP;
+			options[len++] = TCPOPT_SACK_PERM;
+			options[len++] = TCPOLEN_SACK_PERM;
+		}
+	} else if ((flags & ACK) && !has_data && conn->sack_ok &&
+		   CONFIG_NET_TCP_RECV_QUEUE_TIMEOUT &&
+		   !net_pkt_is_empty(conn->queue_recv_data)) {
+		/* Report the out-of-order data held in the receive queue,
+		 * it is always a single block.
+		 */
+		uint32_t start = tcp_get_seq(conn->queue_recv_data->buffer);
+		uint32_t end = start + net_pkt_get_len(conn->queue_recv_data);
+
+		options[len++] = TCPOPT_NOP;
+		options[len++] = TCPOPT_NOP;
+		options[len++] = TCPOPT_SACK;
+		options[len++] = 2 + TCPOLEN_SACK_BLOCK;
+		UNALIGNED_PUT(htonl(start), (uint32_t *)(options + len));
+		len += sizeof(uint32_t);
+		UNALIGNED_PUT(htonl(end), (uint32_t *)(options + len));
+		len += sizeof(uint32_t);
+	}
+
+	return len;
+}
+
 static int tcp_header_add(struct tcp *conn, struct net_pkt *pkt, uint8_t flags,
-			  uint32_t seq)
+			  uint32_t seq, const uint8_t *options,
+			  size_t options_len)
 {
 	NET_PKT_DATA_ACCESS_DEFINE(tcp_access, struct tcphdr);
 	struct tcphdr *th;
+	int ret;
 
 	th = (struct tcphdr *)net_pkt_get_data(pkt, &tcp_access);
 	if (!th) {
@@ -770,7 +906,7 @@ static int tcp_header_add(struct tcp *conn, struct net_pkt *pkt, uint8_t flags,
 
 	UNALIGNED_PUT(conn->src.sin.sin_port, &th->th_sport);
 	UNALIGNED_PUT(conn->dst.sin.sin_port, &th->th_dport);
-	th->th_off = 5;
+	th->th_off = 5 + options_len / 4;
 	UNALIGNED_PUT(flags, &th->th_flags);
 	UNALIGNED_PUT(htons(conn->recv_win), &th->th_win);
 	UNALIGNED_PUT(htonl(seq), &th->th_seq);
@@ -779,7 +915,12 @@ static int tcp_header_add(struct tcp *conn, struct net_pkt *pkt, uint8_t flags,
 		UNALIGNED_PUT(htonl(conn->ack), &th->th_ack);
 	}
 
-	return net_pkt_set_data(pkt, &tcp_access);
+	ret = net_pkt_set_data(pkt, &tcp_access);
+	if (ret < 0 || options_len == 0) {
+		return ret;
+	}
+
+	return net_pkt_write(pkt, options, options_len);
 }
 
 static int ip_header_add(struct tcp *conn, struct net_pkt *pkt)
@@ -802,10 +943,14 @@ static int ip_header_add(struct tcp *conn, struct net_pkt *pkt)
 static int tcp_out_ext(struct tcp *conn, uint8_t flags, struct net_pkt *data,
 		       uint32_t seq)
 {
+	uint8_t options[40]; /* TCP header max options size is 40 */
+	size_t options_len;
 	struct net_pkt *pkt;
 	int ret = 0;
 
-	pkt = tcp_pkt_alloc(conn, sizeof(struct tcphdr));
+	options_len = tcp_options_build(conn, flags, data != NULL, options);
+
+	pkt = tcp_pkt_alloc(conn, sizeof(struct tcphdr) + options_len);
 	if (!pkt) {
 		ret = -ENOBUFS;
 		goto out;
@@ -814,6 +959,7 @@ static int tcp_out_ext(struct tcp *conn, uint8_t flags, struct net_pkt *data,
 	if (data) {
 		/* Append the data buffer to the pkt */
 		net_pkt_append_buffer(pkt, data->buffer);
+		net_pkt_set_gso_size(pkt, net_pkt_gso_size(data));
 		data->buffer = NULL;
 	}
 
@@ -823,7 +969,7 @@ static int tcp_out_ext(struct tcp *conn, uint8_t flags, struct net_pkt *data,
 		goto out;
 	}
 
-	ret = tcp_header_add(conn, pkt, flags, seq);
+	ret = tcp_header_add(conn, pkt, flags, seq, options, options_len);
 	if (ret < 0) {
 		tcp_pkt_unref(pkt);
 		goto out;
@@ -888,9 +1034,17 @@ static int tcp_pkt_peek(struct net_pkt *to, struct net_pkt *from, size_t pos,
 	return net_pkt_copy(to, from, len);
 }
 
+/* The sender may have the smaller of the receiver's window and the
+ * congestion window in flight.
+ */
+static int tcp_send_window(struct tcp *conn)
+{
+	return (int)MIN((uint32_t)conn->send_win, conn->cwnd);
+}
+
 static bool tcp_window_full(struct tcp *conn)
 {
-	bool window_full = !(conn->unacked_len < conn->send_win);
+	bool window_full = !(conn->unacked_len < tcp_send_window(conn));
 
 	NET_DBG("conn: %p window_full=%hu", conn, window_full);
 
@@ -915,18 +1069,49 @@ static int tcp_unsent_len(struct tcp *conn)
 	return unsent_len;
 }
 
-static int tcp_send_data(struct tcp *conn)
+#if defined(CONFIG_NET_TCP_GSO)
+/* The data of several segments, cut to segments only at the L2 */
+static struct net_pkt *tcp_gso_pkt_alloc(struct tcp *conn, int len)
 {
-	int ret = 0;
-	int pos, len;
 	struct net_pkt *pkt;
 
-	pos = conn->unacked_len;
-	len = MIN3(conn->send_data_total - conn->unacked_len,
-		   conn->send_win - conn->unacked_len,
-		   conn_mss(conn));
+	pkt = tcp_pkt_alloc(conn, 0);
+	if (!pkt) {
+		return NULL;
+	}
+
+	net_pkt_set_gso_size(pkt, conn_mss(conn));
+
+	if (net_pkt_alloc_buffer(pkt, len, IPPROTO_TCP,
+				 TCP_PKT_ALLOC_TIMEOUT) < 0) {
+		tcp_pkt_unref(pkt);
+		return NULL;
+	}
+
+	return pkt;
+}
+
+static int tcp_send_max(struct tcp *conn)
+{
+	return MAX(CONFIG_NET_TCP_GSO_MAX_SIZE, conn_mss(conn));
+}
+#else
+#define tcp_gso_pkt_alloc(_conn, _len) NULL
+#define tcp_send_max(_conn) conn_mss(_conn)
+#endif /* CONFIG_NET_TCP_GSO */
+
+/* Send len bytes from offset pos of send_data */
+static int tcp_send_segment(struct tcp *conn, int pos, int len, bool resend)
+{
+	struct net_pkt *pkt;
+	int ret;
+
+	if (IS_ENABLED(CONFIG_NET_TCP_GSO) && len > conn_mss(conn)) {
+		pkt = tcp_gso_pkt_alloc(conn, len);
+	} else {
+		pkt = tcp_pkt_alloc(conn, len);
+	}
 
-	pkt = tcp_pkt_alloc(conn, len);
 	if (!pkt) {
 		NET_ERR("conn: %p packet allocation failed, len=%d", conn, len);
 		ret = -ENOBUFS;
@@ -940,11 +1125,9 @@ static int tcp_send_data(struct tcp *conn)
 		goto out;
 	}
 
-	ret = tcp_out_ext(conn, PSH | ACK, pkt, conn->seq + conn->unacked_len);
+	ret = tcp_out_ext(conn, PSH | ACK, pkt, conn->seq + pos);
 	if (ret == 0) {
-		conn->unacked_len += len;
-
-		if (conn->data_mode == TCP_DATA_MODE_RESEND) {
+		if (resend) {
 			net_stats_update_tcp_resent(conn->iface, len);
 			net_stats_update_tcp_seg_rexmit(conn->iface);
 		} else {
@@ -958,10 +1141,27 @@ static int tcp_send_data(struct tcp *conn)
 	 * the packet anyway.
 	 */
 	tcp_pkt_unref(pkt);
+ out:
+	return ret;
+}
+
+static int tcp_send_data(struct tcp *conn)
+{
+	int ret;
+	int len;
+
+	len = MIN3(conn->send_data_total - conn->unacked_len,
+		   tcp_send_window(conn) - conn->unacked_len,
+		   tcp_send_max(conn));
+
+	ret = tcp_send_segment(conn, conn->unacked_len, len,
+			       conn->data_mode == TCP_DATA_MODE_RESEND);
+	if (ret == 0) {
+		conn->unacked_len += len;
+	}
 
 	conn_send_data_dump(conn);
 
- out:
 	return ret;
 }
 
@@ -1007,7 +1207,7 @@ static int tcp_send_queued_data(struct tcp *conn)
 
 	if (subscribe) {
 		conn->send_data_retries = 0;
-		k_delayed_work_submit_to_queue(&tcp_work_q,
+		k_delayed_work_submit_to_queue(conn->work_q,
 					       &conn->send_data_timer,
 					       K_MSEC(tcp_rto));
 	}
@@ -1015,6 +1215,248 @@ static int tcp_send_queued_data(struct tcp *conn)
 	return ret;
 }
 
+/* Add a SACKed range to the scoreboard, keeping it sorted and merging
+ * the blocks it overlaps or touches.
+ */
+static void tcp_sack_insert(struct tcp *conn, uint32_t start, uint32_t end)
+{
+	struct tcp_sack_block *sb = conn->sacked;
+	int i = 0;
+
+	while (i < conn->sacked_count) {
+		if (net_tcp_seq_cmp(end, sb[i].start) < 0 ||
+		    net_tcp_seq_cmp(start, sb[i].end) > 0) {
+			i++;
+			continue;
+		}
+
+		if (net_tcp_seq_cmp(sb[i].start, start) < 0) {
+			start = sb[i].start;
+		}
+
+		if (net_tcp_seq_cmp(sb[i].end, end) > 0) {
+			end = sb[i].end;
+		}
+
+		conn->sacked_count--;
+		memmove(&sb[i], &sb[i + 1],
+			(conn->sacked_count - i) * sizeof(*sb));
+	}
+
+	for (i = 0; i < conn->sacked_count; i++) {
+		if (net_tcp_seq_cmp(start, sb[i].start) < 0) {
+			break;
+		}
+	}
+
+	if (conn->sacked_count == ARRAY_SIZE(conn->sacked)) {
+		/* Forget the highest block, losing it can at most cause a
+		 * needless retransmission.
+		 */
+		if (i == conn->sacked_count) {
+			return;
+		}
+
+		conn->sacked_count--;
+	}
+
+	memmove(&sb[i + 1], &sb[i], (conn->sacked_count - i) * sizeof(*sb));
+	sb[i].start = start;
+	sb[i].end = end;
+	conn->sacked_count++;
+}
+
+/* Merge the SACK blocks of the received segment into the scoreboard */
+static void tcp_sack_update(struct tcp *conn)
+{
+	uint32_t snd_nxt = conn->seq + conn->unacked_len;
+	int i;
+
+	if (!conn->sack_ok || conn->data_mode == TCP_DATA_MODE_RESEND) {
+		return;
+	}
+
+	for (i = 0; i < conn->recv_options.sack_count; i++) {
+		uint32_t start = conn->recv_options.sack[i].start;
+		uint32_t end = conn->recv_options.sack[i].end;
+
+		/* Ignore reports of acknowledged or never sent data */
+		if (net_tcp_seq_cmp(end, conn->seq) <= 0 ||
+		    net_tcp_seq_cmp(end, snd_nxt) > 0 ||
+		    net_tcp_seq_cmp(start, end) >= 0) {
+			continue;
+		}
+
+		if (net_tcp_seq_cmp(start, conn->seq) < 0) {
+			start = conn->seq;
+		}
+
+		tcp_sack_insert(conn, start, end);
+	}
+}
+
+/* Drop what the cumulative ACK now covers from the scoreboard */
+static void tcp_sack_trim(struct tcp *conn)
+{
+	while (conn->sacked_count &&
+	       net_tcp_seq_cmp(conn->sacked[0].end, conn->seq) <= 0) {
+		conn->sacked_count--;
+		memmove(&conn->sacked[0], &conn->sacked[1],
+			conn->sacked_count * sizeof(conn->sacked[0]));
+	}
+
+	if (conn->sacked_count &&
+	    net_tcp_seq_cmp(conn->sacked[0].start, conn->seq) < 0) {
+		conn->sacked[0].start = conn->seq;
+	}
+}
+
+/* Find the next range to retransmit in loss recovery. Without SACK
+ * information only the first unacknowledged segment is known to be
+ * lost, with it every gap below the highest SACKed byte is.
+ */
+static bool tcp_next_hole(struct tcp *conn, uint32_t *seq, int *len)
+{
+	uint32_t start = conn->rexmit_next;
+	uint32_t end;
+	int i;
+
+	if (net_tcp_seq_cmp(start, conn->seq) < 0) {
+		start = conn->seq;
+	}
+
+	if (conn->sacked_count == 0) {
+		if (start != conn->seq) {
+			return false;
+		}
+
+		end = conn->seq + conn->unacked_len;
+	} else {
+		for (i = 0; i < conn->sacked_count; i++) {
+			if (net_tcp_seq_cmp(start, conn->sacked[i].start) < 0) {
+				break;
+			}
+
+			if (net_tcp_seq_cmp(start, conn->sacked[i].end) < 0) {
+				start = conn->sacked[i].end;
+			}
+		}
+
+		if (i == conn->sacked_count) {
+			return false;
+		}
+
+		end = conn->sacked[i].start;
+	}
+
+	*seq = start;
+	*len = MIN((int)(end - start), (int)conn_mss(conn));
+
+	return *len > 0;
+}
+
+static void tcp_retransmit_hole(struct tcp *conn)
+{
+	uint32_t seq;
+	int len;
+
+	if (!tcp_next_hole(conn, &seq, &len)) {
+		return;
+	}
+
+	NET_DBG("conn: %p retransmit seq %u len %d", conn, seq, len);
+
+	if (tcp_send_segment(conn, seq - conn->seq, len, true) == 0) {
+		conn->rexmit_next = seq + len;
+	}
+}
+
+static bool tcp_is_dup_ack(struct tcp *conn, struct tcphdr *th, size_t len,
+			   uint16_t prev_send_win)
+{
+	/* RFC 5681 chapter 2: no data, no window update and the ACK
+	 * does not move while there is data in flight.
+	 */
+	return conn->data_mode == TCP_DATA_MODE_SEND &&
+		conn->unacked_len > 0 && len == 0 &&
+		th_ack(th) == conn->seq &&
+		conn->send_win == prev_send_win &&
+		(th_flags(th) & (SYN | FIN | RST | ACK)) == ACK;
+}
+
+/* Fast retransmit on the third duplicate ACK, then fast recovery
+ * (RFC 5681, RFC 6582, and RFC 6675 when SACK is in use).
+ */
+static void tcp_dup_ack(struct tcp *conn)
+{
+	if (conn->in_recovery) {
+		/* Each duplicate ACK means a segment has left the network */
+		conn->cwnd += conn_mss(conn);
+		tcp_retransmit_hole(conn);
+		return;
+	}
+
+	if (++conn->dup_acks < TCP_DUP_ACK_THRESHOLD) {
+		return;
+	}
+
+	/* Do not react again to the losses of a window that is already
+	 * being recovered after a timeout.
+	 */
+	if (net_tcp_seq_cmp(conn->seq, conn->recover) <= 0) {
+		return;
+	}
+
+	NET_DBG("conn: %p fast retransmit seq %u", conn, conn->seq);
+	net_stats_update_tcp_fast_rexmit(conn->iface);
+
+	tcp_cc_loss(conn);
+
+	conn->recover = conn->seq + conn->unacked_len - 1;
+	conn->rexmit_next = conn->seq;
+	conn->in_recovery = true;
+
+	tcp_retransmit_hole(conn);
+}
+
+/* The cumulative ACK moved forward by acked bytes */
+static void tcp_new_ack(struct tcp *conn, uint32_t acked)
+{
+	uint16_t mss = conn_mss(conn);
+
+	conn->dup_acks = 0U;
+	tcp_sack_trim(conn);
+
+	if (!conn->in_recovery) {
+		tcp_cc_ack(conn, acked);
+		return;
+	}
+
+	if (net_tcp_seq_cmp(conn->seq, conn->recover) > 0) {
+		/* Full acknowledgment, deflate the window */
+		conn->cwnd = MIN(conn->ssthresh,
+				 (uint32_t)MAX(conn->unacked_len, 0) + mss);
+		conn->in_recovery = false;
+		return;
+	}
+
+	/* Partial acknowledgment, the next hole is lost too. Deflate the
+	 * window by the amount acknowledged, but let one new segment out.
+	 */
+	conn->cwnd -= MIN(conn->cwnd, acked);
+	if (acked >= mss) {
+		conn->cwnd += mss;
+	}
+
+	conn->cwnd = MAX(conn->cwnd, mss);
+
+	if (conn->sacked_count == 0) {
+		conn->rexmit_next = conn->seq;
+	}
+
+	tcp_retransmit_hole(conn);
+}
+
 static void tcp_cleanup_recv_queue(struct k_work *work)
 {
 	struct tcp *conn = CONTAINER_OF(work, struct tcp, recv_queue_timer);
@@ -1043,10 +1485,23 @@ static void tcp_resend_data(struct k_work *work)
 
 	if (conn->send_data_retries >= tcp_retries) {
 		NET_DBG("conn: %p close, data retransmissions exceeded", conn);
+		conn->close_err = -ETIMEDOUT;
 		conn_unref = true;
 		goto out;
 	}
 
+	/* Only the first timeout of the data in flight reduces the window,
+	 * the data is then resent from snd_una on in slow start.
+	 */
+	if (conn->data_mode == TCP_DATA_MODE_SEND && conn->unacked_len > 0) {
+		tcp_cc_timeout(conn);
+		conn->recover = conn->seq + conn->unacked_len - 1;
+	}
+
+	conn->in_recovery = false;
+	conn->dup_acks = 0U;
+	conn->sacked_count = 0U;
+
 	conn->data_mode = TCP_DATA_MODE_RESEND;
 	conn->unacked_len = 0;
 
@@ -1058,7 +1513,7 @@ static void tcp_resend_data(struct k_work *work)
 			NET_DBG("TCP connection in active close, "
 				"not disposing yet (waiting %dms)",
 				FIN_TIMEOUT_MS);
-			k_delayed_work_submit_to_queue(&tcp_work_q,
+			k_delayed_work_submit_to_queue(conn->work_q,
 						       &conn->fin_timer,
 						       FIN_TIMEOUT);
 
@@ -1074,7 +1529,7 @@ static void tcp_resend_data(struct k_work *work)
 		}
 	}
 
-	k_delayed_work_submit_to_queue(&tcp_work_q, &conn->send_data_timer,
+	k_delayed_work_submit_to_queue(conn->work_q, &conn->send_data_timer,
 				       K_MSEC(tcp_rto));
 
  out:
@@ -1177,7 +1632,13 @@ static struct tcp *tcp_conn_alloc(void)
 
 	tcp_conn_ref(conn);
 
+	k_mutex_lock(&tcp_lock, K_FOREVER);
+
+	conn->work_q = &tcp_work_q[tcp_work_q_next++ %
+				   ARRAY_SIZE(tcp_work_q)];
 	sys_slist_append(&tcp_conns, &conn->next);
+
+	k_mutex_unlock(&tcp_lock);
 out:
 	NET_DBG("conn: %p", conn);
 
@@ -1195,59 +1656,52 @@ fail:
 
 int net_tcp_get(struct net_context *context)
 {
-	int ret = 0;
 	struct tcp *conn;
 
-	k_mutex_lock(&tcp_lock, K_FOREVER);
-
 	conn = tcp_conn_alloc();
 	if (conn == NULL) {
-		ret = -ENOMEM;
-		goto out;
+		return -ENOMEM;
 	}
 
 	/* Mutually link the net_context and tcp connection */
 	conn->context = context;
 	context->tcp = conn;
-out:
-	k_mutex_unlock(&tcp_lock);
-
-	return ret;
-}
-
-static bool tcp_endpoint_cmp(union tcp_endpoint *ep, struct net_pkt *pkt,
-			     enum pkt_addr which)
-{
-	union tcp_endpoint ep_tmp;
 
-	if (tcp_endpoint_set(&ep_tmp, pkt, which) < 0) {
-		return false;
-	}
-
-	return !memcmp(ep, &ep_tmp, tcp_endpoint_len(ep->sa.sa_family));
+	return 0;
 }
 
-static bool tcp_conn_cmp(struct tcp *conn, struct net_pkt *pkt)
+static bool tcp_endpoint_cmp(union tcp_endpoint *ep, union tcp_endpoint *ep2)
 {
-	return tcp_endpoint_cmp(&conn->src, pkt, TCP_EP_DST) &&
-		tcp_endpoint_cmp(&conn->dst, pkt, TCP_EP_SRC);
+	return !memcmp(ep, ep2, tcp_endpoint_len(ep->sa.sa_family));
 }
 
 static struct tcp *tcp_conn_search(struct net_pkt *pkt)
 {
-	bool found = false;
+	union tcp_endpoint src, dst;
+	struct tcp *found = NULL;
 	struct tcp *conn;
-	struct tcp *tmp;
 
-	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&tcp_conns, conn, tmp, next) {
+	/* Our source is the packet's destination and vice versa */
+	if (tcp_endpoint_set(&src, pkt, TCP_EP_DST) < 0 ||
+	    tcp_endpoint_set(&dst, pkt, TCP_EP_SRC) < 0) {
+		return NULL;
+	}
 
-		found = tcp_conn_cmp(conn, pkt);
-		if (found) {
+	k_mutex_lock(&tcp_lock, K_FOREVER);
+
+	SYS_SLIST_FOR_EACH_CONTAINER(tcp_conn_bucket(&src, &dst), conn,
+				     hash_next) {
+		if (tcp_endpoint_cmp(&conn->src, &src) &&
+		    tcp_endpoint_cmp(&conn->dst, &dst)) {
+			found = conn;
+			tcp_conn_ref(found);
 			break;
 		}
 	}
 
-	return found ? conn : NULL;
+	k_mutex_unlock(&tcp_lock);
+
+	return found;
 }
 
 static struct tcp *tcp_conn_new(struct net_pkt *pkt);
@@ -1266,7 +1720,10 @@ static enum net_verdict tcp_recv(struct net_conn *net_conn,
 
 	conn = tcp_conn_search(pkt);
 	if (conn) {
-		goto in;
+		tcp_in(conn, pkt);
+		/* Reference taken by tcp_conn_search() */
+		tcp_conn_release(conn);
+		return NET_DROP;
 	}
 
 	th = th_get(pkt);
@@ -1424,6 +1881,8 @@ static struct tcp *tcp_conn_new(struct net_pkt *pkt)
 		goto err;
 	}
 
+	tcp_conn_hash_add(conn);
+
 	NET_DBG("conn: src: %s, dst: %s",
 		log_strdup(net_sprint_addr(conn->src.sa.sa_family,
 				(const void *)&conn->src.sin.sin_addr)),
@@ -1582,7 +2041,7 @@ static void tcp_queue_recv_data(struct tcp *conn, struct net_pkt *pkt,
 		pkt->buffer = NULL;
 
 		if (!k_delayed_work_pending(&conn->recv_queue_timer)) {
-			k_delayed_work_submit_to_queue(&tcp_work_q,
+			k_delayed_work_submit_to_queue(conn->work_q,
 						       &conn->recv_queue_timer,
 						       K_MSEC(CONFIG_NET_TCP_RECV_QUEUE_TIMEOUT));
 		}
@@ -1628,6 +2087,7 @@ static void tcp_in(struct tcp *conn, struct net_pkt *pkt)
 	bool do_close = false;
 	size_t tcp_options_len = th ? (th_off(th) - 5) * 4 : 0;
 	struct net_conn *conn_handler = NULL;
+	uint16_t prev_send_win = 0U;
 	struct net_pkt *recv_pkt;
 	void *recv_user_data;
 	struct k_fifo *recv_data_fifo;
@@ -1645,6 +2105,7 @@ static void tcp_in(struct tcp *conn, struct net_pkt *pkt)
 
 	if (th && th_off(th) < 5) {
 		tcp_out(conn, RST);
+		conn->close_err = -ECONNABORTED;
 		conn_state(conn, TCP_CLOSED);
 		goto next_state;
 	}
@@ -1658,6 +2119,7 @@ static void tcp_in(struct tcp *conn, struct net_pkt *pkt)
 		}
 
 		net_stats_update_tcp_seg_rst(net_pkt_iface(pkt));
+		conn->close_err = -ECONNRESET;
 		conn_state(conn, TCP_CLOSED);
 		goto next_state;
 	}
@@ -1666,13 +2128,20 @@ static void tcp_in(struct tcp *conn, struct net_pkt *pkt)
 						  tcp_options_len)) {
 		NET_DBG("DROP: Invalid TCP option list");
 		tcp_out(conn, RST);
+		conn->close_err = -ECONNABORTED;
 		conn_state(conn, TCP_CLOSED);
 		goto next_state;
 	}
 
+	if (th && (th_flags(th) & SYN)) {
+		conn->sack_ok = IS_ENABLED(CONFIG_NET_TCP_SACK) &&
+			tcp_options_len && conn->recv_options.sack_perm_found;
+	}
+
 	if (th) {
 		size_t max_win;
 
+		prev_send_win = conn->send_win;
 		conn->send_win = ntohs(th_win(th));
 
 #if defined(CONFIG_NET_TCP_MAX_SEND_WINDOW_SIZE)
@@ -1710,7 +2179,7 @@ next_state:
 
 			/* Close the connection if we do not receive ACK on time.
 			 */
-			k_delayed_work_submit_to_queue(&tcp_work_q,
+			k_delayed_work_submit_to_queue(conn->work_q,
 						       &conn->establish_timer,
 						       ACK_TIMEOUT);
 		} else {
@@ -1724,6 +2193,7 @@ next_state:
 				th_seq(th) == conn->ack)) {
 			k_delayed_work_cancel(&conn->establish_timer);
 			tcp_send_timer_cancel(conn);
+			tcp_cc_init(conn);
 			next = TCP_ESTABLISHED;
 			net_context_set_state(conn->context,
 					      NET_CONTEXT_CONNECTED);
@@ -1764,6 +2234,7 @@ next_state:
 				conn_ack(conn, + len);
 			}
 			k_sem_give(&conn->connect_sem);
+			tcp_cc_init(conn);
 			next = TCP_ESTABLISHED;
 			net_context_set_state(conn->context,
 					      NET_CONTEXT_CONNECTED);
@@ -1802,6 +2273,10 @@ next_state:
 			break;
 		}
 
+		if (th && tcp_options_len && conn->recv_options.sack_count) {
+			tcp_sack_update(conn);
+		}
+
 		if (th && net_tcp_seq_cmp(th_ack(th), conn->seq) > 0) {
 			uint32_t len_acked = th_ack(th) - conn->seq;
 
@@ -1815,6 +2290,7 @@ next_state:
 					conn->send_data_total);
 				net_stats_update_tcp_seg_drop(conn->iface);
 				tcp_out(conn, RST);
+				conn->close_err = -ECONNABORTED;
 				conn_state(conn, TCP_CLOSED);
 				break;
 			}
@@ -1824,6 +2300,8 @@ next_state:
 			conn_seq(conn, + len_acked);
 			net_stats_update_tcp_seg_recv(conn->iface);
 
+			tcp_new_ack(conn, len_acked);
+
 			conn_send_data_dump(conn);
 
 			if (!k_delayed_work_remaining_get(&conn->send_data_timer)) {
@@ -1851,9 +2329,23 @@ next_state:
 			ret = tcp_send_queued_data(conn);
 			if (ret < 0 && ret != -ENOBUFS) {
 				tcp_out(conn, RST);
+				conn->close_err = -ECONNABORTED;
 				conn_state(conn, TCP_CLOSED);
 				break;
 			}
+		} else if (th && tcp_is_dup_ack(conn, th, len, prev_send_win)) {
+			tcp_dup_ack(conn);
+
+			/* The inflated window may let new data out */
+			if (conn->in_recovery) {
+				ret = tcp_send_queued_data(conn);
+				if (ret < 0 && ret != -ENOBUFS) {
+					tcp_out(conn, RST);
+					conn->close_err = -ECONNABORTED;
+					conn_state(conn, TCP_CLOSED);
+					break;
+				}
+			}
 		}
 
 		if (th && len) {
@@ -1865,9 +2357,16 @@ next_state:
 				tcp_out(conn, ACK); /* peer has resent */
 
 				net_stats_update_tcp_seg_ackerr(conn->iface);
-			} else if (CONFIG_NET_TCP_RECV_QUEUE_TIMEOUT) {
-				tcp_out_of_order_data(conn, pkt, len,
-						      th_seq(th));
+			} else {
+				if (CONFIG_NET_TCP_RECV_QUEUE_TIMEOUT) {
+					tcp_out_of_order_data(conn, pkt, len,
+							      th_seq(th));
+				}
+
+				/* Duplicate ACK for the hole, it lets the peer
+				 * fast retransmit (RFC 5681 chapter 4.2).
+				 */
+				tcp_out(conn, ACK);
 			}
 		}
 		break;
@@ -1918,7 +2417,7 @@ next_state:
 		}
 		break;
 	case TCP_TIME_WAIT:
-		k_delayed_work_submit_to_queue(&tcp_work_q,
+		k_delayed_work_submit_to_queue(conn->work_q,
 					       &conn->timewait_timer,
 					       K_MSEC(CONFIG_NET_TCP_TIME_WAIT_DELAY));
 		break;
@@ -1996,7 +2495,7 @@ int net_tcp_put(struct net_context *context)
 
 			/* How long to wait until all the data has been sent?
 			 */
-			k_delayed_work_submit_to_queue(&tcp_work_q,
+			k_delayed_work_submit_to_queue(conn->work_q,
 						       &conn->send_data_timer,
 						       K_MSEC(tcp_rto));
 		} else {
@@ -2004,7 +2503,7 @@ int net_tcp_put(struct net_context *context)
 
 			NET_DBG("TCP connection in active close, not "
 				"disposing yet (waiting %dms)", FIN_TIMEOUT_MS);
-			k_delayed_work_submit_to_queue(&tcp_work_q,
+			k_delayed_work_submit_to_queue(conn->work_q,
 						       &conn->fin_timer,
 						       FIN_TIMEOUT);
 
@@ -2060,7 +2559,11 @@ int net_tcp_queue_data(struct net_context *context, struct net_pkt *pkt)
 
 	k_mutex_lock(&conn->lock, K_FOREVER);
 
-	if (tcp_window_full(conn)) {
+	/* After a retransmission timeout unacked_len starts over from zero,
+	 * so bound the queued data too, or it would drain the buffer pools.
+	 */
+	if (tcp_window_full(conn) ||
+	    conn->send_data_total >= (size_t)tcp_send_window(conn)) {
 		/* Trigger resend if the timer is not active */
 		/* TODO: use k_work_delayable for send_data_timer so we don't
 		 * have to directly access the internals of the legacy object.
@@ -2084,7 +2587,7 @@ int net_tcp_queue_data(struct net_context *context, struct net_pkt *pkt)
 		 * conn is embedded, and calling that function directly here
 		 * and in the work handler.
 		 */
-		(void)k_work_schedule_for_queue(&tcp_work_q,
+		(void)k_work_schedule_for_queue(conn->work_q,
 						&conn->send_data_timer.work, K_NO_WAIT);
 
 		ret = -EAGAIN;
@@ -2218,6 +2721,10 @@ int net_tcp_connect(struct net_context *context,
 		ret = -EPROTONOSUPPORT;
 	}
 
+	if (ret == 0) {
+		tcp_conn_hash_add(conn);
+	}
+
 	if (!(IS_ENABLED(CONFIG_NET_TEST_PROTOCOL) ||
 	      IS_ENABLED(CONFIG_NET_TEST))) {
 		conn->seq = tcp_init_isn(&conn->src.sa, &conn->dst.sa);
@@ -2367,20 +2874,106 @@ int net_tcp_finalize(struct net_pkt *pkt)
 
 	tcp_hdr->chksum = 0U;
 
-	if (net_if_need_calc_tx_checksum(net_pkt_iface(pkt))) {
+	/* The segments of a segmentation offload packet get their own */
+	if (net_if_need_calc_tx_checksum(net_pkt_iface(pkt)) &&
+	    !net_pkt_gso_size(pkt)) {
 		tcp_hdr->chksum = net_calc_chksum_tcp(pkt);
 	}
 
 	return net_pkt_set_data(pkt, &tcp_access);
 }
 
+#if defined(CONFIG_NET_TCP_GSO)
+int net_tcp_gso_segment(struct net_pkt *pkt, size_t *offset,
+			struct net_pkt **seg)
+{
+	size_t ip_len = net_pkt_ip_hdr_len(pkt) + net_pkt_ip_opts_len(pkt);
+	size_t hdr_len, len;
+	struct net_pkt *s;
+	struct tcphdr *th;
+
+	th = th_get(pkt);
+	if (!th) {
+		return -ENOBUFS;
+	}
+
+	hdr_len = ip_len + th_off(th) * 4U;
+
+	if (hdr_len + *offset >= net_pkt_get_len(pkt)) {
+		return 0;
+	}
+
+	len = MIN(net_pkt_gso_size(pkt),
+		  net_pkt_get_len(pkt) - hdr_len - *offset);
+
+	s = net_pkt_alloc_with_buffer(net_pkt_iface(pkt), hdr_len + len,
+				      AF_UNSPEC, 0, TCP_PKT_ALLOC_TIMEOUT);
+	if (!s) {
+		return -ENOBUFS;
+	}
+
+	net_pkt_set_family(s, net_pkt_family(pkt));
+	net_pkt_set_context(s, net_pkt_context(pkt));
+	net_pkt_set_ip_hdr_len(s, net_pkt_ip_hdr_len(pkt));
+	net_pkt_set_vlan_tag(s, net_pkt_vlan_tag(pkt));
+	net_pkt_set_priority(s, net_pkt_priority(pkt));
+	*net_pkt_lladdr_src(s) = *net_pkt_lladdr_src(pkt);
+	*net_pkt_lladdr_dst(s) = *net_pkt_lladdr_dst(pkt);
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) && net_pkt_family(pkt) == AF_INET) {
+		net_pkt_set_ipv4_opts_len(s, net_pkt_ipv4_opts_len(pkt));
+	} else if (IS_ENABLED(CONFIG_NET_IPV6) &&
+		   net_pkt_family(pkt) == AF_INET6) {
+		net_pkt_set_ipv6_ext_len(s, net_pkt_ipv6_ext_len(pkt));
+	}
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_cursor_init(s);
+
+	if (net_pkt_copy(s, pkt, hdr_len) < 0 ||
+	    net_pkt_skip(pkt, *offset) < 0 ||
+	    net_pkt_copy(s, pkt, len) < 0) {
+		goto fail;
+	}
+
+	th = th_get(s);
+	if (!th) {
+		goto fail;
+	}
+
+	UNALIGNED_PUT(htonl(th_seq(th) + *offset), &th->th_seq);
+
+	/* Push only once all of the data is out */
+	if (hdr_len + *offset + len < net_pkt_get_len(pkt)) {
+		th->th_flags &= ~PSH;
+	}
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) && net_pkt_family(s) == AF_INET) {
+		NET_IPV4_HDR(s)->chksum = 0U;
+	}
+
+	if (tcp_finalize_pkt(s) < 0) {
+		goto fail;
+	}
+
+	*offset += len;
+	*seg = s;
+
+	return len;
+fail:
+	net_pkt_unref(s);
+
+	return -ENOBUFS;
+}
+#endif /* CONFIG_NET_TCP_GSO */
+
 struct net_tcp_hdr *net_tcp_input(struct net_pkt *pkt,
 				  struct net_pkt_data_access *tcp_access)
 {
 	struct net_tcp_hdr *tcp_hdr;
 
 	if (IS_ENABLED(CONFIG_NET_TCP_CHECKSUM) &&
-			net_if_need_calc_rx_checksum(net_pkt_iface(pkt)) &&
+			net_pkt_need_calc_rx_checksum(pkt) &&
 			net_calc_chksum_tcp(pkt) != 0U) {
 		NET_DBG("DROP: checksum mismatch");
 		goto drop;
@@ -2407,6 +3000,7 @@ static enum net_verdict tcp_input(struct net_conn *net_conn,
 
 	if (th) {
 		struct tcp *conn = tcp_conn_search(pkt);
+		struct tcp *found = conn;
 
 		if (conn == NULL && SYN == th_flags(th)) {
 			struct net_context *context =
@@ -2416,6 +3010,7 @@ static enum net_verdict tcp_input(struct net_conn *net_conn,
 			conn = context->tcp;
 			tcp_endpoint_set(&conn->dst, pkt, TCP_EP_SRC);
 			tcp_endpoint_set(&conn->src, pkt, TCP_EP_DST);
+			tcp_conn_hash_add(conn);
 			/* Make an extra reference, the sanity check suite
 			 * will delete the connection explicitly
 			 */
@@ -2426,6 +3021,10 @@ static enum net_verdict tcp_input(struct net_conn *net_conn,
 			conn->iface = pkt->iface;
 			tcp_in(conn, pkt);
 		}
+
+		if (found) {
+			tcp_conn_release(found);
+		}
 	}
 
 	return NET_DROP;
@@ -2486,7 +3085,7 @@ enum net_verdict tp_input(struct net_conn *net_conn,
 {
 	struct net_udp_hdr *uh = net_udp_get_hdr(pkt, NULL);
 	size_t data_len = ntohs(uh->len) - sizeof(*uh);
-	struct tcp *conn = tcp_conn_search(pkt);
+	struct tcp *conn;
 	size_t json_len = 0;
 	struct tp *tp;
 	struct tp_new *tp_new;
@@ -2569,6 +3168,7 @@ enum net_verdict tp_input(struct net_conn *net_conn,
 			char hexstr[HEXSTR_SIZE];
 			ssize_t len = tp_tcp_recv(0, buf, sizeof(buf), 0);
 
+			conn = (void *)sys_slist_peek_head(&tcp_conns);
 			tp_init(conn, tp);
 			bin2hex(buf, len, hexstr, HEXSTR_SIZE);
 			tp->data = hexstr;
@@ -2706,6 +3306,22 @@ uint16_t net_tcp_get_recv_mss(const struct tcp *conn)
 	return 0;
 }
 
+/* The segment size is bounded by the peer's MSS and by the MTU of the
+ * interface the segments leave from.
+ */
+uint16_t conn_mss(struct tcp *conn)
+{
+	uint16_t mss = conn->recv_options.mss_found ?
+		conn->recv_options.mss : (uint16_t)NET_IPV6_MTU;
+	uint16_t local_mss = net_tcp_get_recv_mss(conn);
+
+	if (local_mss > 0 && local_mss < mss) {
+		mss = local_mss;
+	}
+
+	return mss;
+}
+
 const char *net_tcp_state_str(enum tcp_state state)
 {
 	return tcp_state_to_str(state, false);
@@ -2723,6 +3339,20 @@ void net_tcp_init(void)
 	tcp_recv_cb = tp_tcp_recv_cb;
 #endif
 
+#if defined(CONFIG_NET_TCP_MAX_RECV_WINDOW_SIZE)
+	if (CONFIG_NET_TCP_MAX_RECV_WINDOW_SIZE) {
+		tcp_window = CONFIG_NET_TCP_MAX_RECV_WINDOW_SIZE;
+	} else
+#endif
+	{
+		/* Same as the send window, leave room for the other
+		 * connections and the packets in flight.
+		 */
+		tcp_window = MAX((CONFIG_NET_BUF_RX_COUNT *
+				  CONFIG_NET_BUF_DATA_SIZE) / 3,
+				 NET_IPV6_MTU);
+	}
+
 #if IS_ENABLED(CONFIG_NET_TC_THREAD_COOPERATIVE)
 /* Lowest priority cooperative thread */
 #define THREAD_PRIORITY K_PRIO_COOP(CONFIG_NUM_COOP_PRIORITIES - 1)
@@ -2730,12 +3360,25 @@ void net_tcp_init(void)
 #define THREAD_PRIORITY K_PRIO_PREEMPT(CONFIG_NUM_PREEMPT_PRIORITIES - 1)
 #endif
 
-	/* Use private workqueue in order not to block the system work queue.
+	/* Use private workqueues in order not to block the system work queue.
 	 */
-	k_work_q_start(&tcp_work_q, work_q_stack,
-		       K_KERNEL_STACK_SIZEOF(work_q_stack),
-		       THREAD_PRIORITY);
+	for (int i = 0; i < ARRAY_SIZE(tcp_work_q); i++) {
+		k_work_q_start(&tcp_work_q[i], work_q_stack[i],
+			       K_KERNEL_STACK_SIZEOF(work_q_stack[i]),
+			       THREAD_PRIORITY);
+
+		if (IS_ENABLED(CONFIG_THREAD_NAME)) {
+			char name[] = "tcp_work0";
 
-	k_thread_name_set(&tcp_work_q.thread, "tcp_work");
-	NET_DBG("Workq started. Thread ID: %p", &tcp_work_q.thread);
+			if (ARRAY_SIZE(tcp_work_q) > 1) {
+				name[sizeof(name) - 2] += i;
+			} else {
+				name[sizeof(name) - 2] = '\0';
+			}
+
+			k_thread_name_set(&tcp_work_q[i].thread, name);
+		}
+
+		NET_DBG("Workq started. Thread ID: %p", &tcp_work_q[i].thread);
+	}
 }
@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* TCP congestion control: the window arithmetic of slow start, fast
+ * recovery and retransmission timeout, and the algorithms deciding on
+ * the growth in congestion avoidance. Loss detection is done in tcp2.c.
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_tcp, CONFIG_NET_TCP_LOG_LEVEL);
+
+#include <zephyr.h>
+#include <net/net_pkt.h>
+#include <net/net_context.h>
+#include "tcp2_priv.h"
+
+/* Without window scaling the peer cannot use a larger window anyway */
+#define TCP_CWND_MAX UINT16_MAX
+
+#if defined(CONFIG_NET_TCP_CC_NEWRENO)
+static void newreno_init(struct tcp *conn)
+{
+	ARG_UNUSED(conn);
+}
+
+/* One segment per window's worth of acknowledged data (RFC 3465) */
+static void newreno_cong_avoid(struct tcp *conn, uint32_t acked)
+{
+	conn->cwnd_acked += acked;
+
+	if (conn->cwnd_acked >= conn->cwnd) {
+		conn->cwnd_acked -= conn->cwnd;
+		conn->cwnd += conn_mss(conn);
+	}
+}
+
+static uint32_t newreno_ssthresh(struct tcp *conn)
+{
+	uint32_t flight = MAX(conn->unacked_len, 0);
+
+	return MAX(flight / 2U, 2U * conn_mss(conn));
+}
+
+static const struct tcp_cc_ops tcp_cc_newreno = {
+	.name = "newreno",
+	.init = newreno_init,
+	.cong_avoid = newreno_cong_avoid,
+	.ssthresh = newreno_ssthresh,
+};
+
+#define TCP_CC_DEFAULT (&tcp_cc_newreno)
+#endif /* CONFIG_NET_TCP_CC_NEWRENO */
+
+#if defined(CONFIG_NET_TCP_CC_CUBIC)
+/* RFC 8312 constants, C = 0.4 and beta = 0.7 */
+#define CUBIC_C_DIV	10U
+#define CUBIC_C_MUL	4U
+#define CUBIC_BETA	7U /* in tenths */
+
+/* Clamp for the time since the plateau (ms) so that the cube fits */
+#define CUBIC_MAX_DELTA	100000
+
+static uint32_t cubic_root(uint64_t a)
+{
+	uint64_t x = 0;
+	int s;
+
+	for (s = 63; s >= 0; s -= 3) {
+		uint64_t b;
+
+		x <<= 1;
+		b = 3 * x * (x + 1) + 1;
+
+		if ((a >> s) >= b) {
+			a -= b << s;
+			x++;
+		}
+	}
+
+	return (uint32_t)x;
+}
+
+static void cubic_init(struct tcp *conn)
+{
+	memset(&conn->cubic, 0, sizeof(conn->cubic));
+}
+
+static void cubic_epoch_start(struct tcp *conn, int64_t now)
+{
+	struct tcp_cc_cubic *c = &conn->cubic;
+	uint16_t mss = conn_mss(conn);
+
+	c->epoch_start = now;
+
+	if (conn->cwnd < c->w_max) {
+		/* K = cbrt((W_max - cwnd) / C), W in segments and K in
+		 * seconds, so scale by 10^9 to get K in ms.
+		 */
+		c->k = cubic_root(((uint64_t)(c->w_max - conn->cwnd) *
+				   CUBIC_C_DIV * 1000000000ULL) /
+				  ((uint64_t)CUBIC_C_MUL * mss));
+		c->origin = c->w_max;
+	} else {
+		c->k = 0U;
+		c->origin = conn->cwnd;
+	}
+}
+
+/* W(t) = C * (t - K)^3 + W_max. The RTT is not measured so the target
+ * is taken at t instead of t + RTT, and a Reno-like increase serves as
+ * the lower bound instead of the TCP-friendly estimate.
+ */
+static void cubic_cong_avoid(struct tcp *conn, uint32_t acked)
+{
+	struct tcp_cc_cubic *c = &conn->cubic;
+	int64_t now = k_uptime_get();
+	int64_t delta, offset, target;
+	uint32_t inc = 0U;
+
+	if (c->epoch_start == 0) {
+		cubic_epoch_start(conn, now);
+	}
+
+	delta = (now - c->epoch_start) - c->k;
+	delta = CLAMP(delta, -CUBIC_MAX_DELTA, CUBIC_MAX_DELTA);
+
+	offset = (CUBIC_C_MUL * delta * delta * delta / 10000) *
+		 conn_mss(conn) / (CUBIC_C_DIV * 100000LL);
+	target = CLAMP((int64_t)c->origin + offset, 0, TCP_CWND_MAX);
+
+	if (target > conn->cwnd) {
+		inc = (uint32_t)(((uint64_t)(target - conn->cwnd) * acked) /
+				 conn->cwnd);
+	}
+
+	conn->cwnd_acked += acked;
+
+	if (conn->cwnd_acked >= conn->cwnd) {
+		conn->cwnd_acked -= conn->cwnd;
+		inc = MAX(inc, conn_mss(conn));
+	}
+
+	conn->cwnd += inc;
+}
+
+static uint32_t cubic_ssthresh(struct tcp *conn)
+{
+	struct tcp_cc_cubic *c = &conn->cubic;
+
+	c->epoch_start = 0;
+
+	/* Fast convergence: if the window did not get back to the last
+	 * maximum, another flow is competing, so leave it some room.
+	 */
+	if (conn->cwnd < c->w_max) {
+		c->w_max = conn->cwnd * (10U + CUBIC_BETA) / 20U;
+	} else {
+		c->w_max = conn->cwnd;
+	}
+
+	return MAX(conn->cwnd * CUBIC_BETA / 10U, 2U * conn_mss(conn));
+}
+
+static const struct tcp_cc_ops tcp_cc_cubic = {
+	.name = "cubic",
+	.init = cubic_init,
+	.cong_avoid = cubic_cong_avoid,
+	.ssthresh = cubic_ssthresh,
+};
+
+#define TCP_CC_DEFAULT (&tcp_cc_cubic)
+#endif /* CONFIG_NET_TCP_CC_CUBIC */
+
+/* Called when the connection gets established, after the MSS is known */
+void tcp_cc_init(struct tcp *conn)
+{
+	uint16_t mss = conn_mss(conn);
+
+	conn->cc = TCP_CC_DEFAULT;
+
+	/* Initial window of RFC 3390, in whole segments */
+	conn->cwnd = (mss > 2190U ? 2U : (mss > 1095U ? 3U : 4U)) * mss;
+	conn->ssthresh = UINT32_MAX;
+	conn->cwnd_acked = 0U;
+
+	/* RFC 6582: recover starts at the initial send sequence number */
+	conn->recover = conn->seq - 1;
+
+	conn->cc->init(conn);
+
+	NET_DBG("conn: %p %s cwnd=%u", conn, conn->cc->name, conn->cwnd);
+}
+
+/* New data was acknowledged outside of loss recovery */
+void tcp_cc_ack(struct tcp *conn, uint32_t acked)
+{
+	if (conn->cwnd < conn->ssthresh) {
+		/* Slow start, at most one segment per ACK (RFC 5681) */
+		conn->cwnd += MIN(acked, conn_mss(conn));
+	} else {
+		conn->cc->cong_avoid(conn, acked);
+	}
+
+	conn->cwnd = MIN(conn->cwnd, TCP_CWND_MAX);
+}
+
+/* Fast retransmit, the window is inflated by the segments that have
+ * left the network, i.e. the ones that triggered the duplicate ACKs.
+ */
+void tcp_cc_loss(struct tcp *conn)
+{
+	conn->ssthresh = conn->cc->ssthresh(conn);
+	conn->cwnd = conn->ssthresh + TCP_DUP_ACK_THRESHOLD * conn_mss(conn);
+	conn->cwnd_acked = 0U;
+
+	NET_DBG("conn: %p cwnd=%u ssthresh=%u", conn, conn->cwnd,
+		conn->ssthresh);
+}
+
+/* Retransmission timeout, restart from the loss window of one segment */
+void tcp_cc_timeout(struct tcp *conn)
+{
+	conn->ssthresh = conn->cc->ssthresh(conn);
+	conn->cwnd = conn_mss(conn);
+	conn->cwnd_acked = 0U;
+
+	NET_DBG("conn: %p cwnd=%u ssthresh=%u", conn, conn->cwnd,
+		conn->ssthresh);
+}
@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* TCP receive offload: the in-order data segments of a connection that
+ * are waiting together in a RX traffic class queue are merged into one
+ * packet, so TCP and the application handle the burst at once. The
+ * segments are appended as buffer fragments, the data is not copied.
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_tcp, CONFIG_NET_TCP_LOG_LEVEL);
+
+#include <zephyr.h>
+#include <net/net_core.h>
+#include <net/net_pkt.h>
+#include <net/net_stats.h>
+#include "net_private.h"
+#include "connection.h"
+#include "net_stats.h"
+#include "tcp_internal.h"
+
+/* The merged packet has to fit the IP length fields */
+#define TCP_GRO_MAX_LEN (UINT16_MAX - NET_IPV6H_LEN)
+
+struct tcp_gro {
+	/* Packets submitted to the queue and not processed yet */
+	atomic_t queued;
+	/* More packets follow the one that is being processed */
+	bool more;
+	/* Segments merged so far, delivered when the burst ends */
+	struct net_pkt *held;
+	struct tcphdr *th;
+	size_t hdr_len;
+	uint32_t next_seq;
+};
+
+static struct tcp_gro tcp_gro[NET_TC_RX_QUEUE_COUNT];
+
+static struct tcphdr *gro_th(struct net_pkt *pkt, size_t *hdr_len)
+{
+	size_t ip_len = net_pkt_ip_hdr_len(pkt) + net_pkt_ip_opts_len(pkt);
+	struct tcphdr *th;
+
+	net_pkt_cursor_init(pkt);
+
+	if (net_pkt_skip(pkt, ip_len) ||
+	    !net_pkt_is_contiguous(pkt, sizeof(*th))) {
+		return NULL;
+	}
+
+	th = net_pkt_cursor_get_pos(pkt);
+	*hdr_len = ip_len + th_off(th) * 4U;
+
+	return th;
+}
+
+/* Only data segments of an established connection without options are
+ * merged, anything else is passed on as is.
+ */
+static bool gro_mergeable(struct net_pkt *pkt, struct tcphdr *th,
+			  size_t hdr_len)
+{
+	return !net_pkt_ip_opts_len(pkt) && th_off(th) == 5 &&
+		(th_flags(th) & ~PSH) == ACK &&
+		net_pkt_get_len(pkt) > hdr_len;
+}
+
+static bool gro_same_flow(struct net_pkt *a, struct net_pkt *b,
+			  struct tcphdr *tha, struct tcphdr *thb)
+{
+	if (net_pkt_family(a) != net_pkt_family(b) ||
+	    net_pkt_iface(a) != net_pkt_iface(b) ||
+	    tha->th_sport != thb->th_sport ||
+	    tha->th_dport != thb->th_dport) {
+		return false;
+	}
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) && net_pkt_family(a) == AF_INET) {
+		return net_ipv4_addr_cmp(&NET_IPV4_HDR(a)->src,
+					 &NET_IPV4_HDR(b)->src) &&
+			net_ipv4_addr_cmp(&NET_IPV4_HDR(a)->dst,
+					  &NET_IPV4_HDR(b)->dst);
+	}
+
+	return net_ipv6_addr_cmp(&NET_IPV6_HDR(a)->src,
+				 &NET_IPV6_HDR(b)->src) &&
+		net_ipv6_addr_cmp(&NET_IPV6_HDR(a)->dst,
+				  &NET_IPV6_HDR(b)->dst);
+}
+
+static void gro_flush(struct tcp_gro *gro)
+{
+	struct net_pkt *pkt = gro->held;
+	union net_proto_header proto_hdr;
+	union net_ip_header ip;
+	uint16_t len, old_len;
+
+	if (!pkt) {
+		return;
+	}
+
+	gro->held = NULL;
+
+	len = net_pkt_get_len(pkt);
+
+	/* Keep the IP header consistent with the merged length */
+	if (net_pkt_family(pkt) == AF_INET) {
+		ip.ipv4 = NET_IPV4_HDR(pkt);
+		old_len = ip.ipv4->len;
+		ip.ipv4->len = htons(len);
+		ip.ipv4->chksum = net_calc_chksum_update16(ip.ipv4->chksum,
+							   old_len,
+							   ip.ipv4->len);
+	} else {
+		ip.ipv6 = NET_IPV6_HDR(pkt);
+		ip.ipv6->len = htons(len - NET_IPV6H_LEN);
+	}
+
+	proto_hdr.tcp = (struct net_tcp_hdr *)gro->th;
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_skip(pkt, gro->hdr_len);
+
+	if (net_conn_input(pkt, &ip, IPPROTO_TCP, &proto_hdr) == NET_DROP) {
+		if (net_pkt_family(pkt) == AF_INET) {
+			net_stats_update_ipv4_drop(net_pkt_iface(pkt));
+		} else {
+			net_stats_update_ipv6_drop(net_pkt_iface(pkt));
+		}
+
+		net_pkt_unref(pkt);
+	}
+}
+
+static void gro_merge(struct tcp_gro *gro, struct net_pkt *pkt,
+		      struct tcphdr *th, size_t hdr_len, size_t len)
+{
+	struct net_buf *buf = pkt->buffer;
+
+	/* The latest window and the push of any segment apply */
+	UNALIGNED_PUT(th_win(th), &gro->th->th_win);
+	gro->th->th_flags |= th_flags(th) & PSH;
+
+	gro->next_seq += len;
+
+	/* Drop the headers, the payload buffers go to the held packet */
+	while (buf && hdr_len >= buf->len) {
+		hdr_len -= buf->len;
+		buf = net_buf_frag_del(NULL, buf);
+	}
+
+	net_buf_pull(buf, hdr_len);
+
+	pkt->buffer = NULL;
+	net_pkt_unref(pkt);
+
+	net_pkt_append_buffer(gro->held, buf);
+}
+
+bool net_tcp_gro_receive(struct net_pkt *pkt)
+{
+	uint8_t queue = net_tc_rx_queue_current();
+	struct net_pkt_cursor backup;
+	struct tcp_gro *gro;
+	size_t hdr_len, len;
+	struct tcphdr *th;
+	bool same_flow;
+
+	/* Packets that do not come from a RX queue are not part of a
+	 * burst, e.g. the ones that are passed from a sending context.
+	 * With RSS, the queue is not given by the priority of the packet.
+	 */
+	if (queue >= NET_TC_RX_QUEUE_COUNT) {
+		return false;
+	}
+
+	gro = &tcp_gro[queue];
+
+	net_pkt_cursor_backup(pkt, &backup);
+
+	th = gro_th(pkt, &hdr_len);
+	if (!th) {
+		net_pkt_cursor_restore(pkt, &backup);
+		gro_flush(gro);
+		return false;
+	}
+
+	same_flow = gro->held && gro_same_flow(gro->held, pkt, gro->th, th);
+
+	if (!gro_mergeable(pkt, th, hdr_len)) {
+		net_pkt_cursor_restore(pkt, &backup);
+
+		/* Keep the order of the segments of the held connection */
+		if (same_flow) {
+			gro_flush(gro);
+		}
+
+		return false;
+	}
+
+	len = net_pkt_get_len(pkt) - hdr_len;
+
+	if (same_flow && th_seq(th) == gro->next_seq &&
+	    th_ack(th) == th_ack(gro->th) && hdr_len == gro->hdr_len &&
+	    net_pkt_get_len(gro->held) + len <= TCP_GRO_MAX_LEN) {
+		gro_merge(gro, pkt, th, hdr_len, len);
+		return true;
+	}
+
+	gro_flush(gro);
+
+	gro->held = pkt;
+	gro->th = th;
+	gro->hdr_len = hdr_len;
+	gro->next_seq = th_seq(th) + len;
+
+	return true;
+}
+
+void net_tcp_gro_queued(uint8_t queue)
+{
+	atomic_inc(&tcp_gro[queue].queued);
+}
+
+void net_tcp_gro_begin(uint8_t queue)
+{
+	struct tcp_gro *gro = &tcp_gro[queue];
+
+	gro->more = atomic_dec(&gro->queued) > 1;
+}
+
+void net_tcp_gro_end(uint8_t queue)
+{
+	struct tcp_gro *gro = &tcp_gro[queue];
+
+	if (!gro->more) {
+		gro_flush(gro);
+	}
+}
@@ -110,10 +110,6 @@
 #define conn_ack(_conn, _req) (_conn)->ack += (_req)
 #endif
 
-#define conn_mss(_conn)					\
-	((_conn)->recv_options.mss_found ?		\
-	 (_conn)->recv_options.mss : (uint16_t)NET_IPV6_MTU)
-
 #define conn_state(_conn, _s)						\
 ({									\
 	NET_DBG("%s->%s",						\
@@ -139,6 +135,17 @@
 #define TCPOPT_NOP	1
 #define TCPOPT_MAXSEG	2
 #define TCPOPT_WINDOW	3
+#define TCPOPT_SACK_PERM	4
+#define TCPOPT_SACK	5
+
+#define TCPOLEN_SACK_PERM	2
+#define TCPOLEN_SACK_BLOCK	8
+
+/* Without timestamps, four SACK blocks fit in the 40 bytes of options */
+#define TCP_SACK_BLOCKS_MAX	4
+
+/* Duplicate ACKs needed to trigger a fast retransmit (RFC 5681) */
+#define TCP_DUP_ACK_THRESHOLD	3
 
 enum pkt_addr {
 	TCP_EP_SRC = 1,
@@ -200,15 +207,48 @@ union tcp_endpoint {
 	struct sockaddr_in6 sin6;
 };
 
+struct tcp_sack_block {
+	uint32_t start;
+	uint32_t end; /* first seq after the block */
+};
+
 struct tcp_options {
+	struct tcp_sack_block sack[TCP_SACK_BLOCKS_MAX];
 	uint16_t mss;
 	uint16_t window;
+	uint8_t sack_count; /* SACK blocks in the last received segment */
 	bool mss_found : 1;
 	bool wnd_found : 1;
+	bool sack_perm_found : 1;
+};
+
+struct tcp;
+
+/* Congestion control algorithm. Slow start and the window changes of
+ * fast recovery are done by tcp2_cc.c, the algorithm only decides on
+ * the growth in congestion avoidance and the reduction on loss.
+ */
+struct tcp_cc_ops {
+	const char *name;
+	/* Connection established, reset the algorithm state */
+	void (*init)(struct tcp *conn);
+	/* New data acknowledged while cwnd >= ssthresh */
+	void (*cong_avoid)(struct tcp *conn, uint32_t acked);
+	/* Loss detected, return the new slow start threshold */
+	uint32_t (*ssthresh)(struct tcp *conn);
+};
+
+struct tcp_cc_cubic {
+	int64_t epoch_start; /* uptime (ms) of the start of the epoch, 0 if none */
+	uint32_t w_max;      /* window (bytes) before the last reduction */
+	uint32_t k;          /* time (ms) to grow back to w_max */
+	uint32_t origin;     /* window (bytes) at the plateau of the curve */
 };
 
 struct tcp { /* TCP connection */
 	sys_snode_t next;
+	sys_snode_t hash_next;
+	sys_slist_t *hash_list; /* tcp_conn_hash bucket, NULL if not hashed */
 	struct net_context *context;
 	struct net_pkt *send_data;
 	struct net_pkt *queue_recv_data;
@@ -220,9 +260,16 @@ struct tcp { /* TCP connection */
 		struct tcp *accepted_conn;
 	};
 	struct k_mutex lock;
+	struct k_work_q *work_q; /* queue running this connection's timers */
 	struct k_sem connect_sem; /* semaphore for blocking connect */
 	struct k_fifo recv_data;  /* temp queue before passing data to app */
 	struct tcp_options recv_options;
+	const struct tcp_cc_ops *cc;
+#if defined(CONFIG_NET_TCP_CC_CUBIC)
+	struct tcp_cc_cubic cubic;
+#endif
+	/* Sender's SACK scoreboard, sorted and without overlaps */
+	struct tcp_sack_block sacked[TCP_SACK_BLOCKS_MAX];
 	struct k_delayed_work send_timer;
 	struct k_delayed_work recv_queue_timer;
 	struct k_delayed_work send_data_timer;
@@ -245,12 +292,22 @@ struct tcp { /* TCP connection */
 	enum tcp_data_mode data_mode;
 	uint32_t seq;
 	uint32_t ack;
+	uint32_t cwnd;
+	uint32_t ssthresh;
+	uint32_t cwnd_acked;  /* bytes acked towards the next cwnd increase */
+	uint32_t recover;     /* highest seq sent when loss was detected */
+	uint32_t rexmit_next; /* where to look for the next hole in recovery */
+	int close_err;        /* why the connection ended, 0 if closed by FIN */
 	uint16_t recv_win;
 	uint16_t send_win;
 	uint8_t send_data_retries;
+	uint8_t dup_acks;
+	uint8_t sacked_count;
 	bool in_retransmission : 1;
 	bool in_connect : 1;
 	bool in_close : 1;
+	bool in_recovery : 1;
+	bool sack_ok : 1; /* both ends offered SACK on SYN */
 };
 
 #define _flags(_fl, _op, _mask, _cond)					\
@@ -270,3 +327,10 @@ struct tcp { /* TCP connection */
 	_flags(_fl, _op, _mask, strlen("" #_args) ? _args : true)
 
 typedef void (*net_tcp_cb_t)(struct tcp *conn, void *user_data);
+
+uint16_t conn_mss(struct tcp *conn);
+
+void tcp_cc_init(struct tcp *conn);
+void tcp_cc_ack(struct tcp *conn, uint32_t acked);
+void tcp_cc_loss(struct tcp *conn);
+void tcp_cc_timeout(struct tcp *conn);
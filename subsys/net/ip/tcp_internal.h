@@ -272,6 +272,92 @@ static inline int net_tcp_finalize(struct net_pkt *pkt)
 }
 #endif
 
+/**
+ * @brief Cut the next segment from a TCP segmentation offload packet
+ *
+ * @param pkt Network packet carrying the data of several segments
+ * @param offset Payload offset of the segment, advanced past it
+ * @param seg Finalized segment, ready for the L2
+ *
+ * @return Payload length of the segment, 0 once all the payload has been
+ * consumed, negative errno otherwise.
+ */
+#if defined(CONFIG_NET_TCP_GSO)
+int net_tcp_gso_segment(struct net_pkt *pkt, size_t *offset,
+			struct net_pkt **seg);
+#else
+static inline int net_tcp_gso_segment(struct net_pkt *pkt, size_t *offset,
+				      struct net_pkt **seg)
+{
+	ARG_UNUSED(pkt);
+	ARG_UNUSED(offset);
+	ARG_UNUSED(seg);
+	return -ENOTSUP;
+}
+#endif
+
+/**
+ * @brief Account a packet queued to a RX traffic class queue
+ *
+ * @param queue Queue the packet was submitted to
+ */
+#if defined(CONFIG_NET_TCP_GRO)
+void net_tcp_gro_queued(uint8_t queue);
+#else
+static inline void net_tcp_gro_queued(uint8_t queue)
+{
+	ARG_UNUSED(queue);
+}
+#endif
+
+/**
+ * @brief Start processing a packet taken from a RX traffic class queue
+ *
+ * @param queue Queue the packet was submitted to
+ */
+#if defined(CONFIG_NET_TCP_GRO)
+void net_tcp_gro_begin(uint8_t queue);
+#else
+static inline void net_tcp_gro_begin(uint8_t queue)
+{
+	ARG_UNUSED(queue);
+}
+#endif
+
+/**
+ * @brief Done with a packet taken from a RX traffic class queue. Delivers
+ * the coalesced segments if no more packets are queued.
+ *
+ * @param queue Queue the packet was submitted to
+ */
+#if defined(CONFIG_NET_TCP_GRO)
+void net_tcp_gro_end(uint8_t queue);
+#else
+static inline void net_tcp_gro_end(uint8_t queue)
+{
+	ARG_UNUSED(queue);
+}
+#endif
+
+/**
+ * @brief Coalesce a received TCP segment with the other in-order segments
+ * of its connection in the same RX burst
+ *
+ * @param pkt Network packet, with the IP header and TCP checksum verified
+ *
+ * @return True if the packet was taken, false if it has to be passed to
+ * the connection handlers as is.
+ */
+#if defined(CONFIG_NET_TCP_GRO)
+bool net_tcp_gro_receive(struct net_pkt *pkt);
+#else
+static inline bool net_tcp_gro_receive(struct net_pkt *pkt)
+{
+	ARG_UNUSED(pkt);
+	return false;
+}
+#endif
+
 /**
  * @brief Get pointer to TCP header in net_pkt
  *
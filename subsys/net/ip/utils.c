@@ -487,32 +487,58 @@ int z_vrfy_net_addr_pton(sa_family_t family, const char *src,
 #include <syscalls/net_addr_pton_mrsh.c>
 #endif /* CONFIG_USERSPACE */
 
+static inline uint16_t chksum_add(uint16_t sum, uint16_t val)
+{
+	sum += val;
+	if (sum < val) {
+		sum++;
+	}
+
+	return sum;
+}
+
 static uint16_t calc_chksum(uint16_t sum, const uint8_t *data, size_t len)
 {
-	const uint8_t *end;
-	uint16_t tmp;
+	uint64_t acc = 0U;
 
-	end = data + len - 1;
+	/* The one's complement sum does not depend on the byte order
+	 * (RFC 1071), so add up native 32-bit words in a wide accumulator
+	 * and fold the carries back in only once at the end.
+	 */
+	while (len >= 4 * sizeof(uint32_t)) {
+		acc += UNALIGNED_GET((uint32_t *)data);
+		acc += UNALIGNED_GET((uint32_t *)data + 1);
+		acc += UNALIGNED_GET((uint32_t *)data + 2);
+		acc += UNALIGNED_GET((uint32_t *)data + 3);
 
-	while (data < end) {
-		tmp = (data[0] << 8) + data[1];
-		sum += tmp;
-		if (sum < tmp) {
-			sum++;
-		}
+		data += 4 * sizeof(uint32_t);
+		len -= 4 * sizeof(uint32_t);
+	}
+
+	while (len >= sizeof(uint32_t)) {
+		acc += UNALIGNED_GET((uint32_t *)data);
 
-		data += 2;
+		data += sizeof(uint32_t);
+		len -= sizeof(uint32_t);
 	}
 
-	if (data == end) {
-		tmp = data[0] << 8;
-		sum += tmp;
-		if (sum < tmp) {
-			sum++;
-		}
+	if (len >= sizeof(uint16_t)) {
+		acc += UNALIGNED_GET((uint16_t *)data);
+
+		data += sizeof(uint16_t);
+		len -= sizeof(uint16_t);
 	}
 
-	return sum;
+	/* Odd trailing byte is padded with zero */
+	if (len) {
+		acc += sys_be16_to_cpu((uint16_t)(data[0] << 8));
+	}
+
+	while (acc >> 16) {
+		acc = (acc & 0xffff) + (acc >> 16);
+	}
+
+	return chksum_add(sum, sys_be16_to_cpu((uint16_t)acc));
 }
 
 static inline uint16_t pkt_calc_chksum(struct net_pkt *pkt, uint16_t sum)
@@ -600,6 +626,19 @@ uint16_t net_calc_chksum(struct net_pkt *pkt, uint8_t proto)
 	return ~sum;
 }
 
+uint16_t net_calc_chksum_update(uint16_t chksum, const void *old_data,
+				const void *new_data, size_t len)
+{
+	uint16_t sum;
+
+	/* RFC 1624 eqn. 3: HC' = ~(~HC + ~m + m') */
+	sum = ~ntohs(chksum);
+	sum = chksum_add(sum, ~calc_chksum(0U, old_data, len));
+	sum = calc_chksum(sum, new_data, len);
+
+	return htons(~sum);
+}
+
 #if defined(CONFIG_NET_IPV4)
 uint16_t net_calc_chksum_ipv4(struct net_pkt *pkt)
 {
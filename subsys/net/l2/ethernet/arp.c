@@ -19,6 +19,7 @@ LOG_MODULE_REGISTER(net_arp, CONFIG_NET_ARP_LOG_LEVEL);
 
 #include "arp.h"
 #include "net_private.h"
+#include "route.h"
 
 #define NET_BUF_TIMEOUT K_MSEC(100)
 #define ARP_REQUEST_TIMEOUT (2 * MSEC_PER_SEC)
@@ -335,8 +336,16 @@ struct net_pkt *net_arp_prepare(struct net_pkt *pkt,
 	if (!current_ip &&
 	    !net_if_ipv4_addr_mask_cmp(net_pkt_iface(pkt), request_ip)) {
 		struct net_if_ipv4 *ipv4 = net_pkt_iface(pkt)->config.ip.ipv4;
+		struct net_route_entry_ipv4 *route;
 
-		if (ipv4) {
+		route = net_route_ipv4_lookup(net_pkt_iface(pkt), request_ip);
+		if (route) {
+			if (net_ipv4_is_addr_unspecified(&route->gw)) {
+				addr = request_ip;
+			} else {
+				addr = &route->gw;
+			}
+		} else if (ipv4) {
 			addr = &ipv4->gw;
 			if (net_ipv4_is_addr_unspecified(addr)) {
 				NET_ERR("Gateway not set for iface %p",
@@ -0,0 +1,242 @@
+/** @file
+ * @brief DNS resolver answer cache
+ *
+ * The resolved addresses are kept for the time to live given in the
+ * answer, and the names that do not exist for a fixed time.
+ */
+
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_dns_resolve, CONFIG_DNS_RESOLVER_LOG_LEVEL);
+
+#include <zephyr.h>
+#include <string.h>
+#include <net/dns_resolve.h>
+#include "dns_internal.h"
+
+/* RFC 2181, 8. A TTL with the most significant bit set is taken as zero */
+#define DNS_CACHE_TTL_MAX INT32_MAX
+
+struct dns_cache_entry {
+	/** Uptime in ms when the entry expires, 0 if not in use */
+	int64_t expires;
+
+	/** Cached address, not set for an error */
+	struct dns_addrinfo info;
+
+	/** 0 for an address, the resolve error for a name not found */
+	int status;
+
+	/** Query type the answer is for */
+	enum dns_query_type type;
+
+	/** Name the answer is for */
+	char query[CONFIG_DNS_RESOLVER_CACHE_NAME_SIZE];
+};
+
+static struct dns_cache_entry dns_cache[CONFIG_DNS_RESOLVER_CACHE_MAX_ENTRIES];
+
+static K_MUTEX_DEFINE(dns_cache_lock);
+
+/* Must be invoked with cache lock held */
+static bool entry_is_valid(struct dns_cache_entry *entry, int64_t now)
+{
+	if (entry->expires && entry->expires <= now) {
+		entry->expires = 0;
+	}
+
+	return entry->expires != 0;
+}
+
+/* Must be invoked with cache lock held */
+static bool entry_matches(struct dns_cache_entry *entry, int64_t now,
+			  const char *query, enum dns_query_type type)
+{
+	return entry_is_valid(entry, now) && entry->type == type &&
+		strcmp(entry->query, query) == 0;
+}
+
+/* Must be invoked with cache lock held. The entry that expires first is
+ * replaced if the cache is full.
+ */
+static struct dns_cache_entry *get_free_entry(int64_t now)
+{
+	struct dns_cache_entry *oldest = &dns_cache[0];
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(dns_cache); i++) {
+		if (!entry_is_valid(&dns_cache[i], now)) {
+			return &dns_cache[i];
+		}
+
+		if (dns_cache[i].expires < oldest->expires) {
+			oldest = &dns_cache[i];
+		}
+	}
+
+	NET_DBG("Cache full, dropping %s", log_strdup(oldest->query));
+
+	return oldest;
+}
+
+static void cache_add(const char *query, enum dns_query_type type,
+		      const struct dns_addrinfo *info, int status,
+		      uint32_t ttl, bool replace)
+{
+	struct dns_cache_entry *entry;
+	int64_t now;
+	int i;
+
+	if (!query || strlen(query) >= sizeof(entry->query)) {
+		return;
+	}
+
+	if (ttl > DNS_CACHE_TTL_MAX) {
+		ttl = 0U;
+	}
+
+	k_mutex_lock(&dns_cache_lock, K_FOREVER);
+
+	now = k_uptime_get();
+
+	/* A new answer replaces whatever was known of the name */
+	if (replace) {
+		for (i = 0; i < ARRAY_SIZE(dns_cache); i++) {
+			if (entry_matches(&dns_cache[i], now, query, type)) {
+				dns_cache[i].expires = 0;
+			}
+		}
+	}
+
+	/* Zero TTL answers are only good for the query at hand */
+	if (ttl == 0U) {
+		goto out;
+	}
+
+	entry = get_free_entry(now);
+
+	entry->expires = now + (int64_t)ttl * MSEC_PER_SEC;
+	entry->status = status;
+	entry->type = type;
+	strcpy(entry->query, query);
+
+	if (info) {
+		memcpy(&entry->info, info, sizeof(entry->info));
+	} else {
+		memset(&entry->info, 0, sizeof(entry->info));
+	}
+
+	NET_DBG("Cached %s type %d status %d ttl %u", log_strdup(query),
+		type, status, ttl);
+
+out:
+	k_mutex_unlock(&dns_cache_lock);
+}
+
+void dns_cache_add(const char *query, enum dns_query_type type,
+		   const struct dns_addrinfo *info, uint32_t ttl, bool first)
+{
+	cache_add(query, type, info, 0, ttl, first);
+}
+
+void dns_cache_add_error(const char *query, enum dns_query_type type,
+			 int status)
+{
+	cache_add(query, type, NULL, status,
+		  CONFIG_DNS_RESOLVER_CACHE_NEGATIVE_TTL, true);
+}
+
+/* The entries are copied one at a time, so that the callback is called
+ * without the cache lock held and can do DNS queries of its own.
+ */
+int dns_cache_find(const char *query, enum dns_query_type type,
+		   dns_resolve_cb_t cb, void *user_data)
+{
+	struct dns_addrinfo info;
+	bool found = false;
+	bool match;
+	int status = 0;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(dns_cache); i++) {
+		k_mutex_lock(&dns_cache_lock, K_FOREVER);
+
+		match = entry_matches(&dns_cache[i], k_uptime_get(), query,
+				      type);
+		if (match) {
+			status = dns_cache[i].status;
+			memcpy(&info, &dns_cache[i].info, sizeof(info));
+		}
+
+		k_mutex_unlock(&dns_cache_lock);
+
+		if (!match) {
+			continue;
+		}
+
+		if (status) {
+			cb(status, NULL, user_data);
+			return 0;
+		}
+
+		cb(DNS_EAI_INPROGRESS, &info, user_data);
+		found = true;
+	}
+
+	if (!found) {
+		return -ENOENT;
+	}
+
+	cb(DNS_EAI_ALLDONE, NULL, user_data);
+
+	return 0;
+}
+
+void dns_resolve_cache_foreach(dns_resolve_cache_cb_t cb, void *user_data)
+{
+	struct dns_cache_entry entry;
+	int64_t now;
+	bool valid;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(dns_cache); i++) {
+		k_mutex_lock(&dns_cache_lock, K_FOREVER);
+
+		now = k_uptime_get();
+
+		valid = entry_is_valid(&dns_cache[i], now);
+		if (valid) {
+			memcpy(&entry, &dns_cache[i], sizeof(entry));
+		}
+
+		k_mutex_unlock(&dns_cache_lock);
+
+		if (!valid) {
+			continue;
+		}
+
+		cb(entry.query, entry.type, entry.status ? NULL : &entry.info,
+		   entry.status,
+		   (uint32_t)ceiling_fraction(entry.expires - now,
+					      MSEC_PER_SEC),
+		   user_data);
+	}
+}
+
+void dns_resolve_cache_flush(void)
+{
+	int i;
+
+	k_mutex_lock(&dns_cache_lock, K_FOREVER);
+
+	for (i = 0; i < ARRAY_SIZE(dns_cache); i++) {
+		dns_cache[i].expires = 0;
+	}
+
+	k_mutex_unlock(&dns_cache_lock);
+}
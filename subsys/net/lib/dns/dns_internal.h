@@ -18,3 +18,32 @@ int dns_validate_msg(struct dns_resolve_context *ctx,
 		     struct net_buf *dns_cname,
 		     uint16_t *query_hash);
 #endif
+
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+void dns_cache_add(const char *query, enum dns_query_type type,
+		   const struct dns_addrinfo *info, uint32_t ttl, bool first);
+void dns_cache_add_error(const char *query, enum dns_query_type type,
+			 int status);
+int dns_cache_find(const char *query, enum dns_query_type type,
+		   dns_resolve_cb_t cb, void *user_data);
+#else
+static inline void dns_cache_add(const char *query,
+				 enum dns_query_type type,
+				 const struct dns_addrinfo *info,
+				 uint32_t ttl, bool first)
+{
+}
+
+static inline void dns_cache_add_error(const char *query,
+				       enum dns_query_type type,
+				       int status)
+{
+}
+
+static inline int dns_cache_find(const char *query,
+				 enum dns_query_type type,
+				 dns_resolve_cb_t cb, void *user_data)
+{
+	return -ENOENT;
+}
+#endif
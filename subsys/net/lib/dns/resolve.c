@@ -456,7 +456,7 @@ int dns_validate_msg(struct dns_resolve_context *ctx,
 		     uint16_t *query_hash)
 {
 	struct dns_addrinfo info = { 0 };
-	uint32_t ttl; /* RR ttl, so far it is not passed to caller */
+	uint32_t ttl; /* RR ttl, only used for caching the answer */
 	uint8_t *src, *addr;
 	const char *query_name;
 	int address_size;
@@ -539,20 +539,23 @@ int dns_validate_msg(struct dns_resolve_context *ctx,
 
 		switch (dns_msg->response_type) {
 		case DNS_RESPONSE_IP:
-			if (*query_idx >= 0) {
-				goto query_known;
-			}
-
-			query_name = dns_msg->msg + dns_msg->query_offset;
+			if (*query_idx < 0) {
+				query_name = dns_msg->msg +
+					dns_msg->query_offset;
 
-			/* Add \0 and query type (A or AAAA) to the hash */
-			*query_hash = crc16_ansi(query_name,
-						 strlen(query_name) + 1 + 2);
+				/* Add \0 and query type (A or AAAA) to the
+				 * hash
+				 */
+				*query_hash = crc16_ansi(query_name,
+							 strlen(query_name) +
+							 1 + 2);
 
-			*query_idx = get_slot_by_id(ctx, *dns_id, *query_hash);
-			if (*query_idx < 0) {
-				ret = DNS_EAI_SYSTEM;
-				goto quit;
+				*query_idx = get_slot_by_id(ctx, *dns_id,
+							    *query_hash);
+				if (*query_idx < 0) {
+					ret = DNS_EAI_SYSTEM;
+					goto quit;
+				}
 			}
 
 			if (ctx->queries[*query_idx].query_type ==
@@ -615,7 +618,10 @@ int dns_validate_msg(struct dns_resolve_context *ctx,
 			src = dns_msg->msg + dns_msg->response_position;
 			memcpy(addr, src, address_size);
 
-		query_known:
+			dns_cache_add(ctx->queries[*query_idx].query,
+				      ctx->queries[*query_idx].query_type,
+				      &info, ttl, items == 0);
+
 			invoke_query_callback(DNS_EAI_INPROGRESS, &info,
 					      &ctx->queries[*query_idx]);
 			items++;
@@ -717,6 +723,8 @@ static int dns_read(struct dns_resolve_context *ctx,
 		goto quit;
 	}
 
+	dns_data->len = data_len;
+
 	dns_msg.msg = dns_data->data;
 	dns_msg.msg_size = data_len;
 
@@ -749,6 +757,21 @@ quit:
 	return ret;
 }
 
+/* The server knows that the name, or an address of the requested type for
+ * it, does not exist. Failures of the server itself are not included.
+ */
+static bool is_name_not_found(int status, struct net_buf *dns_data)
+{
+	if (status == DNS_EAI_NODATA) {
+		return true;
+	}
+
+	return status == DNS_EAI_FAIL && dns_data &&
+		dns_data->len >= DNS_MSG_HEADER_SIZE &&
+		dns_header_qr(dns_data->data) == DNS_RESPONSE &&
+		dns_header_rcode(dns_data->data) == DNS_HEADER_NAMEERROR;
+}
+
 static void cb_recv(struct net_context *net_ctx,
 		    struct net_pkt *pkt,
 		    union net_ip_header *ip_hdr,
@@ -831,6 +854,11 @@ quit:
 		goto free_buf;
 	}
 
+	if (is_name_not_found(ret, dns_data)) {
+		dns_cache_add_error(ctx->queries[i].query,
+				    ctx->queries[i].query_type, ret);
+	}
+
 	invoke_query_callback(ret, NULL, &ctx->queries[i]);
 
 	/* Marks the end of the results */
@@ -1123,6 +1151,11 @@ int dns_resolve_name(struct dns_resolve_context *ctx,
 		return 0;
 	}
 
+	/* Recently resolved names are answered without asking the servers */
+	if (dns_cache_find(query, type, cb, user_data) == 0) {
+		return 0;
+	}
+
 try_resolve:
 	k_mutex_lock(&ctx->lock, K_FOREVER);
 
@@ -7,6 +7,7 @@
 
 /* libc headers */
 #include <fcntl.h>
+#include <time.h>
 
 /* Zephyr headers */
 #include <logging/log.h>
@@ -171,6 +172,8 @@ int zsock_socket_internal(int family, int type, int proto)
 	/* recv_q and accept_q are in union */
 	k_fifo_init(&ctx->recv_q);
 
+	zsock_epoll_init_ctx(ctx);
+
 	/* TCP context is effectively owned by both application
 	 * and the stack: stack may detect that peer closed/aborted
 	 * connection, but it must not dispose of the context behind
@@ -238,6 +241,7 @@ int zsock_close_ctx(struct net_context *ctx)
 		(void)net_context_recv(ctx, NULL, K_NO_WAIT, NULL);
 	}
 
+	zsock_epoll_close_ctx(ctx);
 	zsock_flush_queue(ctx);
 
 	SET_ERRNO(net_context_put(ctx));
@@ -307,8 +311,10 @@ static void zsock_accepted_cb(struct net_context *new_ctx,
 		(void)net_context_recv(new_ctx, zsock_received_cb, K_NO_WAIT,
 				       NULL);
 		k_fifo_init(&new_ctx->recv_q);
+		zsock_epoll_init_ctx(new_ctx);
 
 		k_fifo_put(&parent->accept_q, new_ctx);
+		zsock_epoll_notify(parent);
 	}
 }
 
@@ -326,6 +332,11 @@ static void zsock_received_cb(struct net_context *ctx,
 	if (!pkt) {
 		struct net_pkt *last_pkt = k_fifo_peek_tail(&ctx->recv_q);
 
+		/* The connection was reset or timed out */
+		if (status < 0) {
+			sock_set_error(ctx);
+		}
+
 		if (!last_pkt) {
 			/* If there're no packets in the queue, recv() may
 			 * be blocked waiting on it to become non-empty,
@@ -338,6 +349,8 @@ static void zsock_received_cb(struct net_context *ctx,
 			net_pkt_set_eof(last_pkt, true);
 			NET_DBG("Set EOF flag on pkt %p", last_pkt);
 		}
+
+		zsock_epoll_notify(ctx);
 		return;
 	}
 
@@ -351,6 +364,7 @@ static void zsock_received_cb(struct net_context *ctx,
 	net_pkt_set_rx_stats_tick(pkt, k_cycle_get_32());
 
 	k_fifo_put(&ctx->recv_q, pkt);
+	zsock_epoll_notify(ctx);
 }
 
 int zsock_bind_ctx(struct net_context *ctx, const struct sockaddr *addr,
@@ -406,6 +420,9 @@ int zsock_connect_ctx(struct net_context *ctx, const struct sockaddr *addr,
 	SET_ERRNO(net_context_recv(ctx, zsock_received_cb, K_NO_WAIT,
 				   ctx->user_data));
 
+	/* The socket became writable, for edge triggered epoll */
+	zsock_epoll_notify(ctx);
+
 	return 0;
 }
 
@@ -704,90 +721,112 @@ ssize_t z_impl_zsock_sendmsg(int sock, const struct msghdr *msg, int flags)
 }
 
 #ifdef CONFIG_USERSPACE
-static inline ssize_t z_vrfy_zsock_sendmsg(int sock,
-					   const struct msghdr *msg,
-					   int flags)
+static void msghdr_free(struct msghdr *msg)
 {
-	struct msghdr msg_copy;
 	size_t i;
-	int ret;
 
-	Z_OOPS(z_user_from_copy(&msg_copy, (void *)msg, sizeof(msg_copy)));
+	k_free(msg->msg_name);
+	k_free(msg->msg_control);
 
-	msg_copy.msg_name = NULL;
-	msg_copy.msg_control = NULL;
+	if (msg->msg_iov) {
+		for (i = 0; i < msg->msg_iovlen; i++) {
+			k_free(msg->msg_iov[i].iov_base);
+		}
 
-	msg_copy.msg_iov = z_user_alloc_from_copy(msg->msg_iov,
-				       msg->msg_iovlen * sizeof(struct iovec));
-	if (!msg_copy.msg_iov) {
-		errno = ENOMEM;
-		goto fail;
+		k_free(msg->msg_iov);
+	}
+}
+
+/* Replace the user buffers referenced by a message header, which itself
+ * has already been copied from user mode, with kernel copies of them.
+ * The copies are released with msghdr_free(), also on failure.
+ */
+static int msghdr_from_user(struct msghdr *msg)
+{
+	struct iovec *user_iov = msg->msg_iov;
+	void *user_name = msg->msg_name;
+	void *user_control = msg->msg_control;
+	size_t iov_size;
+	size_t i;
+
+	msg->msg_name = NULL;
+	msg->msg_control = NULL;
+	msg->msg_iov = NULL;
+
+	if (size_mul_overflow(msg->msg_iovlen, sizeof(struct iovec),
+			      &iov_size)) {
+		msg->msg_iovlen = 0;
+		return -EINVAL;
+	}
+
+	if (msg->msg_iovlen > 0) {
+		msg->msg_iov = z_user_alloc_from_copy(user_iov, iov_size);
+		if (!msg->msg_iov) {
+			msg->msg_iovlen = 0;
+			return -ENOMEM;
+		}
 	}
 
 	for (i = 0; i < msg->msg_iovlen; i++) {
-		msg_copy.msg_iov[i].iov_base =
-			z_user_alloc_from_copy(msg->msg_iov[i].iov_base,
-					       msg->msg_iov[i].iov_len);
-		if (!msg_copy.msg_iov[i].iov_base) {
-			errno = ENOMEM;
-			goto fail;
+		void *user_base = msg->msg_iov[i].iov_base;
+
+		msg->msg_iov[i].iov_base = NULL;
+
+		if (msg->msg_iov[i].iov_len == 0) {
+			continue;
 		}
 
-		msg_copy.msg_iov[i].iov_len = msg->msg_iov[i].iov_len;
+		msg->msg_iov[i].iov_base =
+			z_user_alloc_from_copy(user_base,
+					       msg->msg_iov[i].iov_len);
+		if (!msg->msg_iov[i].iov_base) {
+			/* Only the buffers copied so far are freed */
+			msg->msg_iovlen = i;
+			return -ENOMEM;
+		}
 	}
 
 	if (msg->msg_namelen > 0) {
-		msg_copy.msg_name = z_user_alloc_from_copy(msg->msg_name,
-							   msg->msg_namelen);
-		if (!msg_copy.msg_name) {
-			errno = ENOMEM;
-			goto fail;
+		msg->msg_name = z_user_alloc_from_copy(user_name,
+						       msg->msg_namelen);
+		if (!msg->msg_name) {
+			return -ENOMEM;
 		}
 	}
 
 	if (msg->msg_controllen > 0) {
-		msg_copy.msg_control = z_user_alloc_from_copy(msg->msg_control,
+		msg->msg_control = z_user_alloc_from_copy(user_control,
 							  msg->msg_controllen);
-		if (!msg_copy.msg_control) {
-			errno = ENOMEM;
-			goto fail;
+		if (!msg->msg_control) {
+			return -ENOMEM;
 		}
 	}
 
-	ret = z_impl_zsock_sendmsg(sock, (const struct msghdr *)&msg_copy,
-				   flags);
-
-	k_free(msg_copy.msg_name);
-	k_free(msg_copy.msg_control);
-
-	for (i = 0; i < msg_copy.msg_iovlen; i++) {
-		k_free(msg_copy.msg_iov[i].iov_base);
-	}
-
-	k_free(msg_copy.msg_iov);
+	return 0;
+}
 
-	return ret;
+static inline ssize_t z_vrfy_zsock_sendmsg(int sock,
+					   const struct msghdr *msg,
+					   int flags)
+{
+	struct msghdr msg_copy;
+	ssize_t ret;
 
-fail:
-	if (msg_copy.msg_name) {
-		k_free(msg_copy.msg_name);
-	}
+	Z_OOPS(z_user_from_copy(&msg_copy, (void *)msg, sizeof(msg_copy)));
 
-	if (msg_copy.msg_control) {
-		k_free(msg_copy.msg_control);
+	ret = msghdr_from_user(&msg_copy);
+	if (ret < 0) {
+		msghdr_free(&msg_copy);
+		errno = -ret;
+		return -1;
 	}
 
-	if (msg_copy.msg_iov) {
-		for (i = 0; i < msg_copy.msg_iovlen; i++) {
-			if (msg_copy.msg_iov[i].iov_base) {
-				k_free(msg_copy.msg_iov[i].iov_base);
-			}
-		}
+	ret = z_impl_zsock_sendmsg(sock, (const struct msghdr *)&msg_copy,
+				   flags);
 
-		k_free(msg_copy.msg_iov);
-	}
+	msghdr_free(&msg_copy);
 
-	return -1;
+	return ret;
 }
 #include <syscalls/zsock_sendmsg_mrsh.c>
 #endif /* CONFIG_USERSPACE */
@@ -925,6 +964,48 @@ void net_socket_update_tc_rx_time(struct net_pkt *pkt, uint32_t end_tick)
 	}
 }
 
+static int zsock_recv_src_addr(struct net_context *ctx, struct net_pkt *pkt,
+			       struct sockaddr *src_addr, socklen_t *addrlen)
+{
+	if (IS_ENABLED(CONFIG_NET_OFFLOAD) &&
+	    net_if_is_ip_offloaded(net_context_get_iface(ctx))) {
+		/*
+		 * Packets from offloaded IP stack do not have IP
+		 * headers, so src address cannot be figured out at this
+		 * point. The best we can do is returning remote address
+		 * if that was set using connect() call.
+		 */
+		if (ctx->flags & NET_CONTEXT_REMOTE_ADDR_SET) {
+			memcpy(src_addr, &ctx->remote,
+			       MIN(*addrlen, sizeof(ctx->remote)));
+		} else {
+			return -ENOTSUP;
+		}
+	} else {
+		int rv;
+
+		rv = sock_get_pkt_src_addr(pkt, net_context_get_ip_proto(ctx),
+					   src_addr, *addrlen);
+		if (rv < 0) {
+			LOG_ERR("sock_get_pkt_src_addr %d", rv);
+			return rv;
+		}
+	}
+
+	/* addrlen is a value-result argument, set to actual
+	 * size of source address
+	 */
+	if (src_addr->sa_family == AF_INET) {
+		*addrlen = sizeof(struct sockaddr_in);
+	} else if (src_addr->sa_family == AF_INET6) {
+		*addrlen = sizeof(struct sockaddr_in6);
+	} else {
+		return -ENOTSUP;
+	}
+
+	return 0;
+}
+
 static inline ssize_t zsock_recv_dgram(struct net_context *ctx,
 				       void *buf,
 				       size_t max_len,
@@ -967,42 +1048,11 @@ static inline ssize_t zsock_recv_dgram(struct net_context *ctx,
 	net_pkt_cursor_backup(pkt, &backup);
 
 	if (src_addr && addrlen) {
-		if (IS_ENABLED(CONFIG_NET_OFFLOAD) &&
-		    net_if_is_ip_offloaded(net_context_get_iface(ctx))) {
-			/*
-			 * Packets from offloaded IP stack do not have IP
-			 * headers, so src address cannot be figured out at this
-			 * point. The best we can do is returning remote address
-			 * if that was set using connect() call.
-			 */
-			if (ctx->flags & NET_CONTEXT_REMOTE_ADDR_SET) {
-				memcpy(src_addr, &ctx->remote,
-				       MIN(*addrlen, sizeof(ctx->remote)));
-			} else {
-				errno = ENOTSUP;
-				goto fail;
-			}
-		} else {
-			int rv;
-
-			rv = sock_get_pkt_src_addr(pkt, net_context_get_ip_proto(ctx),
-						   src_addr, *addrlen);
-			if (rv < 0) {
-				errno = -rv;
-				LOG_ERR("sock_get_pkt_src_addr %d", rv);
-				goto fail;
-			}
-		}
+		int rv;
 
-		/* addrlen is a value-result argument, set to actual
-		 * size of source address
-		 */
-		if (src_addr->sa_family == AF_INET) {
-			*addrlen = sizeof(struct sockaddr_in);
-		} else if (src_addr->sa_family == AF_INET6) {
-			*addrlen = sizeof(struct sockaddr_in6);
-		} else {
-			errno = ENOTSUP;
+		rv = zsock_recv_src_addr(ctx, pkt, src_addr, addrlen);
+		if (rv < 0) {
+			errno = -rv;
 			goto fail;
 		}
 	}
@@ -1216,6 +1266,612 @@ ssize_t z_vrfy_zsock_recvfrom(int sock, void *buf, size_t max_len, int flags,
 #include <syscalls/zsock_recvfrom_mrsh.c>
 #endif /* CONFIG_USERSPACE */
 
+/* Same limit as UIO_MAXIOV, which caps the message vector on Linux */
+#define MMSG_MAX 1024
+
+static int zsock_sendmmsg_ctx(struct net_context *ctx,
+			      struct zsock_mmsghdr *msgvec, unsigned int vlen,
+			      int flags)
+{
+	k_timeout_t timeout = K_FOREVER;
+	unsigned int i;
+	int status = 0;
+
+	if ((flags & ZSOCK_MSG_DONTWAIT) || sock_is_nonblock(ctx)) {
+		timeout = K_NO_WAIT;
+	} else {
+		net_context_get_option(ctx, NET_OPT_SNDTIMEO, &timeout, NULL);
+	}
+
+	/* The TX traffic class thread has a higher priority than the
+	 * application, so it would preempt us after every queued datagram.
+	 * Keep it from running on this CPU until the batch is queued, it
+	 * then drains the whole batch after one wakeup. This only saves
+	 * wakeups on a single CPU: with SMP the TX thread can run on
+	 * another CPU meanwhile. Waiting for a buffer still lets it run.
+	 */
+	k_sched_lock();
+
+	for (i = 0; i < vlen; i++) {
+		status = net_context_sendmsg(ctx, &msgvec[i].msg_hdr, flags,
+					     NULL, timeout, NULL);
+		if (status < 0) {
+			break;
+		}
+
+		msgvec[i].msg_len = status;
+	}
+
+	k_sched_unlock();
+
+	if (i == 0 && status < 0) {
+		errno = -status;
+		return -1;
+	}
+
+	return i;
+}
+
+int z_impl_zsock_sendmmsg(int sock, struct zsock_mmsghdr *msgvec,
+			  unsigned int vlen, int flags)
+{
+	const struct socket_op_vtable *vtable;
+	unsigned int i;
+	ssize_t len = 0;
+	void *obj;
+
+	obj = get_sock_vtable(sock, &vtable);
+	if (obj == NULL || vtable->sendmsg == NULL) {
+		errno = EBADF;
+		return -1;
+	}
+
+	vlen = MIN(vlen, MMSG_MAX);
+
+	if (vtable == &sock_fd_op_vtable &&
+	    net_context_get_type(obj) == SOCK_DGRAM) {
+		return zsock_sendmmsg_ctx(obj, msgvec, vlen, flags);
+	}
+
+	for (i = 0; i < vlen; i++) {
+		len = vtable->sendmsg(obj, &msgvec[i].msg_hdr, flags);
+		if (len < 0) {
+			break;
+		}
+
+		msgvec[i].msg_len = len;
+	}
+
+	return (i == 0 && len < 0) ? -1 : i;
+}
+
+#ifdef CONFIG_USERSPACE
+static inline int z_vrfy_zsock_sendmmsg(int sock,
+					struct zsock_mmsghdr *msgvec,
+					unsigned int vlen, int flags)
+{
+	struct zsock_mmsghdr *copy;
+	unsigned int i, count;
+	bool fault = false;
+	int ret = 0;
+
+	vlen = MIN(vlen, MMSG_MAX);
+	if (vlen == 0) {
+		return 0;
+	}
+
+	copy = z_user_alloc_from_copy(msgvec, vlen * sizeof(*copy));
+	if (!copy) {
+		errno = ENOMEM;
+		return -1;
+	}
+
+	for (count = 0; count < vlen; count++) {
+		ret = msghdr_from_user(&copy[count].msg_hdr);
+		if (ret < 0) {
+			count++;
+			break;
+		}
+	}
+
+	if (ret < 0) {
+		errno = -ret;
+		ret = -1;
+	} else {
+		ret = z_impl_zsock_sendmmsg(sock, copy, vlen, flags);
+	}
+
+	for (i = 0; i < MAX(ret, 0); i++) {
+		fault |= z_user_to_copy(&msgvec[i].msg_len, &copy[i].msg_len,
+					sizeof(copy[i].msg_len)) != 0;
+	}
+
+	for (i = 0; i < count; i++) {
+		msghdr_free(&copy[i].msg_hdr);
+	}
+
+	k_free(copy);
+
+	Z_OOPS(fault);
+
+	return ret;
+}
+#include <syscalls/zsock_sendmmsg_mrsh.c>
+#endif /* CONFIG_USERSPACE */
+
+/* Receive one datagram into the buffers of a message header */
+static int zsock_recvmsg_dgram(struct net_context *ctx, struct msghdr *msg,
+			       int flags, k_timeout_t timeout)
+{
+	struct net_pkt *pkt;
+	size_t recv_len;
+	size_t read_len;
+	size_t total = 0;
+	size_t i;
+	int ret;
+
+	pkt = k_fifo_get(&ctx->recv_q, timeout);
+	if (!pkt) {
+		return -EAGAIN;
+	}
+
+	if (msg->msg_name != NULL && msg->msg_namelen > 0) {
+		ret = zsock_recv_src_addr(ctx, pkt, msg->msg_name,
+					  &msg->msg_namelen);
+		if (ret < 0) {
+			goto out;
+		}
+	}
+
+	msg->msg_controllen = 0;
+	msg->msg_flags = 0;
+
+	recv_len = net_pkt_remaining_data(pkt);
+
+	for (i = 0; i < msg->msg_iovlen && total < recv_len; i++) {
+		read_len = MIN(recv_len - total, msg->msg_iov[i].iov_len);
+
+		if (net_pkt_read(pkt, msg->msg_iov[i].iov_base, read_len)) {
+			ret = -ENOBUFS;
+			goto out;
+		}
+
+		total += read_len;
+	}
+
+	if (total < recv_len) {
+		msg->msg_flags |= ZSOCK_MSG_TRUNC;
+	}
+
+	if (IS_ENABLED(CONFIG_NET_PKT_RXTIME_STATS)) {
+		net_socket_update_tc_rx_time(pkt, k_cycle_get_32());
+	}
+
+	ret = (flags & ZSOCK_MSG_TRUNC) ? recv_len : total;
+
+out:
+	net_pkt_unref(pkt);
+
+	return ret;
+}
+
+/* Bound a wait by the deadline of a recvmmsg() call, if it has one */
+static k_timeout_t mmsg_timeout(k_timeout_t timeout, const int64_t *end)
+{
+	int64_t remaining;
+
+	if (end == NULL || K_TIMEOUT_EQ(timeout, K_NO_WAIT)) {
+		return timeout;
+	}
+
+	remaining = *end - sys_clock_tick_get();
+	if (remaining <= 0) {
+		return K_NO_WAIT;
+	}
+
+	if (K_TIMEOUT_EQ(timeout, K_FOREVER) || remaining < timeout.ticks) {
+		return Z_TIMEOUT_TICKS(remaining);
+	}
+
+	return timeout;
+}
+
+static int zsock_recvmmsg_ctx(struct net_context *ctx,
+			      struct zsock_mmsghdr *msgvec, unsigned int vlen,
+			      int flags, const int64_t *end)
+{
+	k_timeout_t timeout = K_FOREVER;
+	unsigned int i;
+	int ret = 0;
+
+	if ((flags & ZSOCK_MSG_DONTWAIT) || sock_is_nonblock(ctx)) {
+		timeout = K_NO_WAIT;
+	} else {
+		net_context_get_option(ctx, NET_OPT_RCVTIMEO, &timeout, NULL);
+	}
+
+	for (i = 0; i < vlen; i++) {
+		ret = zsock_recvmsg_dgram(ctx, &msgvec[i].msg_hdr, flags,
+					  mmsg_timeout(timeout, end));
+		if (ret < 0) {
+			break;
+		}
+
+		msgvec[i].msg_len = ret;
+
+		if (flags & ZSOCK_MSG_WAITFORONE) {
+			timeout = K_NO_WAIT;
+		}
+	}
+
+	if (i == 0 && ret < 0) {
+		errno = -ret;
+		return -1;
+	}
+
+	return i;
+}
+
+int z_impl_zsock_recvmmsg(int sock, struct zsock_mmsghdr *msgvec,
+			  unsigned int vlen, int flags,
+			  struct timespec *timeout)
+{
+	const struct socket_op_vtable *vtable;
+	int64_t *end = NULL;
+	int64_t end_ticks;
+	struct msghdr *msg;
+	size_t max_len;
+	unsigned int i;
+	ssize_t len = 0;
+	void *buf;
+	void *obj;
+
+	obj = get_sock_vtable(sock, &vtable);
+	if (obj == NULL || vtable->recvfrom == NULL) {
+		errno = EBADF;
+		return -1;
+	}
+
+	if (timeout != NULL) {
+		if (timeout->tv_sec < 0 || timeout->tv_nsec < 0 ||
+		    timeout->tv_nsec >= NSEC_PER_SEC) {
+			errno = EINVAL;
+			return -1;
+		}
+
+		end_ticks = sys_clock_timeout_end_calc(
+			K_NSEC((int64_t)timeout->tv_sec * NSEC_PER_SEC +
+			       timeout->tv_nsec));
+		end = &end_ticks;
+	}
+
+	vlen = MIN(vlen, MMSG_MAX);
+
+	if (vtable == &sock_fd_op_vtable &&
+	    net_context_get_type(obj) == SOCK_DGRAM &&
+	    !(flags & ZSOCK_MSG_PEEK)) {
+		return zsock_recvmmsg_ctx(obj, msgvec, vlen, flags, end);
+	}
+
+	/* Other sockets receive one message at a time into its first
+	 * buffer.
+	 */
+	for (i = 0; i < vlen; i++) {
+		msg = &msgvec[i].msg_hdr;
+
+		if (msg->msg_iovlen > 1) {
+			errno = EOPNOTSUPP;
+			len = -1;
+			break;
+		}
+
+		if (msg->msg_iovlen == 1) {
+			buf = msg->msg_iov->iov_base;
+			max_len = msg->msg_iov->iov_len;
+		} else {
+			buf = NULL;
+			max_len = 0;
+		}
+
+		len = vtable->recvfrom(obj, buf, max_len,
+				       flags & ~ZSOCK_MSG_WAITFORONE,
+				       msg->msg_name,
+				       msg->msg_name ? &msg->msg_namelen : NULL);
+		if (len < 0) {
+			break;
+		}
+
+		msg->msg_controllen = 0;
+		msg->msg_flags = 0;
+		msgvec[i].msg_len = len;
+
+		if (flags & ZSOCK_MSG_WAITFORONE) {
+			flags |= ZSOCK_MSG_DONTWAIT;
+		}
+
+		/* As on Linux, the timeout is only checked once a message
+		 * has been received.
+		 */
+		if (end != NULL && sys_clock_tick_get() >= *end) {
+			i++;
+			break;
+		}
+	}
+
+	return (i == 0 && len < 0) ? -1 : i;
+}
+
+#ifdef CONFIG_USERSPACE
+static inline int z_vrfy_zsock_recvmmsg(int sock,
+					struct zsock_mmsghdr *msgvec,
+					unsigned int vlen, int flags,
+					struct timespec *timeout)
+{
+	struct timespec timeout_copy;
+	struct zsock_mmsghdr *copy;
+	struct msghdr *msg;
+	unsigned int i, count;
+	bool fault = false;
+	size_t iov_size;
+	int ret = 0;
+
+	if (timeout != NULL) {
+		Z_OOPS(z_user_from_copy(&timeout_copy, timeout,
+					sizeof(timeout_copy)));
+		timeout = &timeout_copy;
+	}
+
+	vlen = MIN(vlen, MMSG_MAX);
+	if (vlen == 0) {
+		return 0;
+	}
+
+	copy = z_user_alloc_from_copy(msgvec, vlen * sizeof(*copy));
+	if (!copy) {
+		errno = ENOMEM;
+		return -1;
+	}
+
+	/* The data is received straight to the user buffers, only the
+	 * buffer descriptors are copied.
+	 */
+	for (count = 0; count < vlen; count++) {
+		msg = &copy[count].msg_hdr;
+
+		msg->msg_control = NULL;
+		msg->msg_controllen = 0;
+
+		if (msg->msg_name != NULL &&
+		    Z_SYSCALL_MEMORY_WRITE(msg->msg_name, msg->msg_namelen)) {
+			fault = true;
+			break;
+		}
+
+		if (size_mul_overflow(msg->msg_iovlen, sizeof(struct iovec),
+				      &iov_size)) {
+			fault = true;
+			break;
+		}
+
+		if (msg->msg_iovlen == 0) {
+			msg->msg_iov = NULL;
+			continue;
+		}
+
+		msg->msg_iov = z_user_alloc_from_copy(msg->msg_iov, iov_size);
+		if (!msg->msg_iov) {
+			ret = -ENOMEM;
+			break;
+		}
+
+		for (i = 0; i < msg->msg_iovlen; i++) {
+			if (Z_SYSCALL_MEMORY_WRITE(msg->msg_iov[i].iov_base,
+						   msg->msg_iov[i].iov_len)) {
+				fault = true;
+				break;
+			}
+		}
+
+		if (fault) {
+			count++;
+			break;
+		}
+	}
+
+	if (!fault && ret == 0) {
+		ret = z_impl_zsock_recvmmsg(sock, copy, vlen, flags, timeout);
+	} else if (ret < 0) {
+		errno = -ret;
+		ret = -1;
+	}
+
+	for (i = 0; i < MAX(ret, 0); i++) {
+		msg = &copy[i].msg_hdr;
+
+		fault |= z_user_to_copy(&msgvec[i].msg_len, &copy[i].msg_len,
+					sizeof(copy[i].msg_len)) != 0;
+		fault |= z_user_to_copy(&msgvec[i].msg_hdr.msg_namelen,
+					&msg->msg_namelen,
+					sizeof(msg->msg_namelen)) != 0;
+		fault |= z_user_to_copy(&msgvec[i].msg_hdr.msg_controllen,
+					&msg->msg_controllen,
+					sizeof(msg->msg_controllen)) != 0;
+		fault |= z_user_to_copy(&msgvec[i].msg_hdr.msg_flags,
+					&msg->msg_flags,
+					sizeof(msg->msg_flags)) != 0;
+	}
+
+	for (i = 0; i < count; i++) {
+		k_free(copy[i].msg_hdr.msg_iov);
+	}
+
+	k_free(copy);
+
+	Z_OOPS(fault);
+
+	return ret;
+}
+#include <syscalls/zsock_recvmmsg_mrsh.c>
+#endif /* CONFIG_USERSPACE */
+
+#if defined(CONFIG_NET_SOCKETS_RECV_ZEROCOPY)
+/* Turn the data of the packet after the cursor into a buffer chain of its
+ * own, the buffers holding only headers are released. Buffers that are
+ * shared with another packet cannot be cut, so such a packet is copied.
+ * The packet is consumed in any case.
+ */
+static int zsock_pkt_detach_data(struct net_pkt *pkt, struct net_buf **frags)
+{
+	struct net_pkt *clone;
+	struct net_buf *buf;
+	size_t skip;
+
+	for (buf = pkt->buffer; buf; buf = buf->frags) {
+		if (buf->ref > 1) {
+			break;
+		}
+	}
+
+	if (buf) {
+		clone = net_pkt_clone(pkt, K_NO_WAIT);
+		net_pkt_unref(pkt);
+
+		if (!clone) {
+			return -ENOBUFS;
+		}
+
+		pkt = clone;
+	}
+
+	skip = net_pkt_get_current_offset(pkt);
+	buf = pkt->buffer;
+
+	while (buf && skip >= buf->len) {
+		skip -= buf->len;
+		buf = net_buf_frag_del(NULL, buf);
+	}
+
+	if (buf) {
+		net_buf_pull(buf, skip);
+	}
+
+	pkt->buffer = NULL;
+	net_pkt_unref(pkt);
+
+	*frags = buf;
+
+	return 0;
+}
+
+ssize_t zsock_recvfrom_zc(int sock, struct net_buf **frags, int flags,
+			  struct sockaddr *src_addr, socklen_t *addrlen)
+{
+	const struct socket_op_vtable *vtable;
+	k_timeout_t timeout = K_FOREVER;
+	struct net_context *ctx;
+	struct net_pkt *pkt;
+	size_t len;
+	int ret;
+
+	ctx = get_sock_vtable(sock, &vtable);
+	if (ctx == NULL) {
+		errno = EBADF;
+		return -1;
+	}
+
+	/* Only the native sockets queue the received packets as such */
+	if (vtable != &sock_fd_op_vtable) {
+		errno = EOPNOTSUPP;
+		return -1;
+	}
+
+	if (frags == NULL || (flags & ~ZSOCK_MSG_DONTWAIT)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	*frags = NULL;
+
+	if ((flags & ZSOCK_MSG_DONTWAIT) || sock_is_nonblock(ctx)) {
+		timeout = K_NO_WAIT;
+	} else {
+		net_context_get_option(ctx, NET_OPT_RCVTIMEO, &timeout, NULL);
+	}
+
+	if (net_context_get_type(ctx) == SOCK_STREAM) {
+		if (net_context_get_state(ctx) != NET_CONTEXT_CONNECTED) {
+			errno = ENOTCONN;
+			return -1;
+		}
+
+		if (sock_is_eof(ctx)) {
+			return 0;
+		}
+
+		ret = k_fifo_wait_non_empty(&ctx->recv_q, timeout);
+		/* EAGAIN when timeout expired, EINTR when cancelled */
+		if (ret && ret != -EAGAIN && ret != -EINTR) {
+			errno = -ret;
+			return -1;
+		}
+
+		pkt = k_fifo_get(&ctx->recv_q, K_NO_WAIT);
+		if (!pkt) {
+			if (sock_is_eof(ctx)) {
+				return 0;
+			}
+
+			errno = EAGAIN;
+			return -1;
+		}
+
+		if (net_pkt_eof(pkt)) {
+			sock_set_eof(ctx);
+		}
+	} else {
+		pkt = k_fifo_get(&ctx->recv_q, timeout);
+		if (!pkt) {
+			errno = EAGAIN;
+			return -1;
+		}
+
+		if (src_addr && addrlen) {
+			ret = zsock_recv_src_addr(ctx, pkt, src_addr, addrlen);
+			if (ret < 0) {
+				net_pkt_unref(pkt);
+				errno = -ret;
+				return -1;
+			}
+		}
+	}
+
+	len = net_pkt_remaining_data(pkt);
+
+	if (IS_ENABLED(CONFIG_NET_PKT_RXTIME_STATS)) {
+		net_socket_update_tc_rx_time(pkt, k_cycle_get_32());
+	}
+
+	if (net_context_get_type(ctx) == SOCK_STREAM) {
+		net_context_update_recv_wnd(ctx, len);
+	}
+
+	ret = zsock_pkt_detach_data(pkt, frags);
+	if (ret < 0) {
+		errno = -ret;
+		return -1;
+	}
+
+	return len;
+}
+
+void zsock_recv_zc_release(struct net_buf *frags)
+{
+	if (frags) {
+		net_buf_unref(frags);
+	}
+}
+#endif /* CONFIG_NET_SOCKETS_RECV_ZEROCOPY */
+
 /* As this is limited function, we don't follow POSIX signature, with
  * "..." instead of last arg.
  */
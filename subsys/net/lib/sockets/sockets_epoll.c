@@ -0,0 +1,575 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* epoll() for native sockets. Each watched socket has an item that is
+ * linked both to the socket and to the epoll instance. The receive and
+ * accept callbacks of the socket put its items to the ready lists of the
+ * instances, and epoll_wait() only goes through the ready list, checking
+ * the actual state of each socket there like poll() does.
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_sock, CONFIG_NET_SOCKETS_LOG_LEVEL);
+
+#include <kernel.h>
+#include <net/net_context.h>
+#include <net/socket.h>
+#include <sys/fdtable.h>
+
+#include "sockets_internal.h"
+
+struct epoll_item {
+	/* Node in the ready list of the instance */
+	sys_dnode_t ready_node;
+	/* Node in the list of the socket */
+	sys_snode_t ctx_node;
+	struct epoll_instance *ep;
+	struct net_context *ctx;
+	struct zsock_epoll_event event;
+};
+
+struct epoll_instance {
+	sys_dlist_t ready_list;
+	/* Raised while the ready list is not empty */
+	struct k_poll_signal ready_sig;
+	bool in_use;
+};
+
+static struct epoll_instance epoll_instances[CONFIG_NET_SOCKETS_EPOLL_MAX];
+static struct epoll_item epoll_items[CONFIG_NET_SOCKETS_EPOLL_MAX_ITEMS];
+
+/* Serializes epoll_ctl() and the creation and removal of instances */
+static K_MUTEX_DEFINE(epoll_mutex);
+
+/* Protects the item lists, taken from the receive callbacks too */
+static struct k_spinlock epoll_lock;
+
+static const struct fd_op_vtable epoll_fd_vtable;
+
+#define EPOLL_EVENTS (ZSOCK_EPOLLIN | ZSOCK_EPOLLOUT | ZSOCK_EPOLLERR | \
+		      ZSOCK_EPOLLHUP | ZSOCK_EPOLLONESHOT | ZSOCK_EPOLLET)
+
+/* Always watched, like on Linux */
+#define EPOLL_EVENTS_ALWAYS (ZSOCK_EPOLLERR | ZSOCK_EPOLLHUP)
+
+/* Must be invoked with epoll lock held. The state is checked the same
+ * way as in poll(), sockets are always writable and the end of the
+ * stream makes the socket readable. Once the peer closed the connection
+ * and everything was read, the socket is hung up, and a connection that
+ * was reset or timed out is in error too.
+ */
+static uint32_t item_poll(struct epoll_item *item)
+{
+	struct net_context *ctx = item->ctx;
+	uint32_t revents = ZSOCK_EPOLLOUT;
+
+	if (!k_fifo_is_empty(&ctx->recv_q) || sock_is_eof(ctx)) {
+		revents |= ZSOCK_EPOLLIN;
+	}
+
+	if (sock_is_eof(ctx)) {
+		revents |= ZSOCK_EPOLLHUP;
+	}
+
+	if (sock_is_error(ctx)) {
+		revents |= ZSOCK_EPOLLERR;
+	}
+
+	return revents & item->event.events;
+}
+
+/* Must be invoked with epoll lock held */
+static void item_set_ready(struct epoll_item *item)
+{
+	if (sys_dnode_is_linked(&item->ready_node)) {
+		return;
+	}
+
+	sys_dlist_append(&item->ep->ready_list, &item->ready_node);
+	k_poll_signal_raise(&item->ep->ready_sig, 0);
+}
+
+/* Must be invoked with epoll lock held */
+static void item_remove(struct epoll_item *item)
+{
+	if (sys_dnode_is_linked(&item->ready_node)) {
+		sys_dlist_remove(&item->ready_node);
+	}
+
+	sys_slist_find_and_remove(&item->ctx->epoll_items, &item->ctx_node);
+
+	item->ep = NULL;
+	item->ctx = NULL;
+}
+
+/* Must be invoked with epoll mutex held */
+static struct epoll_item *item_alloc(void)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(epoll_items); i++) {
+		if (epoll_items[i].ep == NULL) {
+			return &epoll_items[i];
+		}
+	}
+
+	return NULL;
+}
+
+/* Must be invoked with epoll mutex held */
+static struct epoll_item *item_find(struct epoll_instance *ep,
+				    struct net_context *ctx)
+{
+	struct epoll_item *item;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&ctx->epoll_items, item, ctx_node) {
+		if (item->ep == ep) {
+			return item;
+		}
+	}
+
+	return NULL;
+}
+
+void zsock_epoll_init_ctx(struct net_context *ctx)
+{
+	sys_slist_init(&ctx->epoll_items);
+}
+
+void zsock_epoll_notify(struct net_context *ctx)
+{
+	struct epoll_item *item;
+	k_spinlock_key_t key;
+
+	/* Sockets that are not watched do not need the lock */
+	if (sys_slist_is_empty(&ctx->epoll_items)) {
+		return;
+	}
+
+	key = k_spin_lock(&epoll_lock);
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&ctx->epoll_items, item, ctx_node) {
+		/* Unless disabled after a one-shot event */
+		if (item->event.events != 0U) {
+			item_set_ready(item);
+		}
+	}
+
+	k_spin_unlock(&epoll_lock, key);
+}
+
+void zsock_epoll_close_ctx(struct net_context *ctx)
+{
+	k_spinlock_key_t key;
+	sys_snode_t *node;
+
+	k_mutex_lock(&epoll_mutex, K_FOREVER);
+	key = k_spin_lock(&epoll_lock);
+
+	while ((node = sys_slist_peek_head(&ctx->epoll_items)) != NULL) {
+		item_remove(CONTAINER_OF(node, struct epoll_item, ctx_node));
+	}
+
+	k_spin_unlock(&epoll_lock, key);
+	k_mutex_unlock(&epoll_mutex);
+}
+
+static int epoll_ctl_add(struct epoll_instance *ep, struct net_context *ctx,
+			 struct zsock_epoll_event *event)
+{
+	struct epoll_item *item;
+	k_spinlock_key_t key;
+
+	if (item_find(ep, ctx) != NULL) {
+		return -EEXIST;
+	}
+
+	item = item_alloc();
+	if (item == NULL) {
+		return -ENOSPC;
+	}
+
+	item->ep = ep;
+	item->ctx = ctx;
+	item->event = *event;
+	item->event.events |= EPOLL_EVENTS_ALWAYS;
+	sys_dnode_init(&item->ready_node);
+
+	key = k_spin_lock(&epoll_lock);
+
+	sys_slist_append(&ctx->epoll_items, &item->ctx_node);
+
+	if (item_poll(item)) {
+		item_set_ready(item);
+	}
+
+	k_spin_unlock(&epoll_lock, key);
+
+	return 0;
+}
+
+static int epoll_ctl_mod(struct epoll_instance *ep, struct net_context *ctx,
+			 struct zsock_epoll_event *event)
+{
+	struct epoll_item *item;
+	k_spinlock_key_t key;
+
+	item = item_find(ep, ctx);
+	if (item == NULL) {
+		return -ENOENT;
+	}
+
+	key = k_spin_lock(&epoll_lock);
+
+	item->event = *event;
+	item->event.events |= EPOLL_EVENTS_ALWAYS;
+
+	if (item_poll(item)) {
+		item_set_ready(item);
+	}
+
+	k_spin_unlock(&epoll_lock, key);
+
+	return 0;
+}
+
+static int epoll_ctl_del(struct epoll_instance *ep, struct net_context *ctx)
+{
+	struct epoll_item *item;
+	k_spinlock_key_t key;
+
+	item = item_find(ep, ctx);
+	if (item == NULL) {
+		return -ENOENT;
+	}
+
+	key = k_spin_lock(&epoll_lock);
+	item_remove(item);
+	k_spin_unlock(&epoll_lock, key);
+
+	return 0;
+}
+
+int zsock_epoll_ctl(int epfd, int op, int fd, struct zsock_epoll_event *event)
+{
+	const struct fd_op_vtable *vtable;
+	struct epoll_instance *ep;
+	struct net_context *ctx;
+	int ret;
+
+	ep = z_get_fd_obj(epfd, &epoll_fd_vtable, EINVAL);
+	if (ep == NULL) {
+		return -1;
+	}
+
+	ctx = z_get_fd_obj_and_vtable(fd, &vtable);
+	if (ctx == NULL) {
+		return -1;
+	}
+
+	/* The receive callbacks are only known for native sockets */
+	if (vtable != &sock_fd_op_vtable.fd_vtable) {
+		errno = EPERM;
+		return -1;
+	}
+
+	if (op != ZSOCK_EPOLL_CTL_DEL &&
+	    (event == NULL || (event->events & ~EPOLL_EVENTS))) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	k_mutex_lock(&epoll_mutex, K_FOREVER);
+
+	switch (op) {
+	case ZSOCK_EPOLL_CTL_ADD:
+		ret = epoll_ctl_add(ep, ctx, event);
+		break;
+	case ZSOCK_EPOLL_CTL_MOD:
+		ret = epoll_ctl_mod(ep, ctx, event);
+		break;
+	case ZSOCK_EPOLL_CTL_DEL:
+		ret = epoll_ctl_del(ep, ctx);
+		break;
+	default:
+		ret = -EINVAL;
+		break;
+	}
+
+	k_mutex_unlock(&epoll_mutex);
+
+	if (ret < 0) {
+		errno = -ret;
+		return -1;
+	}
+
+	return 0;
+}
+
+/* Must be invoked with epoll lock held. The level triggered items that
+ * are still ready go back to the end of the ready list, so that the
+ * other sockets get their turn when there are more than maxevents.
+ */
+static int epoll_collect(struct epoll_instance *ep,
+			 struct zsock_epoll_event *events, int maxevents)
+{
+	sys_dlist_t still_ready;
+	struct epoll_item *item;
+	sys_dnode_t *node;
+	uint32_t revents;
+	int count = 0;
+
+	sys_dlist_init(&still_ready);
+
+	while (count < maxevents &&
+	       (node = sys_dlist_get(&ep->ready_list)) != NULL) {
+		item = CONTAINER_OF(node, struct epoll_item, ready_node);
+
+		revents = item_poll(item);
+		if (!revents) {
+			continue;
+		}
+
+		events[count].events = revents;
+		events[count].data = item->event.data;
+		count++;
+
+		if (item->event.events & ZSOCK_EPOLLONESHOT) {
+			/* Disabled until modified with EPOLL_CTL_MOD */
+			item->event.events = 0U;
+		} else if (!(item->event.events & ZSOCK_EPOLLET)) {
+			sys_dlist_append(&still_ready, node);
+		}
+	}
+
+	while ((node = sys_dlist_get(&still_ready)) != NULL) {
+		sys_dlist_append(&ep->ready_list, node);
+	}
+
+	if (sys_dlist_is_empty(&ep->ready_list)) {
+		k_poll_signal_reset(&ep->ready_sig);
+	}
+
+	return count;
+}
+
+int zsock_epoll_wait(int epfd, struct zsock_epoll_event *events,
+		     int maxevents, int timeout)
+{
+	struct epoll_instance *ep;
+	struct k_poll_event event;
+	k_spinlock_key_t key;
+	k_timeout_t wait;
+	int64_t remaining;
+	uint64_t end;
+	int ret;
+
+	ep = z_get_fd_obj(epfd, &epoll_fd_vtable, EINVAL);
+	if (ep == NULL) {
+		return -1;
+	}
+
+	if (events == NULL || maxevents <= 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	wait = timeout < 0 ? K_FOREVER : K_MSEC(timeout);
+	end = sys_clock_timeout_end_calc(wait);
+
+	k_poll_event_init(&event, K_POLL_TYPE_SIGNAL,
+			  K_POLL_MODE_NOTIFY_ONLY, &ep->ready_sig);
+
+	while (true) {
+		key = k_spin_lock(&epoll_lock);
+		ret = epoll_collect(ep, events, maxevents);
+		k_spin_unlock(&epoll_lock, key);
+
+		if (ret > 0 || K_TIMEOUT_EQ(wait, K_NO_WAIT)) {
+			return ret;
+		}
+
+		if (!K_TIMEOUT_EQ(wait, K_FOREVER)) {
+			remaining = end - sys_clock_tick_get();
+			if (remaining <= 0) {
+				return 0;
+			}
+
+			wait = Z_TIMEOUT_TICKS(remaining);
+		}
+
+		event.state = K_POLL_STATE_NOT_READY;
+
+		ret = k_poll(&event, 1, wait);
+		if (ret == -EAGAIN) {
+			return 0;
+		} else if (ret != 0 && ret != -EINTR) {
+			errno = -ret;
+			return -1;
+		}
+	}
+}
+
+static ssize_t epoll_read_vmeth(void *obj, void *buffer, size_t count)
+{
+	ARG_UNUSED(obj);
+	ARG_UNUSED(buffer);
+	ARG_UNUSED(count);
+
+	errno = EINVAL;
+	return -1;
+}
+
+static ssize_t epoll_write_vmeth(void *obj, const void *buffer, size_t count)
+{
+	ARG_UNUSED(obj);
+	ARG_UNUSED(buffer);
+	ARG_UNUSED(count);
+
+	errno = EINVAL;
+	return -1;
+}
+
+/* The instance itself can be polled, it is readable when any of its
+ * sockets may be ready.
+ */
+static int epoll_ioctl_vmeth(void *obj, unsigned int request, va_list args)
+{
+	struct epoll_instance *ep = obj;
+
+	switch (request) {
+	case ZFD_IOCTL_POLL_PREPARE: {
+		struct zsock_pollfd *pfd;
+		struct k_poll_event **pev;
+		struct k_poll_event *pev_end;
+
+		pfd = va_arg(args, struct zsock_pollfd *);
+		pev = va_arg(args, struct k_poll_event **);
+		pev_end = va_arg(args, struct k_poll_event *);
+
+		if (!(pfd->events & ZSOCK_POLLIN)) {
+			return 0;
+		}
+
+		if (*pev == pev_end) {
+			return -ENOMEM;
+		}
+
+		k_poll_event_init(*pev, K_POLL_TYPE_SIGNAL,
+				  K_POLL_MODE_NOTIFY_ONLY, &ep->ready_sig);
+		(*pev)++;
+
+		return 0;
+	}
+
+	case ZFD_IOCTL_POLL_UPDATE: {
+		struct zsock_pollfd *pfd;
+		struct k_poll_event **pev;
+
+		pfd = va_arg(args, struct zsock_pollfd *);
+		pev = va_arg(args, struct k_poll_event **);
+
+		if (!(pfd->events & ZSOCK_POLLIN)) {
+			return 0;
+		}
+
+		if ((*pev)->state != K_POLL_STATE_NOT_READY) {
+			pfd->revents |= ZSOCK_POLLIN;
+		}
+		(*pev)++;
+
+		return 0;
+	}
+
+	default:
+		errno = EOPNOTSUPP;
+		return -1;
+	}
+}
+
+static int epoll_close_vmeth(void *obj)
+{
+	struct epoll_instance *ep = obj;
+	k_spinlock_key_t key;
+	int i;
+
+	k_mutex_lock(&epoll_mutex, K_FOREVER);
+	key = k_spin_lock(&epoll_lock);
+
+	for (i = 0; i < ARRAY_SIZE(epoll_items); i++) {
+		if (epoll_items[i].ep == ep) {
+			item_remove(&epoll_items[i]);
+		}
+	}
+
+	ep->in_use = false;
+
+	k_spin_unlock(&epoll_lock, key);
+	k_mutex_unlock(&epoll_mutex);
+
+	return 0;
+}
+
+static const struct fd_op_vtable epoll_fd_vtable = {
+	.read = epoll_read_vmeth,
+	.write = epoll_write_vmeth,
+	.close = epoll_close_vmeth,
+	.ioctl = epoll_ioctl_vmeth,
+};
+
+int zsock_epoll_create1(int flags)
+{
+	struct epoll_instance *ep = NULL;
+	int fd = -1;
+	int i;
+
+	if (flags != 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	k_mutex_lock(&epoll_mutex, K_FOREVER);
+
+	for (i = 0; i < ARRAY_SIZE(epoll_instances); i++) {
+		if (!epoll_instances[i].in_use) {
+			ep = &epoll_instances[i];
+			break;
+		}
+	}
+
+	if (ep == NULL) {
+		errno = ENOMEM;
+		goto out;
+	}
+
+	fd = z_reserve_fd();
+	if (fd < 0) {
+		goto out;
+	}
+
+	ep->in_use = true;
+	sys_dlist_init(&ep->ready_list);
+	k_poll_signal_init(&ep->ready_sig);
+
+	z_finalize_fd(fd, ep, &epoll_fd_vtable);
+
+	NET_DBG("epoll: ep=%p, fd=%d", ep, fd);
+
+out:
+	k_mutex_unlock(&epoll_mutex);
+
+	return fd;
+}
+
+int zsock_epoll_create(int size)
+{
+	if (size <= 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	return zsock_epoll_create1(0);
+}
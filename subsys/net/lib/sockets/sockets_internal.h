@@ -11,6 +11,7 @@
 
 #define SOCK_EOF 1
 #define SOCK_NONBLOCK 2
+#define SOCK_ERROR 4
 
 int zsock_close_ctx(struct net_context *ctx);
 
@@ -45,6 +46,8 @@ static inline bool net_socket_is_tls(void *obj)
 #define sock_is_eof(ctx) sock_get_flag(ctx, SOCK_EOF)
 #define sock_set_eof(ctx) sock_set_flag(ctx, SOCK_EOF, SOCK_EOF)
 #define sock_is_nonblock(ctx) sock_get_flag(ctx, SOCK_NONBLOCK)
+#define sock_is_error(ctx) sock_get_flag(ctx, SOCK_ERROR)
+#define sock_set_error(ctx) sock_set_flag(ctx, SOCK_ERROR, SOCK_ERROR)
 
 struct socket_op_vtable {
 	struct fd_op_vtable fd_vtable;
@@ -66,4 +69,27 @@ struct socket_op_vtable {
 			   socklen_t *addrlen);
 };
 
+extern const struct socket_op_vtable sock_fd_op_vtable;
+
+#if defined(CONFIG_NET_SOCKETS_EPOLL)
+void zsock_epoll_init_ctx(struct net_context *ctx);
+void zsock_epoll_notify(struct net_context *ctx);
+void zsock_epoll_close_ctx(struct net_context *ctx);
+#else
+static inline void zsock_epoll_init_ctx(struct net_context *ctx)
+{
+	ARG_UNUSED(ctx);
+}
+
+static inline void zsock_epoll_notify(struct net_context *ctx)
+{
+	ARG_UNUSED(ctx);
+}
+
+static inline void zsock_epoll_close_ctx(struct net_context *ctx)
+{
+	ARG_UNUSED(ctx);
+}
+#endif /* CONFIG_NET_SOCKETS_EPOLL */
+
 #endif /* _SOCKETS_INTERNAL_H_ */
@@ -215,6 +215,61 @@ static int cmd_kernel_stacks(const struct shell *shell,
 }
 #endif
 
+#ifdef CONFIG_K_HEAP_SITE_STATS
+static void shell_heap_site_dump(const struct k_heap_site *site,
+				 void *user_data)
+{
+	const struct shell *shell = (const struct shell *)user_data;
+
+	/* Resolve the call sites with addr2line on zephyr.elf */
+	shell_print(shell, "%-10p %-10p %8u %8u %8u %8zu %8zu",
+		    site->site, site->heap, site->allocs, site->frees,
+		    site->failures, site->bytes, site->max_bytes);
+}
+#endif
+
+static int cmd_kernel_heaps(const struct shell *shell,
+			    size_t argc, char **argv)
+{
+	struct sys_heap_frag_stats frag;
+
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	Z_STRUCT_SECTION_FOREACH(k_heap, h) {
+#ifdef CONFIG_SYS_HEAP_RUNTIME_STATS
+		struct sys_memory_stats stats;
+
+		k_heap_runtime_stats_get(h, &stats);
+		shell_print(shell, "%p allocated %zu free %zu max allocated %zu",
+			    h, stats.allocated_bytes, stats.free_bytes,
+			    stats.max_allocated_bytes);
+#endif
+		k_heap_frag_stats_get(h, &frag);
+		shell_print(shell,
+			    "%p fragmentation %u.%u %% largest free %zu / %zu in %u chunks",
+			    h, frag.frag_index / 10U, frag.frag_index % 10U,
+			    frag.largest_free_bytes, frag.free_bytes,
+			    frag.free_chunks);
+
+		for (int i = 0; i < frag.nb_buckets; i++) {
+			if (frag.buckets[i].chunks != 0U) {
+				shell_print(shell, "\t>= %6u bytes: %u chunks",
+					    frag.buckets[i].min_bytes,
+					    frag.buckets[i].chunks);
+			}
+		}
+	}
+
+#ifdef CONFIG_K_HEAP_SITE_STATS
+	shell_print(shell, "%-10s %-10s %8s %8s %8s %8s %8s", "site", "heap",
+		    "allocs", "frees", "failures", "bytes", "max");
+	k_heap_site_foreach(shell_heap_site_dump, (void *)shell);
+#endif
+
+	return 0;
+}
+
 #if defined(CONFIG_REBOOT)
 static int cmd_kernel_reboot_warm(const struct shell *shell,
 				  size_t argc, char **argv)
@@ -243,6 +298,7 @@ SHELL_STATIC_SUBCMD_SET_CREATE(sub_kernel_reboot,
 
 SHELL_STATIC_SUBCMD_SET_CREATE(sub_kernel,
 	SHELL_CMD(cycles, NULL, "Kernel cycles.", cmd_kernel_cycles),
+	SHELL_CMD(heaps, NULL, "List static heaps usage.", cmd_kernel_heaps),
 #if defined(CONFIG_REBOOT)
 	SHELL_CMD(reboot, &sub_kernel_reboot, "Reboot.", NULL),
 #endif
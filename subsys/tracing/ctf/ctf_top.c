@@ -210,6 +210,23 @@ void sys_trace_mutex_unlock(struct k_mutex *mutex)
 		);
 }
 
+void sys_trace_k_heap_alloc(struct k_heap *heap, size_t bytes, void *mem)
+{
+	ctf_top_k_heap_alloc(
+		(uint32_t)(uintptr_t)heap,
+		(uint32_t)bytes,
+		(uint32_t)(uintptr_t)mem
+		);
+}
+
+void sys_trace_k_heap_free(struct k_heap *heap, void *mem)
+{
+	ctf_top_k_heap_free(
+		(uint32_t)(uintptr_t)heap,
+		(uint32_t)(uintptr_t)mem
+		);
+}
+
 void sys_trace_end_call(unsigned int id)
 {
 	ctf_top_end_call(id);
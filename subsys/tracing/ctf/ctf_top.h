@@ -91,6 +91,8 @@ typedef enum {
 	CTF_EVENT_MUTEX_INIT			=  0x46,
 	CTF_EVENT_MUTEX_LOCK			=  0x47,
 	CTF_EVENT_MUTEX_UNLOCK			=  0x48,
+	CTF_EVENT_K_HEAP_ALLOC			=  0x49,
+	CTF_EVENT_K_HEAP_FREE			=  0x4A,
 } ctf_event_t;
 
 
@@ -322,4 +324,24 @@ static inline void ctf_top_mutex_unlock(uint32_t mutex_id)
 		);
 }
 
+static inline void ctf_top_k_heap_alloc(uint32_t heap_id, uint32_t bytes,
+					uint32_t mem)
+{
+	CTF_EVENT(
+		CTF_LITERAL(uint8_t, CTF_EVENT_K_HEAP_ALLOC),
+		heap_id,
+		bytes,
+		mem
+		);
+}
+
+static inline void ctf_top_k_heap_free(uint32_t heap_id, uint32_t mem)
+{
+	CTF_EVENT(
+		CTF_LITERAL(uint8_t, CTF_EVENT_K_HEAP_FREE),
+		heap_id,
+		mem
+		);
+}
+
 #endif /* SUBSYS_DEBUG_TRACING_CTF_TOP_H */
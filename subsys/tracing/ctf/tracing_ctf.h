@@ -39,6 +39,9 @@ void sys_trace_mutex_init(struct k_mutex *mutex);
 void sys_trace_mutex_lock(struct k_mutex *mutex);
 void sys_trace_mutex_unlock(struct k_mutex *mutex);
 
+void sys_trace_k_heap_alloc(struct k_heap *heap, size_t bytes, void *mem);
+void sys_trace_k_heap_free(struct k_heap *heap, void *mem);
+
 #ifdef __cplusplus
 }
 #endif
@@ -51,6 +51,9 @@ void cpu_stats_reset_counters(void);
 #define sys_trace_mutex_lock(mutex)
 #define sys_trace_mutex_unlock(mutex)
 
+#define sys_trace_k_heap_alloc(heap, bytes, mem)
+#define sys_trace_k_heap_free(heap, mem)
+
 #ifdef __cplusplus
 }
 #endif
@@ -37,6 +37,9 @@ void sys_trace_semaphore_give(struct k_sem *sem);
 void sys_trace_mutex_init(struct k_mutex *mutex);
 void sys_trace_mutex_lock(struct k_mutex *mutex);
 void sys_trace_mutex_unlock(struct k_mutex *mutex);
+
+#define sys_trace_k_heap_alloc(heap, bytes, mem)
+#define sys_trace_k_heap_free(heap, mem)
 #ifdef __cplusplus
 }
 #endif
@@ -53,4 +53,7 @@ void sys_trace_thread_info(struct k_thread *thread);
 
 #define sys_trace_end_call(id) SEGGER_SYSVIEW_RecordEndCall(id)
 
+#define sys_trace_k_heap_alloc(heap, bytes, mem)
+#define sys_trace_k_heap_free(heap, mem)
+
 #endif /* _TRACE_SYSVIEW_H */
@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <sys/sys_heap_cache.h>
+#include <string.h>
+
+/* SMP small allocation benchmark, see README.rst */
+
+#define N_LIVE 16
+#define N_RUNS 20000
+
+#define HEAP_SIZE (32 * 1024)
+#define STACK_SIZE 1024
+
+struct worker {
+	struct k_heap *heap;
+	void *live[N_LIVE];
+	uint32_t rand_state;
+	uint64_t alloc_cycles;
+	uint64_t free_cycles;
+	uint32_t start;
+	uint32_t end;
+	uint32_t ops;
+	uint32_t failed;
+};
+
+static struct worker workers[CONFIG_MP_NUM_CPUS];
+static struct k_thread threads[CONFIG_MP_NUM_CPUS];
+static K_THREAD_STACK_ARRAY_DEFINE(stacks, CONFIG_MP_NUM_CPUS, STACK_SIZE);
+
+K_HEAP_DEFINE(locked_heap, HEAP_SIZE);
+K_HEAP_DEFINE(cached_heap, HEAP_SIZE);
+static struct sys_heap_cache cache;
+
+static atomic_t ready_count;
+static int active_cpus;
+
+static uint32_t next_rand(struct worker *w)
+{
+	w->rand_state = w->rand_state * 1103515245U + 12345U;
+	return w->rand_state >> 8;
+}
+
+/* Mostly small sizes, 8 to 128 bytes, not only powers of two */
+static size_t rand_size(struct worker *w)
+{
+	uint32_t r = next_rand(w);
+
+	return (8U << (r % 5U)) - (r >> 8) % 8U;
+}
+
+static void worker_fn(void *p1, void *p2, void *p3)
+{
+	struct worker *w = p1;
+	uint32_t start, end;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	/* Line everybody up so the measured loops overlap */
+	atomic_inc(&ready_count);
+	while (atomic_get(&ready_count) < active_cpus) {
+	}
+
+	w->start = k_cycle_get_32();
+
+	for (int run = 0; run < N_RUNS; run++) {
+		void **slot = &w->live[next_rand(w) % N_LIVE];
+		size_t bytes = rand_size(w);
+
+		if (*slot != NULL) {
+			start = k_cycle_get_32();
+			k_heap_free(w->heap, *slot);
+			end = k_cycle_get_32();
+			w->free_cycles += end - start;
+		}
+
+		start = k_cycle_get_32();
+		*slot = k_heap_alloc(w->heap, bytes, K_NO_WAIT);
+		end = k_cycle_get_32();
+		w->alloc_cycles += end - start;
+
+		if (*slot == NULL) {
+			w->failed++;
+		}
+
+		w->ops++;
+	}
+
+	w->end = k_cycle_get_32();
+}
+
+/* Largest block the heap itself can still give, cached blocks included */
+static size_t largest_free(struct k_heap *h)
+{
+	size_t lo = 0, hi = HEAP_SIZE;
+
+	while (lo < hi) {
+		size_t mid = (lo + hi + 1) / 2;
+		void *p = sys_heap_alloc(&h->heap, mid);
+
+		if (p != NULL) {
+			sys_heap_free(&h->heap, p);
+			lo = mid;
+		} else {
+			hi = mid - 1;
+		}
+	}
+
+	return lo;
+}
+
+static void run(struct k_heap *h, const char *name, int ncpus)
+{
+	uint64_t alloc_tot = 0U, free_tot = 0U, elapsed_ns;
+	uint32_t ops = 0U, failed = 0U, first, last;
+	size_t initial = largest_free(h);
+
+	atomic_set(&ready_count, 0);
+	active_cpus = ncpus;
+
+	for (int i = 0; i < ncpus; i++) {
+		memset(&workers[i], 0, sizeof(workers[i]));
+		workers[i].heap = h;
+		workers[i].rand_state = 0x12345678 + i;
+
+		k_thread_create(&threads[i], stacks[i], STACK_SIZE,
+				worker_fn, &workers[i], NULL, NULL,
+				K_PRIO_PREEMPT(1), 0, K_FOREVER);
+#if defined(CONFIG_SCHED_CPU_MASK)
+		k_thread_cpu_mask_clear(&threads[i]);
+		k_thread_cpu_mask_enable(&threads[i], i);
+#endif
+		k_thread_start(&threads[i]);
+	}
+
+	/* The workers run once we block here, including the one
+	 * pinned to our own CPU.
+	 */
+	for (int i = 0; i < ncpus; i++) {
+		k_thread_join(&threads[i], K_FOREVER);
+		alloc_tot += workers[i].alloc_cycles;
+		free_tot += workers[i].free_cycles;
+		ops += workers[i].ops;
+		failed += workers[i].failed;
+	}
+
+	first = workers[0].start;
+	last = workers[0].end;
+
+	for (int i = 1; i < ncpus; i++) {
+		if ((int32_t)(workers[i].start - first) < 0) {
+			first = workers[i].start;
+		}
+		if ((int32_t)(workers[i].end - last) > 0) {
+			last = workers[i].end;
+		}
+	}
+
+	for (int i = 0; i < ncpus; i++) {
+		for (int j = 0; j < N_LIVE; j++) {
+			k_heap_free(h, workers[i].live[j]);
+		}
+	}
+
+	elapsed_ns = MAX(k_cyc_to_ns_floor64(last - first), 1U);
+
+	/* Memory held in the caches is not available to big requests
+	 * until it is flushed.
+	 */
+	printk("cpus %d %s alloc %6u free %6u ns, %7u kops/s, "
+	       "largest free block %3u%%\n", ncpus, name,
+	       (uint32_t)k_cyc_to_ns_floor64(alloc_tot / ops),
+	       (uint32_t)k_cyc_to_ns_floor64(free_tot / ops),
+	       (uint32_t)(ops * 1000000ULL / elapsed_ns),
+	       (uint32_t)(largest_free(h) * 100U / initial));
+
+	if (failed) {
+		printk("%u of %u allocations failed\n", failed, ops);
+	}
+
+	if (h->cache != NULL) {
+		sys_heap_cache_flush(h->cache);
+	}
+}
+
+void main(void)
+{
+	k_heap_cache_init(&cached_heap, &cache);
+
+	for (int ncpus = 1; ncpus <= CONFIG_MP_NUM_CPUS; ncpus++) {
+		run(&locked_heap, "locked", ncpus);
+		run(&cached_heap, "cached", ncpus);
+	}
+
+	printk("fin\n");
+}
@@ -0,0 +1,277 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <sys/lockfree_queue.h>
+
+/* Lock-free queue versus k_msgq and k_fifo benchmark, see README.rst */
+
+#define N_RUNS 20000
+#define CAPACITY 8
+
+/* Items the producer adds before letting the consumer run */
+#define BATCH 4
+
+#define STACK_SIZE 1024
+
+struct item {
+	uint32_t value;
+	uint32_t data[3];
+};
+
+/* k_fifo items need a word for the kernel in front */
+struct fifo_item {
+	void *fifo_reserved;
+	struct item item;
+};
+
+struct queue {
+	const char *name;
+	void (*reset)(void);
+	int (*put)(const struct item *item);
+	int (*get)(struct item *item);
+	int (*get_wait)(struct item *item);
+};
+
+static struct spsc_queue spsc;
+static uint8_t spsc_buf[SPSC_QUEUE_BUF_SIZE(sizeof(struct item), CAPACITY)];
+static struct mpmc_queue mpmc;
+static uint8_t __aligned(sizeof(atomic_t))
+	mpmc_buf[MPMC_QUEUE_BUF_SIZE(sizeof(struct item), CAPACITY)];
+static struct sys_sem sem;
+
+K_MSGQ_DEFINE(msgq, sizeof(struct item), CAPACITY, 4);
+
+/* The k_fifo is bounded like the others, so it can use a ring of items */
+K_FIFO_DEFINE(fifo);
+static struct fifo_item fifo_items[CAPACITY];
+static atomic_t fifo_puts;
+static atomic_t fifo_gets;
+
+static struct k_thread threads[2];
+static K_THREAD_STACK_ARRAY_DEFINE(stacks, 2, STACK_SIZE);
+
+static uint32_t got_sum;
+
+static void spsc_reset(void)
+{
+	sys_sem_init(&sem, 0, 1);
+	spsc_queue_init(&spsc, spsc_buf, sizeof(struct item), CAPACITY);
+	spsc_queue_notify_set(&spsc, &sem, NULL);
+}
+
+static int spsc_put(const struct item *item)
+{
+	return spsc_queue_put(&spsc, item);
+}
+
+static int spsc_get(struct item *item)
+{
+	return spsc_queue_get(&spsc, item);
+}
+
+static int spsc_get_wait(struct item *item)
+{
+	return spsc_queue_get_wait(&spsc, item, K_FOREVER);
+}
+
+static void mpmc_reset(void)
+{
+	sys_sem_init(&sem, 0, 1);
+	mpmc_queue_init(&mpmc, mpmc_buf, sizeof(struct item), CAPACITY);
+	mpmc_queue_notify_set(&mpmc, &sem, NULL);
+}
+
+static int mpmc_put(const struct item *item)
+{
+	return mpmc_queue_put(&mpmc, item);
+}
+
+static int mpmc_get(struct item *item)
+{
+	return mpmc_queue_get(&mpmc, item);
+}
+
+static int mpmc_get_wait(struct item *item)
+{
+	return mpmc_queue_get_wait(&mpmc, item, K_FOREVER);
+}
+
+static void msgq_reset(void)
+{
+	k_msgq_purge(&msgq);
+}
+
+static int msgq_put(const struct item *item)
+{
+	return k_msgq_put(&msgq, item, K_NO_WAIT);
+}
+
+static int msgq_get(struct item *item)
+{
+	return k_msgq_get(&msgq, item, K_NO_WAIT);
+}
+
+static int msgq_get_wait(struct item *item)
+{
+	return k_msgq_get(&msgq, item, K_FOREVER);
+}
+
+static void fifo_reset(void)
+{
+	atomic_set(&fifo_puts, 0);
+	atomic_set(&fifo_gets, 0);
+}
+
+static int fifo_put(const struct item *item)
+{
+	uint32_t puts = atomic_get(&fifo_puts);
+	struct fifo_item *fi;
+
+	if (puts - (uint32_t)atomic_get(&fifo_gets) >= CAPACITY) {
+		return -ENOMSG;
+	}
+
+	fi = &fifo_items[puts % CAPACITY];
+	fi->item = *item;
+	atomic_set(&fifo_puts, puts + 1U);
+	k_fifo_put(&fifo, fi);
+
+	return 0;
+}
+
+static int fifo_get_timeout(struct item *item, k_timeout_t timeout)
+{
+	struct fifo_item *fi = k_fifo_get(&fifo, timeout);
+
+	if (fi == NULL) {
+		return -ENOMSG;
+	}
+
+	*item = fi->item;
+	atomic_inc(&fifo_gets);
+
+	return 0;
+}
+
+static int fifo_get(struct item *item)
+{
+	return fifo_get_timeout(item, K_NO_WAIT);
+}
+
+static int fifo_get_wait(struct item *item)
+{
+	return fifo_get_timeout(item, K_FOREVER);
+}
+
+static const struct queue queues[] = {
+	{ "spsc", spsc_reset, spsc_put, spsc_get, spsc_get_wait },
+	{ "mpmc", mpmc_reset, mpmc_put, mpmc_get, mpmc_get_wait },
+	{ "msgq", msgq_reset, msgq_put, msgq_get, msgq_get_wait },
+	{ "fifo", fifo_reset, fifo_put, fifo_get, fifo_get_wait },
+};
+
+static void producer(void *p1, void *p2, void *p3)
+{
+	const struct queue *q = p1;
+	struct item item = { 0 };
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	for (int run = 1; run <= N_RUNS; run++) {
+		item.value = run;
+		while (q->put(&item) != 0) {
+			k_yield();
+		}
+
+		if (run % BATCH == 0) {
+			k_yield();
+		}
+	}
+}
+
+static void consumer(void *p1, void *p2, void *p3)
+{
+	const struct queue *q = p1;
+	struct item item;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	for (int run = 0; run < N_RUNS; run++) {
+		q->get_wait(&item);
+		got_sum += item.value;
+	}
+}
+
+/* A producer and a consumer thread, the consumer waiting when the
+ * queue is empty.
+ */
+static uint64_t stream(const struct queue *q)
+{
+	uint32_t start, end;
+
+	q->reset();
+	got_sum = 0U;
+
+	start = k_cycle_get_32();
+
+	k_thread_create(&threads[0], stacks[0], STACK_SIZE, consumer,
+			(void *)q, NULL, NULL, K_PRIO_PREEMPT(1), 0, K_NO_WAIT);
+	k_thread_create(&threads[1], stacks[1], STACK_SIZE, producer,
+			(void *)q, NULL, NULL, K_PRIO_PREEMPT(1), 0, K_NO_WAIT);
+
+	k_thread_join(&threads[0], K_FOREVER);
+	k_thread_join(&threads[1], K_FOREVER);
+
+	end = k_cycle_get_32();
+
+	if (got_sum != N_RUNS * (N_RUNS + 1U) / 2U) {
+		printk("%s lost items\n", q->name);
+	}
+
+	return k_cyc_to_ns_floor64(end - start) / N_RUNS;
+}
+
+static void run(const struct queue *q)
+{
+	uint64_t put_cycles = 0U, get_cycles = 0U;
+	struct item item = { 0 };
+	uint32_t start, end;
+
+	q->reset();
+
+	/* Uncontended, the queue never holds more than one item */
+	for (int run = 0; run < N_RUNS; run++) {
+		item.value = run;
+
+		start = k_cycle_get_32();
+		q->put(&item);
+		end = k_cycle_get_32();
+		put_cycles += end - start;
+
+		start = k_cycle_get_32();
+		q->get(&item);
+		end = k_cycle_get_32();
+		get_cycles += end - start;
+	}
+
+	printk("%s put %5u get %5u stream %6u ns\n", q->name,
+	       (uint32_t)k_cyc_to_ns_floor64(put_cycles / N_RUNS),
+	       (uint32_t)k_cyc_to_ns_floor64(get_cycles / N_RUNS),
+	       (uint32_t)stream(q));
+}
+
+void main(void)
+{
+	for (int i = 0; i < ARRAY_SIZE(queues); i++) {
+		run(&queues[i]);
+	}
+
+	printk("fin\n");
+}
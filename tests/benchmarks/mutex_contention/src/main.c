@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <string.h>
+
+/* Contended k_mutex benchmark, see README.rst */
+
+#define N_RUNS 20000
+
+/* Loop iterations outside of the critical section */
+#define WORK 200
+
+#define STACK_SIZE 1024
+
+/* Loop iterations inside of the critical section */
+static const int holds[] = { 0, 50, 500 };
+
+struct worker {
+	int hold;
+	uint64_t lock_cycles;
+	uint64_t unlock_cycles;
+	uint32_t start;
+	uint32_t end;
+};
+
+static struct worker workers[CONFIG_MP_NUM_CPUS];
+static struct k_thread threads[CONFIG_MP_NUM_CPUS];
+static K_THREAD_STACK_ARRAY_DEFINE(stacks, CONFIG_MP_NUM_CPUS, STACK_SIZE);
+
+K_MUTEX_DEFINE(mutex);
+
+/* Protected by mutex */
+static uint32_t counter;
+static uint32_t shared[8];
+
+static atomic_t ready_count;
+static int active_cpus;
+
+static void spin(int loops)
+{
+	for (volatile int i = 0; i < loops; i++) {
+	}
+}
+
+static void worker_fn(void *p1, void *p2, void *p3)
+{
+	struct worker *w = p1;
+	uint32_t start, end;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	/* Line everybody up so the measured loops overlap */
+	atomic_inc(&ready_count);
+	while (atomic_get(&ready_count) < active_cpus) {
+	}
+
+	w->start = k_cycle_get_32();
+
+	for (int run = 0; run < N_RUNS; run++) {
+		start = k_cycle_get_32();
+		k_mutex_lock(&mutex, K_FOREVER);
+		end = k_cycle_get_32();
+		w->lock_cycles += end - start;
+
+		counter++;
+		shared[counter % ARRAY_SIZE(shared)] += counter;
+		spin(w->hold);
+
+		start = k_cycle_get_32();
+		k_mutex_unlock(&mutex);
+		end = k_cycle_get_32();
+		w->unlock_cycles += end - start;
+
+		spin(WORK);
+	}
+
+	w->end = k_cycle_get_32();
+}
+
+static void run(int ncpus, int hold)
+{
+	uint64_t lock_tot = 0U, unlock_tot = 0U, elapsed_ns;
+	uint32_t ops = ncpus * N_RUNS, first, last;
+
+	atomic_set(&ready_count, 0);
+	active_cpus = ncpus;
+	counter = 0U;
+
+	for (int i = 0; i < ncpus; i++) {
+		memset(&workers[i], 0, sizeof(workers[i]));
+		workers[i].hold = hold;
+
+		k_thread_create(&threads[i], stacks[i], STACK_SIZE,
+				worker_fn, &workers[i], NULL, NULL,
+				K_PRIO_PREEMPT(1), 0, K_FOREVER);
+#if defined(CONFIG_SCHED_CPU_MASK)
+		k_thread_cpu_mask_clear(&threads[i]);
+		k_thread_cpu_mask_enable(&threads[i], i);
+#endif
+		k_thread_start(&threads[i]);
+	}
+
+	/* The workers run once we block here, including the one
+	 * pinned to our own CPU.
+	 */
+	for (int i = 0; i < ncpus; i++) {
+		k_thread_join(&threads[i], K_FOREVER);
+		lock_tot += workers[i].lock_cycles;
+		unlock_tot += workers[i].unlock_cycles;
+	}
+
+	first = workers[0].start;
+	last = workers[0].end;
+
+	for (int i = 1; i < ncpus; i++) {
+		if ((int32_t)(workers[i].start - first) < 0) {
+			first = workers[i].start;
+		}
+		if ((int32_t)(workers[i].end - last) > 0) {
+			last = workers[i].end;
+		}
+	}
+
+	elapsed_ns = MAX(k_cyc_to_ns_floor64(last - first), 1U);
+
+	printk("cpus %d hold %3d lock %6u unlock %6u ns, %7u kops/s\n",
+	       ncpus, hold,
+	       (uint32_t)k_cyc_to_ns_floor64(lock_tot / ops),
+	       (uint32_t)k_cyc_to_ns_floor64(unlock_tot / ops),
+	       (uint32_t)(ops * 1000000ULL / elapsed_ns));
+
+	if (counter != ops) {
+		printk("lost updates: counter %u, expected %u\n", counter, ops);
+	}
+}
+
+void main(void)
+{
+	for (int ncpus = 1; ncpus <= CONFIG_MP_NUM_CPUS; ncpus++) {
+		for (int i = 0; i < ARRAY_SIZE(holds); i++) {
+			run(ncpus, holds[i]);
+		}
+	}
+
+	printk("fin\n");
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_chksum_bench, LOG_LEVEL_NONE);
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <timing/timing.h>
+#include <net/net_ip.h>
+#include <net/net_pkt.h>
+
+#include "net_private.h"
+
+/* Checksum calculation microbenchmark, see README.rst */
+
+#define N_RUNS 2000
+
+static const uint16_t sizes[] = { 64, 256, 576, 1280, 1500 };
+
+static uint8_t data[1500];
+
+static volatile uint16_t sink;
+
+static void fill_data(void)
+{
+	uint32_t state = 0x12345678;
+
+	for (int i = 0; i < sizeof(data); i++) {
+		state = state * 1103515245U + 12345U;
+		data[i] = state >> 16;
+	}
+}
+
+static void run_udp(uint16_t size)
+{
+	uint64_t tot = 0U;
+	timing_t start, end;
+	struct net_pkt *pkt;
+
+	/* Without an interface nor a family the size is not cut to an MTU */
+	pkt = net_pkt_alloc_with_buffer(NULL, size, AF_UNSPEC, 0, K_NO_WAIT);
+	if (!pkt) {
+		printk("cannot allocate a packet of %u bytes\n", size);
+		return;
+	}
+
+	if (net_pkt_write(pkt, data, size)) {
+		printk("cannot write a packet of %u bytes\n", size);
+		goto out;
+	}
+
+	net_pkt_set_family(pkt, AF_INET6);
+	net_pkt_set_ip_hdr_len(pkt, NET_IPV6H_LEN);
+	net_pkt_set_ipv6_ext_len(pkt, 0);
+
+	for (int i = 0; i < N_RUNS; i++) {
+		start = timing_counter_get();
+		sink = net_calc_chksum(pkt, IPPROTO_UDP);
+		end = timing_counter_get();
+
+		tot += timing_cycles_get(&start, &end);
+	}
+
+	printk("size %4u udp %6u\n", size,
+	       (uint32_t)timing_cycles_to_ns_avg(tot, N_RUNS));
+
+out:
+	net_pkt_unref(pkt);
+}
+
+static void run_ipv4_hdr(void)
+{
+	uint64_t full_tot = 0U, incr_tot = 0U;
+	struct net_ipv4_hdr *hdr;
+	timing_t start, end;
+	struct net_pkt *pkt;
+	uint16_t old_len;
+
+	pkt = net_pkt_alloc_with_buffer(NULL, NET_IPV4H_LEN, AF_UNSPEC, 0,
+					K_NO_WAIT);
+	if (!pkt) {
+		printk("cannot allocate an IPv4 packet\n");
+		return;
+	}
+
+	if (net_pkt_write(pkt, data, NET_IPV4H_LEN)) {
+		printk("cannot write an IPv4 header\n");
+		goto out;
+	}
+
+	net_pkt_set_family(pkt, AF_INET);
+	net_pkt_set_ip_hdr_len(pkt, NET_IPV4H_LEN);
+	net_pkt_set_ipv4_opts_len(pkt, 0);
+
+	hdr = NET_IPV4_HDR(pkt);
+
+	for (int i = 0; i < N_RUNS; i++) {
+		old_len = hdr->len;
+		hdr->len = htons(i);
+
+		start = timing_counter_get();
+		hdr->chksum = 0U;
+		hdr->chksum = net_calc_chksum_ipv4(pkt);
+		end = timing_counter_get();
+
+		full_tot += timing_cycles_get(&start, &end);
+
+		start = timing_counter_get();
+		sink = net_calc_chksum_update16(hdr->chksum, old_len,
+						hdr->len);
+		end = timing_counter_get();
+
+		incr_tot += timing_cycles_get(&start, &end);
+	}
+
+	printk("ipv4 hdr full %6u incremental %6u\n",
+	       (uint32_t)timing_cycles_to_ns_avg(full_tot, N_RUNS),
+	       (uint32_t)timing_cycles_to_ns_avg(incr_tot, N_RUNS));
+
+out:
+	net_pkt_unref(pkt);
+}
+
+void main(void)
+{
+	fill_data();
+
+	timing_init();
+	timing_start();
+
+	for (int i = 0; i < ARRAY_SIZE(sizes); i++) {
+		run_udp(sizes[i]);
+	}
+
+	run_ipv4_hdr();
+
+	timing_stop();
+
+	printk("fin\n");
+}
@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <timing/timing.h>
+#include <net/net_ip.h>
+#include <net/net_pkt.h>
+#include <net/net_if.h>
+
+#include "connection.h"
+
+/* Connection demux microbenchmark, see README.rst. Packets are handed
+ * directly to net_conn_input() so that only the lookup and not the
+ * L2/IP layers below it is measured.
+ */
+
+#define MAX_CONNS 500
+#define N_RUNS 2000
+
+#define LOCAL_PORT_BASE 10000
+#define REMOTE_PORT_BASE 20000
+#define LISTEN_PORT 7
+
+static const int populations[] = { 10, 100, MAX_CONNS };
+
+static struct net_conn_handle *handles[MAX_CONNS + 1];
+static int delivered;
+
+static uint32_t rand_state = 0x12345678;
+
+static uint32_t next_rand(void)
+{
+	/* Cheap deterministic LCG, the same sequence for every run */
+	rand_state = rand_state * 1103515245U + 12345U;
+	return rand_state >> 8;
+}
+
+static enum net_verdict conn_cb(struct net_conn *conn,
+				struct net_pkt *pkt,
+				union net_ip_header *ip_hdr,
+				union net_proto_header *proto_hdr,
+				void *user_data)
+{
+	ARG_UNUSED(conn);
+	ARG_UNUSED(pkt);
+	ARG_UNUSED(ip_hdr);
+	ARG_UNUSED(proto_hdr);
+	ARG_UNUSED(user_data);
+
+	/* Keep the packet, it is reused for the next lookup */
+	delivered++;
+
+	return NET_OK;
+}
+
+static void peer_addr(int i, struct in_addr *addr)
+{
+	addr->s4_addr[0] = 198;
+	addr->s4_addr[1] = 18;
+	addr->s4_addr[2] = i >> 8;
+	addr->s4_addr[3] = i & 0xff;
+}
+
+static void register_conns(int count)
+{
+	struct sockaddr_in local = {
+		.sin_family = AF_INET,
+		.sin_addr = { { { 192, 0, 2, 1 } } },
+	};
+	struct sockaddr_in remote = {
+		.sin_family = AF_INET,
+	};
+	int ret;
+
+	for (int i = 0; i < count; i++) {
+		peer_addr(i, &remote.sin_addr);
+
+		ret = net_conn_register(IPPROTO_UDP, AF_INET,
+					(struct sockaddr *)&remote,
+					(struct sockaddr *)&local,
+					REMOTE_PORT_BASE + i,
+					LOCAL_PORT_BASE + (i % 16),
+					NULL, conn_cb, NULL, &handles[i]);
+		if (ret < 0) {
+			printk("cannot register conn %d (%d)\n", i, ret);
+			return;
+		}
+	}
+
+	ret = net_conn_register(IPPROTO_UDP, AF_INET, NULL, NULL, 0,
+				LISTEN_PORT, NULL, conn_cb, NULL,
+				&handles[count]);
+	if (ret < 0) {
+		printk("cannot register listener (%d)\n", ret);
+	}
+}
+
+static void unregister_conns(int count)
+{
+	for (int i = 0; i <= count; i++) {
+		net_conn_unregister(handles[i]);
+	}
+}
+
+static uint64_t lookup(struct net_pkt *pkt, struct net_ipv4_hdr *ip,
+		       struct net_udp_hdr *udp)
+{
+	union net_ip_header ip_hdr = { .ipv4 = ip };
+	union net_proto_header proto_hdr = { .udp = udp };
+	timing_t start, end;
+
+	start = timing_counter_get();
+	net_conn_input(pkt, &ip_hdr, IPPROTO_UDP, &proto_hdr);
+	end = timing_counter_get();
+
+	return timing_cycles_get(&start, &end);
+}
+
+static void run(struct net_pkt *pkt, int count)
+{
+	uint64_t tuple_tot = 0U, listen_tot = 0U;
+	struct net_ipv4_hdr ip = { 0 };
+	struct net_udp_hdr udp = { 0 };
+
+	register_conns(count);
+
+	ip.dst.s4_addr[0] = 192;
+	ip.dst.s4_addr[1] = 0;
+	ip.dst.s4_addr[2] = 2;
+	ip.dst.s4_addr[3] = 1;
+
+	delivered = 0;
+
+	for (int i = 0; i < N_RUNS; i++) {
+		int peer = next_rand() % count;
+
+		peer_addr(peer, &ip.src);
+		udp.src_port = htons(REMOTE_PORT_BASE + peer);
+		udp.dst_port = htons(LOCAL_PORT_BASE + (peer % 16));
+
+		tuple_tot += lookup(pkt, &ip, &udp);
+
+		/* A peer no connection is registered for */
+		peer_addr(MAX_CONNS + 1, &ip.src);
+		udp.src_port = htons(REMOTE_PORT_BASE);
+		udp.dst_port = htons(LISTEN_PORT);
+
+		listen_tot += lookup(pkt, &ip, &udp);
+	}
+
+	if (delivered != 2 * N_RUNS) {
+		printk("only %d of %d packets delivered\n", delivered,
+		       2 * N_RUNS);
+	}
+
+	printk("conns %4d tuple %6u listen %6u\n", count,
+	       (uint32_t)timing_cycles_to_ns_avg(tuple_tot, N_RUNS),
+	       (uint32_t)timing_cycles_to_ns_avg(listen_tot, N_RUNS));
+
+	unregister_conns(count);
+}
+
+void main(void)
+{
+	struct net_pkt *pkt;
+
+	pkt = net_pkt_alloc_on_iface(net_if_get_default(), K_FOREVER);
+	net_pkt_set_family(pkt, AF_INET);
+
+	timing_init();
+	timing_start();
+
+	for (int i = 0; i < ARRAY_SIZE(populations); i++) {
+		run(pkt, populations[i]);
+	}
+
+	timing_stop();
+
+	net_pkt_unref(pkt);
+
+	printk("fin\n");
+}
@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <timing/timing.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+#include <net/net_pkt.h>
+
+#include "ipv6.h"
+#include "nbr.h"
+
+/* Neighbor lookup microbenchmark, see README.rst */
+
+#define N_RUNS 2000
+
+static const int populations[] = { 8, 64, CONFIG_NET_IPV6_MAX_NEIGHBORS };
+
+static struct in6_addr my_addr = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+				       0, 0, 0, 0, 0, 0, 0, 0x1 } } };
+
+static uint32_t rand_state = 0x12345678;
+
+static uint32_t next_rand(void)
+{
+	/* Cheap deterministic LCG, the same sequence for every run */
+	rand_state = rand_state * 1103515245U + 12345U;
+	return rand_state >> 8;
+}
+
+/* 2001:db8::<i>:<i + 2> */
+static void nbr_addr(int i, struct in6_addr *addr)
+{
+	net_ipaddr_copy(addr, &my_addr);
+
+	addr->s6_addr[13] = i;
+	addr->s6_addr[15] = i + 2;
+}
+
+static int add_nbrs(struct net_if *iface, int count)
+{
+	uint8_t mac[] = { 0x00, 0x00, 0x5e, 0x00, 0x53, 0x00 };
+	struct net_linkaddr lladdr = {
+		.addr = mac,
+		.len = sizeof(mac),
+		.type = NET_LINK_ETHERNET,
+	};
+	struct in6_addr addr;
+
+	for (int i = 0; i < count; i++) {
+		nbr_addr(i, &addr);
+		mac[5] = i;
+
+		if (!net_ipv6_nbr_add(iface, &addr, &lladdr, false,
+				      NET_IPV6_NBR_STATE_REACHABLE)) {
+			printk("cannot add neighbor %d\n", i);
+			return -ENOMEM;
+		}
+	}
+
+	return 0;
+}
+
+static void del_nbrs(struct net_if *iface, int count)
+{
+	struct in6_addr addr;
+
+	for (int i = 0; i < count; i++) {
+		nbr_addr(i, &addr);
+		net_ipv6_nbr_rm(iface, &addr);
+	}
+}
+
+static struct net_pkt *create_pkt(struct net_if *iface)
+{
+	struct net_pkt *pkt;
+
+	pkt = net_pkt_alloc_with_buffer(iface, 0, AF_INET6, 0, K_NO_WAIT);
+	if (!pkt) {
+		return NULL;
+	}
+
+	if (net_ipv6_create(pkt, &my_addr, &my_addr)) {
+		goto fail;
+	}
+
+	net_pkt_cursor_init(pkt);
+
+	if (net_ipv6_finalize(pkt, NET_IPV6_NEXTHDR_NONE)) {
+		goto fail;
+	}
+
+	return pkt;
+
+fail:
+	net_pkt_unref(pkt);
+	return NULL;
+}
+
+static void run(struct net_if *iface, struct net_pkt *pkt, int count)
+{
+	uint64_t hit_tot = 0U, miss_tot = 0U, tx_tot = 0U;
+	struct net_ipv6_hdr *hdr = NET_IPV6_HDR(pkt);
+	timing_t start, end;
+	struct in6_addr dst;
+	struct net_nbr *nbr;
+	int errors = 0;
+
+	if (add_nbrs(iface, count) < 0) {
+		return;
+	}
+
+	for (int i = 0; i < N_RUNS; i++) {
+		nbr_addr(next_rand() % count, &dst);
+
+		start = timing_counter_get();
+		nbr = net_ipv6_nbr_lookup(iface, &dst);
+		end = timing_counter_get();
+
+		hit_tot += timing_cycles_get(&start, &end);
+
+		if (!nbr) {
+			errors++;
+		}
+
+		/* Same interface identifier, other prefix */
+		dst.s6_addr[2] ^= 0xff;
+
+		start = timing_counter_get();
+		nbr = net_ipv6_nbr_lookup(iface, &dst);
+		end = timing_counter_get();
+
+		miss_tot += timing_cycles_get(&start, &end);
+
+		if (nbr) {
+			errors++;
+		}
+
+		dst.s6_addr[2] ^= 0xff;
+
+		net_ipaddr_copy(&hdr->dst, &dst);
+		net_pkt_lladdr_dst(pkt)->addr = NULL;
+		net_pkt_cursor_init(pkt);
+
+		start = timing_counter_get();
+		if (net_ipv6_prepare_for_send(pkt) != NET_OK) {
+			errors++;
+		}
+		end = timing_counter_get();
+
+		tx_tot += timing_cycles_get(&start, &end);
+	}
+
+	if (errors) {
+		printk("%d of %d lookups failed\n", errors, N_RUNS);
+	}
+
+	printk("neighbors %3d hit %6u miss %6u tx %6u\n", count,
+	       (uint32_t)timing_cycles_to_ns_avg(hit_tot, N_RUNS),
+	       (uint32_t)timing_cycles_to_ns_avg(miss_tot, N_RUNS),
+	       (uint32_t)timing_cycles_to_ns_avg(tx_tot, N_RUNS));
+
+	del_nbrs(iface, count);
+}
+
+void main(void)
+{
+	struct net_if *iface = net_if_get_default();
+	struct net_if_addr *ifaddr;
+	struct net_pkt *pkt;
+
+	ifaddr = net_if_ipv6_addr_add(iface, &my_addr, NET_ADDR_MANUAL, 0);
+	if (!ifaddr || !net_if_ipv6_prefix_add(iface, &my_addr, 64, 0)) {
+		printk("cannot add address\n");
+		return;
+	}
+
+	pkt = create_pkt(iface);
+	if (!pkt) {
+		printk("cannot create packet\n");
+		return;
+	}
+
+	timing_init();
+	timing_start();
+
+	for (int i = 0; i < ARRAY_SIZE(populations); i++) {
+		run(iface, pkt, populations[i]);
+	}
+
+	timing_stop();
+
+	net_pkt_unref(pkt);
+
+	printk("fin\n");
+}
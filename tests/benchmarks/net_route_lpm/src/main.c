@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <timing/timing.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+
+#include "ipv6.h"
+#include "route.h"
+
+/* Routing table lookup microbenchmark, see README.rst */
+
+#define MAX_ROUTES 4096
+#define N_RUNS 2000
+
+/* A neighbor can be the next hop of at most 254 routes */
+#define N_NEXTHOPS 32
+
+static const int populations[] = { 16, 256, MAX_ROUTES };
+
+static struct net_route_entry *routes[MAX_ROUTES + 1];
+static struct net_route_entry_ipv4 *routes_ipv4[MAX_ROUTES + 1];
+
+static struct in6_addr nexthops[N_NEXTHOPS];
+static struct in_addr gw = { { { 192, 0, 2, 1 } } };
+
+static uint8_t nexthop_macs[N_NEXTHOPS][6];
+
+static uint32_t rand_state = 0x12345678;
+
+static uint32_t next_rand(void)
+{
+	/* Cheap deterministic LCG, the same sequence for every run */
+	rand_state = rand_state * 1103515245U + 12345U;
+	return rand_state >> 8;
+}
+
+/* 2001:db8:<i>::/64 */
+static void prefix_ipv6(int i, struct in6_addr *addr)
+{
+	(void)memset(addr, 0, sizeof(*addr));
+
+	addr->s6_addr[0] = 0x20;
+	addr->s6_addr[1] = 0x01;
+	addr->s6_addr[2] = 0x0d;
+	addr->s6_addr[3] = 0xb8;
+	addr->s6_addr[4] = i >> 8;
+	addr->s6_addr[5] = i & 0xff;
+}
+
+/* 10.<i>.0/24 */
+static void prefix_ipv4(int i, struct in_addr *addr)
+{
+	addr->s4_addr[0] = 10;
+	addr->s4_addr[1] = i >> 8;
+	addr->s4_addr[2] = i & 0xff;
+	addr->s4_addr[3] = 0;
+}
+
+static void add_routes(struct net_if *iface, int count)
+{
+	struct in6_addr addr6;
+	struct in_addr addr4;
+
+	for (int i = 0; i < count; i++) {
+		prefix_ipv6(i, &addr6);
+		routes[i] = net_route_add(iface, &addr6, 64,
+					  &nexthops[i % N_NEXTHOPS]);
+
+		prefix_ipv4(i, &addr4);
+		routes_ipv4[i] = net_route_ipv4_add(iface, &addr4, 24, &gw);
+
+		if (!routes[i] || !routes_ipv4[i]) {
+			printk("cannot add route %d\n", i);
+			return;
+		}
+	}
+
+	/* Default routes */
+	(void)memset(&addr6, 0, sizeof(addr6));
+	routes[count] = net_route_add(iface, &addr6, 0, &nexthops[0]);
+
+	(void)memset(&addr4, 0, sizeof(addr4));
+	routes_ipv4[count] = net_route_ipv4_add(iface, &addr4, 0, &gw);
+}
+
+static void del_routes(int count)
+{
+	for (int i = 0; i <= count; i++) {
+		net_route_del(routes[i]);
+		net_route_ipv4_del(routes_ipv4[i]);
+	}
+}
+
+static void run(struct net_if *iface, int count)
+{
+	uint64_t ipv6_tot = 0U, ipv4_tot = 0U;
+	struct net_route_entry_ipv4 *route_ipv4;
+	struct net_route_entry *route;
+	timing_t start, end;
+	struct in6_addr dst6;
+	struct in_addr dst4;
+	int errors = 0;
+
+	add_routes(iface, count);
+
+	for (int i = 0; i < N_RUNS; i++) {
+		int idx = next_rand() % count;
+		uint32_t host = next_rand();
+
+		prefix_ipv6(idx, &dst6);
+		UNALIGNED_PUT(host, (uint32_t *)&dst6.s6_addr[12]);
+
+		start = timing_counter_get();
+		route = net_route_lookup(iface, &dst6);
+		end = timing_counter_get();
+
+		ipv6_tot += timing_cycles_get(&start, &end);
+
+		prefix_ipv4(idx, &dst4);
+		dst4.s4_addr[3] = host;
+
+		start = timing_counter_get();
+		route_ipv4 = net_route_ipv4_lookup(iface, &dst4);
+		end = timing_counter_get();
+
+		ipv4_tot += timing_cycles_get(&start, &end);
+
+		if (route != routes[idx] || route_ipv4 != routes_ipv4[idx]) {
+			errors++;
+		}
+	}
+
+	if (errors) {
+		printk("%d of %d lookups returned a wrong route\n", errors,
+		       N_RUNS);
+	}
+
+	printk("routes %4d ipv6 %6u ipv4 %6u\n", count,
+	       (uint32_t)timing_cycles_to_ns_avg(ipv6_tot, N_RUNS),
+	       (uint32_t)timing_cycles_to_ns_avg(ipv4_tot, N_RUNS));
+
+	del_routes(count);
+}
+
+static int add_nexthops(struct net_if *iface)
+{
+	struct net_linkaddr lladdr = {
+		.len = sizeof(nexthop_macs[0]),
+		.type = NET_LINK_ETHERNET,
+	};
+
+	for (int i = 0; i < N_NEXTHOPS; i++) {
+		/* fe80::<i + 1> and 00-00-5E-00-53-<i + 1> */
+		nexthops[i].s6_addr[0] = 0xfe;
+		nexthops[i].s6_addr[1] = 0x80;
+		nexthops[i].s6_addr[15] = i + 1;
+
+		nexthop_macs[i][2] = 0x5e;
+		nexthop_macs[i][4] = 0x53;
+		nexthop_macs[i][5] = i + 1;
+
+		lladdr.addr = nexthop_macs[i];
+
+		if (!net_ipv6_nbr_add(iface, &nexthops[i], &lladdr, true,
+				      NET_IPV6_NBR_STATE_STATIC)) {
+			printk("cannot add next hop neighbor %d\n", i);
+			return -ENOMEM;
+		}
+	}
+
+	return 0;
+}
+
+void main(void)
+{
+	struct net_if *iface = net_if_get_default();
+
+	if (add_nexthops(iface) < 0) {
+		return;
+	}
+
+	timing_init();
+	timing_start();
+
+	for (int i = 0; i < ARRAY_SIZE(populations); i++) {
+		run(iface, populations[i]);
+	}
+
+	timing_stop();
+
+	printk("fin\n");
+}
@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <timing/timing.h>
+#include <net/socket.h>
+
+/* poll() versus epoll_wait() benchmark, see README.rst */
+
+#define MAX_SOCKS 512
+#define N_RUNS 1000
+#define PORT_BASE 10000
+
+static const int populations[] = { 8, 64, MAX_SOCKS };
+
+static int socks[MAX_SOCKS];
+static struct pollfd pollfds[MAX_SOCKS];
+static int sender;
+static int epfd;
+
+static struct sockaddr_in sock_addr(int i)
+{
+	struct sockaddr_in addr = {
+		.sin_family = AF_INET,
+		.sin_port = htons(PORT_BASE + i),
+		.sin_addr = { { { 192, 0, 2, 1 } } },
+	};
+
+	return addr;
+}
+
+static int open_socks(int count)
+{
+	struct epoll_event ev = {
+		.events = EPOLLIN,
+	};
+	struct sockaddr_in addr;
+
+	for (int i = 0; i < count; i++) {
+		socks[i] = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+		if (socks[i] < 0) {
+			printk("socket %d failed (%d)\n", i, errno);
+			return -1;
+		}
+
+		addr = sock_addr(i);
+
+		if (bind(socks[i], (struct sockaddr *)&addr,
+			 sizeof(addr)) < 0) {
+			printk("bind %d failed (%d)\n", i, errno);
+			return -1;
+		}
+
+		pollfds[i].fd = socks[i];
+		pollfds[i].events = POLLIN;
+
+		ev.data.u32 = i;
+
+		if (epoll_ctl(epfd, EPOLL_CTL_ADD, socks[i], &ev) < 0) {
+			printk("epoll_ctl %d failed (%d)\n", i, errno);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static void close_socks(int count)
+{
+	for (int i = 0; i < count; i++) {
+		/* Closing also removes the socket from the epoll instance */
+		close(socks[i]);
+	}
+}
+
+static void send_to(int i)
+{
+	struct sockaddr_in addr = sock_addr(i);
+	static const char data = 'x';
+
+	(void)sendto(sender, &data, sizeof(data), 0,
+		     (struct sockaddr *)&addr, sizeof(addr));
+}
+
+static int wait_poll(int count, int timeout)
+{
+	int ret;
+
+	ret = poll(pollfds, count, timeout);
+	if (ret <= 0) {
+		return -1;
+	}
+
+	for (int i = 0; i < count; i++) {
+		if (pollfds[i].revents & POLLIN) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+static int wait_epoll(int count, int timeout)
+{
+	struct epoll_event ev;
+
+	ARG_UNUSED(count);
+
+	if (epoll_wait(epfd, &ev, 1, timeout) <= 0) {
+		return -1;
+	}
+
+	return ev.data.u32;
+}
+
+/* A wait that returns at once, one socket has data queued */
+static uint32_t bench_ready(int count, int (*wait)(int, int))
+{
+	int ready = count - 1;
+	uint64_t total = 0U;
+	timing_t start, end;
+	char buf[4];
+
+	send_to(ready);
+	k_msleep(10);
+
+	for (int i = 0; i < N_RUNS; i++) {
+		start = timing_counter_get();
+		if (wait(count, 0) != ready) {
+			printk("wait did not find socket %d\n", ready);
+		}
+		end = timing_counter_get();
+
+		total += timing_cycles_get(&start, &end);
+	}
+
+	(void)recv(socks[ready], buf, sizeof(buf), 0);
+
+	return (uint32_t)timing_cycles_to_ns_avg(total, N_RUNS);
+}
+
+/* Send to the sockets in turn, wait for the datagram and read it */
+static uint32_t bench_rtt(int count, int (*wait)(int, int))
+{
+	uint64_t total = 0U;
+	timing_t start, end;
+	char buf[4];
+	int ready;
+
+	for (int i = 0; i < N_RUNS; i++) {
+		start = timing_counter_get();
+
+		send_to(i % count);
+
+		ready = wait(count, SYS_FOREVER_MS);
+		if (ready != i % count) {
+			printk("wait returned socket %d, not %d\n", ready,
+			       i % count);
+			continue;
+		}
+
+		(void)recv(socks[ready], buf, sizeof(buf), 0);
+
+		end = timing_counter_get();
+
+		total += timing_cycles_get(&start, &end);
+	}
+
+	return (uint32_t)timing_cycles_to_ns_avg(total, N_RUNS);
+}
+
+static void run(int count)
+{
+	uint32_t poll_ns, epoll_ns, poll_rtt, epoll_rtt;
+
+	if (open_socks(count) < 0) {
+		return;
+	}
+
+	poll_ns = bench_ready(count, wait_poll);
+	epoll_ns = bench_ready(count, wait_epoll);
+	poll_rtt = bench_rtt(count, wait_poll);
+	epoll_rtt = bench_rtt(count, wait_epoll);
+
+	printk("fds %3d poll %7u epoll %7u rtt poll %7u epoll %7u\n",
+	       count, poll_ns, epoll_ns, poll_rtt, epoll_rtt);
+
+	close_socks(count);
+}
+
+void main(void)
+{
+	sender = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	epfd = epoll_create1(0);
+
+	if (sender < 0 || epfd < 0) {
+		printk("cannot create sockets (%d)\n", errno);
+		return;
+	}
+
+	timing_init();
+	timing_start();
+
+	for (int i = 0; i < ARRAY_SIZE(populations); i++) {
+		run(populations[i]);
+	}
+
+	timing_stop();
+
+	close(epfd);
+	close(sender);
+
+	printk("fin\n");
+}
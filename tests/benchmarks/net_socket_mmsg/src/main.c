@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <timing/timing.h>
+#include <net/socket.h>
+
+/* sendmmsg()/recvmmsg() versus per datagram calls, see README.rst */
+
+#define MAX_BATCH 64
+#define N_DGRAMS 4096
+#define DGRAM_LEN 32
+#define PORT 9999
+
+/* 0 stands for sendto() and recvfrom() */
+static const int batches[] = { 0, 1, 8, 32, MAX_BATCH };
+
+static struct mmsghdr tx_msgs[MAX_BATCH];
+static struct mmsghdr rx_msgs[MAX_BATCH];
+static struct iovec tx_iov[MAX_BATCH];
+static struct iovec rx_iov[MAX_BATCH];
+static char tx_buf[DGRAM_LEN];
+static char rx_bufs[MAX_BATCH][DGRAM_LEN];
+
+static struct sockaddr_in addr = {
+	.sin_family = AF_INET,
+	.sin_port = htons(PORT),
+	.sin_addr = { { { 192, 0, 2, 1 } } },
+};
+
+static int sender;
+static int receiver;
+
+static void setup_msgs(void)
+{
+	for (int i = 0; i < MAX_BATCH; i++) {
+		tx_iov[i].iov_base = tx_buf;
+		tx_iov[i].iov_len = sizeof(tx_buf);
+		tx_msgs[i].msg_hdr.msg_iov = &tx_iov[i];
+		tx_msgs[i].msg_hdr.msg_iovlen = 1;
+		tx_msgs[i].msg_hdr.msg_name = &addr;
+		tx_msgs[i].msg_hdr.msg_namelen = sizeof(addr);
+
+		rx_iov[i].iov_base = rx_bufs[i];
+		rx_iov[i].iov_len = sizeof(rx_bufs[i]);
+		rx_msgs[i].msg_hdr.msg_iov = &rx_iov[i];
+		rx_msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+}
+
+static int xfer_single(int count)
+{
+	for (int i = 0; i < count; i++) {
+		if (sendto(sender, tx_buf, sizeof(tx_buf), 0,
+			   (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+			return -1;
+		}
+	}
+
+	for (int i = 0; i < count; i++) {
+		if (recv(receiver, rx_bufs[i], sizeof(rx_bufs[i]), 0) < 0) {
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static int xfer_batch(int count)
+{
+	int ret;
+
+	ret = sendmmsg(sender, tx_msgs, count, 0);
+	if (ret != count) {
+		return -1;
+	}
+
+	ret = recvmmsg(receiver, rx_msgs, count, 0, NULL);
+	if (ret != count) {
+		return -1;
+	}
+
+	return 0;
+}
+
+static void run(int batch)
+{
+	/* The reference run moves the datagrams in groups of 8 */
+	int count = batch ? batch : 8;
+	uint64_t total = 0U;
+	timing_t start, end;
+	uint64_t ns;
+	uint32_t rate;
+
+	for (int i = 0; i < N_DGRAMS; i += count) {
+		start = timing_counter_get();
+
+		if ((batch ? xfer_batch(count) : xfer_single(count)) < 0) {
+			printk("batch %d failed (%d)\n", batch, errno);
+			return;
+		}
+
+		end = timing_counter_get();
+
+		total += timing_cycles_get(&start, &end);
+	}
+
+	ns = timing_cycles_to_ns(total);
+	rate = ns ? (uint32_t)(N_DGRAMS * 1000000000ULL / ns) : 0U;
+
+	printk("batch %2d dgrams/s %8u\n", batch, rate);
+}
+
+void main(void)
+{
+	sender = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	receiver = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+
+	if (sender < 0 || receiver < 0) {
+		printk("cannot create sockets (%d)\n", errno);
+		return;
+	}
+
+	if (bind(receiver, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		printk("bind failed (%d)\n", errno);
+		return;
+	}
+
+	setup_msgs();
+
+	timing_init();
+	timing_start();
+
+	for (int i = 0; i < ARRAY_SIZE(batches); i++) {
+		run(batches[i]);
+	}
+
+	timing_stop();
+
+	close(receiver);
+	close(sender);
+
+	printk("fin\n");
+}
@@ -26,7 +26,13 @@
  *
  * It then iterates this many times, reporting timestamp latencies
  * between each numbered step and for the whole cycle, and a running
- * average for all cycles run.
+ * average for all cycles run.  At the end it reports the average
+ * latency of the two context switches (steps 3 and 4) for the number
+ * of CPUs it was built for.
+ *
+ * On SMP, both threads are pinned to CPU 0, otherwise the partner
+ * would be woken on another CPU as soon as it is readied and the
+ * steps above would race.
  */
 
 #define N_RUNS 1000
@@ -36,6 +42,9 @@
 static K_THREAD_STACK_DEFINE(partner_stack, 1024);
 static struct k_thread partner_thread;
 
+static K_THREAD_STACK_DEFINE(bench_stack, 1024);
+static struct k_thread bench_thread;
+
 _wait_q_t waitq;
 
 enum {
@@ -86,22 +95,17 @@ static void partner_fn(void *arg1, void *arg2, void *arg3)
 	}
 }
 
-void main(void)
+static void bench_fn(void *arg1, void *arg2, void *arg3)
 {
-	z_waitq_init(&waitq);
+	k_tid_t th = arg1;
 
-	int main_prio = k_thread_priority_get(k_current_get());
-	int partner_prio = main_prio - 1;
-
-	k_tid_t th = k_thread_create(&partner_thread, partner_stack,
-				     K_THREAD_STACK_SIZEOF(partner_stack),
-				     partner_fn, NULL, NULL, NULL,
-				     partner_prio, 0, K_NO_WAIT);
+	ARG_UNUSED(arg2);
+	ARG_UNUSED(arg3);
 
-	/* Let it start running and pend */
+	/* Let the partner start running and pend */
 	k_sleep(K_MSEC(100));
 
-	uint64_t tot = 0U;
+	uint64_t tot = 0U, tot_switch = 0U, tot_pend = 0U;
 	uint32_t runs = 0U;
 
 	for (int i = 0; i < N_RUNS + N_SETTLE; i++) {
@@ -129,6 +133,8 @@ void main(void)
 			 * data
 			 */
 			tot += whole;
+			tot_switch += stamps[3] - stamps[2];
+			tot_pend += stamps[4] - stamps[3];
 			avg = tot / (runs - 10);
 		} else {
 			tot = 0U;
@@ -148,5 +154,45 @@ void main(void)
 		       stamps[4] - stamps[3],
 		       whole, avg);
 	}
+
+	printk("cpus %d switch avg %4d pend avg %4d\n", CONFIG_MP_NUM_CPUS,
+	       (uint32_t)(tot_switch / N_RUNS), (uint32_t)(tot_pend / N_RUNS));
+}
+
+static void pin_cpu0(k_tid_t th)
+{
+#ifdef CONFIG_SCHED_CPU_MASK
+	k_thread_cpu_mask_clear(th);
+	k_thread_cpu_mask_enable(th, 0);
+#endif
+}
+
+void main(void)
+{
+	z_waitq_init(&waitq);
+
+	printk("cpus %d runq %s\n", CONFIG_MP_NUM_CPUS,
+	       IS_ENABLED(CONFIG_SCHED_MULTIQ) ? "multiq" :
+	       IS_ENABLED(CONFIG_SCHED_SCALABLE) ? "scalable" : "dumb");
+
+	int main_prio = k_thread_priority_get(k_current_get());
+	int partner_prio = main_prio - 1;
+
+	k_tid_t th = k_thread_create(&partner_thread, partner_stack,
+				     K_THREAD_STACK_SIZEOF(partner_stack),
+				     partner_fn, NULL, NULL, NULL,
+				     partner_prio, 0, K_FOREVER);
+	k_tid_t bench = k_thread_create(&bench_thread, bench_stack,
+					K_THREAD_STACK_SIZEOF(bench_stack),
+					bench_fn, th, NULL, NULL,
+					main_prio, 0, K_FOREVER);
+
+	/* The CPU mask can only be changed before the threads start */
+	pin_cpu0(th);
+	pin_cpu0(bench);
+	k_thread_start(th);
+	k_thread_start(bench);
+
+	k_thread_join(bench, K_FOREVER);
 	printk("fin\n");
 }
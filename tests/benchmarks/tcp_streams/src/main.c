@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <net/socket.h>
+
+/* Loopback TCP multi-stream throughput benchmark, see README.rst */
+
+#define MAX_STREAMS 4
+#define STREAM_BYTES (256 * 1024)
+#define CHUNK 1024
+#define PORT 4242
+#define STACK_SIZE 2048
+#define PRIO K_PRIO_PREEMPT(8)
+
+static const int stream_counts[] = { 1, 2, MAX_STREAMS };
+
+K_THREAD_STACK_ARRAY_DEFINE(tx_stacks, MAX_STREAMS, STACK_SIZE);
+K_THREAD_STACK_ARRAY_DEFINE(rx_stacks, MAX_STREAMS, STACK_SIZE);
+static struct k_thread tx_threads[MAX_STREAMS];
+static struct k_thread rx_threads[MAX_STREAMS];
+
+static struct sockaddr_in server_addr = {
+	.sin_family = AF_INET,
+	.sin_port = htons(PORT),
+	.sin_addr = { { { 192, 0, 2, 1 } } },
+};
+
+static size_t received[MAX_STREAMS];
+
+static void sender(void *p1, void *p2, void *p3)
+{
+	static uint8_t buf[CHUNK];
+	size_t left = STREAM_BYTES;
+	int sock;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (sock < 0) {
+		printk("socket failed (%d)\n", errno);
+		return;
+	}
+
+	if (connect(sock, (struct sockaddr *)&server_addr,
+		    sizeof(server_addr)) < 0) {
+		printk("connect failed (%d)\n", errno);
+		close(sock);
+		return;
+	}
+
+	while (left > 0) {
+		ssize_t ret = send(sock, buf, MIN(left, sizeof(buf)), 0);
+
+		if (ret < 0) {
+			printk("send failed (%d)\n", errno);
+			break;
+		}
+
+		left -= ret;
+	}
+
+	close(sock);
+}
+
+static void receiver(void *p1, void *p2, void *p3)
+{
+	int sock = POINTER_TO_INT(p1);
+	int idx = POINTER_TO_INT(p2);
+	uint8_t buf[CHUNK];
+	ssize_t ret;
+
+	ARG_UNUSED(p3);
+
+	while ((ret = recv(sock, buf, sizeof(buf), 0)) > 0) {
+		received[idx] += ret;
+	}
+
+	close(sock);
+}
+
+static void run(int listener, int streams)
+{
+	size_t total = 0;
+	int64_t start;
+	int64_t ms;
+
+	for (int i = 0; i < streams; i++) {
+		received[i] = 0;
+		k_thread_create(&tx_threads[i], tx_stacks[i], STACK_SIZE,
+				sender, NULL, NULL, NULL, PRIO, 0, K_NO_WAIT);
+	}
+
+	start = k_uptime_get();
+
+	for (int i = 0; i < streams; i++) {
+		int sock = accept(listener, NULL, NULL);
+
+		if (sock < 0) {
+			printk("accept failed (%d)\n", errno);
+			return;
+		}
+
+		k_thread_create(&rx_threads[i], rx_stacks[i], STACK_SIZE,
+				receiver, INT_TO_POINTER(sock),
+				INT_TO_POINTER(i), NULL, PRIO, 0, K_NO_WAIT);
+	}
+
+	for (int i = 0; i < streams; i++) {
+		k_thread_join(&tx_threads[i], K_FOREVER);
+		k_thread_join(&rx_threads[i], K_FOREVER);
+		total += received[i];
+	}
+
+	ms = MAX(k_uptime_get() - start, 1);
+
+	if (total != (size_t)streams * STREAM_BYTES) {
+		printk("received %zu of %zu bytes\n", total,
+		       (size_t)streams * STREAM_BYTES);
+	}
+
+	printk("streams %d workq %d kbps %u\n", streams,
+	       CONFIG_NET_TCP_WORKQ_COUNT, (uint32_t)(total * 8U / ms));
+}
+
+void main(void)
+{
+	int listener;
+
+	listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (listener < 0) {
+		printk("socket failed (%d)\n", errno);
+		return;
+	}
+
+	if (bind(listener, (struct sockaddr *)&server_addr,
+		 sizeof(server_addr)) < 0 ||
+	    listen(listener, MAX_STREAMS) < 0) {
+		printk("cannot listen (%d)\n", errno);
+		return;
+	}
+
+	for (int i = 0; i < ARRAY_SIZE(stream_counts); i++) {
+		run(listener, stream_counts[i]);
+
+		/* Let the closed connections go through TIME_WAIT */
+		k_sleep(K_MSEC(CONFIG_NET_TCP_TIME_WAIT_DELAY + 100));
+	}
+
+	close(listener);
+
+	printk("fin\n");
+}
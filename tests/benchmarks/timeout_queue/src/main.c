@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <timeout_q.h>
+#include <timing/timing.h>
+
+/* Timeout queue microbenchmark, see README.rst.  It works directly
+ * on struct _timeout objects so that only the queue operations, not
+ * the k_timer or k_work layers above them, are measured.
+ */
+
+#define MAX_OUTSTANDING 10000
+#define N_RUNS 200
+#define N_BATCH 32
+
+/* Background timeouts are spread over this many ticks past BG_MIN */
+#define BG_MIN 1000
+#define BG_SPAN 100000
+
+/* Batch probes expire this far out, beyond the first wheel level */
+#define BATCH_TICKS 100
+
+static const int populations[] = { 10, 100, MAX_OUTSTANDING };
+
+static struct _timeout background[MAX_OUTSTANDING];
+static struct _timeout probe;
+static struct _timeout batch[N_BATCH];
+
+static timing_t batch_stamps[N_BATCH];
+static int batch_fired;
+
+static uint32_t rand_state = 0x12345678;
+
+static uint32_t next_rand(void)
+{
+	/* Cheap deterministic LCG, the same sequence for every backend */
+	rand_state = rand_state * 1103515245U + 12345U;
+	return rand_state >> 8;
+}
+
+static void background_fn(struct _timeout *t)
+{
+	ARG_UNUSED(t);
+
+	printk("background timeout fired, increase BG_MIN\n");
+}
+
+static void probe_fn(struct _timeout *t)
+{
+	ARG_UNUSED(t);
+}
+
+static void batch_fn(struct _timeout *t)
+{
+	ARG_UNUSED(t);
+
+	batch_stamps[batch_fired++] = timing_counter_get();
+}
+
+static void run(int outstanding)
+{
+	uint64_t insert_tot = 0U, cancel_tot = 0U, expire_tot = 0U;
+	timing_t start, end;
+
+	for (int i = 0; i < outstanding; i++) {
+		z_init_timeout(&background[i]);
+		z_add_timeout(&background[i], background_fn,
+			      K_TICKS(BG_MIN + next_rand() % BG_SPAN));
+	}
+
+	for (int run = 0; run < N_RUNS; run++) {
+		k_timeout_t to = K_TICKS(BG_MIN + next_rand() % BG_SPAN);
+
+		start = timing_counter_get();
+		z_add_timeout(&probe, probe_fn, to);
+		end = timing_counter_get();
+		insert_tot += timing_cycles_get(&start, &end);
+
+		start = timing_counter_get();
+		z_abort_timeout(&probe);
+		end = timing_counter_get();
+		cancel_tot += timing_cycles_get(&start, &end);
+	}
+
+	for (int run = 0; run < N_RUNS / N_BATCH; run++) {
+		batch_fired = 0;
+		for (int i = 0; i < N_BATCH; i++) {
+			z_add_timeout(&batch[i], batch_fn, K_TICKS(BATCH_TICKS));
+		}
+
+		k_sleep(K_TICKS(BATCH_TICKS + 1));
+
+		if (batch_fired != N_BATCH) {
+			printk("only %d of %d batch timeouts fired\n",
+			       batch_fired, N_BATCH);
+			continue;
+		}
+
+		expire_tot += timing_cycles_get(&batch_stamps[0],
+						&batch_stamps[N_BATCH - 1]);
+	}
+
+	for (int i = 0; i < outstanding; i++) {
+		z_abort_timeout(&background[i]);
+	}
+
+	printk("outstanding %5d insert %6u cancel %6u expire %6u (ns)\n",
+	       outstanding,
+	       (uint32_t)timing_cycles_to_ns_avg(insert_tot, N_RUNS),
+	       (uint32_t)timing_cycles_to_ns_avg(cancel_tot, N_RUNS),
+	       (uint32_t)timing_cycles_to_ns_avg(expire_tot,
+			(N_RUNS / N_BATCH) * (N_BATCH - 1)));
+}
+
+void main(void)
+{
+	z_init_timeout(&probe);
+	for (int i = 0; i < N_BATCH; i++) {
+		z_init_timeout(&batch[i]);
+	}
+
+	timing_init();
+	timing_start();
+
+	printk("timeout queue: %s\n",
+	       IS_ENABLED(CONFIG_TIMEOUT_QUEUE_WHEEL) ? "wheel" : "dlist");
+
+	for (int i = 0; i < ARRAY_SIZE(populations); i++) {
+		run(populations[i]);
+	}
+
+	timing_stop();
+	printk("fin\n");
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <timeout_q.h>
+#include <string.h>
+
+/* SMP timeout queue scaling benchmark, see README.rst */
+
+#define N_TIMEOUTS 64
+#define N_RUNS 5000
+
+/* Armed timeouts land this many ticks out, so none of them fire */
+#define TIMEOUT_MIN 100000
+#define TIMEOUT_SPAN 100000
+
+#define STACK_SIZE 1024
+
+struct worker {
+	struct _timeout timeouts[N_TIMEOUTS];
+	uint32_t rand_state;
+	uint64_t arm_cycles;
+	uint64_t abort_cycles;
+	uint32_t ops;
+};
+
+static struct worker workers[CONFIG_MP_NUM_CPUS];
+static struct k_thread threads[CONFIG_MP_NUM_CPUS];
+static K_THREAD_STACK_ARRAY_DEFINE(stacks, CONFIG_MP_NUM_CPUS, STACK_SIZE);
+
+static atomic_t ready_count;
+static int active_cpus;
+
+static uint32_t next_rand(struct worker *w)
+{
+	w->rand_state = w->rand_state * 1103515245U + 12345U;
+	return w->rand_state >> 8;
+}
+
+static void timeout_fn(struct _timeout *t)
+{
+	ARG_UNUSED(t);
+
+	printk("timeout fired, increase TIMEOUT_MIN\n");
+}
+
+static k_timeout_t rand_timeout(struct worker *w)
+{
+	return K_TICKS(TIMEOUT_MIN + next_rand(w) % TIMEOUT_SPAN);
+}
+
+static void worker_fn(void *p1, void *p2, void *p3)
+{
+	struct worker *w = p1;
+	uint32_t start, end;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	for (int i = 0; i < N_TIMEOUTS; i++) {
+		z_init_timeout(&w->timeouts[i]);
+		z_add_timeout(&w->timeouts[i], timeout_fn, rand_timeout(w));
+	}
+
+	/* Line everybody up so the measured loops overlap */
+	atomic_inc(&ready_count);
+	while (atomic_get(&ready_count) < active_cpus) {
+	}
+
+	for (int run = 0; run < N_RUNS; run++) {
+		struct _timeout *t = &w->timeouts[next_rand(w) % N_TIMEOUTS];
+
+		start = k_cycle_get_32();
+		z_abort_timeout(t);
+		end = k_cycle_get_32();
+		w->abort_cycles += end - start;
+
+		start = k_cycle_get_32();
+		z_add_timeout(t, timeout_fn, rand_timeout(w));
+		end = k_cycle_get_32();
+		w->arm_cycles += end - start;
+
+		w->ops++;
+	}
+
+	for (int i = 0; i < N_TIMEOUTS; i++) {
+		z_abort_timeout(&w->timeouts[i]);
+	}
+}
+
+static void run(int ncpus)
+{
+	uint64_t arm = 0U, abort = 0U;
+	uint32_t ops = 0U;
+
+	atomic_set(&ready_count, 0);
+	active_cpus = ncpus;
+
+	for (int i = 0; i < ncpus; i++) {
+		memset(&workers[i], 0, sizeof(workers[i]));
+		workers[i].rand_state = 0x12345678 + i;
+
+		k_thread_create(&threads[i], stacks[i], STACK_SIZE,
+				worker_fn, &workers[i], NULL, NULL,
+				K_PRIO_PREEMPT(1), 0, K_FOREVER);
+		k_thread_cpu_mask_clear(&threads[i]);
+		k_thread_cpu_mask_enable(&threads[i], i);
+		k_thread_start(&threads[i]);
+	}
+
+	/* The workers run once we block here, including the one
+	 * pinned to our own CPU.
+	 */
+	for (int i = 0; i < ncpus; i++) {
+		k_thread_join(&threads[i], K_FOREVER);
+		arm += workers[i].arm_cycles;
+		abort += workers[i].abort_cycles;
+		ops += workers[i].ops;
+	}
+
+	printk("cpus %d arm %6u abort %6u\n", ncpus,
+	       (uint32_t)(arm / ops), (uint32_t)(abort / ops));
+}
+
+void main(void)
+{
+	printk("timeout queue: %s\n",
+	       IS_ENABLED(CONFIG_TIMEOUT_QUEUE_PER_CPU) ? "per_cpu" : "dlist");
+
+	for (int ncpus = 1; ncpus <= CONFIG_MP_NUM_CPUS; ncpus++) {
+		run(ncpus);
+	}
+
+	printk("fin\n");
+}
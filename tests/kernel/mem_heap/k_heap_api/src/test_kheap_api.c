@@ -6,6 +6,7 @@
 
 #include <ztest.h>
 #include <irq_offload.h>
+#include <string.h>
 #include "test_kheap.h"
 
 #define STACK_SIZE (512 + CONFIG_TEST_EXTRA_STACKSIZE)
@@ -154,3 +155,231 @@ void test_k_heap_alloc_pending(void)
 
 	k_thread_join(tid, K_FOREVER);
 }
+
+#ifdef CONFIG_SYS_HEAP_CPU_CACHE
+#include <sys/sys_heap_cache.h>
+
+K_HEAP_DEFINE(k_heap_cache_test, HEAP_SIZE);
+static struct sys_heap_cache heap_cache;
+
+#define CACHE_BATCH (CONFIG_SYS_HEAP_CPU_CACHE_SIZE / 2)
+#define SMALL_BLOCKS 16
+
+static void *small_blocks[SMALL_BLOCKS];
+
+static void thread_alloc_cached_heap(void *p1, void *p2, void *p3)
+{
+	char *p = (char *)k_heap_alloc(&k_heap_cache_test, ALLOC_SIZE_2,
+				       Z_TIMEOUT_MS(200));
+
+	zassert_not_null(p, "k_heap_alloc operation failed");
+	k_heap_free(&k_heap_cache_test, p);
+}
+#endif
+
+/**
+ * @brief Validate the per-CPU caches of small blocks of a k_heap.
+ *
+ * @details Small blocks are refilled in batches and reused in LIFO
+ * order, and the cached blocks are given back to the heap when a big
+ * allocation would fail otherwise.
+ *
+ * @ingroup kernel_heap_tests
+ */
+void test_k_heap_cache(void)
+{
+#ifdef CONFIG_SYS_HEAP_CPU_CACHE
+	char *p, *q;
+	int i;
+
+	k_heap_cache_init(&k_heap_cache_test, &heap_cache);
+
+	p = k_heap_alloc(&k_heap_cache_test, 24, K_NO_WAIT);
+	zassert_not_null(p, "k_heap_alloc operation failed");
+	zassert_equal(sys_heap_cache_count(&heap_cache), CACHE_BATCH - 1,
+		      "Cache not refilled");
+
+	k_heap_free(&k_heap_cache_test, p);
+	zassert_equal(sys_heap_cache_count(&heap_cache), CACHE_BATCH,
+		      "Block not cached");
+
+	/* Same 32 bytes class */
+	q = k_heap_alloc(&k_heap_cache_test, 20, K_NO_WAIT);
+	zassert_equal(p, q, "Cached block not reused");
+	k_heap_free(&k_heap_cache_test, q);
+
+	/* Too big to be cached.  Just above the largest class would share
+	 * its chunk size once a call site tag is added.
+	 */
+	p = k_heap_alloc(&k_heap_cache_test, 2 * SYS_HEAP_CACHE_MAX_BYTES,
+			 K_NO_WAIT);
+	zassert_not_null(p, "k_heap_alloc operation failed");
+	k_heap_free(&k_heap_cache_test, p);
+	zassert_equal(sys_heap_cache_count(&heap_cache), CACHE_BATCH,
+		      "Big block cached");
+
+	/* Fill every class, the magazines keep some of the blocks */
+	for (i = 0; i < SMALL_BLOCKS; i++) {
+		size_t bytes = SYS_HEAP_CACHE_MIN_BYTES <<
+			       (i % CONFIG_SYS_HEAP_CPU_CACHE_CLASSES);
+
+		small_blocks[i] = k_heap_alloc(&k_heap_cache_test, bytes,
+					       K_NO_WAIT);
+		zassert_not_null(small_blocks[i], "k_heap_alloc failed");
+	}
+
+	for (i = 0; i < SMALL_BLOCKS; i++) {
+		k_heap_free(&k_heap_cache_test, small_blocks[i]);
+	}
+
+	zassert_true(sys_heap_cache_count(&heap_cache) > CACHE_BATCH,
+		     "Blocks not cached");
+
+	/* Needs the memory of the cached blocks */
+	p = k_heap_alloc(&k_heap_cache_test, ALLOC_SIZE_2, K_NO_WAIT);
+	zassert_not_null(p, "Cached blocks not given back");
+	zassert_equal(sys_heap_cache_count(&heap_cache), 0,
+		      "Cache not flushed");
+	k_heap_free(&k_heap_cache_test, p);
+#else
+	ztest_test_skip();
+#endif
+}
+
+/**
+ * @brief Validate that frees of cached blocks wake a waiting thread.
+ *
+ * @details The child thread waits for a big block while the main
+ * thread holds small ones.  Freeing them must not leave them in the
+ * caches, so that the child thread gets its block.
+ *
+ * @ingroup kernel_heap_tests
+ */
+void test_k_heap_cache_pending(void)
+{
+#ifdef CONFIG_SYS_HEAP_CPU_CACHE
+	k_tid_t tid;
+	int i;
+
+	k_heap_cache_init(&k_heap_cache_test, &heap_cache);
+
+	for (i = 0; i < SMALL_BLOCKS; i++) {
+		small_blocks[i] = k_heap_alloc(&k_heap_cache_test,
+					       64,
+					       K_NO_WAIT);
+		zassert_not_null(small_blocks[i], "k_heap_alloc failed");
+	}
+
+	tid = k_thread_create(&tdata, tstack, STACK_SIZE,
+			      thread_alloc_cached_heap, NULL, NULL, NULL,
+			      K_PRIO_PREEMPT(5), 0, K_NO_WAIT);
+
+	/* make the child thread run */
+	k_msleep(1);
+
+	for (i = 0; i < SMALL_BLOCKS; i++) {
+		k_heap_free(&k_heap_cache_test, small_blocks[i]);
+	}
+
+	k_thread_join(tid, K_FOREVER);
+
+	sys_heap_cache_flush(&heap_cache);
+#else
+	ztest_test_skip();
+#endif
+}
+
+#ifdef CONFIG_K_HEAP_SITE_STATS
+K_HEAP_DEFINE(k_heap_site_test, HEAP_SIZE);
+
+static void site_cb(const struct k_heap_site *site, void *user_data)
+{
+	struct k_heap_site *total = user_data;
+
+	if (site->heap == &k_heap_site_test) {
+		total->allocs += site->allocs;
+		total->frees += site->frees;
+		total->failures += site->failures;
+		total->bytes += site->bytes;
+		total->max_bytes += site->max_bytes;
+	}
+}
+
+/* Sum of the call sites of k_heap_site_test, an allocation in tail
+ * position is accounted to the caller of its caller.
+ */
+static struct k_heap_site site_test_get(void)
+{
+	struct k_heap_site total = { 0 };
+
+	k_heap_site_foreach(site_cb, &total);
+
+	return total;
+}
+#endif
+
+/**
+ * @brief Validate the allocation statistics of a k_heap.
+ *
+ * @details The allocations are accounted to their call site, with
+ * the bytes in use and the failures, and the usage and fragmentation
+ * of the heap can be read back.
+ *
+ * @ingroup kernel_heap_tests
+ */
+void test_k_heap_stats(void)
+{
+#ifdef CONFIG_K_HEAP_SITE_STATS
+	struct sys_heap_frag_stats frag;
+#ifdef CONFIG_SYS_HEAP_RUNTIME_STATS
+	struct sys_memory_stats stats;
+#endif
+	struct k_heap_site site;
+	char *p, *q;
+
+	p = k_heap_alloc(&k_heap_site_test, 100, K_NO_WAIT);
+	q = k_heap_alloc(&k_heap_site_test, 200, K_NO_WAIT);
+	zassert_true(p != NULL && q != NULL, "k_heap_alloc operation failed");
+
+	/* The call site tag is not part of the memory given */
+	memset(p, 0xaa, 100);
+	memset(q, 0x55, 200);
+
+	zassert_is_null(k_heap_alloc(&k_heap_site_test, HEAP_SIZE, K_NO_WAIT),
+			"Oversized allocation");
+
+	site = site_test_get();
+	zassert_equal(site.allocs, 2, "Allocations not counted");
+	zassert_equal(site.failures, 1, "Failure not counted");
+	zassert_equal(site.frees, 0, "Spurious free");
+	zassert_true(site.bytes >= 300, "Bytes not counted");
+	zassert_equal(site.max_bytes, site.bytes, "Max not raised");
+
+#ifdef CONFIG_SYS_HEAP_RUNTIME_STATS
+	k_heap_runtime_stats_get(&k_heap_site_test, &stats);
+	zassert_true(stats.allocated_bytes >= site.bytes,
+		     "Heap usage not counted");
+#endif
+
+	/* A hole between the two blocks and the rest of the heap */
+	k_heap_free(&k_heap_site_test, p);
+	k_heap_frag_stats_get(&k_heap_site_test, &frag);
+	zassert_equal(frag.free_chunks, 2, "Hole not seen");
+	zassert_true(frag.frag_index > 0, "Hole not seen as fragmentation");
+
+	k_heap_free(&k_heap_site_test, q);
+
+	site = site_test_get();
+	zassert_equal(site.frees, 2, "Frees not counted");
+	zassert_equal(site.bytes, 0, "Bytes not given back");
+	zassert_true(site.max_bytes >= 300, "Max lost");
+
+#ifdef CONFIG_SYS_HEAP_RUNTIME_STATS
+	k_heap_runtime_stats_get(&k_heap_site_test, &stats);
+	zassert_equal(stats.allocated_bytes, 0, "Memory leaked");
+	zassert_true(stats.max_allocated_bytes >= 300, "Max lost");
+#endif
+#else
+	ztest_test_skip();
+#endif
+}
@@ -23,6 +23,9 @@ extern void test_msgq_alloc(void);
 extern void test_msgq_pend_thread(void);
 extern void test_msgq_empty(void);
 extern void test_msgq_full(void);
+extern void test_msgq_claim(void);
+extern void test_msgq_claim_pend(void);
+extern void test_msgq_claim_refill(void);
 #ifdef CONFIG_USERSPACE
 extern void test_msgq_user_thread(void);
 extern void test_msgq_user_thread_overflow(void);
@@ -30,6 +33,7 @@ extern void test_msgq_user_put_fail(void);
 extern void test_msgq_user_get_fail(void);
 extern void test_msgq_user_attrs_get(void);
 extern void test_msgq_user_purge_when_put(void);
+extern void test_msgq_user_claim(void);
 #else
 #define dummy_test(_name) \
 	static void _name(void) \
@@ -43,6 +47,7 @@ dummy_test(test_msgq_user_put_fail);
 dummy_test(test_msgq_user_get_fail);
 dummy_test(test_msgq_user_attrs_get);
 dummy_test(test_msgq_user_purge_when_put);
+dummy_test(test_msgq_user_claim);
 #endif /* CONFIG_USERSPACE */
 
 #ifdef CONFIG_64BIT
@@ -84,6 +89,10 @@ void test_main(void)
 			 ztest_1cpu_unit_test(test_msgq_pend_thread),
 			 ztest_1cpu_unit_test(test_msgq_empty),
 			 ztest_1cpu_unit_test(test_msgq_full),
+			 ztest_unit_test(test_msgq_claim),
+			 ztest_user_unit_test(test_msgq_user_claim),
+			 ztest_1cpu_unit_test(test_msgq_claim_pend),
+			 ztest_1cpu_unit_test(test_msgq_claim_refill),
 			 ztest_unit_test(test_msgq_alloc));
 	ztest_run_test_suite(msgq_api);
 }
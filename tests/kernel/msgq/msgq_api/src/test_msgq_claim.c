@@ -0,0 +1,304 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "test_msgq.h"
+
+K_THREAD_STACK_EXTERN(tstack);
+K_THREAD_STACK_EXTERN(tstack1);
+extern struct k_thread tdata;
+extern struct k_thread tdata1;
+extern struct k_msgq msgq;
+static K_THREAD_STACK_DEFINE(tstack2, STACK_SIZE);
+static K_THREAD_STACK_DEFINE(tstack3, STACK_SIZE);
+static struct k_thread tdata2;
+static struct k_thread tdata3;
+static ZTEST_BMEM char __aligned(4) tbuffer[MSG_SIZE * MSGQ_LEN];
+static ZTEST_DMEM uint32_t data[MSGQ_LEN] = { MSG0, MSG1 };
+static int claim_ret, other_ret, refill_ret, get_ret;
+static uint32_t get_data;
+
+static void claim_msgq(struct k_msgq *q, bool user)
+{
+	uint32_t buf, rx_data;
+	void *slot;
+
+	/**TESTPOINT: build a message in a claimed slot*/
+	zassert_equal(k_msgq_put_claim(q, &slot, &buf, K_NO_WAIT), 0, NULL);
+	if (user) {
+		zassert_equal(slot, &buf, NULL);
+	} else {
+		zassert_true((char *)slot >= q->buffer_start &&
+			     (char *)slot < q->buffer_end, NULL);
+	}
+	*(uint32_t *)slot = data[0];
+
+	/**TESTPOINT: the claim holds the sending side*/
+	zassert_equal(k_msgq_put(q, &data[1], K_NO_WAIT), -EBUSY, NULL);
+	zassert_equal(k_msgq_put_claim(q, &slot, &buf, K_NO_WAIT), -EBUSY,
+		      NULL);
+	zassert_equal(k_msgq_num_used_get(q), 0, NULL);
+
+	zassert_equal(k_msgq_put_commit(q, slot), 0, NULL);
+	zassert_equal(k_msgq_put_commit(q, slot), -EINVAL, NULL);
+	zassert_equal(k_msgq_num_used_get(q), 1, NULL);
+
+	/* fill the queue to full */
+	zassert_equal(k_msgq_put(q, &data[1], K_NO_WAIT), 0, NULL);
+	zassert_equal(k_msgq_put_claim(q, &slot, &buf, K_NO_WAIT), -ENOMSG,
+		      NULL);
+
+	/**TESTPOINT: use the first message in place*/
+	zassert_equal(k_msgq_get_claim(q, &slot, &buf, K_NO_WAIT), 0, NULL);
+	zassert_equal(*(uint32_t *)slot, data[0], NULL);
+
+	/**TESTPOINT: the claim holds the receiving side*/
+	zassert_equal(k_msgq_get(q, &rx_data, K_NO_WAIT), -EBUSY, NULL);
+	zassert_equal(k_msgq_get_claim(q, &slot, &buf, K_NO_WAIT), -EBUSY,
+		      NULL);
+	zassert_equal(k_msgq_peek(q, &rx_data), 0, NULL);
+	zassert_equal(rx_data, data[0], NULL);
+	zassert_equal(k_msgq_num_used_get(q), MSGQ_LEN, NULL);
+
+	zassert_equal(k_msgq_get_commit(q), 0, NULL);
+	zassert_equal(k_msgq_get_commit(q), -EINVAL, NULL);
+	zassert_equal(k_msgq_num_used_get(q), 1, NULL);
+
+	zassert_equal(k_msgq_get(q, &rx_data, K_NO_WAIT), 0, NULL);
+	zassert_equal(rx_data, data[1], NULL);
+
+	/**TESTPOINT: give a claimed slot back*/
+	zassert_equal(k_msgq_put_claim(q, &slot, &buf, K_NO_WAIT), 0, NULL);
+	zassert_equal(k_msgq_put_commit(q, NULL), 0, NULL);
+	zassert_equal(k_msgq_num_used_get(q), 0, NULL);
+	zassert_equal(k_msgq_get_claim(q, &slot, &buf, K_NO_WAIT), -ENOMSG,
+		      NULL);
+}
+
+static void put_claim_entry(void *p1, void *p2, void *p3)
+{
+	void *slot;
+
+	claim_ret = k_msgq_put_claim(p1, &slot, NULL, K_FOREVER);
+	if (claim_ret == 0) {
+		*(uint32_t *)slot = MSG0;
+		k_msgq_put_commit(p1, slot);
+	}
+}
+
+static void put_entry(void *p1, void *p2, void *p3)
+{
+	other_ret = k_msgq_put(p1, &data[1], TIMEOUT);
+}
+
+static void get_claim_entry(void *p1, void *p2, void *p3)
+{
+	void *slot;
+
+	claim_ret = k_msgq_get_claim(p1, &slot, NULL, K_FOREVER);
+	if (claim_ret == 0) {
+		zassert_equal(*(uint32_t *)slot, MSG1, NULL);
+		k_msgq_get_commit(p1);
+	}
+}
+
+static void get_entry(void *p1, void *p2, void *p3)
+{
+	uint32_t rx_data;
+
+	other_ret = k_msgq_get(p1, &rx_data, TIMEOUT);
+}
+
+static void put_claim_back_entry(void *p1, void *p2, void *p3)
+{
+	void *slot;
+
+	claim_ret = k_msgq_put_claim(p1, &slot, NULL, K_FOREVER);
+	if (claim_ret == 0) {
+		/* let the receivers pend on the empty queue */
+		k_msleep(10);
+		k_msgq_put_commit(p1, NULL);
+	}
+}
+
+static void refill_entry(void *p1, void *p2, void *p3)
+{
+	refill_ret = k_msgq_put(p1, &data[0], TIMEOUT);
+}
+
+static void get_refill_entry(void *p1, void *p2, void *p3)
+{
+	get_ret = k_msgq_get(p1, &get_data, TIMEOUT);
+}
+
+static void start_waiters(k_thread_entry_t claim_fn, k_thread_entry_t other_fn)
+{
+	claim_ret = other_ret = 1;
+
+	k_thread_create(&tdata, tstack, STACK_SIZE, claim_fn, &msgq, NULL,
+			NULL, K_PRIO_PREEMPT(0), 0, K_NO_WAIT);
+	k_msleep(10);
+	k_thread_create(&tdata1, tstack1, STACK_SIZE, other_fn, &msgq, NULL,
+			NULL, K_PRIO_PREEMPT(0), 0, K_NO_WAIT);
+	k_msleep(10);
+}
+
+static void join_claim_waiter(void)
+{
+	k_thread_join(&tdata, K_FOREVER);
+
+	zassert_equal(claim_ret, 0, NULL);
+	/* the other waiter was left waiting */
+	zassert_equal(other_ret, 1, NULL);
+	zassert_equal(tdata1.base.thread_state, _THREAD_PENDING, NULL);
+}
+
+static void join_other_waiter(void)
+{
+	k_thread_join(&tdata1, K_FOREVER);
+
+	zassert_equal(other_ret, 0, NULL);
+}
+
+/**
+ * @addtogroup kernel_message_queue_tests
+ * @{
+ */
+
+/**
+ * @brief Test claiming message queue slots
+ * @see k_msgq_put_claim(), k_msgq_put_commit(), k_msgq_get_claim(),
+ * k_msgq_get_commit()
+ */
+void test_msgq_claim(void)
+{
+	k_msgq_init(&msgq, tbuffer, MSG_SIZE, MSGQ_LEN);
+
+	claim_msgq(&msgq, false);
+}
+
+/**
+ * @brief Test waiting for message queue claims
+ * @details A full queue grants the claim when a message is received,
+ * an empty one when a message is sent. Other threads waiting on the
+ * same side are served afterwards.
+ * @see k_msgq_put_claim(), k_msgq_get_claim()
+ */
+void test_msgq_claim_pend(void)
+{
+	uint32_t rx_data;
+
+	k_msgq_init(&msgq, tbuffer, MSG_SIZE, MSGQ_LEN);
+
+	/* fill the queue to full */
+	for (int i = 0; i < MSGQ_LEN; i++) {
+		zassert_equal(k_msgq_put(&msgq, &data[i], K_NO_WAIT), 0, NULL);
+	}
+
+	/**TESTPOINT: receiving grants the waiting put claim*/
+	start_waiters(put_claim_entry, put_entry);
+	zassert_equal(k_msgq_get(&msgq, &rx_data, K_NO_WAIT), 0, NULL);
+	zassert_equal(rx_data, data[0], NULL);
+	join_claim_waiter();
+
+	/**TESTPOINT: the next free slot goes to the other waiter*/
+	zassert_equal(k_msgq_get(&msgq, &rx_data, K_NO_WAIT), 0, NULL);
+	zassert_equal(rx_data, data[1], NULL);
+	join_other_waiter();
+
+	zassert_equal(k_msgq_get(&msgq, &rx_data, K_NO_WAIT), 0, NULL);
+	zassert_equal(rx_data, MSG0, NULL);
+	zassert_equal(k_msgq_get(&msgq, &rx_data, K_NO_WAIT), 0, NULL);
+	zassert_equal(rx_data, data[1], NULL);
+
+	/**TESTPOINT: sending grants the waiting get claim*/
+	start_waiters(get_claim_entry, get_entry);
+	zassert_equal(k_msgq_put(&msgq, &data[1], K_NO_WAIT), 0, NULL);
+	join_claim_waiter();
+
+	/**TESTPOINT: the next message goes to the other waiter*/
+	zassert_equal(k_msgq_put(&msgq, &data[0], K_NO_WAIT), 0, NULL);
+	join_other_waiter();
+
+	zassert_equal(k_msgq_num_used_get(&msgq), 0, NULL);
+}
+
+/**
+ * @brief Test refilling a message queue given back by a claim
+ * @details Threads waiting to receive pend while the put claim holds the
+ * last free slot. When the claim is given back, the messages of the
+ * threads waiting to send are handed to them, or signalled to pollers.
+ * @see k_msgq_put_claim(), k_msgq_put_commit(), k_poll()
+ */
+void test_msgq_claim_refill(void)
+{
+	struct k_poll_event event;
+	uint32_t rx_data;
+
+	k_msgq_init(&msgq, tbuffer, MSG_SIZE, MSGQ_LEN);
+	refill_ret = get_ret = 1;
+
+	/* fill the queue to full */
+	for (int i = 0; i < MSGQ_LEN; i++) {
+		zassert_equal(k_msgq_put(&msgq, &data[i], K_NO_WAIT), 0, NULL);
+	}
+
+	/* a claimer and two senders wait for free slots */
+	start_waiters(put_claim_back_entry, put_entry);
+	k_thread_create(&tdata2, tstack2, STACK_SIZE, refill_entry, &msgq,
+			NULL, NULL, K_PRIO_PREEMPT(0), 0, K_NO_WAIT);
+	k_msleep(5);
+
+	/* the first slot is claimed, the second stays free */
+	zassert_equal(k_msgq_get(&msgq, &rx_data, K_NO_WAIT), 0, NULL);
+	zassert_equal(k_msgq_get(&msgq, &rx_data, K_NO_WAIT), 0, NULL);
+	zassert_equal(k_msgq_num_used_get(&msgq), 0, NULL);
+
+	k_thread_create(&tdata3, tstack3, STACK_SIZE, get_refill_entry, &msgq,
+			NULL, NULL, K_PRIO_PREEMPT(0), 0, K_NO_WAIT);
+
+	/**TESTPOINT: the first refilled message goes to the receiver*/
+	k_poll_event_init(&event, K_POLL_TYPE_MSGQ_DATA_AVAILABLE,
+			  K_POLL_MODE_NOTIFY_ONLY, &msgq);
+	zassert_equal(k_poll(&event, 1, TIMEOUT), 0, NULL);
+
+	k_thread_join(&tdata3, K_FOREVER);
+	zassert_equal(get_ret, 0, NULL);
+	zassert_equal(get_data, data[1], NULL);
+
+	/**TESTPOINT: the second one is signalled to the poller*/
+	zassert_equal(event.state, K_POLL_STATE_MSGQ_DATA_AVAILABLE, NULL);
+	zassert_equal(k_msgq_get(&msgq, &rx_data, K_NO_WAIT), 0, NULL);
+	zassert_equal(rx_data, data[0], NULL);
+
+	k_thread_join(&tdata, K_FOREVER);
+	join_other_waiter();
+	k_thread_join(&tdata2, K_FOREVER);
+	zassert_equal(claim_ret, 0, NULL);
+	zassert_equal(refill_ret, 0, NULL);
+	zassert_equal(k_msgq_num_used_get(&msgq), 0, NULL);
+}
+
+#ifdef CONFIG_USERSPACE
+/**
+ * @brief Test claiming message queue slots from user mode
+ * @details User threads get their own buffer instead of the slot.
+ * @see k_msgq_put_claim(), k_msgq_get_claim()
+ */
+void test_msgq_user_claim(void)
+{
+	struct k_msgq *q;
+
+	q = k_object_alloc(K_OBJ_MSGQ);
+	zassert_not_null(q, "couldn't alloc message queue");
+	zassert_false(k_msgq_alloc_init(q, MSG_SIZE, MSGQ_LEN), NULL);
+
+	claim_msgq(q, true);
+}
+#endif
+
+/**
+ * @}
+ */
@@ -18,6 +18,7 @@ static ZTEST_DMEM int thread_ret = TC_FAIL;
 /**TESTPOINT: init via K_MUTEX_DEFINE*/
 K_MUTEX_DEFINE(kmutex);
 static struct k_mutex mutex;
+static struct k_mutex mutex2;
 
 static K_THREAD_STACK_DEFINE(tstack, STACK_SIZE);
 static K_THREAD_STACK_DEFINE(tstack2, STACK_SIZE);
@@ -187,6 +188,12 @@ static void tThread_waiter(void *p1, void *p2, void *p3)
 	k_mutex_unlock((struct k_mutex *)p1);
 }
 
+static void tThread_lock_timeout_eagain(void *p1, void *p2, void *p3)
+{
+	zassert_equal(k_mutex_lock((struct k_mutex *)p1, K_MSEC(100)), -EAGAIN,
+		      "lock should have timed out");
+}
+
 /*test cases*/
 void test_mutex_reent_lock_forever(void)
 {
@@ -386,6 +393,111 @@ void test_mutex_priority_inheritance(void)
 	k_msleep(TIMEOUT+1000);
 }
 
+/**
+ * @brief Test a waiter giving up on a mutex
+ * @details A waiter that times out must restore the priority of the
+ * owner, and leave the mutex usable by the next waiters and once given
+ * back.
+ * @ingroup kernel_mutex_tests
+ */
+void test_mutex_waiter_timeout(void)
+{
+	k_tid_t self = k_current_get();
+	int prio = k_thread_priority_get(self);
+
+	k_thread_priority_set(self, K_PRIO_PREEMPT(THREAD_LOW_PRIORITY));
+
+	k_mutex_init(&mutex);
+	zassert_equal(k_mutex_lock(&mutex, K_NO_WAIT), 0, "fail to lock");
+
+	/* The waiter runs right away and raises our priority */
+	k_thread_create(&tdata, tstack, STACK_SIZE,
+			tThread_lock_timeout_eagain, &mutex, NULL, NULL,
+			K_PRIO_PREEMPT(THREAD_HIGH_PRIORITY), 0, K_NO_WAIT);
+
+	zassert_equal(k_thread_priority_get(self),
+		      K_PRIO_PREEMPT(THREAD_HIGH_PRIORITY),
+		      "priority not inherited");
+
+	k_thread_join(&tdata, K_FOREVER);
+
+	zassert_equal(k_thread_priority_get(self),
+		      K_PRIO_PREEMPT(THREAD_LOW_PRIORITY),
+		      "priority not restored after timeout");
+
+	/* The next waiter gets the mutex handed over */
+	thread_ret = TC_FAIL;
+	k_thread_create(&tdata, tstack, STACK_SIZE,
+			tThread_waiter, &mutex, NULL, NULL,
+			K_PRIO_PREEMPT(THREAD_HIGH_PRIORITY), 0, K_NO_WAIT);
+
+	zassert_equal(k_mutex_unlock(&mutex), 0, "fail to unlock");
+	zassert_equal(k_thread_priority_get(self),
+		      K_PRIO_PREEMPT(THREAD_LOW_PRIORITY),
+		      "priority not restored after unlock");
+
+	k_thread_join(&tdata, K_FOREVER);
+	zassert_equal(thread_ret, TC_PASS, "waiter did not get the mutex");
+
+	/* Given back by the waiter, free again */
+	zassert_is_null(mutex.owner, "mutex still owned");
+	zassert_equal(k_mutex_lock(&mutex, K_NO_WAIT), 0, "fail to lock");
+	zassert_equal(mutex.owner, self, "wrong owner");
+	zassert_equal(k_mutex_unlock(&mutex), 0, "fail to unlock");
+	zassert_equal(k_mutex_unlock(&mutex), -EINVAL, "mutex still owned");
+
+	k_thread_priority_set(self, prio);
+}
+
+/**
+ * @brief Test priority inheritance with nested mutexes
+ * @details The owner of two mutexes has its priority raised by the
+ * waiters of both. Once it gave both back, it must have the priority it
+ * had before it took them, whichever waiter came first.
+ * @ingroup kernel_mutex_tests
+ */
+void test_mutex_nested_priority_inheritance(void)
+{
+	k_tid_t self = k_current_get();
+	int prio = k_thread_priority_get(self);
+
+	k_thread_priority_set(self, K_PRIO_PREEMPT(10));
+
+	k_mutex_init(&mutex);
+	k_mutex_init(&mutex2);
+	zassert_equal(k_mutex_lock(&mutex, K_NO_WAIT), 0, "fail to lock");
+	zassert_equal(k_mutex_lock(&mutex2, K_NO_WAIT), 0, "fail to lock");
+
+	/* The waiter on the first mutex runs right away */
+	thread_ret = TC_FAIL;
+	k_thread_create(&tdata, tstack, STACK_SIZE,
+			tThread_waiter, &mutex, NULL, NULL,
+			K_PRIO_PREEMPT(5), 0, K_NO_WAIT);
+	zassert_equal(k_thread_priority_get(self), K_PRIO_PREEMPT(5),
+		      "priority not inherited");
+
+	/* The one on the second mutex only once we sleep, while raised */
+	k_thread_create(&tdata2, tstack2, STACK_SIZE,
+			tThread_waiter, &mutex2, NULL, NULL,
+			K_PRIO_PREEMPT(7), 0, K_NO_WAIT);
+	k_msleep(10);
+	zassert_equal(tdata2.base.thread_state, _THREAD_PENDING,
+		      "waiter not pending");
+	zassert_equal(k_thread_priority_get(self), K_PRIO_PREEMPT(5),
+		      "priority lowered");
+
+	zassert_equal(k_mutex_unlock(&mutex), 0, "fail to unlock");
+	zassert_equal(k_mutex_unlock(&mutex2), 0, "fail to unlock");
+	zassert_equal(k_thread_priority_get(self), K_PRIO_PREEMPT(10),
+		      "priority not restored");
+
+	k_thread_join(&tdata, K_FOREVER);
+	k_thread_join(&tdata2, K_FOREVER);
+	zassert_equal(thread_ret, TC_PASS, "waiters did not get the mutex");
+
+	k_thread_priority_set(self, prio);
+}
+
 /*test case main entry*/
 void test_main(void)
 {
@@ -400,7 +512,9 @@ void test_main(void)
 		 ztest_user_unit_test(test_mutex_reent_lock_timeout_fail),
 		 ztest_1cpu_user_unit_test(test_mutex_reent_lock_timeout_pass),
 		 ztest_user_unit_test(test_mutex_recursive),
-		 ztest_user_unit_test(test_mutex_priority_inheritance)
+		 ztest_user_unit_test(test_mutex_priority_inheritance),
+		 ztest_1cpu_unit_test(test_mutex_waiter_timeout),
+		 ztest_1cpu_unit_test(test_mutex_nested_priority_inheritance)
 		 );
 	ztest_run_test_suite(mutex_api);
 }
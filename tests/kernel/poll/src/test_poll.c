@@ -401,6 +401,84 @@ void test_poll_wait(void)
 	check_results(&wait_events[2], K_POLL_TYPE_SIGNAL, true);
 }
 
+/* verify k_poll() on a message queue */
+
+#define MSGQ_MSG_VALUE 0x5a5aa5a5
+
+K_MSGQ_DEFINE(wait_msgq, sizeof(uint32_t), 2, 4);
+
+static void poll_msgq_helper(void *claim, void *p2, void *p3)
+{
+	uint32_t msg = MSGQ_MSG_VALUE;
+	void *slot;
+
+	(void)p2; (void)p3;
+
+	k_sleep(K_MSEC(100));
+
+	if ((intptr_t)claim) {
+		zassert_equal(k_msgq_put_claim(&wait_msgq, &slot, NULL,
+					       K_NO_WAIT), 0, "");
+		*(uint32_t *)slot = msg;
+		zassert_equal(k_msgq_put_commit(&wait_msgq, slot), 0, "");
+	} else {
+		zassert_equal(k_msgq_put(&wait_msgq, &msg, K_NO_WAIT), 0, "");
+	}
+}
+
+/**
+ * @brief Test polling on a message queue
+ *
+ * @ingroup kernel_poll_tests
+ *
+ * @details Wait for a message sent by k_msgq_put() and then by
+ * k_msgq_put_commit() from another thread.
+ *
+ * @see k_poll(), k_msgq_put(), k_msgq_put_commit()
+ */
+void test_poll_msgq(void)
+{
+	struct k_poll_event event;
+	uint32_t msg;
+	void *slot;
+
+	k_poll_event_init(&event, K_POLL_TYPE_MSGQ_DATA_AVAILABLE,
+			  K_POLL_MODE_NOTIFY_ONLY, &wait_msgq);
+
+	zassert_equal(k_poll(&event, 1, K_NO_WAIT), -EAGAIN, "");
+
+	for (intptr_t claim = 0; claim < 2; claim++) {
+		k_thread_create(&test_thread, test_stack,
+				K_THREAD_STACK_SIZEOF(test_stack),
+				poll_msgq_helper, (void *)claim, 0, 0,
+				K_PRIO_PREEMPT(0), 0, K_NO_WAIT);
+
+		zassert_equal(k_poll(&event, 1, K_SECONDS(1)), 0, "");
+		zassert_equal(event.state, K_POLL_STATE_MSGQ_DATA_AVAILABLE,
+			      "");
+
+		zassert_equal(k_msgq_get(&wait_msgq, &msg, K_NO_WAIT), 0, "");
+		zassert_equal(msg, MSGQ_MSG_VALUE, "");
+
+		k_thread_join(&test_thread, K_FOREVER);
+		event.state = K_POLL_STATE_NOT_READY;
+	}
+
+	/* a message already there satisfies the event right away */
+	msg = MSGQ_MSG_VALUE;
+	zassert_equal(k_msgq_put(&wait_msgq, &msg, K_NO_WAIT), 0, "");
+	zassert_equal(k_poll(&event, 1, K_NO_WAIT), 0, "");
+	zassert_equal(event.state, K_POLL_STATE_MSGQ_DATA_AVAILABLE, "");
+
+	/* but not while it is held by a get claim */
+	event.state = K_POLL_STATE_NOT_READY;
+	zassert_equal(k_msgq_get_claim(&wait_msgq, &slot, NULL, K_NO_WAIT), 0,
+		      "");
+	zassert_equal(k_poll(&event, 1, K_NO_WAIT), -EAGAIN, "");
+	zassert_equal(k_msgq_get_commit(&wait_msgq), 0, "");
+	k_msgq_purge(&wait_msgq);
+}
+
 /* verify k_poll() that waits on object which gets cancellation */
 
 static struct k_fifo cancel_fifo;
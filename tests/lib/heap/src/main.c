@@ -323,10 +323,158 @@ static void test_realloc(void)
 		     "Realloc should have moved %p", p2);
 }
 
+static void test_usable_size(void)
+{
+	struct sys_heap heap;
+	void *p1, *p2;
+	size_t sz;
+
+	sys_heap_init(&heap, heapmem, SMALL_HEAP_SZ);
+
+	/* Sizes are rounded up to a whole chunk, minus the header */
+	for (sz = 1; sz <= 128; sz++) {
+		p1 = sys_heap_alloc(&heap, sz);
+		zassert_not_null(p1, "allocation failed");
+
+		zassert_true(sys_heap_usable_size(&heap, p1) >= sz,
+			     "usable size too small for %zu bytes", sz);
+		zassert_true(sys_heap_usable_size(&heap, p1) < sz + 8,
+			     "usable size too big for %zu bytes", sz);
+
+		sys_heap_free(&heap, p1);
+	}
+
+	/* The alignment gap is not usable */
+	p1 = sys_heap_aligned_alloc(&heap, 64, 40);
+	p2 = sys_heap_aligned_realloc(&heap, p1, 64, 200);
+	zassert_equal((uintptr_t)p2 % 64, 0, "bad alignment");
+	zassert_true(sys_heap_usable_size(&heap, p2) >= 200,
+		     "usable size too small");
+
+	/* Shrinking in place gives the rest back */
+	p1 = sys_heap_realloc(&heap, p2, 20);
+	zassert_equal(p1, p2, "Realloc should have shrunk in place");
+	zassert_true(sys_heap_usable_size(&heap, p1) < 28,
+		     "usable size not shrunk");
+
+	sys_heap_free(&heap, p1);
+	zassert_true(sys_heap_validate(&heap), "invalid heap");
+}
+
+static void test_frag_stats(void)
+{
+	struct sys_heap_frag_stats stats;
+	struct sys_heap heap;
+	void *p[8];
+	size_t free_bytes;
+	uint32_t chunks;
+
+	sys_heap_init(&heap, heapmem, SMALL_HEAP_SZ);
+
+	/* A fresh heap has all its free memory in one chunk */
+	sys_heap_frag_stats_get(&heap, &stats);
+	zassert_equal(stats.free_chunks, 1, "fresh heap not in one chunk");
+	zassert_equal(stats.frag_index, 0, "fresh heap fragmented");
+	zassert_equal(stats.largest_free_bytes, stats.free_bytes,
+		      "largest free block not the whole heap");
+	free_bytes = stats.free_bytes;
+
+	for (int i = 0; i < ARRAY_SIZE(p); i++) {
+		p[i] = sys_heap_alloc(&heap, 64);
+		zassert_not_null(p[i], "allocation failed");
+	}
+
+	/* Punch holes between the blocks still in use */
+	for (int i = 0; i < ARRAY_SIZE(p); i += 2) {
+		sys_heap_free(&heap, p[i]);
+	}
+
+	sys_heap_frag_stats_get(&heap, &stats);
+	zassert_equal(stats.free_chunks, ARRAY_SIZE(p) / 2 + 1,
+		      "holes not counted");
+	zassert_true(stats.frag_index > 0, "holes not seen as fragmentation");
+	zassert_true(stats.largest_free_bytes < stats.free_bytes,
+		     "largest free block too big");
+
+	chunks = 0;
+	for (int i = 0; i < stats.nb_buckets; i++) {
+		chunks += stats.buckets[i].chunks;
+		if (i > 0) {
+			zassert_true(stats.buckets[i].min_bytes >
+				     stats.buckets[i - 1].min_bytes,
+				     "buckets not sorted by size");
+		}
+	}
+	zassert_equal(chunks, stats.free_chunks, "histogram incomplete");
+
+	for (int i = 1; i < ARRAY_SIZE(p); i += 2) {
+		sys_heap_free(&heap, p[i]);
+	}
+
+	sys_heap_frag_stats_get(&heap, &stats);
+	zassert_equal(stats.free_chunks, 1, "free chunks not merged");
+	zassert_equal(stats.free_bytes, free_bytes, "free memory leaked");
+}
+
+static void test_runtime_stats(void)
+{
+#ifdef CONFIG_SYS_HEAP_RUNTIME_STATS
+	struct sys_memory_stats stats;
+	size_t total, used;
+	struct sys_heap heap;
+	void *p1, *p2;
+
+	sys_heap_init(&heap, heapmem, SMALL_HEAP_SZ);
+
+	sys_heap_runtime_stats_get(&heap, &stats);
+	zassert_equal(stats.allocated_bytes, 0, "fresh heap in use");
+	zassert_equal(stats.max_allocated_bytes, 0, "fresh heap in use");
+	total = stats.free_bytes;
+
+	p1 = sys_heap_alloc(&heap, 100);
+	p2 = sys_heap_alloc(&heap, 200);
+	zassert_true(p1 != NULL && p2 != NULL, "allocation failed");
+
+	sys_heap_runtime_stats_get(&heap, &stats);
+	zassert_true(stats.allocated_bytes >= 300, "allocations not counted");
+	zassert_equal(stats.allocated_bytes + stats.free_bytes, total,
+		      "bytes lost");
+	zassert_equal(stats.max_allocated_bytes, stats.allocated_bytes,
+		      "high-water mark not raised");
+	used = stats.allocated_bytes;
+
+	/* Shrinking and growing in place is accounted too */
+	zassert_equal(sys_heap_realloc(&heap, p2, 20), p2, "not in place");
+	zassert_equal(sys_heap_realloc(&heap, p2, 150), p2, "not in place");
+	zassert_true(sys_heap_validate(&heap), "counters off after realloc");
+
+	sys_heap_free(&heap, p2);
+	sys_heap_runtime_stats_get(&heap, &stats);
+	zassert_true(stats.allocated_bytes < used, "free not counted");
+	zassert_equal(stats.max_allocated_bytes, used,
+		      "high-water mark lowered");
+
+	sys_heap_runtime_stats_reset_max(&heap);
+	sys_heap_runtime_stats_get(&heap, &stats);
+	zassert_equal(stats.max_allocated_bytes, stats.allocated_bytes,
+		      "high-water mark not reset");
+
+	sys_heap_free(&heap, p1);
+	sys_heap_runtime_stats_get(&heap, &stats);
+	zassert_equal(stats.allocated_bytes, 0, "memory leaked");
+	zassert_equal(stats.free_bytes, total, "free memory lost");
+#else
+	ztest_test_skip();
+#endif
+}
+
 void test_main(void)
 {
 	ztest_test_suite(lib_heap_test,
 			 ztest_unit_test(test_realloc),
+			 ztest_unit_test(test_usable_size),
+			 ztest_unit_test(test_frag_stats),
+			 ztest_unit_test(test_runtime_stats),
 			 ztest_unit_test(test_small_heap),
 			 ztest_unit_test(test_fragmentation),
 			 ztest_unit_test(test_big_heap)
@@ -0,0 +1,306 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <irq_offload.h>
+#include <sys/lockfree_queue.h>
+
+/**
+ * @defgroup lib_lockfree_queue_tests Lock-free queues
+ * @ingroup all_tests
+ * @{
+ * @}
+ */
+
+#define CAPACITY 8
+#define N_ITEMS 1000
+#define N_THREADS 3
+#define STACK_SIZE (1024 + CONFIG_TEST_EXTRA_STACKSIZE)
+
+struct item {
+	uint32_t value;
+	uint8_t pad[3];
+};
+
+static struct spsc_queue spsc;
+static uint8_t spsc_buf[SPSC_QUEUE_BUF_SIZE(sizeof(struct item), CAPACITY)];
+static struct mpmc_queue mpmc;
+static uint8_t __aligned(sizeof(atomic_t))
+	mpmc_buf[MPMC_QUEUE_BUF_SIZE(sizeof(struct item), CAPACITY)];
+
+static struct sys_sem sem;
+static struct k_poll_signal signal;
+
+static K_THREAD_STACK_ARRAY_DEFINE(stacks, 2 * N_THREADS, STACK_SIZE);
+static struct k_thread threads[2 * N_THREADS];
+
+static atomic_t got_sum;
+static atomic_t got_count;
+
+typedef int (*put_fn)(void *q, const void *item);
+typedef int (*get_fn)(void *q, void *item);
+
+static int spsc_put(void *q, const void *item)
+{
+	return spsc_queue_put(q, item);
+}
+
+static int spsc_get(void *q, void *item)
+{
+	return spsc_queue_get(q, item);
+}
+
+static int mpmc_put(void *q, const void *item)
+{
+	return mpmc_queue_put(q, item);
+}
+
+static int mpmc_get(void *q, void *item)
+{
+	return mpmc_queue_get(q, item);
+}
+
+static void init_queues(void)
+{
+	spsc_queue_init(&spsc, spsc_buf, sizeof(struct item), CAPACITY);
+	mpmc_queue_init(&mpmc, mpmc_buf, sizeof(struct item), CAPACITY);
+	sys_sem_init(&sem, 0, 10);
+}
+
+static void put_get(void *q, put_fn put, get_fn get)
+{
+	struct item item = { 0 };
+	uint32_t next = 0U;
+
+	zassert_equal(get(q, &item), -ENOMSG, NULL);
+
+	/* go around the buffer a few times, wrapping at every position */
+	for (int fill = 1; fill <= CAPACITY; fill++) {
+		for (int i = 0; i < fill; i++) {
+			item.value = next + i;
+			zassert_equal(put(q, &item), 0, NULL);
+		}
+
+		for (int i = 0; i < fill; i++) {
+			zassert_equal(get(q, &item), 0, NULL);
+			zassert_equal(item.value, next + i, NULL);
+		}
+
+		next += fill;
+		zassert_equal(get(q, &item), -ENOMSG, NULL);
+	}
+
+	for (int i = 0; i < CAPACITY; i++) {
+		zassert_equal(put(q, &item), 0, NULL);
+	}
+	zassert_equal(put(q, &item), -ENOMSG, NULL);
+
+	for (int i = 0; i < CAPACITY; i++) {
+		zassert_equal(get(q, &item), 0, NULL);
+	}
+}
+
+/**
+ * @brief Test adding and taking items in order, full and empty queues
+ *
+ * @ingroup lib_lockfree_queue_tests
+ */
+void test_lockfree_queue_put_get(void)
+{
+	init_queues();
+
+	put_get(&spsc, spsc_put, spsc_get);
+	put_get(&mpmc, mpmc_put, mpmc_get);
+}
+
+static void isr_put(const void *arg)
+{
+	struct item item = { .value = (uint32_t)(uintptr_t)arg };
+
+	zassert_equal(spsc_queue_put(&spsc, &item), 0, NULL);
+	zassert_equal(mpmc_queue_put(&mpmc, &item), 0, NULL);
+}
+
+/**
+ * @brief Test an ISR producer and the wakeups of the consumer
+ *
+ * @details The semaphore must only be given when the queue gets an item
+ * while it was empty.
+ *
+ * @ingroup lib_lockfree_queue_tests
+ */
+void test_lockfree_queue_notify(void)
+{
+	struct item item;
+
+	init_queues();
+	spsc_queue_notify_set(&spsc, &sem, NULL);
+
+	for (uintptr_t i = 0; i < 3; i++) {
+		irq_offload(isr_put, (const void *)i);
+	}
+	zassert_equal(sys_sem_count_get(&sem), 1, NULL);
+
+	for (uint32_t i = 0; i < 3; i++) {
+		zassert_equal(spsc_queue_get_wait(&spsc, &item, K_NO_WAIT), 0,
+			      NULL);
+		zassert_equal(item.value, i, NULL);
+		zassert_equal(mpmc_queue_get(&mpmc, &item), 0, NULL);
+		zassert_equal(item.value, i, NULL);
+	}
+
+	irq_offload(isr_put, (const void *)3);
+	zassert_equal(sys_sem_count_get(&sem), 2, NULL);
+	zassert_equal(spsc_queue_get(&spsc, &item), 0, NULL);
+
+	/* a left over wakeup doesn't end the wait */
+	zassert_equal(spsc_queue_get_wait(&spsc, &item, K_NO_WAIT), -ENOMSG,
+		      NULL);
+	zassert_equal(spsc_queue_get_wait(&spsc, &item, K_MSEC(50)), -EAGAIN,
+		      NULL);
+	zassert_equal(sys_sem_count_get(&sem), 0, NULL);
+
+	/* the poll signal is raised the same way */
+	k_poll_signal_init(&signal);
+	mpmc_queue_init(&mpmc, mpmc_buf, sizeof(struct item), CAPACITY);
+	mpmc_queue_notify_set(&mpmc, NULL, &signal);
+
+	struct k_poll_event event = K_POLL_EVENT_INITIALIZER(
+		K_POLL_TYPE_SIGNAL, K_POLL_MODE_NOTIFY_ONLY, &signal);
+
+	zassert_equal(k_poll(&event, 1, K_NO_WAIT), -EAGAIN, NULL);
+	irq_offload(isr_put, (const void *)4);
+	zassert_equal(k_poll(&event, 1, K_NO_WAIT), 0, NULL);
+	zassert_equal(mpmc_queue_get(&mpmc, &item), 0, NULL);
+	zassert_equal(item.value, 4, NULL);
+}
+
+static void waiter(void *p1, void *p2, void *p3)
+{
+	struct item item;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	zassert_equal(mpmc_queue_get_wait(p1, &item, K_SECONDS(1)), 0, NULL);
+	atomic_add(&got_sum, item.value);
+	atomic_inc(&got_count);
+}
+
+/**
+ * @brief Test the wakeup of several waiting consumers
+ *
+ * @details Only the first item wakes up a consumer, which must wake up
+ * the next one for the second item.
+ *
+ * @ingroup lib_lockfree_queue_tests
+ */
+void test_lockfree_queue_wait(void)
+{
+	struct item item;
+
+	init_queues();
+	mpmc_queue_notify_set(&mpmc, &sem, NULL);
+	atomic_set(&got_sum, 0);
+	atomic_set(&got_count, 0);
+
+	for (int i = 0; i < 2; i++) {
+		k_thread_create(&threads[i], stacks[i], STACK_SIZE, waiter,
+				&mpmc, NULL, NULL, K_PRIO_PREEMPT(1), 0,
+				K_NO_WAIT);
+	}
+
+	/* let both block */
+	k_msleep(10);
+
+	for (int i = 1; i <= 2; i++) {
+		item.value = i;
+		zassert_equal(mpmc_queue_put(&mpmc, &item), 0, NULL);
+	}
+
+	/* without passing the wakeup on, the second one times out */
+
+	for (int i = 0; i < 2; i++) {
+		k_thread_join(&threads[i], K_FOREVER);
+	}
+
+	zassert_equal(atomic_get(&got_count), 2, NULL);
+	zassert_equal(atomic_get(&got_sum), 3, NULL);
+}
+
+static void producer(void *p1, void *p2, void *p3)
+{
+	struct item item;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	for (int i = 1; i <= N_ITEMS; i++) {
+		item.value = i;
+		while (mpmc_queue_put(p1, &item) != 0) {
+			k_yield();
+		}
+		if (i % 4 == 0) {
+			k_yield();
+		}
+	}
+}
+
+static void consumer(void *p1, void *p2, void *p3)
+{
+	struct item item;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (atomic_get(&got_count) < N_THREADS * N_ITEMS) {
+		if (mpmc_queue_get(p1, &item) != 0) {
+			k_yield();
+			continue;
+		}
+		atomic_add(&got_sum, item.value);
+		atomic_inc(&got_count);
+	}
+}
+
+/**
+ * @brief Test several producers and consumers sharing a queue
+ *
+ * @ingroup lib_lockfree_queue_tests
+ */
+void test_lockfree_queue_mpmc(void)
+{
+	init_queues();
+	atomic_set(&got_sum, 0);
+	atomic_set(&got_count, 0);
+
+	for (int i = 0; i < N_THREADS; i++) {
+		k_thread_create(&threads[i], stacks[i], STACK_SIZE, producer,
+				&mpmc, NULL, NULL, K_PRIO_PREEMPT(1), 0,
+				K_NO_WAIT);
+		k_thread_create(&threads[N_THREADS + i], stacks[N_THREADS + i],
+				STACK_SIZE, consumer, &mpmc, NULL, NULL,
+				K_PRIO_PREEMPT(1), 0, K_NO_WAIT);
+	}
+
+	for (int i = 0; i < 2 * N_THREADS; i++) {
+		k_thread_join(&threads[i], K_FOREVER);
+	}
+
+	zassert_equal(atomic_get(&got_count), N_THREADS * N_ITEMS, NULL);
+	zassert_equal(atomic_get(&got_sum),
+		      N_THREADS * N_ITEMS * (N_ITEMS + 1) / 2, NULL);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(lockfree_queue,
+			 ztest_unit_test(test_lockfree_queue_put_get),
+			 ztest_unit_test(test_lockfree_queue_notify),
+			 ztest_1cpu_unit_test(test_lockfree_queue_wait),
+			 ztest_unit_test(test_lockfree_queue_mpmc));
+	ztest_run_test_suite(lockfree_queue);
+}
@@ -680,6 +680,94 @@ static void test_net_buf_byte_order(void)
 	net_buf_unref(buf);
 }
 
+#if defined(CONFIG_NET_BUF_CPU_CACHE)
+#define CACHE_POOL_COUNT 4
+
+NET_BUF_POOL_FIXED_DEFINE(cache_pool, CACHE_POOL_COUNT, 32, NULL);
+
+static struct net_buf_cache pool_cache =
+	NET_BUF_POOL_CACHE_INITIALIZER(cache_pool);
+
+static K_THREAD_STACK_DEFINE(waiter_stack, 1024);
+static struct k_thread waiter_thread;
+static struct net_buf *waiter_buf;
+
+static void waiter(void *p1, void *p2, void *p3)
+{
+	waiter_buf = net_buf_alloc(&cache_pool, K_FOREVER);
+}
+
+static void test_net_buf_cpu_cache(void)
+{
+	struct net_buf *bufs[CACHE_POOL_COUNT];
+	uint32_t hits, misses;
+	int i;
+
+	cache_pool.cache = &pool_cache;
+
+	/* The first allocation refills the cache with half of its size */
+	bufs[0] = net_buf_alloc(&cache_pool, K_NO_WAIT);
+	zassert_not_null(bufs[0], "Failed to get buffer");
+	zassert_equal(net_buf_cache_count(&pool_cache),
+		      CONFIG_NET_BUF_CPU_CACHE_SIZE / 2 - 1, "Not refilled");
+
+	net_buf_unref(bufs[0]);
+
+	bufs[0] = net_buf_alloc(&cache_pool, K_NO_WAIT);
+	zassert_not_null(bufs[0], "Failed to get buffer");
+
+	net_buf_cache_stats(&pool_cache, &hits, &misses);
+	zassert_equal(hits, 1, "Cached buffer not used");
+	zassert_equal(misses, 1, "Unexpected refill");
+
+	/* All the buffers can be taken, cached or not */
+	for (i = 1; i < CACHE_POOL_COUNT; i++) {
+		bufs[i] = net_buf_alloc(&cache_pool, K_NO_WAIT);
+		zassert_not_null(bufs[i], "Failed to get buffer %d", i);
+	}
+
+	zassert_is_null(net_buf_alloc(&cache_pool, K_NO_WAIT),
+			"Got more buffers than in the pool");
+
+	for (i = 0; i < CACHE_POOL_COUNT; i++) {
+		net_buf_unref(bufs[i]);
+	}
+
+	net_buf_cache_flush(&pool_cache);
+	zassert_equal(net_buf_cache_count(&pool_cache), 0, "Not flushed");
+
+	/* A freed buffer goes to a waiter rather than to the cache */
+	for (i = 0; i < CACHE_POOL_COUNT; i++) {
+		bufs[i] = net_buf_alloc(&cache_pool, K_NO_WAIT);
+		zassert_not_null(bufs[i], "Failed to get buffer %d", i);
+	}
+
+	k_thread_create(&waiter_thread, waiter_stack,
+			K_THREAD_STACK_SIZEOF(waiter_stack), waiter,
+			NULL, NULL, NULL, K_PRIO_COOP(7), 0, K_NO_WAIT);
+	k_msleep(10);
+	zassert_is_null(waiter_buf, "Waiter did not wait");
+
+	net_buf_unref(bufs[0]);
+	k_thread_join(&waiter_thread, TEST_TIMEOUT);
+	zassert_equal(waiter_buf, bufs[0], "Waiter did not get the buffer");
+
+	net_buf_unref(waiter_buf);
+
+	for (i = 1; i < CACHE_POOL_COUNT; i++) {
+		net_buf_unref(bufs[i]);
+	}
+
+	cache_pool.cache = NULL;
+	net_buf_cache_flush(&pool_cache);
+}
+#else
+static void test_net_buf_cpu_cache(void)
+{
+	ztest_test_skip();
+}
+#endif /* CONFIG_NET_BUF_CPU_CACHE */
+
 void test_main(void)
 {
 	ztest_test_suite(test_net_buf,
@@ -692,7 +780,8 @@ void test_main(void)
 			 ztest_unit_test(test_net_buf_clone),
 			 ztest_unit_test(test_net_buf_fixed_pool),
 			 ztest_unit_test(test_net_buf_var_pool),
-			 ztest_unit_test(test_net_buf_byte_order)
+			 ztest_unit_test(test_net_buf_byte_order),
+			 ztest_unit_test(test_net_buf_cpu_cache)
 			 );
 
 	ztest_run_test_suite(test_net_buf);
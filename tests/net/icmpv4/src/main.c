@@ -498,6 +498,40 @@ static void test_icmpv4_send_echo_req_bad_opt(void)
 	}
 }
 
+static void test_icmpv4_chksum_done(void)
+{
+	struct net_pkt *pkt;
+	int i;
+
+	net_icmpv4_register_handler(&echo_rep_handler);
+
+	for (i = 0; i < 2; i++) {
+		pkt = prepare_echo_reply(iface);
+		zassert_not_null(pkt, "EchoReply packet prep failed");
+
+		/* Break the IPv4 and ICMPv4 checksums */
+		pkt->buffer->data[10] ^= 0xff;
+		pkt->buffer->data[22] ^= 0xff;
+
+		if (i == 0) {
+			zassert_equal(net_ipv4_input(pkt), NET_DROP,
+				      "Bad checksum accepted");
+			net_pkt_unref(pkt);
+			continue;
+		}
+
+		/* Already verified, for example by the hardware */
+		net_pkt_set_chksum_done(pkt, true);
+
+		if (net_ipv4_input(pkt)) {
+			net_pkt_unref(pkt);
+			zassert_true(false, "Verified packet dropped");
+		}
+	}
+
+	net_icmpv4_unregister_handler(&echo_rep_handler);
+}
+
 /**test case main entry */
 void test_main(void)
 {
@@ -506,6 +540,7 @@ void test_main(void)
 			 ztest_unit_test(test_icmpv4_send_echo_req),
 			 ztest_unit_test(test_icmpv4_send_echo_rep),
 			 ztest_unit_test(test_icmpv4_send_echo_req_opt),
-			 ztest_unit_test(test_icmpv4_send_echo_req_bad_opt));
+			 ztest_unit_test(test_icmpv4_send_echo_req_bad_opt),
+			 ztest_unit_test(test_icmpv4_chksum_done));
 	ztest_run_test_suite(test_icmpv4_fn);
 }
@@ -0,0 +1,401 @@
+/* main.c - Application main entry point */
+
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_IPV4_LOG_LEVEL);
+
+#include <zephyr/types.h>
+#include <ztest.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/printk.h>
+#include <linker/sections.h>
+
+#include <net/dummy.h>
+#include <net/buf.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+
+#define NET_LOG_ENABLED 1
+#include "net_private.h"
+#include "ipv4.h"
+#include "udp_internal.h"
+#include "reassembly.h"
+
+static struct in_addr my_addr = { { { 192, 0, 2, 1 } } };
+static struct in_addr peer_addr = { { { 192, 0, 2, 2 } } };
+
+#define MY_PORT 4242
+#define PEER_PORT 4243
+
+/* Largest UDP datagram of the tests, header included */
+#define MAX_DATAGRAM_LEN 2008
+
+static uint8_t datagram[MAX_DATAGRAM_LEN];
+static uint16_t datagram_len;
+
+static struct net_if *iface;
+static struct net_conn_handle *handle;
+
+static int recv_count;
+static size_t recv_len;
+static bool recv_match;
+
+K_SEM_DEFINE(wait_data, 0, UINT_MAX);
+
+#define WAIT_TIME K_MSEC(100)
+
+static uint8_t mac_addr[] = { 0x00, 0x00, 0x5e, 0x00, 0x53, 0x01 };
+
+int net_ipv4_fragment_dev_init(const struct device *dev)
+{
+	return 0;
+}
+
+static void net_ipv4_fragment_iface_init(struct net_if *iface)
+{
+	net_if_set_link_addr(iface, mac_addr, sizeof(mac_addr),
+			     NET_LINK_ETHERNET);
+}
+
+static int tester_send(const struct device *dev, struct net_pkt *pkt)
+{
+	return 0;
+}
+
+static struct dummy_api net_ipv4_fragment_if_api = {
+	.iface_api.init = net_ipv4_fragment_iface_init,
+	.send = tester_send,
+};
+
+#define _ETH_L2_LAYER DUMMY_L2
+#define _ETH_L2_CTX_TYPE NET_L2_GET_CTX_TYPE(DUMMY_L2)
+
+NET_DEVICE_INIT(net_ipv4_fragment_test, "net_ipv4_fragment_test",
+		net_ipv4_fragment_dev_init, device_pm_control_nop,
+		NULL, NULL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		&net_ipv4_fragment_if_api, _ETH_L2_LAYER, _ETH_L2_CTX_TYPE,
+		127);
+
+static enum net_verdict udp_recv(struct net_conn *conn,
+				 struct net_pkt *pkt,
+				 union net_ip_header *ip_hdr,
+				 union net_proto_header *proto_hdr,
+				 void *user_data)
+{
+	static uint8_t buf[MAX_DATAGRAM_LEN];
+
+	recv_len = net_pkt_get_len(pkt) - NET_IPV4H_LEN;
+
+	net_pkt_cursor_init(pkt);
+	recv_match = recv_len == datagram_len &&
+		     !net_pkt_skip(pkt, NET_IPV4H_LEN) &&
+		     !net_pkt_read(pkt, buf, recv_len) &&
+		     !memcmp(buf, datagram, recv_len);
+
+	recv_count++;
+
+	net_pkt_unref(pkt);
+
+	k_sem_give(&wait_data);
+
+	return NET_OK;
+}
+
+static void test_init(void)
+{
+	struct sockaddr_in local = {
+		.sin_family = AF_INET,
+		.sin_port = htons(MY_PORT),
+	};
+	struct net_if_addr *ifaddr;
+	int ret;
+
+	iface = net_if_get_default();
+	zassert_not_null(iface, "Interface not found");
+
+	ifaddr = net_if_ipv4_addr_add(iface, &my_addr, NET_ADDR_MANUAL, 0);
+	zassert_not_null(ifaddr, "Cannot add IPv4 address");
+
+	net_ipaddr_copy(&local.sin_addr, &my_addr);
+
+	ret = net_udp_register(AF_INET, NULL, (struct sockaddr *)&local,
+			       0, MY_PORT, NULL, udp_recv, NULL, &handle);
+	zassert_equal(ret, 0, "Cannot register UDP handler");
+}
+
+static struct net_pkt *alloc_pkt(size_t size)
+{
+	struct net_pkt *pkt;
+
+	/* Without an interface nor a family the size is not cut to the
+	 * IPv4 MTU.
+	 */
+	pkt = net_pkt_alloc_with_buffer(NULL, size, AF_UNSPEC, 0, K_FOREVER);
+	zassert_not_null(pkt, "Cannot allocate packet");
+
+	net_pkt_set_iface(pkt, iface);
+	net_pkt_set_family(pkt, AF_INET);
+
+	return pkt;
+}
+
+/* Builds an UDP datagram with a valid checksum of len bytes in datagram[] */
+static void create_datagram(uint16_t len)
+{
+	struct net_pkt *pkt;
+	int i;
+
+	pkt = alloc_pkt(NET_IPV4H_LEN + len);
+
+	zassert_equal(net_ipv4_create(pkt, &peer_addr, &my_addr), 0,
+		      "Cannot create IPv4 header");
+	zassert_equal(net_udp_create(pkt, htons(PEER_PORT), htons(MY_PORT)),
+		      0, "Cannot create UDP header");
+
+	for (i = 0; i < len - NET_UDPH_LEN; i++) {
+		zassert_equal(net_pkt_write_u8(pkt, i * 7), 0,
+			      "Cannot write payload");
+	}
+
+	net_pkt_cursor_init(pkt);
+	zassert_equal(net_ipv4_finalize(pkt, IPPROTO_UDP), 0,
+		      "Cannot finalize packet");
+
+	net_pkt_cursor_init(pkt);
+	zassert_equal(net_pkt_skip(pkt, NET_IPV4H_LEN), 0, "Cannot skip");
+	zassert_equal(net_pkt_read(pkt, datagram, len), 0, "Cannot read");
+
+	datagram_len = len;
+
+	net_pkt_unref(pkt);
+}
+
+/* Receives bytes start to end of datagram[] as a fragment */
+static void recv_fragment(uint16_t id, uint16_t start, uint16_t end)
+{
+	bool more = end < datagram_len;
+	struct net_ipv4_hdr *hdr;
+	struct net_pkt *pkt;
+
+	pkt = alloc_pkt(NET_IPV4H_LEN + end - start);
+
+	zassert_equal(net_ipv4_create_full(pkt, &peer_addr, &my_addr, 0U, id,
+					   more ? NET_IPV4_MF : 0U,
+					   start / 8U,
+					   net_if_ipv4_get_ttl(iface)),
+		      0, "Cannot create IPv4 header");
+	zassert_equal(net_pkt_write(pkt, datagram + start, end - start), 0,
+		      "Cannot write fragment");
+
+	hdr = NET_IPV4_HDR(pkt);
+	hdr->len = htons(net_pkt_get_len(pkt));
+	hdr->proto = IPPROTO_UDP;
+	hdr->chksum = 0U;
+	hdr->chksum = net_calc_chksum_ipv4(pkt);
+
+	net_pkt_cursor_init(pkt);
+
+	zassert_equal(net_recv_data(iface, pkt), 0, "Cannot receive packet");
+}
+
+static void frag_count_cb(struct net_reass *reass, void *user_data)
+{
+	int *count = user_data;
+
+	(*count)++;
+}
+
+static int pending_fragments(void)
+{
+	int count = 0;
+
+	/* Let the RX thread handle the fragments received */
+	k_sleep(K_MSEC(10));
+
+	net_ipv4_frag_foreach(frag_count_cb, &count);
+
+	return count;
+}
+
+/* Waits for the RX path to handle everything received */
+static bool datagram_received(void)
+{
+	int count = recv_count;
+
+	k_sem_take(&wait_data, WAIT_TIME);
+
+	return recv_count > count;
+}
+
+static void check_received(void)
+{
+	zassert_true(datagram_received(), "Datagram not received");
+	zassert_true(recv_match, "Datagram corrupted, %zu bytes received",
+		     recv_len);
+	zassert_equal(pending_fragments(), 0, "Fragments left pending");
+}
+
+static void test_in_order(void)
+{
+	create_datagram(1008);
+
+	recv_fragment(1, 0, 400);
+	recv_fragment(1, 400, 800);
+	recv_fragment(1, 800, 1008);
+
+	check_received();
+}
+
+static void test_reverse_order(void)
+{
+	create_datagram(1008);
+
+	recv_fragment(2, 800, 1008);
+	recv_fragment(2, 400, 800);
+	recv_fragment(2, 0, 400);
+
+	check_received();
+}
+
+static void test_first_last_middle(void)
+{
+	create_datagram(1008);
+
+	recv_fragment(3, 0, 400);
+	recv_fragment(3, 800, 1008);
+
+	/* Duplicates are ignored */
+	recv_fragment(3, 800, 1008);
+	recv_fragment(3, 0, 200);
+
+	zassert_false(datagram_received(), "Incomplete datagram received");
+	zassert_equal(pending_fragments(), 1, "Fragments not pending");
+
+	recv_fragment(3, 400, 800);
+
+	check_received();
+}
+
+static void test_overlap(void)
+{
+	create_datagram(1008);
+
+	recv_fragment(4, 0, 400);
+	recv_fragment(4, 392, 800);
+
+	zassert_false(datagram_received(), "Overlapping datagram received");
+	zassert_equal(pending_fragments(), 0, "Reassembly not given up");
+}
+
+static void test_too_many_holes(void)
+{
+	create_datagram(1008);
+
+	/* CONFIG_NET_REASSEMBLY_MAX_RANGES is 2 */
+	recv_fragment(5, 0, 200);
+	recv_fragment(5, 400, 600);
+	recv_fragment(5, 800, 1008);
+
+	zassert_false(datagram_received(), "Datagram received");
+	zassert_equal(pending_fragments(), 0, "Reassembly not given up");
+}
+
+static void test_memory_eviction(void)
+{
+	create_datagram(1008);
+
+	recv_fragment(6, 0, 1000);
+	zassert_equal(pending_fragments(), 1, "Fragments not pending");
+
+	/* CONFIG_NET_REASSEMBLY_MEM is 2048, the older datagram 6 is given
+	 * up to complete this one.
+	 */
+	create_datagram(2008);
+
+	recv_fragment(7, 0, 1000);
+	zassert_equal(pending_fragments(), 2, "Fragments not pending");
+
+	recv_fragment(7, 1000, 2008);
+
+	check_received();
+}
+
+static void test_context_eviction(void)
+{
+	create_datagram(1008);
+
+	/* CONFIG_NET_IPV4_FRAGMENT_MAX_COUNT is 2, the oldest datagram 8
+	 * is given up for datagram 10.
+	 */
+	recv_fragment(8, 0, 400);
+	recv_fragment(9, 0, 400);
+	recv_fragment(10, 0, 400);
+
+	zassert_equal(pending_fragments(), 2, "Oldest datagram not given up");
+
+	recv_fragment(10, 400, 1008);
+	zassert_true(datagram_received(), "Datagram not received");
+	zassert_true(recv_match, "Datagram corrupted");
+
+	recv_fragment(9, 400, 1008);
+	check_received();
+}
+
+static void test_timeout(void)
+{
+	create_datagram(1008);
+
+	recv_fragment(11, 0, 400);
+	zassert_equal(pending_fragments(), 1, "Fragments not pending");
+
+	/* CONFIG_NET_IPV4_FRAGMENT_TIMEOUT is 1 second */
+	k_sleep(K_MSEC(1100));
+
+	zassert_equal(pending_fragments(), 0, "Reassembly not timed out");
+}
+
+static void test_bad_fragment(void)
+{
+	create_datagram(1008);
+
+	recv_fragment(12, 0, 400);
+	recv_fragment(13, 0, 400);
+
+	/* An empty fragment neither evicts nor gives up a datagram */
+	recv_fragment(14, 400, 400);
+	recv_fragment(12, 400, 400);
+
+	zassert_equal(pending_fragments(), 2, "Reassembly given up");
+
+	recv_fragment(12, 400, 1008);
+	zassert_true(datagram_received(), "Datagram not received");
+	zassert_true(recv_match, "Datagram corrupted");
+
+	recv_fragment(13, 400, 1008);
+	check_received();
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_ipv4_fragment_test,
+			 ztest_unit_test(test_init),
+			 ztest_unit_test(test_in_order),
+			 ztest_unit_test(test_reverse_order),
+			 ztest_unit_test(test_first_last_middle),
+			 ztest_unit_test(test_overlap),
+			 ztest_unit_test(test_too_many_holes),
+			 ztest_unit_test(test_memory_eviction),
+			 ztest_unit_test(test_context_eviction),
+			 ztest_unit_test(test_timeout),
+			 ztest_unit_test(test_bad_fragment));
+
+	ztest_run_test_suite(net_ipv4_fragment_test);
+}
@@ -502,6 +502,41 @@ static void test_nbr_lookup_ok(void)
 			 net_sprint_ipv6_addr(&peer_addr));
 }
 
+/**
+ * @brief IPv6 neighbor lookup after remove and add
+ */
+static void test_nbr_lookup_rm(void)
+{
+	struct net_if *iface = net_if_get_default();
+	struct net_nbr *nbr;
+	uint8_t mac[] = { 0x01, 0x02, 0x33, 0x44, 0x05, 0x06 };
+	struct net_linkaddr lladdr = {
+		.addr = mac,
+		.len = sizeof(mac),
+		.type = NET_LINK_ETHERNET,
+	};
+
+	zassert_true(net_ipv6_nbr_rm(iface, &peer_addr),
+		     "Cannot remove peer %s from neighbor cache\n",
+		     net_sprint_ipv6_addr(&peer_addr));
+
+	nbr = net_ipv6_nbr_lookup(iface, &peer_addr);
+	zassert_is_null(nbr, "Neighbor %s found in cache\n",
+			net_sprint_ipv6_addr(&peer_addr));
+
+	nbr = net_ipv6_nbr_add(iface, &peer_addr, &lladdr, false,
+			       NET_IPV6_NBR_STATE_REACHABLE);
+	zassert_not_null(nbr, "Cannot add peer %s to neighbor cache\n",
+			 net_sprint_ipv6_addr(&peer_addr));
+
+	zassert_equal_ptr(net_ipv6_nbr_lookup(iface, &peer_addr), nbr,
+			  "Neighbor %s not found in cache\n",
+			  net_sprint_ipv6_addr(&peer_addr));
+	zassert_equal_ptr(net_ipv6_nbr_lookup(NULL, &peer_addr), nbr,
+			  "Neighbor %s not found without iface\n",
+			  net_sprint_ipv6_addr(&peer_addr));
+}
+
 /**
  * @brief IPv6 send NS extra options
  */
@@ -1502,6 +1537,7 @@ void test_main(void)
 			 ztest_unit_test(test_add_neighbor),
 			 ztest_unit_test(test_add_max_neighbors),
 			 ztest_unit_test(test_nbr_lookup_ok),
+			 ztest_unit_test(test_nbr_lookup_rm),
 			 ztest_unit_test(test_send_ns_extra_options),
 			 ztest_unit_test(test_send_ns_no_options),
 			 ztest_unit_test(test_rs_message),
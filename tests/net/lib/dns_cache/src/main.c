@@ -0,0 +1,268 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_DNS_RESOLVER_LOG_LEVEL);
+
+#include <ztest.h>
+#include <net/socket.h>
+#include <net/dns_resolve.h>
+
+#include "socket_helpers.h"
+
+#define STACK_SIZE 1024
+#define THREAD_PRIORITY K_PRIO_COOP(2)
+
+#define MAX_BUF_SIZE 512
+#define DNS_HEADER_SIZE 12
+
+/* RCODE of a name that does not exist */
+#define DNS_NXDOMAIN 3
+
+#define TTL_LONG 600
+#define TTL_SHORT 1
+
+static uint8_t dns_buf[MAX_BUF_SIZE];
+static int server_sock;
+static int queries_received;
+
+static const struct in_addr answer_addr = { { { 192, 0, 2, 10 } } };
+
+/* A very small stand-in for a DNS server. The names are answered by their
+ * first label: "missing" does not exist, "short" and "zero" are answered
+ * with 1 and 0 second TTL, and everything else with TTL_LONG.
+ */
+static int dns_answer(uint8_t *buf, int len)
+{
+	char label[16] = { 0 };
+	int pos = DNS_HEADER_SIZE;
+	uint32_t ttl = TTL_LONG;
+
+	if (len < DNS_HEADER_SIZE + 5 || buf[pos] >= sizeof(label)) {
+		return -EINVAL;
+	}
+
+	memcpy(label, &buf[pos + 1], buf[pos]);
+
+	/* Skip the query name, type and class */
+	while (pos < len && buf[pos] != 0) {
+		pos += buf[pos] + 1;
+	}
+
+	pos += 1 + 4;
+	if (pos > len) {
+		return -EINVAL;
+	}
+
+	/* Response, recursion desired and available */
+	buf[2] = 0x81;
+	buf[3] = 0x80;
+
+	if (!strcmp(label, "missing")) {
+		buf[3] |= DNS_NXDOMAIN;
+		return pos;
+	}
+
+	if (!strcmp(label, "short")) {
+		ttl = TTL_SHORT;
+	} else if (!strcmp(label, "zero")) {
+		ttl = 0;
+	}
+
+	/* One answer */
+	buf[6] = 0;
+	buf[7] = 1;
+
+	/* Pointer to the query name, type A, class IN */
+	buf[pos++] = 0xc0;
+	buf[pos++] = DNS_HEADER_SIZE;
+	buf[pos++] = 0;
+	buf[pos++] = 1;
+	buf[pos++] = 0;
+	buf[pos++] = 1;
+
+	sys_put_be32(ttl, &buf[pos]);
+	pos += 4;
+
+	sys_put_be16(sizeof(answer_addr), &buf[pos]);
+	pos += 2;
+
+	memcpy(&buf[pos], &answer_addr, sizeof(answer_addr));
+	pos += sizeof(answer_addr);
+
+	return pos;
+}
+
+static void dns_server(void *p1, void *p2, void *p3)
+{
+	struct sockaddr_in addr;
+	socklen_t addr_len;
+	int len;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (true) {
+		addr_len = sizeof(addr);
+
+		len = recvfrom(server_sock, dns_buf, sizeof(dns_buf), 0,
+			       (struct sockaddr *)&addr, &addr_len);
+		if (len < 0) {
+			continue;
+		}
+
+		queries_received++;
+
+		len = dns_answer(dns_buf, len);
+		if (len < 0) {
+			continue;
+		}
+
+		(void)sendto(server_sock, dns_buf, len, 0,
+			     (struct sockaddr *)&addr, addr_len);
+	}
+}
+
+K_THREAD_DEFINE(dns_server_thread_id, STACK_SIZE,
+		dns_server, NULL, NULL, NULL,
+		THREAD_PRIORITY, 0, -1);
+
+static int resolve(const char *name)
+{
+	struct addrinfo hints = {
+		.ai_family = AF_INET,
+	};
+	struct addrinfo *res = NULL;
+	int ret;
+
+	ret = getaddrinfo(name, NULL, &hints, &res);
+	if (ret == 0) {
+		zassert_not_null(res, "No result");
+		zassert_equal(net_sin(res->ai_addr)->sin_addr.s_addr,
+			      answer_addr.s_addr, "Wrong address");
+	}
+
+	freeaddrinfo(res);
+
+	return ret;
+}
+
+static void test_dns_cache_setup(void)
+{
+	struct sockaddr addr;
+	int ret;
+
+	ret = net_ipaddr_parse(CONFIG_DNS_SERVER1,
+			       sizeof(CONFIG_DNS_SERVER1) - 1, &addr);
+	zassert_true(ret, "Cannot parse IP address %s", CONFIG_DNS_SERVER1);
+
+	server_sock = prepare_listen_sock_udp_v4(net_sin(&addr));
+	zassert_true(server_sock >= 0, "Invalid server socket");
+
+	k_thread_start(dns_server_thread_id);
+	k_yield();
+}
+
+static void test_dns_cache_hit(void)
+{
+	queries_received = 0;
+
+	zassert_equal(resolve("cached.example"), 0, "Cannot resolve");
+	zassert_equal(queries_received, 1, "No query sent");
+
+	zassert_equal(resolve("cached.example"), 0, "Cannot resolve");
+	zassert_equal(queries_received, 1, "Cached answer not used");
+}
+
+static void test_dns_cache_ttl(void)
+{
+	queries_received = 0;
+
+	zassert_equal(resolve("short.example"), 0, "Cannot resolve");
+	zassert_equal(resolve("short.example"), 0, "Cannot resolve");
+	zassert_equal(queries_received, 1, "Cached answer not used");
+
+	k_msleep(TTL_SHORT * MSEC_PER_SEC + 100);
+
+	zassert_equal(resolve("short.example"), 0, "Cannot resolve");
+	zassert_equal(queries_received, 2, "Expired answer used");
+
+	/* A zero TTL answer is not cached at all */
+	zassert_equal(resolve("zero.example"), 0, "Cannot resolve");
+	zassert_equal(resolve("zero.example"), 0, "Cannot resolve");
+	zassert_equal(queries_received, 4, "Zero TTL answer cached");
+}
+
+static void test_dns_cache_negative(void)
+{
+	int ret;
+
+	queries_received = 0;
+
+	ret = resolve("missing.example");
+	zassert_not_equal(ret, 0, "Missing name resolved");
+	zassert_equal(queries_received, 1, "No query sent");
+
+	zassert_equal(resolve("missing.example"), ret, "Different result");
+	zassert_equal(queries_received, 1, "Cached name error not used");
+}
+
+static void cache_count_cb(const char *query, enum dns_query_type type,
+			   const struct dns_addrinfo *info, int status,
+			   uint32_t ttl, void *user_data)
+{
+	int *count = user_data;
+
+	zassert_true(ttl <= TTL_LONG, "Invalid TTL %u", ttl);
+	zassert_true(info || status, "Neither address nor status");
+
+	(*count)++;
+}
+
+static void test_dns_cache_bounded(void)
+{
+	char name[sizeof("hostNN.example")];
+	int count = 0;
+	int i;
+
+	for (i = 0; i < CONFIG_DNS_RESOLVER_CACHE_MAX_ENTRIES + 2; i++) {
+		snprintk(name, sizeof(name), "host%d.example", i);
+		zassert_equal(resolve(name), 0, "Cannot resolve %s", name);
+	}
+
+	dns_resolve_cache_foreach(cache_count_cb, &count);
+	zassert_equal(count, CONFIG_DNS_RESOLVER_CACHE_MAX_ENTRIES,
+		      "Invalid number of cached answers %d", count);
+}
+
+static void test_dns_cache_flush(void)
+{
+	int count = 0;
+
+	dns_resolve_cache_flush();
+
+	dns_resolve_cache_foreach(cache_count_cb, &count);
+	zassert_equal(count, 0, "Cache not flushed");
+
+	queries_received = 0;
+
+	zassert_equal(resolve("cached.example"), 0, "Cannot resolve");
+	zassert_equal(queries_received, 1, "Flushed answer used");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(dns_cache,
+			 ztest_unit_test(test_dns_cache_setup),
+			 ztest_unit_test(test_dns_cache_hit),
+			 ztest_unit_test(test_dns_cache_ttl),
+			 ztest_unit_test(test_dns_cache_negative),
+			 ztest_unit_test(test_dns_cache_bounded),
+			 ztest_unit_test(test_dns_cache_flush));
+
+	ztest_run_test_suite(dns_cache);
+}
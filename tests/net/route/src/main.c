@@ -447,6 +447,99 @@ static void test_route_del_nexthop_again(void)
 	zassert_false((ret >= 0), "Route del again nexthop failed");
 }
 
+static void test_route_lookup_longest_prefix(void)
+{
+	struct net_route_entry *prefix_route, *host_route, *found;
+	struct in6_addr other_addr;
+
+	net_ipaddr_copy(&other_addr, &dest_addr);
+	other_addr.s6_addr[15] ^= 0xff;
+
+	prefix_route = net_route_add(my_iface, &dest_addr, 64, &peer_addr);
+	zassert_not_null(prefix_route, "Prefix route add failed");
+
+	host_route = net_route_add(my_iface, &dest_addr, 128, &peer_addr);
+	zassert_not_null(host_route, "Host route add failed");
+	zassert_not_equal(host_route, prefix_route,
+			  "Host route replaced the prefix route");
+
+	found = net_route_lookup(my_iface, &dest_addr);
+	zassert_equal_ptr(found, host_route, "Longest prefix not selected");
+
+	found = net_route_lookup(my_iface, &other_addr);
+	zassert_equal_ptr(found, prefix_route, "Prefix route not selected");
+
+	found = net_route_lookup(my_iface, &peer_addr);
+	zassert_equal_ptr(found, prefix_route, "Prefix route not selected");
+
+	zassert_equal(net_route_del(host_route), 0, "Host route del failed");
+
+	found = net_route_lookup(my_iface, &dest_addr);
+	zassert_equal_ptr(found, prefix_route,
+			  "No fallback to the prefix route");
+
+	zassert_equal(net_route_del(prefix_route), 0,
+		      "Prefix route del failed");
+
+	found = net_route_lookup(my_iface, &dest_addr);
+	zassert_is_null(found, "Route found after delete");
+}
+
+#if defined(CONFIG_NET_ROUTE_IPV4)
+static void test_route_ipv4_lookup(void)
+{
+	struct in_addr net = { { { 192, 0, 2, 0 } } };
+	struct in_addr subnet = { { { 192, 0, 2, 128 } } };
+	struct in_addr host = { { { 192, 0, 2, 200 } } };
+	struct in_addr other = { { { 198, 51, 100, 1 } } };
+	struct in_addr gw1 = { { { 10, 0, 0, 1 } } };
+	struct in_addr gw2 = { { { 10, 0, 0, 2 } } };
+	struct net_route_entry_ipv4 *net_route, *subnet_route, *found;
+
+	net_route = net_route_ipv4_add(my_iface, &net, 24, &gw1);
+	zassert_not_null(net_route, "IPv4 route add failed");
+
+	subnet_route = net_route_ipv4_add(my_iface, &subnet, 25, &gw2);
+	zassert_not_null(subnet_route, "IPv4 route add failed");
+
+	found = net_route_ipv4_lookup(my_iface, &host);
+	zassert_equal_ptr(found, subnet_route, "Longest prefix not selected");
+
+	found = net_route_ipv4_lookup(NULL, &net);
+	zassert_equal_ptr(found, net_route, "Prefix route not selected");
+
+	found = net_route_ipv4_lookup(peer_iface, &host);
+	zassert_is_null(found, "Route found for wrong interface");
+
+	found = net_route_ipv4_lookup(my_iface, &other);
+	zassert_is_null(found, "Route found for unknown network");
+
+	zassert_equal_ptr(net_route_ipv4_add(my_iface, &subnet, 25, &gw1),
+			  subnet_route, "IPv4 route update failed");
+	zassert_true(net_ipv4_addr_cmp(&subnet_route->gw, &gw1),
+		     "Gateway not updated");
+
+	zassert_equal(net_route_ipv4_del(subnet_route), 0,
+		      "IPv4 route del failed");
+
+	found = net_route_ipv4_lookup(my_iface, &host);
+	zassert_equal_ptr(found, net_route, "No fallback to the prefix route");
+
+	zassert_equal(net_route_ipv4_del(net_route), 0,
+		      "IPv4 route del failed");
+	zassert_not_equal(net_route_ipv4_del(net_route), 0,
+			  "IPv4 route del again succeeded");
+
+	found = net_route_ipv4_lookup(my_iface, &host);
+	zassert_is_null(found, "Route found after delete");
+}
+#else
+static void test_route_ipv4_lookup(void)
+{
+	ztest_test_skip();
+}
+#endif /* CONFIG_NET_ROUTE_IPV4 */
+
 static void test_route_add_many(void)
 {
 	int i;
@@ -490,6 +583,8 @@ void test_main(void)
 			ztest_unit_test(test_route_del_nexthop),
 			ztest_unit_test(test_route_del_again),
 			ztest_unit_test(test_route_del_nexthop_again),
+			ztest_unit_test(test_route_lookup_longest_prefix),
+			ztest_unit_test(test_route_ipv4_lookup),
 			ztest_unit_test(test_populate_nbr_cache),
 			ztest_unit_test(test_route_add_many),
 			ztest_unit_test(test_route_del_many));
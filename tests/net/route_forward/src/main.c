@@ -0,0 +1,324 @@
+/* main.c - Application main entry point */
+
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_ROUTE_LOG_LEVEL);
+
+#include <zephyr/types.h>
+#include <ztest.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/printk.h>
+#include <linker/sections.h>
+
+#include <tc_util.h>
+
+#include <net/ethernet.h>
+#include <net/dummy.h>
+#include <net/buf.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+
+#define NET_LOG_ENABLED 1
+#include "net_private.h"
+#include "ipv6.h"
+#include "nbr.h"
+#include "route.h"
+
+#if defined(CONFIG_NET_ROUTE_LOG_LEVEL_DBG)
+#define DBG(fmt, ...) printk(fmt, ##__VA_ARGS__)
+#else
+#define DBG(fmt, ...)
+#endif
+
+/* Packets are received from the host network behind iface_in and routed
+ * through the router on the network behind iface_out.
+ */
+static struct in6_addr in_addr = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 1, 0, 0,
+				       0, 0, 0, 0, 0, 0, 0, 0x1 } } };
+static struct in6_addr out_addr = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 2, 0, 0,
+					0, 0, 0, 0, 0, 0, 0, 0x1 } } };
+static struct in6_addr host_addr = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 1, 0, 0,
+					 0, 0, 0, 0, 0, 0, 0, 0x10 } } };
+static struct in6_addr router_addr = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 2, 0, 0,
+					   0, 0, 0, 0, 0, 0, 0, 0x2 } } };
+static struct in6_addr dest_net = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 0x99, 0, 0,
+					0, 0, 0, 0, 0, 0, 0, 0 } } };
+static struct in6_addr dest_addr = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 0x99, 0, 0,
+					 0, 0, 0, 0, 0, 0, 0, 0x5 } } };
+
+static uint8_t router_mac[] = { 0x00, 0x00, 0x5e, 0x00, 0x53, 0x02 };
+static uint8_t router_mac_new[] = { 0x00, 0x00, 0x5e, 0x00, 0x53, 0x03 };
+
+static struct net_if *iface_in;
+static struct net_if *iface_out;
+
+static struct net_route_entry *route;
+
+static int sent_in;
+static int sent_out;
+static uint8_t sent_out_mac[sizeof(struct net_eth_addr)];
+
+K_SEM_DEFINE(wait_data, 0, UINT_MAX);
+
+#define WAIT_TIME K_MSEC(100)
+
+struct net_route_forward_test {
+	uint8_t mac_addr[sizeof(struct net_eth_addr)];
+};
+
+static struct net_route_forward_test net_route_forward_data_in = {
+	.mac_addr = { 0x00, 0x00, 0x5e, 0x00, 0x53, 0x10 },
+};
+
+static struct net_route_forward_test net_route_forward_data_out = {
+	.mac_addr = { 0x00, 0x00, 0x5e, 0x00, 0x53, 0x20 },
+};
+
+int net_route_forward_dev_init(const struct device *dev)
+{
+	return 0;
+}
+
+static void net_route_forward_iface_init(struct net_if *iface)
+{
+	struct net_route_forward_test *data = net_if_get_device(iface)->data;
+
+	net_if_set_link_addr(iface, data->mac_addr, sizeof(data->mac_addr),
+			     NET_LINK_ETHERNET);
+}
+
+static int tester_send_in(const struct device *dev, struct net_pkt *pkt)
+{
+	sent_in++;
+
+	k_sem_give(&wait_data);
+
+	return 0;
+}
+
+static int tester_send_out(const struct device *dev, struct net_pkt *pkt)
+{
+	struct net_linkaddr *lladdr = net_pkt_lladdr_dst(pkt);
+
+	DBG("pkt %p forwarded len %zu\n", pkt, net_pkt_get_len(pkt));
+
+	zassert_true(net_pkt_forwarding(pkt), "Packet not forwarded");
+	zassert_equal(lladdr->len, sizeof(sent_out_mac), "Wrong ll addr");
+
+	memcpy(sent_out_mac, lladdr->addr, sizeof(sent_out_mac));
+	sent_out++;
+
+	k_sem_give(&wait_data);
+
+	return 0;
+}
+
+static struct dummy_api net_route_forward_if_api_in = {
+	.iface_api.init = net_route_forward_iface_init,
+	.send = tester_send_in,
+};
+
+static struct dummy_api net_route_forward_if_api_out = {
+	.iface_api.init = net_route_forward_iface_init,
+	.send = tester_send_out,
+};
+
+#define _ETH_L2_LAYER DUMMY_L2
+#define _ETH_L2_CTX_TYPE NET_L2_GET_CTX_TYPE(DUMMY_L2)
+
+NET_DEVICE_INIT_INSTANCE(net_route_forward_in, "net_route_forward_in", in,
+			 net_route_forward_dev_init, device_pm_control_nop,
+			 &net_route_forward_data_in, NULL,
+			 CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+			 &net_route_forward_if_api_in, _ETH_L2_LAYER,
+			 _ETH_L2_CTX_TYPE, 127);
+
+NET_DEVICE_INIT_INSTANCE(net_route_forward_out, "net_route_forward_out", out,
+			 net_route_forward_dev_init, device_pm_control_nop,
+			 &net_route_forward_data_out, NULL,
+			 CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+			 &net_route_forward_if_api_out, _ETH_L2_LAYER,
+			 _ETH_L2_CTX_TYPE, 127);
+
+static void add_router(uint8_t *mac)
+{
+	struct net_linkaddr lladdr = {
+		.addr = mac,
+		.len = sizeof(router_mac),
+		.type = NET_LINK_ETHERNET,
+	};
+	struct net_nbr *nbr;
+
+	nbr = net_ipv6_nbr_add(iface_out, &router_addr, &lladdr, true,
+			       NET_IPV6_NBR_STATE_REACHABLE);
+	zassert_not_null(nbr, "Cannot add router to neighbor cache");
+}
+
+static void iface_cb(struct net_if *iface, void *user_data)
+{
+	const void *api = net_if_get_device(iface)->api;
+
+	if (api == &net_route_forward_if_api_in) {
+		iface_in = iface;
+	} else if (api == &net_route_forward_if_api_out) {
+		iface_out = iface;
+	}
+}
+
+static void test_init(void)
+{
+	struct net_if_addr *ifaddr;
+
+	net_if_foreach(iface_cb, NULL);
+
+	zassert_not_null(iface_in, "Ingress interface not found");
+	zassert_not_null(iface_out, "Egress interface not found");
+
+	ifaddr = net_if_ipv6_addr_add(iface_in, &in_addr, NET_ADDR_MANUAL, 0);
+	zassert_not_null(ifaddr, "Cannot add IPv6 address");
+	ifaddr->addr_state = NET_ADDR_PREFERRED;
+
+	ifaddr = net_if_ipv6_addr_add(iface_out, &out_addr, NET_ADDR_MANUAL,
+				      0);
+	zassert_not_null(ifaddr, "Cannot add IPv6 address");
+	ifaddr->addr_state = NET_ADDR_PREFERRED;
+
+	add_router(router_mac);
+
+	route = net_route_add(iface_out, &dest_net, 64, &router_addr);
+	zassert_not_null(route, "Cannot add route");
+}
+
+static struct net_pkt *create_pkt(void)
+{
+	struct net_udp_hdr udp = {
+		.src_port = htons(4242),
+		.dst_port = htons(4243),
+		.len = htons(sizeof(struct net_udp_hdr)),
+	};
+	struct net_pkt *pkt;
+
+	pkt = net_pkt_alloc_with_buffer(iface_in, sizeof(udp), AF_INET6,
+					IPPROTO_UDP, K_FOREVER);
+	zassert_not_null(pkt, "Cannot allocate packet");
+
+	zassert_equal(net_ipv6_create(pkt, &host_addr, &dest_addr), 0,
+		      "Cannot create IPv6 header");
+	zassert_equal(net_pkt_write(pkt, &udp, sizeof(udp)), 0,
+		      "Cannot write UDP header");
+
+	net_pkt_cursor_init(pkt);
+	zassert_equal(net_ipv6_finalize(pkt, IPPROTO_UDP), 0,
+		      "Cannot finalize packet");
+
+	net_pkt_cursor_init(pkt);
+
+	return pkt;
+}
+
+static bool recv_pkt(void)
+{
+	int out = sent_out;
+
+	zassert_equal(net_recv_data(iface_in, create_pkt()), 0,
+		      "Cannot receive packet");
+
+	k_sem_take(&wait_data, WAIT_TIME);
+
+	zassert_equal(sent_in, 0, "Packet sent back to ingress interface");
+
+	return sent_out > out;
+}
+
+static void test_forward(void)
+{
+	int i;
+
+	for (i = 0; i < 4; i++) {
+		zassert_true(recv_pkt(), "Packet %d not forwarded", i);
+		zassert_mem_equal(sent_out_mac, router_mac, sizeof(router_mac),
+				  "Packet %d sent to wrong next hop", i);
+	}
+}
+
+static void test_flow_cache(void)
+{
+	struct net_pkt *pkt;
+	int out = sent_out;
+
+	if (CONFIG_NET_ROUTE_FLOW_CACHE_SIZE == 0) {
+		ztest_test_skip();
+		return;
+	}
+
+	/* The flow was routed by test_forward() */
+	pkt = create_pkt();
+	zassert_equal(net_route_flow_packet(pkt, &host_addr, &dest_addr), 0,
+		      "Flow not cached");
+
+	k_sem_take(&wait_data, WAIT_TIME);
+	zassert_equal(sent_out, out + 1, "Cached flow not forwarded");
+
+	/* Other flows and interfaces do not match */
+	pkt = create_pkt();
+	zassert_equal(net_route_flow_packet(pkt, &in_addr, &dest_addr),
+		      -ENOENT, "Wrong flow matched");
+
+	net_pkt_set_iface(pkt, iface_out);
+	zassert_equal(net_route_flow_packet(pkt, &host_addr, &dest_addr),
+		      -ENOENT, "Flow matched on wrong interface");
+
+	net_pkt_unref(pkt);
+}
+
+static void test_flow_lladdr_change(void)
+{
+	zassert_true(recv_pkt(), "Packet not forwarded");
+
+	/* The router moved to another link layer address */
+	add_router(router_mac_new);
+
+	zassert_true(recv_pkt(), "Packet not forwarded");
+	zassert_mem_equal(sent_out_mac, router_mac_new, sizeof(router_mac),
+			  "Stale link layer address used");
+}
+
+static void test_flow_route_del(void)
+{
+	struct net_pkt *pkt;
+
+	zassert_true(recv_pkt(), "Packet not forwarded");
+
+	zassert_equal(net_route_del(route), 0, "Cannot delete route");
+
+	pkt = create_pkt();
+	zassert_equal(net_route_flow_packet(pkt, &host_addr, &dest_addr),
+		      -ENOENT, "Flow kept after route delete");
+	net_pkt_unref(pkt);
+
+	zassert_false(recv_pkt(), "Packet forwarded without route");
+
+	route = net_route_add(iface_out, &dest_net, 64, &router_addr);
+	zassert_not_null(route, "Cannot add route");
+
+	zassert_true(recv_pkt(), "Packet not forwarded");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(test_route_forward,
+			 ztest_unit_test(test_init),
+			 ztest_unit_test(test_forward),
+			 ztest_unit_test(test_flow_cache),
+			 ztest_unit_test(test_flow_lladdr_change),
+			 ztest_unit_test(test_flow_route_del));
+	ztest_run_test_suite(test_route_forward);
+}
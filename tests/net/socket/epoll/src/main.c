@@ -0,0 +1,462 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_SOCKETS_LOG_LEVEL);
+
+#include <stdio.h>
+#include <ztest_assert.h>
+
+#include <net/socket.h>
+#include <net/loopback.h>
+#include <sys/fdtable.h>
+
+#include "../../socket_helpers.h"
+
+#define BUF_AND_SIZE(buf) buf, sizeof(buf) - 1
+#define STRLEN(buf) (sizeof(buf) - 1)
+
+#define TEST_STR_SMALL "test"
+
+#define SERVER_PORT 4242
+#define CLIENT_PORT 9898
+
+/* On QEMU, a wait takes +10ms from the requested time. */
+#define FUZZ 10
+
+static int c_sock;
+static int s_sock;
+static int epfd;
+static struct sockaddr_in6 c_addr;
+static struct sockaddr_in6 s_addr;
+
+static void send_small(void)
+{
+	ssize_t len;
+
+	len = send(c_sock, BUF_AND_SIZE(TEST_STR_SMALL), 0);
+	zassert_equal(len, STRLEN(TEST_STR_SMALL), "invalid send len");
+
+	/* Let the network stack run */
+	k_msleep(10);
+}
+
+static void recv_small(void)
+{
+	char buf[10];
+	ssize_t len;
+
+	len = recv(s_sock, BUF_AND_SIZE(buf), 0);
+	zassert_equal(len, STRLEN(TEST_STR_SMALL), "invalid recv len");
+}
+
+static void add(int fd, uint32_t events)
+{
+	struct epoll_event ev = {
+		.events = events,
+		.data.fd = fd,
+	};
+
+	zassert_equal(epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev), 0,
+		      "add failed (%d)", errno);
+}
+
+static void test_epoll_setup(void)
+{
+	int res;
+
+	prepare_sock_udp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, CLIENT_PORT,
+			    &c_sock, &c_addr);
+	prepare_sock_udp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, SERVER_PORT,
+			    &s_sock, &s_addr);
+
+	res = bind(s_sock, (struct sockaddr *)&s_addr, sizeof(s_addr));
+	zassert_equal(res, 0, "bind failed");
+
+	res = connect(c_sock, (struct sockaddr *)&s_addr, sizeof(s_addr));
+	zassert_equal(res, 0, "connect failed");
+
+	zassert_equal(epoll_create(0), -1, "invalid size accepted");
+	zassert_equal(errno, EINVAL, "");
+
+	epfd = epoll_create1(0);
+	zassert_true(epfd >= 0, "epoll_create1 failed");
+}
+
+static void test_epoll_level(void)
+{
+	struct epoll_event ev[2];
+	uint32_t tstamp;
+	int res;
+
+	add(c_sock, EPOLLIN);
+	add(s_sock, EPOLLIN);
+
+	/* Nothing ready, no wait */
+	tstamp = k_uptime_get_32();
+	res = epoll_wait(epfd, ev, ARRAY_SIZE(ev), 0);
+	zassert_true(k_uptime_get_32() - tstamp <= FUZZ, "");
+	zassert_equal(res, 0, "");
+
+	/* Nothing ready, wait for the timeout */
+	tstamp = k_uptime_get_32();
+	res = epoll_wait(epfd, ev, ARRAY_SIZE(ev), 30);
+	tstamp = k_uptime_get_32() - tstamp;
+	zassert_true(tstamp >= 30U && tstamp <= 30 + FUZZ * 2, "tstamp %d",
+		     tstamp);
+	zassert_equal(res, 0, "");
+
+	send_small();
+
+	tstamp = k_uptime_get_32();
+	res = epoll_wait(epfd, ev, ARRAY_SIZE(ev), 30);
+	zassert_true(k_uptime_get_32() - tstamp <= FUZZ, "");
+	zassert_equal(res, 1, "");
+	zassert_equal(ev[0].events, EPOLLIN, "");
+	zassert_equal(ev[0].data.fd, s_sock, "");
+
+	/* Level triggered, still ready until the data is read */
+	res = epoll_wait(epfd, ev, ARRAY_SIZE(ev), 0);
+	zassert_equal(res, 1, "");
+	zassert_equal(ev[0].data.fd, s_sock, "");
+
+	recv_small();
+
+	res = epoll_wait(epfd, ev, ARRAY_SIZE(ev), 0);
+	zassert_equal(res, 0, "");
+}
+
+static void send_work_handler(struct k_work *work)
+{
+	ARG_UNUSED(work);
+
+	(void)send(c_sock, BUF_AND_SIZE(TEST_STR_SMALL), 0);
+}
+
+static void test_epoll_wakeup(void)
+{
+	struct epoll_event ev[2];
+	struct k_work_delayable work;
+	uint32_t tstamp;
+	int res;
+
+	/* Data arriving while waiting ends the wait */
+	k_work_init_delayable(&work, send_work_handler);
+	k_work_schedule(&work, K_MSEC(30));
+
+	tstamp = k_uptime_get_32();
+	res = epoll_wait(epfd, ev, ARRAY_SIZE(ev), 1000);
+	tstamp = k_uptime_get_32() - tstamp;
+	zassert_equal(res, 1, "");
+	zassert_equal(ev[0].data.fd, s_sock, "");
+	zassert_true(tstamp >= 30U && tstamp < 500, "tstamp %d", tstamp);
+
+	recv_small();
+}
+
+static void test_epoll_edge(void)
+{
+	struct epoll_event mod = {
+		.events = EPOLLIN | EPOLLET,
+		.data.fd = s_sock,
+	};
+	struct epoll_event ev[2];
+	int res;
+
+	res = epoll_ctl(epfd, EPOLL_CTL_MOD, s_sock, &mod);
+	zassert_equal(res, 0, "mod failed");
+
+	send_small();
+
+	res = epoll_wait(epfd, ev, ARRAY_SIZE(ev), 0);
+	zassert_equal(res, 1, "");
+	zassert_equal(ev[0].data.fd, s_sock, "");
+
+	/* Edge triggered, reported once even though data is left */
+	res = epoll_wait(epfd, ev, ARRAY_SIZE(ev), 0);
+	zassert_equal(res, 0, "");
+
+	/* New data is a new edge */
+	send_small();
+
+	res = epoll_wait(epfd, ev, ARRAY_SIZE(ev), 0);
+	zassert_equal(res, 1, "");
+
+	recv_small();
+	recv_small();
+}
+
+static void test_epoll_oneshot(void)
+{
+	struct epoll_event mod = {
+		.events = EPOLLIN | EPOLLONESHOT,
+		.data.fd = s_sock,
+	};
+	struct epoll_event ev[2];
+	int res;
+
+	res = epoll_ctl(epfd, EPOLL_CTL_MOD, s_sock, &mod);
+	zassert_equal(res, 0, "mod failed");
+
+	send_small();
+
+	res = epoll_wait(epfd, ev, ARRAY_SIZE(ev), 0);
+	zassert_equal(res, 1, "");
+
+	/* Disabled after the first report */
+	send_small();
+
+	res = epoll_wait(epfd, ev, ARRAY_SIZE(ev), 0);
+	zassert_equal(res, 0, "");
+
+	/* Rearmed by modifying, the data is still there */
+	res = epoll_ctl(epfd, EPOLL_CTL_MOD, s_sock, &mod);
+	zassert_equal(res, 0, "mod failed");
+
+	res = epoll_wait(epfd, ev, ARRAY_SIZE(ev), 0);
+	zassert_equal(res, 1, "");
+
+	recv_small();
+	recv_small();
+}
+
+static void test_epoll_pollout(void)
+{
+	struct epoll_event mod = {
+		.events = EPOLLIN | EPOLLOUT,
+		.data.fd = c_sock,
+	};
+	struct pollfd pfd = {
+		.fd = epfd,
+		.events = POLLIN,
+	};
+	struct epoll_event ev[2];
+	int res;
+
+	res = epoll_ctl(epfd, EPOLL_CTL_MOD, c_sock, &mod);
+	zassert_equal(res, 0, "mod failed");
+
+	res = epoll_wait(epfd, ev, ARRAY_SIZE(ev), 200);
+	zassert_equal(res, 1, "");
+	zassert_equal(ev[0].events, EPOLLOUT, "");
+	zassert_equal(ev[0].data.fd, c_sock, "");
+
+	/* The epoll instance itself can be polled */
+	res = poll(&pfd, 1, 0);
+	zassert_equal(res, 1, "");
+	zassert_equal(pfd.revents, POLLIN, "");
+
+	res = epoll_ctl(epfd, EPOLL_CTL_DEL, c_sock, NULL);
+	zassert_equal(res, 0, "del failed");
+
+	res = epoll_wait(epfd, ev, ARRAY_SIZE(ev), 0);
+	zassert_equal(res, 0, "");
+}
+
+static void test_epoll_accept(void)
+{
+	struct sockaddr_in6 addr;
+	struct epoll_event ev[2];
+	socklen_t addrlen = sizeof(addr);
+	int c_sock_tcp, s_sock_tcp, new_sock;
+	int res;
+
+	prepare_sock_tcp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, CLIENT_PORT,
+			    &c_sock_tcp, &c_addr);
+	prepare_sock_tcp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, SERVER_PORT,
+			    &s_sock_tcp, &s_addr);
+
+	res = bind(s_sock_tcp, (struct sockaddr *)&s_addr, sizeof(s_addr));
+	zassert_equal(res, 0, "");
+	res = listen(s_sock_tcp, 0);
+	zassert_equal(res, 0, "");
+
+	add(s_sock_tcp, EPOLLIN);
+
+	res = connect(c_sock_tcp, (const struct sockaddr *)&s_addr,
+		      sizeof(s_addr));
+	zassert_equal(res, 0, "");
+
+	res = epoll_wait(epfd, ev, ARRAY_SIZE(ev), 200);
+	zassert_equal(res, 1, "");
+	zassert_equal(ev[0].data.fd, s_sock_tcp, "");
+
+	new_sock = accept(s_sock_tcp, (struct sockaddr *)&addr, &addrlen);
+	zassert_true(new_sock >= 0, "accept failed");
+
+	res = epoll_wait(epfd, ev, ARRAY_SIZE(ev), 0);
+	zassert_equal(res, 0, "");
+
+	/* Data on the accepted socket */
+	add(new_sock, EPOLLIN);
+
+	res = send(c_sock_tcp, BUF_AND_SIZE(TEST_STR_SMALL), 0);
+	zassert_equal(res, STRLEN(TEST_STR_SMALL), "");
+
+	res = epoll_wait(epfd, ev, ARRAY_SIZE(ev), 200);
+	zassert_equal(res, 1, "");
+	zassert_equal(ev[0].data.fd, new_sock, "");
+
+	/* Closing removes the socket from the instance */
+	res = close(new_sock);
+	zassert_equal(res, 0, "close failed");
+
+	res = epoll_wait(epfd, ev, ARRAY_SIZE(ev), 0);
+	zassert_equal(res, 0, "");
+
+	k_msleep(10);
+
+	res = close(c_sock_tcp);
+	zassert_equal(res, 0, "close failed");
+
+	res = close(s_sock_tcp);
+	zassert_equal(res, 0, "close failed");
+}
+
+/* A connected pair of TCP sockets, with the listening one closed */
+static void tcp_connect(int port, int *c_sock_tcp, int *new_sock)
+{
+	struct sockaddr_in6 addr, tcp_c_addr, tcp_s_addr;
+	socklen_t addrlen = sizeof(addr);
+	int s_sock_tcp;
+	int res;
+
+	prepare_sock_tcp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, port + 1,
+			    c_sock_tcp, &tcp_c_addr);
+	prepare_sock_tcp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, port,
+			    &s_sock_tcp, &tcp_s_addr);
+
+	res = bind(s_sock_tcp, (struct sockaddr *)&tcp_s_addr,
+		   sizeof(tcp_s_addr));
+	zassert_equal(res, 0, "");
+	res = listen(s_sock_tcp, 0);
+	zassert_equal(res, 0, "");
+
+	res = connect(*c_sock_tcp, (const struct sockaddr *)&tcp_s_addr,
+		      sizeof(tcp_s_addr));
+	zassert_equal(res, 0, "connect %d", errno);
+
+	*new_sock = accept(s_sock_tcp, (struct sockaddr *)&addr, &addrlen);
+	zassert_true(*new_sock >= 0, "accept failed");
+
+	res = close(s_sock_tcp);
+	zassert_equal(res, 0, "close failed");
+}
+
+static void test_epoll_hangup(void)
+{
+	struct epoll_event ev[2];
+	int c_sock_tcp, new_sock;
+	int res;
+
+	tcp_connect(SERVER_PORT + 2, &c_sock_tcp, &new_sock);
+
+	add(c_sock_tcp, EPOLLIN);
+
+	res = epoll_wait(epfd, ev, ARRAY_SIZE(ev), 0);
+	zassert_equal(res, 0, "");
+
+	/* The peer closes the connection */
+	res = close(new_sock);
+	zassert_equal(res, 0, "close failed");
+
+	res = epoll_wait(epfd, ev, ARRAY_SIZE(ev), 200);
+	zassert_equal(res, 1, "");
+	zassert_equal(ev[0].events, EPOLLIN | EPOLLHUP, "");
+	zassert_equal(ev[0].data.fd, c_sock_tcp, "");
+
+	res = close(c_sock_tcp);
+	zassert_equal(res, 0, "close failed");
+
+	res = epoll_wait(epfd, ev, ARRAY_SIZE(ev), 0);
+	zassert_equal(res, 0, "");
+}
+
+static void test_epoll_error(void)
+{
+	struct epoll_event ev[2];
+	int c_sock_tcp, new_sock;
+	int res;
+
+	tcp_connect(SERVER_PORT + 4, &c_sock_tcp, &new_sock);
+
+	/* Errors and hangups are reported without asking for them */
+	add(c_sock_tcp, 0);
+
+	/* The data is never acknowledged and the connection times out */
+	zassert_equal(loopback_set_packet_drop_ratio(1.0f), 0, "");
+
+	res = send(c_sock_tcp, BUF_AND_SIZE(TEST_STR_SMALL), 0);
+	zassert_equal(res, STRLEN(TEST_STR_SMALL), "");
+
+	res = epoll_wait(epfd, ev, ARRAY_SIZE(ev), 5000);
+	zassert_equal(res, 1, "");
+	zassert_equal(ev[0].events, EPOLLERR | EPOLLHUP, "");
+	zassert_equal(ev[0].data.fd, c_sock_tcp, "");
+
+	zassert_equal(loopback_set_packet_drop_ratio(0.0f), 0, "");
+
+	res = close(c_sock_tcp);
+	zassert_equal(res, 0, "close failed");
+
+	res = close(new_sock);
+	zassert_equal(res, 0, "close failed");
+}
+
+static void test_epoll_errors(void)
+{
+	struct epoll_event ev = {
+		.events = EPOLLIN,
+	};
+
+	zassert_equal(epoll_ctl(epfd, EPOLL_CTL_ADD, s_sock, &ev), -1, "");
+	zassert_equal(errno, EEXIST, "");
+
+	zassert_equal(epoll_ctl(epfd, EPOLL_CTL_MOD, c_sock, &ev), -1, "");
+	zassert_equal(errno, ENOENT, "");
+
+	/* Only sockets can be watched */
+	zassert_equal(epoll_ctl(epfd, EPOLL_CTL_ADD, epfd, &ev), -1, "");
+	zassert_equal(errno, EPERM, "");
+
+	zassert_equal(epoll_ctl(s_sock, EPOLL_CTL_ADD, c_sock, &ev), -1, "");
+	zassert_equal(errno, EINVAL, "");
+
+	zassert_equal(epoll_wait(epfd, &ev, 0, 0), -1, "");
+	zassert_equal(errno, EINVAL, "");
+}
+
+static void test_epoll_close(void)
+{
+	int res;
+
+	res = close(epfd);
+	zassert_equal(res, 0, "close failed");
+
+	res = close(c_sock);
+	zassert_equal(res, 0, "close failed");
+
+	res = close(s_sock);
+	zassert_equal(res, 0, "close failed");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(socket_epoll,
+			 ztest_unit_test(test_epoll_setup),
+			 ztest_unit_test(test_epoll_level),
+			 ztest_unit_test(test_epoll_wakeup),
+			 ztest_unit_test(test_epoll_edge),
+			 ztest_unit_test(test_epoll_oneshot),
+			 ztest_unit_test(test_epoll_pollout),
+			 ztest_unit_test(test_epoll_accept),
+			 ztest_unit_test(test_epoll_error),
+			 ztest_unit_test(test_epoll_hangup),
+			 ztest_unit_test(test_epoll_errors),
+			 ztest_unit_test(test_epoll_close));
+
+	ztest_run_test_suite(socket_epoll);
+}
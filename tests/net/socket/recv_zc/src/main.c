@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_SOCKETS_LOG_LEVEL);
+
+#include <stdio.h>
+#include <ztest_assert.h>
+
+#include <net/socket.h>
+#include <net/buf.h>
+
+#include "../../socket_helpers.h"
+
+#define BUF_AND_SIZE(buf) buf, sizeof(buf) - 1
+#define STRLEN(buf) (sizeof(buf) - 1)
+
+#define TEST_STR_SMALL "test"
+/* More than 128 bytes, to use >1 net_buf. */
+#define TEST_STR2 \
+	"The Zephyr Project, a Linux Foundation hosted Collaboration " \
+	"Project, is an open source collaborative effort uniting leaders " \
+	"from across the industry to build a best-in-breed small, scalable, " \
+	"real-time operating system (RTOS) optimized for resource-" \
+	"constrained devices, across multiple architectures."
+
+#define SERVER_PORT 4242
+#define CLIENT_PORT 9898
+
+/* Enough rounds to run out of RX buffers if they are not released */
+#define ROUNDS (CONFIG_NET_BUF_RX_COUNT * 2)
+
+static char rx_buf[400];
+
+/* Copy the lent fragments to rx_buf */
+static size_t linearize(struct net_buf *frags)
+{
+	size_t len = 0;
+
+	for (; frags; frags = frags->frags) {
+		zassert_true(len + frags->len <= sizeof(rx_buf), "too long");
+		memcpy(rx_buf + len, frags->data, frags->len);
+		len += frags->len;
+	}
+
+	return len;
+}
+
+static void test_recv_zc_udp(void)
+{
+	struct sockaddr_in c_addr, s_addr;
+	struct sockaddr_in addr;
+	socklen_t addrlen;
+	struct net_buf *frags;
+	int c_sock, s_sock;
+	ssize_t len;
+	int i;
+
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, CLIENT_PORT,
+			    &c_sock, &c_addr);
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &s_sock, &s_addr);
+
+	zassert_equal(bind(s_sock, (struct sockaddr *)&s_addr,
+			   sizeof(s_addr)), 0, "bind failed");
+	zassert_equal(bind(c_sock, (struct sockaddr *)&c_addr,
+			   sizeof(c_addr)), 0, "bind failed");
+
+	/* Nothing queued */
+	len = zsock_recvfrom_zc(s_sock, &frags, ZSOCK_MSG_DONTWAIT, NULL,
+				NULL);
+	zassert_equal(len, -1, "");
+	zassert_equal(errno, EAGAIN, "");
+	zassert_is_null(frags, "");
+
+	/* Unsupported flags */
+	len = zsock_recvfrom_zc(s_sock, &frags, ZSOCK_MSG_PEEK, NULL, NULL);
+	zassert_equal(len, -1, "");
+	zassert_equal(errno, EINVAL, "");
+
+	for (i = 0; i < ROUNDS; i++) {
+		len = sendto(c_sock, BUF_AND_SIZE(TEST_STR2), 0,
+			     (struct sockaddr *)&s_addr, sizeof(s_addr));
+		zassert_equal(len, STRLEN(TEST_STR2), "send failed");
+
+		addrlen = sizeof(addr);
+		len = zsock_recvfrom_zc(s_sock, &frags, 0,
+					(struct sockaddr *)&addr, &addrlen);
+		zassert_equal(len, STRLEN(TEST_STR2), "invalid recv len");
+		zassert_not_null(frags, "no data");
+
+		zassert_equal(addrlen, sizeof(addr), "");
+		zassert_equal(addr.sin_port, c_addr.sin_port, "wrong port");
+
+		zassert_equal(linearize(frags), len, "wrong chain len");
+		zassert_mem_equal(rx_buf, TEST_STR2, len, "wrong data");
+
+		zsock_recv_zc_release(frags);
+	}
+
+	zassert_equal(close(c_sock), 0, "close failed");
+	zassert_equal(close(s_sock), 0, "close failed");
+}
+
+static void test_recv_zc_tcp(void)
+{
+	struct sockaddr_in c_addr, s_addr;
+	struct sockaddr_in addr;
+	socklen_t addrlen = sizeof(addr);
+	int c_sock, s_sock, new_sock;
+	struct net_buf *frags;
+	size_t total;
+	ssize_t len;
+	char buf[2];
+	int i;
+
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, CLIENT_PORT,
+			    &c_sock, &c_addr);
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &s_sock, &s_addr);
+
+	zassert_equal(bind(s_sock, (struct sockaddr *)&s_addr,
+			   sizeof(s_addr)), 0, "bind failed");
+	zassert_equal(listen(s_sock, 1), 0, "listen failed");
+
+	zassert_equal(connect(c_sock, (struct sockaddr *)&s_addr,
+			      sizeof(s_addr)), 0, "connect failed");
+
+	new_sock = accept(s_sock, (struct sockaddr *)&addr, &addrlen);
+	zassert_true(new_sock >= 0, "accept failed");
+
+	/* A listening socket has no data */
+	len = zsock_recvfrom_zc(s_sock, &frags, 0, NULL, NULL);
+	zassert_equal(len, -1, "");
+	zassert_equal(errno, ENOTCONN, "");
+
+	for (i = 0; i < ROUNDS; i++) {
+		len = send(c_sock, BUF_AND_SIZE(TEST_STR2), 0);
+		zassert_equal(len, STRLEN(TEST_STR2), "send failed");
+
+		/* Part of the segment is copied, the rest is lent */
+		len = recv(new_sock, buf, sizeof(buf), 0);
+		zassert_equal(len, sizeof(buf), "invalid recv len");
+
+		total = len;
+
+		while (total < STRLEN(TEST_STR2)) {
+			len = zsock_recvfrom_zc(new_sock, &frags, 0, NULL,
+						NULL);
+			zassert_true(len > 0, "recv failed (%d)", errno);
+			zassert_equal(linearize(frags), len, "wrong chain len");
+			zassert_mem_equal(rx_buf, TEST_STR2 + total, len,
+					  "wrong data");
+
+			zsock_recv_zc_release(frags);
+
+			total += len;
+		}
+
+		zassert_equal(total, STRLEN(TEST_STR2), "too much data");
+	}
+
+	zassert_equal(close(c_sock), 0, "close failed");
+
+	/* End of the stream */
+	len = zsock_recvfrom_zc(new_sock, &frags, 0, NULL, NULL);
+	zassert_equal(len, 0, "no end of stream");
+	zassert_is_null(frags, "");
+
+	zassert_equal(close(new_sock), 0, "close failed");
+	zassert_equal(close(s_sock), 0, "close failed");
+
+	/* Let the connections close */
+	k_msleep(100);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(socket_recv_zc,
+			 ztest_unit_test(test_recv_zc_udp),
+			 ztest_unit_test(test_recv_zc_tcp));
+
+	ztest_run_test_suite(socket_recv_zc);
+}
@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_SOCKETS_LOG_LEVEL);
+
+#include <ztest.h>
+#include <net/socket.h>
+#include <net/loopback.h>
+#include <net/net_stats.h>
+
+#include "../../socket_helpers.h"
+
+#define ANY_PORT 0
+#define SERVER_PORT 4242
+
+#define TRANSFER_SIZE (64 * 1024)
+#define CHUNK 1024
+/* The loopback drops one packet in every 1 / DROP_RATIO. Data segments
+ * and ACKs alternate, so an odd period drops some of each.
+ */
+#define DROP_RATIO (1.0f / 49)
+
+#define SENDER_STACK_SIZE 2048
+#define SENDER_PRIO K_PRIO_PREEMPT(8)
+
+#define TCP_TEARDOWN_TIMEOUT K_SECONDS(1)
+
+K_THREAD_STACK_DEFINE(sender_stack, SENDER_STACK_SIZE);
+static struct k_thread sender_thread;
+
+static uint8_t rx_buf[CHUNK];
+
+static void get_tcp_stats(struct net_stats_tcp *stats)
+{
+	zassert_equal(net_mgmt(NET_REQUEST_STATS_GET_TCP, NULL, stats,
+			       sizeof(*stats)), 0, "cannot get TCP stats");
+}
+
+static uint8_t pattern(size_t pos)
+{
+	return (uint8_t)(pos ^ (pos >> 8));
+}
+
+static void sender(void *p1, void *p2, void *p3)
+{
+	static uint8_t tx_buf[CHUNK];
+	int sock = POINTER_TO_INT(p1);
+	size_t pos = 0;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (pos < TRANSFER_SIZE) {
+		size_t len = MIN(sizeof(tx_buf), TRANSFER_SIZE - pos);
+		ssize_t ret;
+		size_t i;
+
+		for (i = 0; i < len; i++) {
+			tx_buf[i] = pattern(pos + i);
+		}
+
+		ret = send(sock, tx_buf, len, 0);
+		zassert_true(ret > 0, "send failed (%d)", errno);
+
+		pos += ret;
+	}
+}
+
+/* Stream data over the loopback interface while it loses packets. The
+ * lost segments must be resent, and at least some of them by fast
+ * retransmit rather than only after the retransmission timeout.
+ */
+static void test_loss(struct sockaddr *s_saddr, socklen_t s_addrlen,
+		      int c_sock, int s_sock)
+{
+	int dropped = loopback_get_num_dropped_packets();
+	struct net_stats_tcp before, after;
+	struct sockaddr addr;
+	socklen_t addrlen = sizeof(addr);
+	size_t pos = 0;
+	int64_t start;
+	int new_sock;
+
+	zassert_equal(bind(s_sock, s_saddr, s_addrlen), 0,
+		      "bind failed");
+	zassert_equal(listen(s_sock, 1), 0, "listen failed");
+	zassert_equal(connect(c_sock, s_saddr, s_addrlen),
+		      0, "connect failed");
+
+	new_sock = accept(s_sock, &addr, &addrlen);
+	zassert_true(new_sock >= 0, "accept failed");
+
+	/* The connection setup and teardown are not in the test scope */
+	zassert_equal(loopback_set_packet_drop_ratio(DROP_RATIO), 0,
+		      "cannot set drop ratio");
+
+	get_tcp_stats(&before);
+	start = k_uptime_get();
+
+	k_thread_create(&sender_thread, sender_stack,
+			K_THREAD_STACK_SIZEOF(sender_stack),
+			sender, INT_TO_POINTER(c_sock), NULL, NULL,
+			SENDER_PRIO, 0, K_NO_WAIT);
+
+	while (pos < TRANSFER_SIZE) {
+		ssize_t ret = recv(new_sock, rx_buf, sizeof(rx_buf), 0);
+		ssize_t i;
+
+		zassert_true(ret > 0, "recv failed (%d) at %zu", errno, pos);
+
+		for (i = 0; i < ret; i++) {
+			zassert_equal(rx_buf[i], pattern(pos + i),
+				      "corrupted data at %zu", pos + i);
+		}
+
+		pos += ret;
+	}
+
+	k_thread_join(&sender_thread, K_FOREVER);
+
+	get_tcp_stats(&after);
+
+	TC_PRINT("%d bytes in %d ms, %d packets dropped, "
+		 "%u segments resent, %u fast retransmits\n", TRANSFER_SIZE,
+		 (int)(k_uptime_get() - start),
+		 loopback_get_num_dropped_packets() - dropped,
+		 after.rexmit - before.rexmit,
+		 after.fast_rexmit - before.fast_rexmit);
+
+	zassert_true(loopback_get_num_dropped_packets() > dropped,
+		     "no packets were dropped");
+	zassert_true(after.rexmit > before.rexmit, "nothing was resent");
+	zassert_true(after.fast_rexmit > before.fast_rexmit,
+		     "losses were only recovered by timeout");
+
+	loopback_set_packet_drop_ratio(0.0f);
+
+	zassert_equal(close(c_sock), 0, "close failed");
+	zassert_equal(close(new_sock), 0, "close failed");
+	zassert_equal(close(s_sock), 0, "close failed");
+
+	k_sleep(TCP_TEARDOWN_TIMEOUT);
+}
+
+void test_v4_loss(void)
+{
+	struct sockaddr_in c_saddr, s_saddr;
+	int c_sock, s_sock;
+
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    &c_sock, &c_saddr);
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &s_sock, &s_saddr);
+
+	test_loss((struct sockaddr *)&s_saddr, sizeof(s_saddr),
+		  c_sock, s_sock);
+}
+
+void test_v6_loss(void)
+{
+	struct sockaddr_in6 c_saddr, s_saddr;
+	int c_sock, s_sock;
+
+	prepare_sock_tcp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, ANY_PORT,
+			    &c_sock, &c_saddr);
+	prepare_sock_tcp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, SERVER_PORT,
+			    &s_sock, &s_saddr);
+
+	test_loss((struct sockaddr *)&s_saddr, sizeof(s_saddr),
+		  c_sock, s_sock);
+}
+
+void test_main(void)
+{
+	k_thread_priority_set(k_current_get(), K_PRIO_PREEMPT(8));
+
+	ztest_test_suite(socket_tcp_loss,
+			 ztest_unit_test(test_v4_loss),
+			 ztest_unit_test(test_v6_loss));
+
+	ztest_run_test_suite(socket_tcp_loss);
+}
@@ -9,6 +9,7 @@
 LOG_MODULE_REGISTER(net_test, CONFIG_NET_SOCKETS_LOG_LEVEL);
 
 #include <stdio.h>
+#include <time.h>
 #include <sys/mutex.h>
 #include <ztest_assert.h>
 
@@ -704,6 +705,142 @@ void test_v6_sendmsg_recvfrom_connected(void)
 	zassert_equal(rv, 0, "close failed");
 }
 
+#define MMSG_COUNT 4
+
+void test_v4_sendmmsg_recvmmsg(void)
+{
+	int rv;
+	int client_sock;
+	int server_sock;
+	struct sockaddr_in client_addr;
+	struct sockaddr_in server_addr;
+	struct sockaddr_in src_addr[MMSG_COUNT];
+	struct mmsghdr msgs[MMSG_COUNT];
+	struct iovec io_vector[MMSG_COUNT][2];
+	struct timespec timeout;
+	char seq[MMSG_COUNT];
+	char head[MMSG_COUNT][2];
+	char tail[MMSG_COUNT][8];
+	int i;
+
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, CLIENT_PORT,
+			    &client_sock, &client_addr);
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &server_sock, &server_addr);
+
+	rv = bind(server_sock,
+		  (struct sockaddr *)&server_addr,
+		  sizeof(server_addr));
+	zassert_equal(rv, 0, "server bind failed");
+
+	rv = bind(client_sock,
+		  (struct sockaddr *)&client_addr,
+		  sizeof(client_addr));
+	zassert_equal(rv, 0, "client bind failed");
+
+	/* Send "test0" ... "test3", each from two buffers */
+	memset(msgs, 0, sizeof(msgs));
+
+	for (i = 0; i < MMSG_COUNT; i++) {
+		seq[i] = '0' + i;
+
+		io_vector[i][0].iov_base = TEST_STR_SMALL;
+		io_vector[i][0].iov_len = STRLEN(TEST_STR_SMALL);
+		io_vector[i][1].iov_base = &seq[i];
+		io_vector[i][1].iov_len = 1;
+
+		msgs[i].msg_hdr.msg_iov = io_vector[i];
+		msgs[i].msg_hdr.msg_iovlen = 2;
+		msgs[i].msg_hdr.msg_name = &server_addr;
+		msgs[i].msg_hdr.msg_namelen = sizeof(server_addr);
+	}
+
+	rv = sendmmsg(client_sock, msgs, MMSG_COUNT, 0);
+	zassert_equal(rv, MMSG_COUNT, "sendmmsg failed (%d)", errno);
+
+	for (i = 0; i < MMSG_COUNT; i++) {
+		zassert_equal(msgs[i].msg_len, STRLEN(TEST_STR_SMALL) + 1,
+			      "invalid sent length");
+	}
+
+	/* Receive them scattered to two buffers */
+	memset(msgs, 0, sizeof(msgs));
+
+	for (i = 0; i < MMSG_COUNT; i++) {
+		io_vector[i][0].iov_base = head[i];
+		io_vector[i][0].iov_len = sizeof(head[i]);
+		io_vector[i][1].iov_base = tail[i];
+		io_vector[i][1].iov_len = sizeof(tail[i]);
+
+		msgs[i].msg_hdr.msg_iov = io_vector[i];
+		msgs[i].msg_hdr.msg_iovlen = 2;
+		msgs[i].msg_hdr.msg_name = &src_addr[i];
+		msgs[i].msg_hdr.msg_namelen = sizeof(src_addr[i]);
+	}
+
+	rv = recvmmsg(server_sock, msgs, MMSG_COUNT, 0, NULL);
+	zassert_equal(rv, MMSG_COUNT, "recvmmsg failed (%d)", errno);
+
+	for (i = 0; i < MMSG_COUNT; i++) {
+		zassert_equal(msgs[i].msg_len, STRLEN(TEST_STR_SMALL) + 1,
+			      "invalid received length");
+		zassert_equal(msgs[i].msg_hdr.msg_flags, 0, "unexpected flags");
+		zassert_mem_equal(head[i], "te", 2, "invalid rx data");
+		zassert_mem_equal(tail[i], "st", 2, "invalid rx data");
+		zassert_equal(tail[i][2], '0' + i, "datagrams out of order");
+		zassert_equal(msgs[i].msg_hdr.msg_namelen, sizeof(src_addr[i]),
+			      "unexpected addrlen");
+		zassert_equal(src_addr[i].sin_port, client_addr.sin_port,
+			      "unexpected client port");
+	}
+
+	/* Two datagrams too long for the buffers, return what is there */
+	for (i = 0; i < 2; i++) {
+		rv = sendto(client_sock, BUF_AND_SIZE(TEST_STR_SMALL), 0,
+			    (struct sockaddr *)&server_addr,
+			    sizeof(server_addr));
+		zassert_equal(rv, STRLEN(TEST_STR_SMALL), "send failed");
+	}
+
+	for (i = 0; i < MMSG_COUNT; i++) {
+		msgs[i].msg_hdr.msg_iovlen = 1;
+		msgs[i].msg_hdr.msg_name = NULL;
+		msgs[i].msg_hdr.msg_namelen = 0;
+	}
+
+	rv = recvmmsg(server_sock, msgs, MMSG_COUNT, MSG_WAITFORONE,
+		      NULL);
+	zassert_equal(rv, 2, "recvmmsg did not return the queued datagrams");
+
+	for (i = 0; i < 2; i++) {
+		zassert_equal(msgs[i].msg_len, sizeof(head[i]),
+			      "invalid received length");
+		zassert_equal(msgs[i].msg_hdr.msg_flags, MSG_TRUNC,
+			      "truncation not reported");
+	}
+
+	rv = recvmmsg(server_sock, msgs, MMSG_COUNT, MSG_DONTWAIT, NULL);
+	zassert_equal(rv, -1, "recvmmsg should have failed");
+	zassert_equal(errno, EAGAIN, "incorrect errno value");
+
+	/* A blocking call gives up when the timeout expires */
+	timeout.tv_sec = 0;
+	timeout.tv_nsec = 100 * NSEC_PER_USEC * USEC_PER_MSEC;
+	rv = recvmmsg(server_sock, msgs, MMSG_COUNT, 0, &timeout);
+	zassert_equal(rv, -1, "recvmmsg should have timed out");
+	zassert_equal(errno, EAGAIN, "incorrect errno value");
+
+	timeout.tv_nsec = NSEC_PER_SEC;
+	rv = recvmmsg(server_sock, msgs, MMSG_COUNT, 0, &timeout);
+	zassert_equal(rv, -1, "recvmmsg should have failed");
+	zassert_equal(errno, EINVAL, "incorrect errno value");
+
+	rv = close(client_sock);
+	zassert_equal(rv, 0, "close failed");
+	rv = close(server_sock);
+	zassert_equal(rv, 0, "close failed");
+}
+
 void test_so_type(void)
 {
 	struct sockaddr_in bind_addr4;
@@ -1227,6 +1364,8 @@ void test_main(void)
 			 ztest_user_unit_test(test_v4_sendmsg_recvfrom_connected),
 			 ztest_unit_test(test_v6_sendmsg_recvfrom_connected),
 			 ztest_user_unit_test(test_v6_sendmsg_recvfrom_connected),
+			 ztest_unit_test(test_v4_sendmmsg_recvmmsg),
+			 ztest_user_unit_test(test_v4_sendmmsg_recvmmsg),
 			 ztest_unit_test(test_setup_eth),
 			 ztest_unit_test(test_v6_sendmsg_with_txtime),
 			 ztest_user_unit_test(test_v6_sendmsg_with_txtime),
@@ -119,6 +119,7 @@ static void handle_syn_resend(void);
 static void handle_client_fin_wait_2_test(sa_family_t af, struct tcphdr *th);
 static void handle_client_closing_test(sa_family_t af, struct tcphdr *th);
 static void handle_server_recv_out_of_order(struct net_pkt *pkt);
+static void handle_server_recv_burst(struct net_pkt *pkt);
 
 static void verify_flags(struct tcphdr *th, uint8_t flags,
 			 const char *fun, int line)
@@ -414,6 +415,9 @@ static int tester_send(const struct device *dev, struct net_pkt *pkt)
 	case 9:
 		handle_server_recv_out_of_order(pkt);
 		break;
+	case 10:
+		handle_server_recv_burst(pkt);
+		break;
 	default:
 		zassert_true(false, "Undefined test case");
 	}
@@ -1332,6 +1336,9 @@ static void test_client_invalid_rst(void)
 static uint32_t expected_ack = MAX_DATA + 1 - 15;
 static struct net_context *ooo_ctx;
 
+/* Every out-of-order segment is answered by a duplicate ACK of this */
+static uint32_t ooo_dup_ack;
+
 static void handle_server_recv_out_of_order(struct net_pkt *pkt)
 {
 	struct tcphdr th;
@@ -1342,6 +1349,10 @@ static void handle_server_recv_out_of_order(struct net_pkt *pkt)
 		goto fail;
 	}
 
+	if (ntohl(th.th_ack) == ooo_dup_ack) {
+		return;
+	}
+
 	/* Verify that we received all the queued data */
 	zassert_equal(expected_ack, ntohl(th.th_ack),
 		      "Not all pending data received. "
@@ -1372,6 +1383,7 @@ static void test_server_recv_out_of_order_data(void)
 	 * testing purposes)
 	 */
 	ooo_ctx = create_server_socket(-15U, -15U);
+	ooo_dup_ack = seq;
 
 	/* This will force the packet to be routed to our checker func
 	 * handle_server_recv_out_of_order()
@@ -1449,6 +1461,7 @@ static void test_server_timeout_out_of_order_data(void)
 	}
 
 	k_sem_reset(&test_sem);
+	ooo_dup_ack = expected_ack;
 
 	/* The +1 will cause the seq to be not sequential thus we should
 	 * get a timeout.
@@ -1478,6 +1491,88 @@ static void test_server_timeout_out_of_order_data(void)
 	net_tcp_put(ooo_ctx);
 }
 
+#define BURST_SEGMENTS 5
+#define BURST_SEGMENT_LEN 10
+static uint32_t burst_ack;
+static int burst_acks;
+
+static void handle_server_recv_burst(struct net_pkt *pkt)
+{
+	struct tcphdr th;
+	int ret;
+
+	ret = read_tcp_header(pkt, &th);
+	if (ret < 0) {
+		goto fail;
+	}
+
+	if (!(th.th_flags & ACK) || (th.th_flags & FIN)) {
+		return;
+	}
+
+	burst_acks++;
+
+	if (ntohl(th.th_ack) == burst_ack) {
+		test_sem_give();
+	}
+
+	return;
+
+fail:
+	zassert_true(false, "%s failed", __func__);
+	net_pkt_unref(pkt);
+}
+
+/* Segments that are queued together are acknowledged at once when the
+ * receive offload merges them.
+ */
+static void test_server_recv_burst(void)
+{
+	struct net_context *ctx;
+	struct net_pkt *pkt;
+	int ret, i;
+
+	ctx = create_server_socket(0, 0);
+
+	test_case_no = 10;
+	burst_ack = seq + BURST_SEGMENTS * BURST_SEGMENT_LEN;
+	burst_acks = 0;
+
+	/* The test thread is cooperative, so the packets stay in the RX
+	 * queue until all of them have been passed.
+	 */
+	for (i = 0; i < BURST_SEGMENTS; i++) {
+		pkt = prepare_data_packet(AF_INET6, htons(MY_PORT),
+					  htons(PEER_PORT),
+					  &lorem_ipsum[i * BURST_SEGMENT_LEN],
+					  BURST_SEGMENT_LEN);
+		zassert_not_null(pkt, "Cannot create pkt");
+
+		ret = net_recv_data(iface, pkt);
+		zassert_true(ret == 0, "recv data failed (%d)", ret);
+
+		seq += BURST_SEGMENT_LEN;
+	}
+
+	test_sem_take(K_MSEC(100), __LINE__);
+
+	if (IS_ENABLED(CONFIG_NET_TCP_GRO)) {
+		zassert_equal(burst_acks, 1, "Burst acknowledged in %d ACKs",
+			      burst_acks);
+	}
+
+	/* Reset the connection, the following tests use the same ports */
+	pkt = prepare_rst_packet(AF_INET6, htons(MY_PORT), htons(PEER_PORT));
+	zassert_not_null(pkt, "Cannot create pkt");
+
+	ret = net_recv_data(iface, pkt);
+	zassert_true(ret == 0, "recv data failed (%d)", ret);
+
+	k_msleep(50);
+
+	net_tcp_put(ctx);
+}
+
 /** Test case main entry */
 void test_main(void)
 {
@@ -1492,6 +1587,7 @@ void test_main(void)
 			 ztest_unit_test(test_client_fin_wait_2_ipv4),
 			 ztest_unit_test(test_client_closing_ipv6),
 			 ztest_unit_test(test_client_invalid_rst),
+			 ztest_unit_test(test_server_recv_burst),
 			 ztest_unit_test(test_server_recv_out_of_order_data),
 			 ztest_unit_test(test_server_timeout_out_of_order_data)
 			 );
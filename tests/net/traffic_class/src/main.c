@@ -968,10 +968,86 @@ static void test_traffic_class_recv_data_mix_all_2(void)
 	zassert_false(test_failed, "Traffic class verification failed.");
 }
 
+static struct net_pkt *flow_pkt(struct net_if *iface, uint16_t src_port)
+{
+	struct net_udp_hdr udp_hdr = {
+		.src_port = htons(src_port),
+		.dst_port = htons(TEST_PORT),
+		.len = htons(sizeof(udp_hdr)),
+	};
+	struct net_pkt *pkt;
+
+	pkt = net_pkt_alloc_with_buffer(iface, sizeof(udp_hdr), AF_INET6,
+					IPPROTO_UDP, K_NO_WAIT);
+	zassert_not_null(pkt, "Cannot allocate pkt");
+
+	zassert_equal(net_ipv6_create(pkt, &my_addr1, &dst_addr), 0,
+		      "Cannot create IPv6 header");
+	zassert_equal(net_pkt_write(pkt, &udp_hdr, sizeof(udp_hdr)), 0,
+		      "Cannot write UDP header");
+
+	net_pkt_cursor_init(pkt);
+	zassert_equal(net_ipv6_finalize(pkt, IPPROTO_UDP), 0,
+		      "Cannot finalize IPv6 packet");
+
+	return pkt;
+}
+
+static void flow_queue_check(int tc, uint8_t queue)
+{
+	zassert_true(queue >= tc * NET_TC_RSS_QUEUES &&
+		     queue < (tc + 1) * NET_TC_RSS_QUEUES,
+		     "Queue %d is not in traffic class %d", queue, tc);
+}
+
+static void test_traffic_class_flow_queue(void)
+{
+	struct net_if *iface = net_if_get_first_by_type(&NET_L2_GET_NAME(DUMMY));
+	int tx_tc = net_tx_priority2tc(NET_PRIORITY_BE);
+	int rx_tc = net_rx_priority2tc(NET_PRIORITY_BE);
+	uint32_t tx_used = 0U, rx_used = 0U;
+	struct net_pkt *pkt;
+	uint8_t tx_queue, rx_queue;
+	int i;
+
+	for (i = 0; i < 64; i++) {
+		pkt = flow_pkt(iface, 1024 + i);
+
+		tx_queue = net_tc_tx_queue(tx_tc, pkt);
+		rx_queue = net_tc_rx_queue(rx_tc, pkt);
+
+		flow_queue_check(tx_tc, tx_queue);
+		flow_queue_check(rx_tc, rx_queue);
+
+		/* The packets of a flow always use the same queue */
+		zassert_equal(net_tc_tx_queue(tx_tc, pkt), tx_queue,
+			      "TX queue of the flow changed");
+		zassert_equal(net_tc_rx_queue(rx_tc, pkt), rx_queue,
+			      "RX queue of the flow changed");
+
+		net_pkt_unref(pkt);
+
+		pkt = flow_pkt(iface, 1024 + i);
+		zassert_equal(net_tc_tx_queue(tx_tc, pkt), tx_queue,
+			      "TX queue of the flow changed");
+		net_pkt_unref(pkt);
+
+		tx_used |= BIT(tx_queue % NET_TC_RSS_QUEUES);
+		rx_used |= BIT(rx_queue % NET_TC_RSS_QUEUES);
+	}
+
+	/* Different flows are spread over all the queues of the class */
+	zassert_equal(tx_used, BIT_MASK(NET_TC_RSS_QUEUES),
+		      "TX flows not spread (0x%x)", tx_used);
+	zassert_equal(rx_used, BIT_MASK(NET_TC_RSS_QUEUES),
+		      "RX flows not spread (0x%x)", rx_used);
+}
+
 void test_main(void)
 {
 	ztest_test_suite(net_traffic_class_test,
 			 ztest_unit_test(test_traffic_class_general_setup),
+			 ztest_unit_test(test_traffic_class_flow_queue),
 			 ztest_unit_test(test_traffic_class_setup_tx),
 			 /* Send only same priority packets and verify that
 			  * all are sent with proper traffic class.
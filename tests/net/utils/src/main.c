@@ -848,11 +848,148 @@ void test_addr_parse(void)
 #endif
 }
 
+static uint8_t chksum_data[512];
+
+/* Plain byte pair one's complement sum used as the reference */
+static uint16_t chksum_ref(uint32_t sum, const uint8_t *data, size_t len)
+{
+	size_t i;
+
+	for (i = 0; i + 1 < len; i += 2) {
+		sum += (data[i] << 8) | data[i + 1];
+	}
+
+	if (len % 2) {
+		sum += data[len - 1] << 8;
+	}
+
+	while (sum >> 16) {
+		sum = (sum & 0xffff) + (sum >> 16);
+	}
+
+	return sum;
+}
+
+static void chksum_fill(void)
+{
+	uint32_t state = 0x12345678;
+	int i;
+
+	for (i = 0; i < sizeof(chksum_data); i++) {
+		state = state * 1103515245U + 12345U;
+		chksum_data[i] = state >> 16;
+	}
+}
+
+/* Fragment lengths of the test packets, the first one holds the 40 byte
+ * IPv6 header.
+ */
+static const uint16_t chksum_frags[][4] = {
+	{ 40, 0, 0, 0 },
+	{ 41, 0, 0, 0 },
+	{ 43, 1, 0, 0 },
+	{ 45, 3, 64, 7 },
+	{ 100, 2, 1, 125 },
+	{ 125, 125, 125, 125 },
+	{ 48, 120, 96, 125 },
+};
+
+static void test_chksum(void)
+{
+	uint16_t len, expected, sum;
+	struct net_pkt *pkt;
+	struct net_buf *buf;
+	int i, j, align;
+	size_t off;
+
+	chksum_fill();
+
+	for (i = 0; i < ARRAY_SIZE(chksum_frags); i++) {
+		for (align = 0; align < 4; align++) {
+			pkt = net_pkt_alloc(K_NO_WAIT);
+			zassert_not_null(pkt, "Cannot allocate pkt");
+
+			net_pkt_set_family(pkt, AF_INET6);
+			net_pkt_set_ip_hdr_len(pkt, NET_IPV6H_LEN);
+			net_pkt_set_ipv6_ext_len(pkt, 0);
+
+			off = 0;
+
+			for (j = 0; j < 4 && chksum_frags[i][j]; j++) {
+				buf = net_pkt_get_frag(pkt, K_NO_WAIT);
+				zassert_not_null(buf, "Cannot allocate frag");
+
+				/* Vary the alignment of the data */
+				net_buf_reserve(buf, align);
+				net_buf_add_mem(buf, chksum_data + off,
+						chksum_frags[i][j]);
+				net_pkt_frag_add(pkt, buf);
+
+				off += chksum_frags[i][j];
+			}
+
+			/* Pseudo header and the payload */
+			len = off - NET_IPV6H_LEN;
+			sum = chksum_ref(len + IPPROTO_UDP, chksum_data + 8,
+					 2 * sizeof(struct in6_addr));
+			sum = chksum_ref(sum, chksum_data + NET_IPV6H_LEN, len);
+			expected = ~htons(sum);
+
+			zassert_equal(net_calc_chksum(pkt, IPPROTO_UDP),
+				      expected, "Wrong checksum %d/%d", i,
+				      align);
+
+			net_pkt_unref(pkt);
+		}
+	}
+}
+
+static void test_chksum_update(void)
+{
+	uint8_t hdr[NET_IPV4H_LEN];
+	uint16_t chksum, old_val, new_val;
+	struct in_addr addr = { { { 192, 0, 2, 42 } } };
+	struct in_addr old_addr;
+	int i;
+
+	chksum_fill();
+
+	for (i = 0; i < sizeof(hdr); i += 2) {
+		memcpy(hdr, chksum_data + i, sizeof(hdr));
+
+		chksum = htons(~chksum_ref(0, hdr, sizeof(hdr)));
+
+		/* Rewrite a 16 bit word, like a TTL or a length */
+		old_val = UNALIGNED_GET((uint16_t *)&hdr[i]);
+		new_val = old_val + 0x0102;
+		UNALIGNED_PUT(new_val, (uint16_t *)&hdr[i]);
+
+		chksum = net_calc_chksum_update16(chksum, old_val, new_val);
+		zassert_equal(chksum, htons(~chksum_ref(0, hdr, sizeof(hdr))),
+			      "Wrong 16 bit update at %d", i);
+
+		if (i + sizeof(addr) > sizeof(hdr)) {
+			continue;
+		}
+
+		/* Rewrite an address, like NAT */
+		memcpy(&old_addr, &hdr[i], sizeof(old_addr));
+		memcpy(&hdr[i], &addr, sizeof(addr));
+
+		chksum = net_calc_chksum_update(chksum, &old_addr, &addr,
+						sizeof(addr));
+		zassert_equal(chksum, htons(~chksum_ref(0, hdr, sizeof(hdr))),
+			      "Wrong address update at %d", i);
+	}
+}
+
 void test_main(void)
 {
 	ztest_test_suite(test_utils_fn,
 			 ztest_user_unit_test(test_net_addr),
-			 ztest_unit_test(test_addr_parse));
+			 ztest_unit_test(test_addr_parse),
+			 ztest_unit_test(test_chksum),
+			 ztest_unit_test(test_chksum_update));
 
 	ztest_run_test_suite(test_utils_fn);
 }